@@ -26,7 +26,8 @@ common_exynos_dirs := \
 	libvideocodec \
 	libmpp \
 	libhwcutils \
-	libdisplay
+	libdisplay \
+	libcamera/common/bench
 
 ifneq ($(BOARD_TV_PRIMARY), true)
 common_exynos_dirs += \
@@ -35,6 +35,7 @@ extern "C" {
 #endif
 
 #define CSC_MAX_PLANES 3
+#define CSC_SW_THREADS_MAX 8
 
 typedef enum _CSC_ERRORCODE {
     CSC_ErrorNone = 0,
@@ -142,6 +143,10 @@ typedef struct _CSC_HANDLE {
     CSC_EQ_MODE       csc_mode;
     CSC_EQ_RANGE      csc_range;
     CSC_EQ_COLORSPACE colorspace;
+
+    /* band-parallel software conversion */
+    unsigned int    sw_threads;
+    void           *sw_pool;
 } CSC_HANDLE;
 
 /*
@@ -241,6 +246,25 @@ CSC_ERRORCODE csc_set_hw_property(
     CSC_HW_PROPERTY_TYPE property,
     int                  value);
 
+/*
+ * Set number of threads for software conversion
+ *
+ * Conversions with CSC_METHOD_SW are split into row bands and run on a
+ * persistent worker pool owned by the handle. 0 or 1 disables it.
+ *
+ * @param handle
+ *   CSC handle[in]
+ *
+ * @param threads
+ *   number of threads, including the caller[in]
+ *
+ * @return
+ *   error code
+ */
+CSC_ERRORCODE csc_set_sw_threads(
+    void           *handle,
+    unsigned int    threads);
+
 /*
  * Get csc equation property.
  *
@@ -0,0 +1,85 @@
+/*
+ * Copyright@ Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _EXYNOS_PLANE_COPY_H_
+#define _EXYNOS_PLANE_COPY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* YUV 4:2:0 plane orders handled by exynos_plane_copy() */
+enum {
+    PLANE_COPY_FMT_NONE = -1,
+    PLANE_COPY_FMT_NV12 = 0,    /* Y, CbCr interleaved */
+    PLANE_COPY_FMT_NV21,        /* Y, CrCb interleaved */
+    PLANE_COPY_FMT_I420,        /* Y, Cb, Cr */
+    PLANE_COPY_FMT_YV12,        /* Y, Cr, Cb */
+};
+
+typedef struct {
+    unsigned char *plane[3];    /* Y, chroma 1, chroma 2 (semi-planar uses two) */
+    unsigned int   stride[3];   /* bytes per line of each plane */
+    int            format;      /* PLANE_COPY_FMT_XXX */
+} plane_copy_image_t;
+
+/*
+ * Map v4l2_pixel_format / hal_pixel_format to PLANE_COPY_FMT_XXX.
+ *
+ * @return
+ *   PLANE_COPY_FMT_XXX, or PLANE_COPY_FMT_NONE when unsupported
+ */
+int exynos_plane_copy_v4l2_format(
+    unsigned int v4l2_pixel_format);
+
+int exynos_plane_copy_hal_format(
+    int hal_pixel_format);
+
+/*
+ * Copy one plane of height lines, width bytes each, between strided buffers.
+ * Contiguous planes are copied with a single memcpy.
+ */
+void exynos_copy_plane(
+    unsigned char *dst,
+    unsigned int   dst_stride,
+    const unsigned char *src,
+    unsigned int   src_stride,
+    unsigned int   width,
+    unsigned int   height);
+
+/*
+ * Copy the (crop_x, crop_y, width, height) window of src into the top-left
+ * of dst. Chroma order and interleaving are converted in the same pass when
+ * src->format differs from dst->format (NV12 <-> NV21 <-> I420 <-> YV12).
+ * crop_x and crop_y are rounded down to even values; chroma covers
+ * (width / 2) x (height / 2) samples.
+ *
+ * @return
+ *   0 on success, -1 on invalid argument
+ */
+int exynos_plane_copy(
+    const plane_copy_image_t *src,
+    const plane_copy_image_t *dst,
+    unsigned int crop_x,
+    unsigned int crop_y,
+    unsigned int width,
+    unsigned int height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -41,9 +41,33 @@ extern "C" {
 
 /* V4L2 */
 #include <stdbool.h>
+#include <sys/types.h>
 #include <linux/videodev2.h> /* vendor specific videodev2.h */
 #include <linux/videodev2_exynos_media.h>
 
+/*!
+ * \ingroup exynos_v4l2
+ * \brief Device backend
+ *
+ * A registered backend serves every node whose path (exynos_v4l2_open) or
+ * video4linux name (exynos_v4l2_open_devname) it matches, and all the calls
+ * on the fd it returned are routed to it. ioctl() follows the ioctl(2)
+ * convention: -1 with errno set on failure. mmap may be NULL.
+ */
+struct exynos_v4l2_backend {
+    const char *name;
+    bool  (*match)(const char *name);
+    int   (*open)(const char *name, int oflag);
+    int   (*close)(int fd);
+    int   (*ioctl)(int fd, unsigned long request, void *arg);
+    void *(*mmap)(int fd, size_t length, int prot, int flags, off_t offset);
+};
+
+/*! \ingroup exynos_v4l2 */
+int exynos_v4l2_register_backend(const struct exynos_v4l2_backend *backend);
+/*! \ingroup exynos_v4l2 */
+int exynos_v4l2_unregister_backend(const struct exynos_v4l2_backend *backend);
+
 /*! \ingroup exynos_v4l2 */
 int exynos_v4l2_open(const char *filename, int oflag, ...);
 /*! \ingroup exynos_v4l2 */
@@ -51,6 +75,8 @@ int exynos_v4l2_open_devname(const char *devname, int oflag, ...);
 /*! \ingroup exynos_v4l2 */
 int exynos_v4l2_close(int fd);
 /*! \ingroup exynos_v4l2 */
+void *exynos_v4l2_mmap(int fd, size_t length, int prot, int flags, off_t offset);
+/*! \ingroup exynos_v4l2 */
 bool exynos_v4l2_enuminput(int fd, int index, char *input_name_buf);
 /*! \ingroup exynos_v4l2 */
 int exynos_v4l2_s_input(int fd, int index);
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      exynos_v4l2_fake_mfc.h
+ * \brief     header file for the in-process MFC backend of libv4l2
+ *
+ */
+
+/*!
+ * \defgroup exynos_v4l2_fake_mfc
+ * \brief In-process stand-in for the MFC decoder/encoder nodes
+ * \addtogroup Exynos
+ *
+ * Once installed, exynos_v4l2_open_devname() of the MFC and HEVC nodes
+ * returns an instance of this backend instead of the kernel device, so
+ * libvideocodec runs without the hardware. Nothing is decoded: every
+ * stream buffer turns into one picture after decode_latency_us, one at a
+ * time, the way the MFC firmware serializes frames. The fd is an eventfd:
+ * POLLIN is set while a capture buffer can be dequeued, as on the device,
+ * but POLLOUT is always set, so a DQBUF of the output queue doesn't wait
+ * and fails with EAGAIN when no stream/source buffer is done yet.
+ */
+
+#ifndef __EXYNOS_V4L2_FAKE_MFC_H__
+#define __EXYNOS_V4L2_FAKE_MFC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \ingroup exynos_v4l2_fake_mfc */
+struct exynos_v4l2_fake_mfc_config {
+    unsigned int decode_latency_us;
+    /* coded size reported once the first stream buffer (the header) is consumed */
+    unsigned int width;
+    unsigned int height;
+    /* V4L2_CID_MIN_BUFFERS_FOR_CAPTURE */
+    unsigned int min_dpb;
+    /* pictures a decoded frame stays referenced, it is not written while referenced */
+    unsigned int ref_frames;
+    /* decoded frame number (from 1) that reports a resolution change, 0 for never */
+    unsigned int resolution_change_frame;
+    unsigned int new_width;
+    unsigned int new_height;
+};
+
+/*! \ingroup exynos_v4l2_fake_mfc */
+int exynos_v4l2_fake_mfc_install(const struct exynos_v4l2_fake_mfc_config *config);
+/*! \ingroup exynos_v4l2_fake_mfc */
+int exynos_v4l2_fake_mfc_uninstall(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EXYNOS_V4L2_FAKE_MFC_H__ */
@@ -57,6 +57,11 @@ ExynosCamera::ExynosCamera(int cameraId, camera_device_t *dev)
     /* preview Buffer */
     m_scpBufferMgr = NULL;
     m_createInternalBufferManager(&m_previewCallbackBufferMgr, "PREVIEW_CB_BUF");
+    for (int i = 0; i < MAX_BUFFERS; i++) {
+        m_previewCallbackHeap[i] = NULL;
+        m_previewCallbackHeapFd[i] = -1;
+        m_previewCallbackHeapSize[i] = 0;
+    }
     m_createInternalBufferManager(&m_highResolutionCallbackBufferMgr, "HIGH_RESOLUTION_CB_BUF");
 
     /* recording Buffer */
@@ -86,6 +91,11 @@ ExynosCamera::ExynosCamera(int cameraId, camera_device_t *dev)
 
     m_jpegCallbackQ->setWaitTime(1000000000);
 
+    /* lock-free ring : every pipe thread pushes to doneQ, only main thread pushes to previewQ */
+    m_pipeFrameDoneQ->setMode(LIST_MODE_RING_MPSC, FRAME_QUEUE_RING_SIZE);
+    m_previewQ->setMode(LIST_MODE_RING_SPSC, FRAME_QUEUE_RING_SIZE);
+    m_previewFrontQ->setMode(LIST_MODE_RING_SPSC, FRAME_QUEUE_RING_SIZE);
+
     memset(&m_frameMetadata, 0, sizeof(camera_frame_metadata_t));
     memset(m_faces, 0, sizeof(camera_face_t) * NUM_OF_DETECTED_FACES);
 
@@ -428,6 +438,7 @@ void ExynosCamera::release()
         ALOGD("DEBUG(%s):BufferManager(jpegBufferMgr) destroyed", __FUNCTION__);
     }
 
+    m_releasePreviewCallbackHeap();
     if (m_previewCallbackBufferMgr != NULL) {
         delete m_previewCallbackBufferMgr;
         m_previewCallbackBufferMgr = NULL;
@@ -925,6 +936,7 @@ void ExynosCamera::stopPreview()
         m_recordingBufferMgr->deinit();
     }
     if (m_previewCallbackBufferMgr != NULL) {
+        m_releasePreviewCallbackHeap();
         m_previewCallbackBufferMgr->deinit();
     }
     if (m_highResolutionCallbackBufferMgr != NULL) {
@@ -2446,6 +2458,7 @@ status_t ExynosCamera::m_restartPreviewInternal(void)
         m_scpBufferMgr->deinit();
     }
     if (m_previewCallbackBufferMgr != NULL) {
+        m_releasePreviewCallbackHeap();
         m_previewCallbackBufferMgr->deinit();
     }
 #endif
@@ -2492,6 +2505,7 @@ status_t ExynosCamera::m_restartPreviewInternal(void)
         m_scpBufferMgr->setBufferCount(0);
     }
     if (m_previewCallbackBufferMgr != NULL) {
+        m_releasePreviewCallbackHeap();
         m_previewCallbackBufferMgr->deinit();
     }
 
@@ -2613,7 +2627,7 @@ bool ExynosCamera::m_mainThreadFunc(void)
 
         if (newFrame->getFrameLockState() == false)
         {
-            delete newFrame;
+            releaseFrame(newFrame);
             newFrame = NULL;
         }
     }
@@ -3110,7 +3124,7 @@ bool ExynosCamera::m_previewThreadFunc(void)
 func_exit:
 
     if (frame != NULL) {
-        delete frame;
+        releaseFrame(frame);
         frame = NULL;
     }
 
@@ -3158,6 +3172,109 @@ status_t ExynosCamera::m_setCallbackBufferInfo(ExynosCameraBuffer *callbackBuf,
     return NO_ERROR;
 }
 
+static status_t setPlaneCopyImage(ExynosCameraBuffer *buf, int v4l2Format, int w, int h, int stride, plane_copy_image_t *image)
+{
+    bool semiPlanar = false;
+
+    image->format = exynos_plane_copy_v4l2_format(v4l2Format);
+    if (image->format == PLANE_COPY_FMT_NONE || w <= 0 || h <= 1 || stride < w) {
+        ALOGE("ERR(%s[%d]):unsupported format(%x) size(%dx%d) stride(%d)",
+            __FUNCTION__, __LINE__, v4l2Format, w, h, stride);
+        return BAD_VALUE;
+    }
+
+    semiPlanar = (image->format == PLANE_COPY_FMT_NV12 || image->format == PLANE_COPY_FMT_NV21);
+
+    for (int plane = 0; plane < 3; plane++) {
+        if (plane == 2 && semiPlanar == true) {
+            image->plane[plane] = NULL;
+            image->stride[plane] = 0;
+            continue;
+        }
+
+        image->plane[plane] = (unsigned char *)buf->addr[plane];
+        image->stride[plane] = (plane == 0 || semiPlanar == true) ? stride : stride / 2;
+    }
+
+    return NO_ERROR;
+}
+
+status_t ExynosCamera::m_copyPreviewPlanes(
+        ExynosCameraBuffer *srcBuf, int srcFormat, int srcW, int srcH, int srcStride,
+        ExynosCameraBuffer *dstBuf, int dstFormat, int dstW, int dstH, int dstStride)
+{
+    plane_copy_image_t srcImage;
+    plane_copy_image_t dstImage;
+
+    if (setPlaneCopyImage(srcBuf, srcFormat, srcW, srcH, srcStride, &srcImage) != NO_ERROR ||
+        setPlaneCopyImage(dstBuf, dstFormat, dstW, dstH, dstStride, &dstImage) != NO_ERROR)
+        return BAD_VALUE;
+
+    if (exynos_plane_copy(&srcImage, &dstImage, 0, 0,
+                          (srcW < dstW) ? srcW : dstW,
+                          (srcH < dstH) ? srcH : dstH) < 0) {
+        ALOGE("ERR(%s[%d]):exynos_plane_copy(%dx%d -> %dx%d) fail",
+            __FUNCTION__, __LINE__, srcW, srcH, dstW, dstH);
+        return INVALID_OPERATION;
+    }
+
+    return NO_ERROR;
+}
+
+camera_memory_t *ExynosCamera::m_getPreviewCallbackHeap(ExynosCameraBuffer *callbackBuf)
+{
+    Mutex::Autolock lock(m_previewCallbackHeapLock);
+
+    int index = callbackBuf->index;
+    int fd = callbackBuf->fd[0];
+    unsigned int size = callbackBuf->size[0];
+
+    if (index < 0 || MAX_BUFFERS <= index) {
+        ALOGE("ERR(%s[%d]):invalid callback buffer index(%d)", __FUNCTION__, __LINE__, index);
+        return NULL;
+    }
+
+    if (m_previewCallbackHeap[index] != NULL &&
+        (m_previewCallbackHeapFd[index] != fd || m_previewCallbackHeapSize[index] != size)) {
+        ALOGD("DEBUG(%s[%d]):callback buffer(%d) changed, fd(%d->%d) size(%d->%d), remap",
+            __FUNCTION__, __LINE__, index,
+            m_previewCallbackHeapFd[index], fd, m_previewCallbackHeapSize[index], size);
+        m_previewCallbackHeap[index]->release(m_previewCallbackHeap[index]);
+        m_previewCallbackHeap[index] = NULL;
+    }
+
+    if (m_previewCallbackHeap[index] == NULL) {
+        camera_memory_t *heap = m_getMemoryCb(fd, size, 1, m_callbackCookie);
+        if (heap == NULL || heap->data == MAP_FAILED) {
+            ALOGE("ERR(%s[%d]):m_getMemoryCb(index(%d), fd(%d), size(%d)) fail",
+                __FUNCTION__, __LINE__, index, fd, size);
+            if (heap != NULL)
+                heap->release(heap);
+            return NULL;
+        }
+
+        m_previewCallbackHeap[index] = heap;
+        m_previewCallbackHeapFd[index] = fd;
+        m_previewCallbackHeapSize[index] = size;
+    }
+
+    return m_previewCallbackHeap[index];
+}
+
+void ExynosCamera::m_releasePreviewCallbackHeap(void)
+{
+    Mutex::Autolock lock(m_previewCallbackHeapLock);
+
+    for (int i = 0; i < MAX_BUFFERS; i++) {
+        if (m_previewCallbackHeap[i] != NULL) {
+            m_previewCallbackHeap[i]->release(m_previewCallbackHeap[i]);
+            m_previewCallbackHeap[i] = NULL;
+        }
+        m_previewCallbackHeapFd[i] = -1;
+        m_previewCallbackHeapSize[i] = 0;
+    }
+}
+
 status_t ExynosCamera::m_doPreviewToCallbackFunc(
         int32_t pipeId,
         ExynosCameraFrame *newFrame,
@@ -3182,7 +3299,16 @@ status_t ExynosCamera::m_doPreviewToCallbackFunc(
     ExynosRect srcRect, dstRect;
 
     camera_memory_t *previewCallbackHeap = NULL;
-    previewCallbackHeap = m_getMemoryCb(callbackBuf.fd[0], callbackBuf.size[0], 1, m_callbackCookie);
+
+    probeTimer.start();
+    previewCallbackHeap = m_getPreviewCallbackHeap(&callbackBuf);
+    probeTimer.stop();
+    ALOGV("DEBUG(%s[%d]):callback heap(%d) acquired in %d usec",
+        __FUNCTION__, __LINE__, callbackBuf.index, (int)probeTimer.durationUsecs());
+    if (previewCallbackHeap == NULL) {
+        ALOGE("ERR(%s[%d]):m_getPreviewCallbackHeap(index(%d)) fail", __FUNCTION__, __LINE__, callbackBuf.index);
+        return INVALID_OPERATION;
+    }
 
     ret = m_setCallbackBufferInfo(&callbackBuf, (char *)previewCallbackHeap->data);
     if (ret < 0) {
@@ -3247,22 +3373,22 @@ status_t ExynosCamera::m_doPreviewToCallbackFunc(
             }
         }
 #endif
-    } else { /* neon memcpy */
-        char *srcAddr = NULL;
-        char *dstAddr = NULL;
-        int planeCount = getYuvPlaneCount(hwPreviewFormat);
-        if (planeCount <= 0) {
-            ALOGE("ERR(%s[%d]):getYuvPlaneCount(%d) fail", __FUNCTION__, __LINE__, hwPreviewFormat);
+    } else { /* neon copy */
+        int previewW = 0, previewH = 0;
+        int hwPreviewStride = m_exynosCameraParameters->getHwPreviewStride();
+        m_exynosCameraParameters->getPreviewSize(&previewW, &previewH);
+
+        /* the stride is only set with USE_BUFFER_WITH_STRIDE, the callback heap is packed */
+        if (hwPreviewStride < hwPreviewW)
+            hwPreviewStride = hwPreviewW;
+
+        ret = m_copyPreviewPlanes(&previewBuf, hwPreviewFormat, hwPreviewW, hwPreviewH, hwPreviewStride,
+                                  &callbackBuf, m_exynosCameraParameters->getPreviewFormat(), previewW, previewH, previewW);
+        if (ret < 0) {
+            ALOGE("ERR(%s[%d]):m_copyPreviewPlanes fail, ret(%d)", __FUNCTION__, __LINE__, ret);
             statusRet = INVALID_OPERATION;
             goto done;
         }
-
-        /* TODO : have to consider all fmt(planes) and stride */
-        for (int plane = 0; plane < planeCount; plane++) {
-            srcAddr = previewBuf.addr[plane];
-            dstAddr = callbackBuf.addr[plane];
-            memcpy(dstAddr, srcAddr, callbackBuf.size[plane]);
-        }
     }
 
     probeTimer.start();
@@ -3283,8 +3409,6 @@ status_t ExynosCamera::m_doPreviewToCallbackFunc(
         ALOGV("(%s[%d]):(%d) %5d ", __FUNCTION__, __LINE__, fcount, (int)probeTimer.durationMsecs());
 
 done:
-    previewCallbackHeap->release(previewCallbackHeap);
-
     return statusRet;
 }
 
@@ -3306,7 +3430,11 @@ status_t ExynosCamera::m_doCallbackToPreviewFunc(
     m_exynosCameraParameters->getHwPreviewSize(&hwPreviewW, &hwPreviewH);
 
     camera_memory_t *previewCallbackHeap = NULL;
-    previewCallbackHeap = m_getMemoryCb(callbackBuf.fd[0], callbackBuf.size[0], 1, m_callbackCookie);
+    previewCallbackHeap = m_getPreviewCallbackHeap(&callbackBuf);
+    if (previewCallbackHeap == NULL) {
+        ALOGE("ERR(%s[%d]):m_getPreviewCallbackHeap(index(%d)) fail", __FUNCTION__, __LINE__, callbackBuf.index);
+        return INVALID_OPERATION;
+    }
 
     ret = m_setCallbackBufferInfo(&callbackBuf, (char *)previewCallbackHeap->data);
     if (ret < 0) {
@@ -3344,27 +3472,25 @@ status_t ExynosCamera::m_doCallbackToPreviewFunc(
 #else
         ALOGW("WRN(%s[%d]): doCallbackToPreview use CSC is not yet possible", __FUNCTION__, __LINE__);
 #endif
-    } else { /* neon memcpy */
-        char *srcAddr = NULL;
-        char *dstAddr = NULL;
-        int planeCount = getYuvPlaneCount(hwPreviewFormat);
-        if (planeCount <= 0) {
-            ALOGE("ERR(%s[%d]):getYuvPlaneCount(%d) fail", __FUNCTION__, __LINE__, hwPreviewFormat);
+    } else { /* neon copy */
+        int previewW = 0, previewH = 0;
+        int hwPreviewStride = m_exynosCameraParameters->getHwPreviewStride();
+        m_exynosCameraParameters->getPreviewSize(&previewW, &previewH);
+
+        /* the stride is only set with USE_BUFFER_WITH_STRIDE, the callback heap is packed */
+        if (hwPreviewStride < hwPreviewW)
+            hwPreviewStride = hwPreviewW;
+
+        ret = m_copyPreviewPlanes(&callbackBuf, m_exynosCameraParameters->getPreviewFormat(), previewW, previewH, previewW,
+                                  &previewBuf, hwPreviewFormat, hwPreviewW, hwPreviewH, hwPreviewStride);
+        if (ret < 0) {
+            ALOGE("ERR(%s[%d]):m_copyPreviewPlanes fail, ret(%d)", __FUNCTION__, __LINE__, ret);
             statusRet = INVALID_OPERATION;
             goto done;
         }
-
-        /* TODO : have to consider all fmt(planes) and stride */
-        for (int plane = 0; plane < planeCount; plane++) {
-            srcAddr = callbackBuf.addr[plane];
-            dstAddr = previewBuf.addr[plane];
-            memcpy(dstAddr, srcAddr, callbackBuf.size[plane]);
-        }
     }
 
 done:
-    previewCallbackHeap->release(previewCallbackHeap);
-
     return statusRet;
 }
 
@@ -3780,7 +3906,7 @@ CLEAN:
     if (newFrame != NULL && newFrame->isComplete() == true) {
         newFrame->printEntity();
         ALOGD("DEBUG(%s[%d]): Picture frame delete(%d)", __FUNCTION__, __LINE__, newFrame->getFrameCount());
-        delete newFrame;
+        releaseFrame(newFrame);
         newFrame = NULL;
     }
 
@@ -4130,7 +4256,7 @@ CLEAN_FRAME:
     if (newFrame != NULL && newFrame->getFrameLockState() == false) {
         newFrame->printEntity();
         ALOGD("DEBUG(%s[%d]): Reprocessing frame delete(%d)", __FUNCTION__, __LINE__, newFrame->getFrameCount());
-        delete newFrame;
+        releaseFrame(newFrame);
         newFrame = NULL;
     }
 
@@ -4150,7 +4276,7 @@ CLEAN:
 
         newFrame->printEntity();
         ALOGD("DEBUG(%s[%d]): Reprocessing frame delete(%d)", __FUNCTION__, __LINE__, newFrame->getFrameCount());
-        delete newFrame;
+        releaseFrame(newFrame);
         newFrame = NULL;
     }
 
@@ -4432,7 +4558,7 @@ CLEAN:
         ALOGD("DEBUG(%s[%d]): print Entity state in error state", __FUNCTION__, __LINE__);
         newFrame->printEntity();
         ALOGD("DEBUG(%s[%d]): delete newFrame in error state", __FUNCTION__, __LINE__);
-        delete newFrame;
+        releaseFrame(newFrame);
         newFrame = NULL;
     }
 #endif
@@ -4758,7 +4884,7 @@ retry:
 
         if (newFrame->isComplete() == true) {
             ALOGD("DEBUG(%s[%d]): Picture frame delete(%d)", __FUNCTION__, __LINE__, newFrame->getFrameCount());
-            delete newFrame;
+            releaseFrame(newFrame);
             newFrame = NULL;
         } else {
             ALOGW("WRN(%s[%d]): Picture frame(%d) is not completed", __FUNCTION__, __LINE__, newFrame->getFrameCount());
@@ -4959,7 +5085,7 @@ void ExynosCamera::m_clearJpegCallbackThread(void)
     while(m_postPictureQ->getSizeOfProcessQ()) {
         m_postPictureQ->popProcessQ(&frame);
         if (frame != NULL) {
-            delete frame;
+            releaseFrame(frame);
             frame = NULL;
         }
     }
@@ -4968,7 +5094,7 @@ void ExynosCamera::m_clearJpegCallbackThread(void)
     while(dstSccReprocessingQ->getSizeOfProcessQ()) {
         dstSccReprocessingQ->popProcessQ(&frame);
         if (frame != NULL) {
-            delete frame;
+            releaseFrame(frame);
             frame = NULL;
         }
     }
@@ -5163,7 +5289,7 @@ bool ExynosCamera::m_highResolutionCallbackThreadFunc(void)
 
         if (newFrame->isComplete() == true) {
             ALOGD("DEBUG(%s[%d]): Reprocessing frame delete(%d)", __FUNCTION__, __LINE__, newFrame->getFrameCount());
-            delete newFrame;
+            releaseFrame(newFrame);
             newFrame = NULL;
         }
     }
@@ -5195,7 +5321,7 @@ CLEAN:
 
         if (newFrame->isComplete() == true) {
             ALOGD("DEBUG(%s[%d]): Reprocessing frame delete(%d)", __FUNCTION__, __LINE__, newFrame->getFrameCount());
-            delete newFrame;
+            releaseFrame(newFrame);
             newFrame = NULL;
         }
     }
@@ -5242,7 +5368,7 @@ status_t ExynosCamera::m_doPrviewToRecordingFunc(
             __FUNCTION__, __LINE__, pipeId, ret);
         ret = INVALID_OPERATION;
         if (newFrame != NULL) {
-            delete newFrame;
+            releaseFrame(newFrame);
             newFrame = NULL;
         }
         goto func_exit;
@@ -5355,7 +5481,7 @@ bool ExynosCamera::m_recordingThreadFunc(void)
 func_exit:
 
     if (frame != NULL) {
-        delete frame;
+        releaseFrame(frame);
         frame = NULL;
     }
 
@@ -5502,7 +5628,7 @@ status_t ExynosCamera::m_clearList(List<ExynosCameraFrame *> *list)
         curFrame = *r;
         if (curFrame != NULL && curFrame->getFrameLockState() == false) {
             ALOGV("DEBUG(%s):remove frame count %d", __FUNCTION__, curFrame->getFrameCount() );
-            delete curFrame;
+            releaseFrame(curFrame);
             curFrame = NULL;
         }
         list->erase(r);
@@ -5621,6 +5747,7 @@ bool ExynosCamera::m_releasebuffersForRealloc()
 #endif
 
     if (m_previewCallbackBufferMgr != NULL) {
+        m_releasePreviewCallbackHeap();
         m_previewCallbackBufferMgr->deinit();
     }
     if (m_highResolutionCallbackBufferMgr != NULL) {
@@ -5928,6 +6055,7 @@ status_t ExynosCamera::m_setPreviewCallbackBuffer(void)
     if (m_previewCallbackBufferMgr->isAllocated() == true) {
         if (m_exynosCameraParameters->getRestartPreview() == true) {
             ALOGD("DEBUG(%s[%d]): preview size is changed, realloc buffer", __FUNCTION__, __LINE__);
+            m_releasePreviewCallbackHeap();
             m_previewCallbackBufferMgr->deinit();
         } else {
             return NO_ERROR;
@@ -6056,6 +6184,7 @@ status_t ExynosCamera::m_releaseBuffers(void)
         m_recordingBufferMgr->deinit();
     }
     if (m_previewCallbackBufferMgr != NULL) {
+        m_releasePreviewCallbackHeap();
         m_previewCallbackBufferMgr->deinit();
     }
     if (m_highResolutionCallbackBufferMgr != NULL) {
@@ -6618,7 +6747,7 @@ ERR:
     if (bayerFrame != NULL && bayerFrame->isComplete() == true) {
         if (bayerFrame->getFrameLockState() == false) {
             ALOGD("DEBUG(%s[%d]): Selected frame(%d) complete, Delete", __FUNCTION__, __LINE__, bayerFrame->getFrameCount());
-            delete bayerFrame;
+            releaseFrame(bayerFrame);
         }
         bayerFrame = NULL;
     }
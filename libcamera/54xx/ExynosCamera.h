@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <sys/mman.h>
 #include "csc.h"
+#include "exynos_plane_copy.h"
 
 #include "ExynosCameraParameters.h"
 #include "ExynosCameraFrameFactory.h"
@@ -53,6 +54,9 @@ typedef struct ExynosCameraJpegCallbackBuffer {
 typedef ExynosCameraList<ExynosCameraFrame *> frame_queue_t;
 typedef ExynosCameraList<jpeg_callback_buffer_t> jpeg_callback_queue_t;
 
+/* over the max number of in-flight frames (VIDEO_MAX_FRAME) */
+#define FRAME_QUEUE_RING_SIZE   (64)
+
 typedef enum buffer_direction_type {
     SRC_BUFFER_DIRECTION        = 0,
     DST_BUFFER_DIRECTION        = 1,
@@ -217,6 +221,11 @@ private:
     status_t    m_calcPictureRect(int originW, int originH, ExynosRect *srcRect, ExynosRect *dstRect);
 
     status_t    m_setCallbackBufferInfo(ExynosCameraBuffer *callbackBuf, char *baseAddr);
+    camera_memory_t *m_getPreviewCallbackHeap(ExynosCameraBuffer *callbackBuf);
+    status_t    m_copyPreviewPlanes(
+                    ExynosCameraBuffer *srcBuf, int srcFormat, int srcW, int srcH, int srcStride,
+                    ExynosCameraBuffer *dstBuf, int dstFormat, int dstW, int dstH, int dstStride);
+    void        m_releasePreviewCallbackHeap(void);
 
     status_t    m_doPreviewToCallbackFunc(
                     int32_t pipeId,
@@ -334,6 +343,11 @@ private:
     bool                            m_recordingThreadFunc(void);
 
     ExynosCameraBufferManager       *m_previewCallbackBufferMgr;
+    /* heaps mapped on preview callback buffers, kept until the buffers are freed */
+    mutable Mutex                   m_previewCallbackHeapLock;
+    camera_memory_t                 *m_previewCallbackHeap[MAX_BUFFERS];
+    int                             m_previewCallbackHeapFd[MAX_BUFFERS];
+    unsigned int                    m_previewCallbackHeapSize[MAX_BUFFERS];
     ExynosCameraBufferManager       *m_highResolutionCallbackBufferMgr;
 
     /* Pre picture Thread */
@@ -32,6 +32,9 @@ ExynosCameraFrameFactory::ExynosCameraFrameFactory() {
     /* Activity Control */
     m_activityControl = NULL;
 
+    m_framePool = NULL;
+    m_framePoolLayout = 0;
+
     for (int i = 0; i < MAX_NUM_PIPES; i++)
         m_pipes[i] = NULL;
 
@@ -58,6 +61,9 @@ ExynosCameraFrameFactory::ExynosCameraFrameFactory(int cameraId, ExynosCameraPar
     /* Activity Control */
     m_activityControl = m_parameters->getActivityControl();
 
+    m_framePool = NULL;
+    m_framePoolLayout = 0;
+
     for (int i = 0; i < MAX_NUM_PIPES; i++)
         m_pipes[i] = NULL;
 
@@ -82,6 +88,8 @@ ExynosCameraFrameFactory::~ExynosCameraFrameFactory()
     ret = destroy();
     if (ret < 0)
         ALOGE("ERR(%s[%d]):destroy fail", __FUNCTION__, __LINE__);
+
+    m_destroyFramePool();
 }
 
 ExynosCameraFrameFactory *ExynosCameraFrameFactory::createFrameFactory(int cameraId, ExynosCameraParameters *param)
@@ -251,6 +259,8 @@ status_t ExynosCameraFrameFactory::destroy(void)
 {
     ALOGI("INFO(%s[%d])", __FUNCTION__, __LINE__);
 
+    m_destroyFramePool();
+
     for (int i = 0; i < MAX_NUM_PIPES; i++) {
         if (m_pipes[i] != NULL) {
             m_pipes[i]->destroy();
@@ -266,12 +276,9 @@ status_t ExynosCameraFrameFactory::destroy(void)
 status_t ExynosCameraFrameFactory::m_initFrameMetadata(ExynosCameraFrame *frame)
 {
     int ret = 0;
-    struct camera2_shot_ext *shot_ext = new struct camera2_shot_ext;
-
-    if (shot_ext == NULL) {
-        ALOGE("ERR(%s[%d]): new struct camera2_shot_ext fail", __FUNCTION__, __LINE__);
-        return INVALID_OPERATION;
-    }
+    /* on the stack : no heap traffic per frame */
+    struct camera2_shot_ext shot;
+    struct camera2_shot_ext *shot_ext = &shot;
 
     memset(shot_ext, 0x0, sizeof(struct camera2_shot_ext));
 
@@ -300,9 +307,6 @@ status_t ExynosCameraFrameFactory::m_initFrameMetadata(ExynosCameraFrame *frame)
                        m_requestDIS,
                        m_requestSCP);
 
-    delete shot_ext;
-    shot_ext = NULL;
-
     return ret;
 }
 
@@ -677,14 +681,41 @@ ExynosCameraFrame *ExynosCameraFrameFactory::createNewFrameVideoOnly(void)
 ExynosCameraFrame *ExynosCameraFrameFactory::createNewFrame(void)
 {
     int ret = 0;
-    ExynosCameraFrameEntity *newEntity[MAX_NUM_PIPES];
-    ExynosCameraFrame *frame = new ExynosCameraFrame(m_parameters, m_frameCount);
-    int requestEntityCount = 0;
+    ExynosCameraFrame *frame = NULL;
+
+    /* pooled frames only fit the entity layout they were built with */
+    if (m_framePool != NULL && m_framePoolLayout == m_getFrameLayout())
+        frame = m_framePool->getFrame(m_frameCount);
+
+    if (frame == NULL) {
+        frame = new ExynosCameraFrame(m_parameters, m_frameCount);
+
+        ret = m_buildFrameEntities(frame);
+        if (ret < 0)
+            ALOGE("ERR(%s[%d]):frame(%d) m_buildFrameEntities fail, ret(%d)", __FUNCTION__, __LINE__, m_frameCount, ret);
+    }
 
     ret = m_initFrameMetadata(frame);
     if (ret < 0)
         ALOGE("(%s[%d]): frame(%d) metadata initialize fail", __FUNCTION__, __LINE__, m_frameCount);
 
+    ret = m_initPipelines(frame);
+    if (ret < 0) {
+        ALOGE("ERR(%s):m_initPipelines fail, ret(%d)", __FUNCTION__, ret);
+    }
+
+    m_fillNodeGroupInfo(frame);
+
+    m_frameCount++;
+
+    return frame;
+}
+
+status_t ExynosCameraFrameFactory::m_buildFrameEntities(ExynosCameraFrame *frame)
+{
+    ExynosCameraFrameEntity *newEntity[MAX_NUM_PIPES];
+    int requestEntityCount = 0;
+
     if (m_requestFLITE) {
         /* set flite pipe to linkageList */
         newEntity[INDEX(PIPE_FLITE)] = new ExynosCameraFrameEntity(PIPE_FLITE, ENTITY_TYPE_OUTPUT_ONLY, ENTITY_BUFFER_FIXED);
@@ -716,19 +747,72 @@ ExynosCameraFrame *ExynosCameraFrameFactory::createNewFrame(void)
     newEntity[INDEX(PIPE_GSC_VIDEO)] = new ExynosCameraFrameEntity(PIPE_GSC_VIDEO, ENTITY_TYPE_INPUT_OUTPUT, ENTITY_BUFFER_FIXED);
     frame->addSiblingEntity(NULL, newEntity[INDEX(PIPE_GSC_VIDEO)]);
 
-    ret = m_initPipelines(frame);
-    if (ret < 0) {
-        ALOGE("ERR(%s):m_initPipelines fail, ret(%d)", __FUNCTION__, ret);
-    }
-
     /* TODO: make it dynamic */
     frame->setNumRequestPipe(requestEntityCount);
 
-    m_fillNodeGroupInfo(frame);
+    return NO_ERROR;
+}
 
-    m_frameCount++;
+uint32_t ExynosCameraFrameFactory::m_getFrameLayout(void)
+{
+    uint32_t layout = 0;
 
-    return frame;
+    /* the requests m_buildFrameEntities() depends on */
+    if (m_requestFLITE)
+        layout |= (1 << 0);
+    if (m_parameters->getUsePureBayerReprocessing() == true)
+        layout |= (1 << 1);
+
+    return layout;
+}
+
+status_t ExynosCameraFrameFactory::m_createFramePool(int numFrames)
+{
+    int ret = 0;
+    ExynosCameraFrame *frame = NULL;
+
+    /* the entity topology depends on the parameters of initPipes(), rebuild it */
+    m_destroyFramePool();
+
+    if (FRAME_POOL_MAX < numFrames) {
+        ALOGW("WARN(%s[%d]):numFrames(%d) is over FRAME_POOL_MAX(%d)", __FUNCTION__, __LINE__, numFrames, FRAME_POOL_MAX);
+        numFrames = FRAME_POOL_MAX;
+    }
+
+    m_framePool = new ExynosCameraFramePool("PREVIEW_FRAME_POOL");
+    m_framePoolLayout = m_getFrameLayout();
+
+    for (int i = 0; i < numFrames; i++) {
+        frame = new ExynosCameraFrame(m_parameters, 0);
+
+        ret = m_buildFrameEntities(frame);
+        if (ret < 0) {
+            ALOGE("ERR(%s[%d]):m_buildFrameEntities fail, ret(%d)", __FUNCTION__, __LINE__, ret);
+            delete frame;
+            return ret;
+        }
+
+        ret = m_framePool->addFrame(frame);
+        if (ret < 0) {
+            ALOGE("ERR(%s[%d]):addFrame fail, ret(%d)", __FUNCTION__, __LINE__, ret);
+            delete frame;
+            return ret;
+        }
+    }
+
+    ALOGI("INFO(%s[%d]):%d frames are ready", __FUNCTION__, __LINE__, numFrames);
+
+    return NO_ERROR;
+}
+
+void ExynosCameraFrameFactory::m_destroyFramePool(void)
+{
+    if (m_framePool != NULL) {
+        m_framePool->dump();
+        /* frames still in the pipeline keep the pool alive until they are released */
+        m_framePool->release();
+        m_framePool = NULL;
+    }
 }
 
 status_t ExynosCameraFrameFactory::initPipes(void)
@@ -988,6 +1072,12 @@ status_t ExynosCameraFrameFactory::initPipes(void)
 
     m_frameCount = 0;
 
+    ret = m_createFramePool(config->current->bufInfo.num_bayer_buffers
+                            + config->current->bufInfo.num_preview_buffers
+                            + FRAME_POOL_MARGIN);
+    if (ret < 0)
+        ALOGW("WARN(%s[%d]):m_createFramePool fail, ret(%d), frames are allocated on demand", __FUNCTION__, __LINE__, ret);
+
     return NO_ERROR;
 }
 
@@ -1338,6 +1428,9 @@ void ExynosCameraFrameFactory::dump()
         }
     }
 
+    if (m_framePool != NULL)
+        m_framePool->dump();
+
     return;
 }
 
@@ -34,6 +34,9 @@
 #define MAX_NUM_PIPES       (MAX_PIPE_NUM)
 #define INDEX(x)            (x % MAX_NUM_PIPES)
 
+/* frames pre-built by initPipes() for createNewFrame() */
+#define FRAME_POOL_MARGIN   (4)
+
 namespace android {
 
 class ExynosCameraFrameFactory {
@@ -84,6 +87,10 @@ public:
 protected:
     virtual status_t        m_initPipelines(ExynosCameraFrame *frame);
     virtual status_t        m_initFrameMetadata(ExynosCameraFrame *frame);
+    virtual status_t        m_buildFrameEntities(ExynosCameraFrame *frame);
+    virtual uint32_t        m_getFrameLayout(void);
+    virtual status_t        m_createFramePool(int numFrames);
+    virtual void            m_destroyFramePool(void);
     virtual status_t        m_fillNodeGroupInfo(ExynosCameraFrame *frame);
     virtual status_t        m_checkPipeInfo(uint32_t srcPipeId, uint32_t dstPipeId);
 
@@ -95,6 +102,9 @@ protected:
 
     ExynosCameraActivityControl *m_activityControl;
 
+    ExynosCameraFramePool      *m_framePool;
+    uint32_t                    m_framePoolLayout;
+
     uint32_t                    m_requestFLITE;
     uint32_t                    m_request3AP;
     uint32_t                    m_request3AC;
@@ -258,6 +258,8 @@ status_t ExynosCameraFrameFactoryFront::destroy(void)
 {
     ALOGI("INFO(%s[%d])", __FUNCTION__, __LINE__);
 
+    m_destroyFramePool();
+
     for (int i = 0; i < MAX_NUM_PIPES; i++) {
         if (m_pipes[i] != NULL) {
             m_pipes[i]->destroy();
@@ -320,17 +322,11 @@ ExynosCameraFrame *ExynosCameraFrameFactoryFront::createNewFrameVideoOnly(void)
     return frame;
 }
 
-ExynosCameraFrame *ExynosCameraFrameFactoryFront::createNewFrame(void)
+status_t ExynosCameraFrameFactoryFront::m_buildFrameEntities(ExynosCameraFrame *frame)
 {
-    int ret = 0;
     ExynosCameraFrameEntity *newEntity[INDEX(MAX_PIPE_NUM_FRONT)];
-    ExynosCameraFrame *frame = new ExynosCameraFrame(m_parameters, m_frameCount);
     int requestEntityCount = 0;
 
-    ret = m_initFrameMetadata(frame);
-    if (ret < 0)
-        ALOGE("(%s[%d]): frame(%d) metadata initialize fail", __FUNCTION__, __LINE__, m_frameCount);
-
     /* set flite pipe to linkageList */
     newEntity[INDEX(PIPE_FLITE_FRONT)] = new ExynosCameraFrameEntity(PIPE_FLITE_FRONT, ENTITY_TYPE_OUTPUT_ONLY, ENTITY_BUFFER_FIXED);
     frame->addSiblingEntity(NULL, newEntity[INDEX(PIPE_FLITE_FRONT)]);
@@ -371,19 +367,16 @@ ExynosCameraFrame *ExynosCameraFrameFactoryFront::createNewFrame(void)
     newEntity[INDEX(PIPE_JPEG_FRONT)] = new ExynosCameraFrameEntity(PIPE_JPEG_FRONT, ENTITY_TYPE_INPUT_OUTPUT, ENTITY_BUFFER_FIXED);
     frame->addSiblingEntity(NULL, newEntity[INDEX(PIPE_JPEG_FRONT)]);
 
-    ret = m_initPipelines(frame);
-    if (ret < 0) {
-        ALOGE("ERR(%s):m_initPipelines fail, ret(%d)", __FUNCTION__, ret);
-    }
-
     /* TODO: make it dynamic */
     frame->setNumRequestPipe(requestEntityCount);
 
-    m_fillNodeGroupInfo(frame);
-
-    m_frameCount++;
+    return NO_ERROR;
+}
 
-    return frame;
+uint32_t ExynosCameraFrameFactoryFront::m_getFrameLayout(void)
+{
+    /* the front entity layout does not depend on the requests */
+    return 0;
 }
 
 status_t ExynosCameraFrameFactoryFront::initPipes(void)
@@ -610,6 +603,12 @@ status_t ExynosCameraFrameFactoryFront::initPipes(void)
 
     m_frameCount = 0;
 
+    ret = m_createFramePool(FRONT_NUM_BAYER_BUFFERS
+                            + m_parameters->getPreviewBufferCount()
+                            + FRAME_POOL_MARGIN);
+    if (ret < 0)
+        ALOGW("WARN(%s[%d]):m_createFramePool fail, ret(%d), frames are allocated on demand", __FUNCTION__, __LINE__, ret);
+
     return NO_ERROR;
 }
 
@@ -31,7 +31,6 @@ public:
     virtual status_t        destroy(void);
 
     virtual ExynosCameraFrame *createNewFrameVideoOnly(void);
-    virtual ExynosCameraFrame *createNewFrame(void);
 
     virtual status_t        initPipes(void);
     virtual status_t        preparePipes(void);
@@ -44,6 +43,8 @@ public:
     virtual void            setRequest3AC(bool enable);
 protected:
     status_t                m_fillNodeGroupInfo(ExynosCameraFrame *frame);
+    status_t                m_buildFrameEntities(ExynosCameraFrame *frame);
+    uint32_t                m_getFrameLayout(void);
 };
 
 }; /* namespace android */
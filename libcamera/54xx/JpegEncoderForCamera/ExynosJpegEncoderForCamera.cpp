@@ -28,6 +28,11 @@
 
 #include "ExynosJpegEncoderForCamera.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define JPEG_SCALE_USE_NEON
+#endif
+
 static const char ExifAsciiPrefix[] = { 0x41, 0x53, 0x43, 0x49, 0x49, 0x0, 0x0, 0x0 };
 
 #define THUMBNAIL_IMAGE_PIXEL_SIZE (4)
@@ -63,6 +68,8 @@ ExynosJpegEncoderForCamera::~ExynosJpegEncoderForCamera()
     if (m_flagCreate == true)
         this->destroy();
 
+    destroyThumbnail();
+
     m_ionJpegClient = deleteIonClient(m_ionJpegClient);
     if(m_ionJpegClient!= 0) {
         ALOGE("ERR(%s):Cannot deinitialize m_ionJpegClient [%d]"
@@ -132,24 +139,10 @@ int ExynosJpegEncoderForCamera::destroy(void)
         m_jpegMain = NULL;
     }
 
-    if (m_jpegThumb != NULL) {
-        int iSize = sizeof(char)*m_thumbnailW*m_thumbnailH*4;
-
-        // May be those memory can be reused...
-        freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
-        freeJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
-
-        /* In original design, m_ionJpegClient is deinitialized here.
-           But now it is moved to the destructor to avoid
-           open/close overhead in create() and destroy() method */
-        //m_ionJpegClient = deleteIonClient(m_ionJpegClient);
-
-        m_stThumbInBuf.ionClient = m_stThumbOutBuf.ionClient = 0;
-        m_jpegThumb->destroy();
-        delete m_jpegThumb;
-        m_jpegThumb = NULL;
-    }
-
+    /*
+     * The thumbnail encoder and its ion buffers are kept until the destructor,
+     * so the next capture skips device open and buffer allocation.
+     */
     m_flagCreate = false;
     m_thumbnailW = 0;
     m_thumbnailH = 0;
@@ -864,102 +857,173 @@ inline void ExynosJpegEncoderForCamera::writeExifIfd(unsigned char **pCur,
 }
 
 
-int ExynosJpegEncoderForCamera::roundToInt(double x)
+/*
+ * Box-filter downscaler in integer arithmetic.
+ * The source is cut into dst-sized spans, and every source sample is folded into
+ * exactly one destination sample, so any ratio works without skipping pixels.
+ * Rows are summed vertically into a 16-bit accumulator (NEON when available),
+ * then each horizontal span is averaged over the box area.
+ * Upscaling degenerates to nearest sampling.
+ */
+#define SCALE_MAX_BOX_ROWS (256) /* 255 * 256 still fits the uint16_t accumulator */
+
+struct scale_component {
+    unsigned int srcOffset; /* first byte of the component in a source row */
+    unsigned int srcStep;   /* bytes between two samples of the component */
+    unsigned int srcLen;    /* samples per source row */
+    unsigned int dstOffset;
+    unsigned int dstStep;
+    unsigned int dstLen;
+};
+
+/* span[i] .. span[i + 1] are the source samples folded into destination sample i */
+static void makeBoxSpan(unsigned int *span, unsigned int srcLen, unsigned int dstLen)
 {
-    if (x >= 0)
-	    return (int) (x + 0.5);
-    return (int) (x - 0.5);
+    for (unsigned int i = 0; i <= dstLen; i++)
+        span[i] = (unsigned int)(((uint64_t)i * srcLen) / dstLen);
 }
 
-int ExynosJpegEncoderForCamera::get_approximate_value(int value, int limit)
+static void addBoxRow(uint16_t *acc, const unsigned char *src, unsigned int len)
 {
-    int x;
-    if( value % 4 != 0 ) {
-        for(x = 0; x < 100 && value < limit; x++) {
-            if( value % 4 == 0)
-                break;
-            else
-                value++;
-        }
+    unsigned int i = 0;
+
+#ifdef JPEG_SCALE_USE_NEON
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t s = vld1q_u8(src + i);
+        vst1q_u16(acc + i,     vaddw_u8(vld1q_u16(acc + i),     vget_low_u8(s)));
+        vst1q_u16(acc + i + 8, vaddw_u8(vld1q_u16(acc + i + 8), vget_high_u8(s)));
     }
-    return value;
+#endif
+    for (; i < len; i++)
+        acc[i] += src[i];
 }
 
-int ExynosJpegEncoderForCamera::scaleDownYuv422(char **srcBuf, unsigned int srcW, unsigned int srcH,  char **dstBuf, unsigned int dstW, unsigned int dstH)
+static void reduceBoxRow(unsigned char *dst, const uint16_t *acc, unsigned int rows,
+                         const struct scale_component *comp, const unsigned int *span)
 {
-    double step_x, step_y;
-    int src_y_start_pos, dst_pos, src_pos;
-    char *src_buf = srcBuf[0];
-    char *dst_buf = dstBuf[0];
+    const uint16_t *src = acc + comp->srcOffset;
+    unsigned char *out = dst + comp->dstOffset;
+
+    for (unsigned int i = 0; i < comp->dstLen; i++) {
+        unsigned int start = span[i];
+        unsigned int count = span[i + 1] - start;
+        const uint16_t *p;
+        uint32_t sum = 0;
+        uint32_t area;
+
+        if (count == 0)
+            count = 1;
+
+        p = src + (start * comp->srcStep);
+        for (unsigned int k = 0; k < count; k++) {
+            sum += *p;
+            p += comp->srcStep;
+        }
 
-    if (dstW & 0x01 || dstH & 0x01)
-        return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
+        area = count * rows;
+        *out = (unsigned char)((sum + (area >> 1)) / area);
+        out += comp->dstStep;
+    }
+}
 
-    step_x = (double)srcW / (double)dstW;
-    step_y = (double)srcH / (double)dstH;
+static int boxScalePlane(const unsigned char *src, unsigned int srcStride, unsigned int srcH,
+                         unsigned char *dst, unsigned int dstStride, unsigned int dstH,
+                         const struct scale_component *comp, int numComp)
+{
+    unsigned int *rowSpan = NULL;
+    unsigned int *colSpan[MAX_IMAGE_PLANE_NUM] = {NULL,};
+    uint16_t *acc = NULL;
+    int ret = 0;
+
+    rowSpan = new unsigned int[dstH + 1];
+    acc = new uint16_t[srcStride];
+    for (int c = 0; c < numComp; c++)
+        colSpan[c] = new unsigned int[comp[c].dstLen + 1];
+
+    if (rowSpan == NULL || acc == NULL) {
+        ret = -1;
+        goto done;
+    }
 
-    double srcWStride = srcW * 2;
-    double stepXStride = step_x * 2;
+    for (int c = 0; c < numComp; c++) {
+        if (colSpan[c] == NULL) {
+            ret = -1;
+            goto done;
+        }
+        makeBoxSpan(colSpan[c], comp[c].srcLen, comp[c].dstLen);
+    }
+    makeBoxSpan(rowSpan, srcH, dstH);
 
-    dst_pos = 0;
     for (unsigned int y = 0; y < dstH; y++) {
-        src_y_start_pos = srcWStride * get_approximate_value( roundToInt(step_y * (double)y), dstH*srcWStride);
-
-        for (unsigned int x = 0; x < dstW; x += 2) {
-            src_pos = src_y_start_pos + get_approximate_value( roundToInt(stepXStride * (double)x), dstW*stepXStride);
-            if ((unsigned int)src_pos >= srcW * srcH * 2) break;
-            dst_buf[dst_pos++] = src_buf[src_pos    ];
-            dst_buf[dst_pos++] = src_buf[src_pos + 1];
-            dst_buf[dst_pos++] = src_buf[src_pos + 2];
-            dst_buf[dst_pos++] = src_buf[src_pos + 3];
+        unsigned int rows = rowSpan[y + 1] - rowSpan[y];
+        const unsigned char *s = src + (rowSpan[y] * srcStride);
+
+        if (rows == 0)
+            rows = 1;
+        if (rows > SCALE_MAX_BOX_ROWS)
+            rows = SCALE_MAX_BOX_ROWS;
+
+        memset(acc, 0, sizeof(uint16_t) * srcStride);
+        for (unsigned int r = 0; r < rows; r++) {
+            addBoxRow(acc, s, srcStride);
+            s += srcStride;
         }
+
+        for (int c = 0; c < numComp; c++)
+            reduceBoxRow(dst, acc, rows, &comp[c], colSpan[c]);
+
+        dst += dstStride;
     }
 
-    return ERROR_NONE;
+done:
+    for (int c = 0; c < numComp; c++)
+        delete [] colSpan[c];
+    delete [] acc;
+    delete [] rowSpan;
+
+    return ret;
 }
 
-int ExynosJpegEncoderForCamera::scaleDownYuv422_2p(char **srcBuf, unsigned int srcW, unsigned int srcH, char **dstBuf, unsigned int dstW, unsigned int dstH)
+int ExynosJpegEncoderForCamera::scaleDownYuv422(char **srcBuf, unsigned int srcW, unsigned int srcH,  char **dstBuf, unsigned int dstW, unsigned int dstH)
 {
-    int32_t step_x, step_y;
-    int32_t src_y_start_pos, dst_pos, src_pos;
-    int32_t src_Y_offset;
-    char *src_buf;
-    char *dst_buf;
-
-    if (dstW % 2 != 0 || dstH % 2 != 0)
+    if (dstW & 0x01 || dstH & 0x01 || dstW == 0 || dstH == 0 || srcW < 2 || srcH == 0)
         return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
 
-    step_x = srcW / dstW;
-    step_y = srcH / dstH;
-
-    /* Y scale down */
-    src_buf = srcBuf[0];
-    dst_buf = dstBuf[0];
-    dst_pos = 0;
-    for (uint32_t y = 0; y < dstH; y++) {
-        src_y_start_pos = y * step_y * srcW;
+    /* Y0 Cb Y1 Cr : luma every 2 bytes, each chroma every 4 bytes */
+    const struct scale_component comp[3] = {
+        {0, 2, srcW,      0, 2, dstW},
+        {1, 4, srcW >> 1, 1, 4, dstW >> 1},
+        {3, 4, srcW >> 1, 3, 4, dstW >> 1},
+    };
 
-        for (uint32_t x = 0; x < dstW; x++) {
-            src_pos = src_y_start_pos + (x * step_x);
+    if (boxScalePlane((unsigned char *)srcBuf[0], srcW * 2, srcH,
+                      (unsigned char *)dstBuf[0], dstW * 2, dstH, comp, 3) != 0)
+        return ERROR_MEM_ALLOC_FAIL;
 
-            dst_buf[dst_pos++] = src_buf[src_pos];
-        }
-    }
+    return ERROR_NONE;
+}
 
-    /* UV scale down */
-    src_buf = srcBuf[1];
-    dst_buf = dstBuf[1];
-    dst_pos = 0;
-    for (uint32_t i = 0; i < dstH; i++) {
-        src_y_start_pos = i * step_y * srcW;
+int ExynosJpegEncoderForCamera::scaleDownYuv422_2p(char **srcBuf, unsigned int srcW, unsigned int srcH, char **dstBuf, unsigned int dstW, unsigned int dstH)
+{
+    if (dstW % 2 != 0 || dstH % 2 != 0 || dstW == 0 || dstH == 0 || srcW < 2 || srcH == 0)
+        return ERROR_INVALID_SCALING_WIDTH_HEIGHT;
 
-        for (uint32_t j = 0; j < dstW; j += 2) {
-            src_pos = src_y_start_pos + (j * step_x);
+    /* NV16 / NV61 : chroma plane is full height, CbCr (or CrCb) pairs at half width */
+    const struct scale_component compY[1] = {
+        {0, 1, srcW, 0, 1, dstW},
+    };
+    const struct scale_component compUV[2] = {
+        {0, 2, srcW >> 1, 0, 2, dstW >> 1},
+        {1, 2, srcW >> 1, 1, 2, dstW >> 1},
+    };
+
+    if (boxScalePlane((unsigned char *)srcBuf[0], srcW, srcH,
+                      (unsigned char *)dstBuf[0], dstW, dstH, compY, 1) != 0)
+        return ERROR_MEM_ALLOC_FAIL;
 
-            dst_buf[dst_pos++] = src_buf[src_pos    ];
-            dst_buf[dst_pos++] = src_buf[src_pos + 1];
-        }
-    }
+    if (boxScalePlane((unsigned char *)srcBuf[1], srcW, srcH,
+                      (unsigned char *)dstBuf[1], dstW, dstH, compUV, 2) != 0)
+        return ERROR_MEM_ALLOC_FAIL;
 
     return ERROR_NONE;
 }
@@ -1000,7 +1064,7 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
     if (m_flagCreate == false)
         return ERROR_CANNOT_CREATE_EXYNOS_JPEG_ENC_HAL;
 
-    /* create jpeg thumbnail class */
+    /* create jpeg thumbnail class once, it is reused by the following captures */
     if (m_jpegThumb == NULL) {
         m_jpegThumb = new ExynosJpegEncoder;
 
@@ -1008,18 +1072,23 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
             ALOGE("ERR(%s):Cannot open a jpeg device file", __FUNCTION__);
             return ERROR_CANNOT_CREATE_SEC_THUMB;
         }
-    }
 
-    ret = m_jpegThumb->create();
-    if (ret) {
-        ALOGE("ERR(%s):Fail create", __FUNCTION__);
-        return ret;
-    }
+        ret = m_jpegThumb->create();
+        if (ret) {
+            ALOGE("ERR(%s):Fail create", __FUNCTION__);
+            delete m_jpegThumb;
+            m_jpegThumb = NULL;
+            return ret;
+        }
 
         ret = m_jpegThumb->setCache(JPEG_CACHE_ON);
-    if (ret) {
-        ALOGE("ERR(%s):Fail cache set", __FUNCTION__);
-        return ret;
+        if (ret) {
+            ALOGE("ERR(%s):Fail cache set", __FUNCTION__);
+            m_jpegThumb->destroy();
+            delete m_jpegThumb;
+            m_jpegThumb = NULL;
+            return ret;
+        }
     }
 
     void *pConfig = m_jpegMain->getJpegConfig();
@@ -1040,19 +1109,31 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
         return ret;
     }
 
-    freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
-    freeJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
+    int iInSize[MAX_IMAGE_PLANE_NUM] = {0,};
+    int iOutSize = sizeof(char)*m_thumbnailW*m_thumbnailH*THUMBNAIL_IMAGE_PIXEL_SIZE;
 
-    if (m_jpegThumb->setColorBufSize(m_stThumbInBuf.iSize, MAX_IMAGE_PLANE_NUM) != ERROR_NONE)
+    if (m_jpegThumb->setColorBufSize(iInSize, MAX_IMAGE_PLANE_NUM) != ERROR_NONE)
         return ERROR_INVALID_COLOR_FORMAT;
 
-    m_stThumbOutBuf.iSize[0] = sizeof(char)*m_thumbnailW*m_thumbnailH*THUMBNAIL_IMAGE_PIXEL_SIZE;
+    /* reallocate only when the thumbnail size or color format has changed */
+    if (memcmp(iInSize, m_stThumbInBuf.iSize, sizeof(iInSize)) != 0
+        || m_stThumbOutBuf.iSize[0] != iOutSize) {
+        ALOGD("DEBUG(%s):(re)allocate thumbnail buffers for %dx%d", __FUNCTION__, m_thumbnailW, m_thumbnailH);
 
-    if (allocJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE)
-        return ERROR_MEM_ALLOC_FAIL;
+        freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
+        freeJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
 
-    if (allocJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE)
-        return ERROR_MEM_ALLOC_FAIL;
+        memcpy(m_stThumbInBuf.iSize, iInSize, sizeof(iInSize));
+        m_stThumbOutBuf.iSize[0] = iOutSize;
+
+        if (allocJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE)
+            return ERROR_MEM_ALLOC_FAIL;
+
+        if (allocJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM) != ERROR_NONE) {
+            freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
+            return ERROR_MEM_ALLOC_FAIL;
+        }
+    }
 
     /* Thumbnail InBuf is DMA_BUF */
     ret = m_jpegThumb->setInBuf(m_stThumbInBuf.ionBuffer, m_stThumbInBuf.iSize);
@@ -1280,6 +1361,19 @@ int ExynosJpegEncoderForCamera::encodeThumbnail(unsigned int *size, bool useMain
     return ERROR_NONE;
 }
 
+void ExynosJpegEncoderForCamera::destroyThumbnail(void)
+{
+    freeJpegMemory(&m_stThumbInBuf, MAX_IMAGE_PLANE_NUM);
+    freeJpegMemory(&m_stThumbOutBuf, MAX_IMAGE_PLANE_NUM);
+    m_stThumbInBuf.ionClient = m_stThumbOutBuf.ionClient = 0;
+
+    if (m_jpegThumb != NULL) {
+        m_jpegThumb->destroy();
+        delete m_jpegThumb;
+        m_jpegThumb = NULL;
+    }
+}
+
 int ExynosJpegEncoderForCamera::createIonClient(ion_client ionClient)
 {
     if (ionClient == 0) {
@@ -107,6 +107,12 @@ public :
     void    setInBufType(int sel);
     int     getInBufType(void);
 
+    /* thumbnail downscalers, any ratio; public for exynos_jpeg_thumbnail_scale_bench */
+    int     scaleDownYuv422(char **srcBuf, unsigned int srcW, unsigned int srcH,
+                                                char **dstBuf, unsigned int dstW, unsigned int dstH);
+    int     scaleDownYuv422_2p(char **srcBuf, unsigned int srcW, unsigned int srcH,
+                                                        char **dstBuf, unsigned int dstW, unsigned int dstH);
+
 private:
     inline void writeExifIfd(unsigned char **pCur,
                                          unsigned short tag,
@@ -132,14 +138,9 @@ private:
                                          unsigned char *pValue,
                                          unsigned int *offset,
                                          unsigned char *start);
-    int     roundToInt(double x);
-    int     get_approximate_value(int value, int limit);
-    int     scaleDownYuv422(char **srcBuf, unsigned int srcW, unsigned int srcH,
-                                                char **dstBuf, unsigned int dstW, unsigned int dstH);
-    int     scaleDownYuv422_2p(char **srcBuf, unsigned int srcW, unsigned int srcH,
-                                                        char **dstBuf, unsigned int dstW, unsigned int dstH);
     /* thumbnail */
     int     encodeThumbnail(unsigned int *size, bool useMain = true);
+    void    destroyThumbnail(void);
 
     struct stJpegMem {
         ion_client ionClient;
@@ -94,6 +94,13 @@ void ExynosCameraBufferManager::init(void)
     m_flagNeedMmap = false;
     m_allocMode = BUFFER_MANAGER_ALLOCATION_ATONCE;
 
+    m_clearAvailableIndex();
+    m_statAcquireCount = 0;
+    m_statAcquireTimeTotal = 0;
+    m_statAcquireTimeMax = 0;
+    m_statStarvationCount = 0;
+    m_statHighWaterMark = 0;
+
     EXYNOS_CAMERA_BUFFER_OUT();
 }
 
@@ -250,9 +257,7 @@ status_t ExynosCameraBufferManager::m_free(void)
                 goto func_exit;
             }
         }
-        m_availableBufferIndexQLock.lock();
-        m_availableBufferIndexQ.clear();
-        m_availableBufferIndexQLock.unlock();
+        m_clearAvailableIndex();
         m_allocatedBufCount  = 0;
         m_allowedMaxBufCount = 0;
         m_flagAllocated = false;
@@ -270,15 +275,124 @@ func_exit:
 
 void ExynosCameraBufferManager::m_resetSequenceQ()
 {
-    Mutex::Autolock lock(m_availableBufferIndexQLock);
-    m_availableBufferIndexQ.clear();
+    m_clearAvailableIndex();
 
     for (int bufIndex = 0; bufIndex < m_allocatedBufCount; bufIndex++)
-        m_availableBufferIndexQ.push_back(m_buffer[bufIndex].index);
+        m_setAvailableIndex(m_buffer[bufIndex].index);
 
     return;
 }
 
+void ExynosCameraBufferManager::m_clearAvailableIndex(void)
+{
+    for (int i = 0; i < BUFFER_INDEX_MAP_SIZE; i++)
+        __atomic_store_n(&m_availableBufferIndexMap[i], 0, __ATOMIC_RELEASE);
+
+    m_availableBufferIndexCursor = 0;
+}
+
+void ExynosCameraBufferManager::m_setAvailableIndex(int bufIndex)
+{
+    if (bufIndex < 0 || VIDEO_MAX_FRAME <= bufIndex)
+        return;
+
+    __atomic_fetch_or(&m_availableBufferIndexMap[bufIndex / BUFFER_INDEX_MAP_BITS],
+                      (1U << (bufIndex % BUFFER_INDEX_MAP_BITS)), __ATOMIC_ACQ_REL);
+}
+
+/* take the requested index, return false when it was not available */
+bool ExynosCameraBufferManager::m_testAndClearAvailableIndex(int bufIndex)
+{
+    uint32_t bit;
+    uint32_t prev;
+
+    if (bufIndex < 0 || VIDEO_MAX_FRAME <= bufIndex)
+        return false;
+
+    bit = 1U << (bufIndex % BUFFER_INDEX_MAP_BITS);
+    prev = __atomic_fetch_and(&m_availableBufferIndexMap[bufIndex / BUFFER_INDEX_MAP_BITS],
+                              ~bit, __ATOMIC_ACQ_REL);
+
+    return ((prev & bit) != 0);
+}
+
+/*
+ * take any available index, return -1 when there is none.
+ * The search starts after the last taken index, so buffers are
+ * handed out in the round-robin order the former FIFO queue gave.
+ */
+int ExynosCameraBufferManager::m_findAndClearAvailableIndex(void)
+{
+    int start = m_availableBufferIndexCursor;
+    int wordIndex;
+    int bitIndex;
+    uint32_t word;
+    uint32_t mask;
+
+    for (int i = 0; i <= BUFFER_INDEX_MAP_SIZE; i++) {
+        wordIndex = ((start / BUFFER_INDEX_MAP_BITS) + i) % BUFFER_INDEX_MAP_SIZE;
+        /* first word : only the bits from the cursor, last pass : the bits before it */
+        if (i == 0)
+            mask = ~0U << (start % BUFFER_INDEX_MAP_BITS);
+        else
+            mask = ~0U;
+
+        word = __atomic_load_n(&m_availableBufferIndexMap[wordIndex], __ATOMIC_ACQUIRE);
+        while ((word & mask) != 0) {
+            bitIndex = __builtin_ctz(word & mask);
+            if (__atomic_compare_exchange_n(&m_availableBufferIndexMap[wordIndex], &word,
+                                            word & ~(1U << bitIndex), false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == true) {
+                m_availableBufferIndexCursor = (wordIndex * BUFFER_INDEX_MAP_BITS + bitIndex + 1) % VIDEO_MAX_FRAME;
+                return wordIndex * BUFFER_INDEX_MAP_BITS + bitIndex;
+            }
+        }
+    }
+
+    return -1;
+}
+
+bool ExynosCameraBufferManager::m_isAvailableIndex(int bufIndex)
+{
+    uint32_t word;
+
+    if (bufIndex < 0 || VIDEO_MAX_FRAME <= bufIndex)
+        return false;
+
+    word = __atomic_load_n(&m_availableBufferIndexMap[bufIndex / BUFFER_INDEX_MAP_BITS], __ATOMIC_ACQUIRE);
+
+    return ((word & (1U << (bufIndex % BUFFER_INDEX_MAP_BITS))) != 0);
+}
+
+int ExynosCameraBufferManager::m_getNumOfAvailableIndex(void)
+{
+    int num = 0;
+
+    for (int i = 0; i < BUFFER_INDEX_MAP_SIZE; i++)
+        num += __builtin_popcount(__atomic_load_n(&m_availableBufferIndexMap[i], __ATOMIC_ACQUIRE));
+
+    return num;
+}
+
+void ExynosCameraBufferManager::m_updateStat(nsecs_t acquireTime, bool starved)
+{
+    int numInUse = 0;
+
+    if (starved == true) {
+        m_statStarvationCount++;
+        return;
+    }
+
+    m_statAcquireCount++;
+    m_statAcquireTimeTotal += acquireTime;
+    if (m_statAcquireTimeMax < acquireTime)
+        m_statAcquireTimeMax = acquireTime;
+
+    numInUse = m_allocatedBufCount - m_getNumOfAvailableIndex();
+    if (m_statHighWaterMark < numInUse)
+        m_statHighWaterMark = numInUse;
+}
+
 /*  If Image buffer color format equals YV12, and buffer has MetaDataPlane..
 
     planeCount = 4      (set by user)
@@ -430,7 +544,7 @@ bool ExynosCameraBufferManager::m_allocationThreadFunc(void)
             CLOGE("ERR(%s[%d]):increase the buffer failed", __FUNCTION__, __LINE__);
         } else {
             m_lock.lock();
-            m_availableBufferIndexQ.push_back(m_buffer[m_allocatedBufCount].index);
+            m_setAvailableIndex(m_buffer[m_allocatedBufCount].index);
             m_allocatedBufCount++;
             m_lock.unlock();
         }
@@ -454,7 +568,6 @@ status_t ExynosCameraBufferManager::putBuffer(
     Mutex::Autolock lock(m_lock);
 
     status_t ret = NO_ERROR;
-    List<int>::iterator r;
     bool found = false;
     enum EXYNOS_CAMERA_BUFFER_PERMISSION permission;
 
@@ -467,15 +580,7 @@ status_t ExynosCameraBufferManager::putBuffer(
         goto func_exit;
     }
 
-    m_availableBufferIndexQLock.lock();
-    for (r = m_availableBufferIndexQ.begin(); r != m_availableBufferIndexQ.end(); r++) {
-        if (bufIndex == *r) {
-            found = true;
-            break;
-        }
-    }
-    m_availableBufferIndexQLock.unlock();
-
+    found = m_isAvailableIndex(bufIndex);
     if (found == true) {
         CLOGI("INFO(%s[%d]):bufIndex=%d is already in (available state)",
             __FUNCTION__, __LINE__, bufIndex);
@@ -496,9 +601,7 @@ status_t ExynosCameraBufferManager::putBuffer(
         goto func_exit;
     }
 
-    m_availableBufferIndexQLock.lock();
-    m_availableBufferIndexQ.push_back(m_buffer[bufIndex].index);
-    m_availableBufferIndexQLock.unlock();
+    m_setAvailableIndex(m_buffer[bufIndex].index);
 
 func_exit:
 
@@ -517,7 +620,7 @@ status_t ExynosCameraBufferManager::getBuffer(
     Mutex::Autolock lock(m_lock);
 
     status_t ret = NO_ERROR;
-    List<int>::iterator r;
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
 
     int  bufferIndex;
     enum EXYNOS_CAMERA_BUFFER_PERMISSION permission;
@@ -542,27 +645,17 @@ reDo:
 
     if (bufferIndex < 0 || m_allocatedBufCount <= bufferIndex) {
         /* find availableBuffer */
-        m_availableBufferIndexQLock.lock();
-        if (m_availableBufferIndexQ.empty() == false) {
-            r = m_availableBufferIndexQ.begin();
-            bufferIndex = *r;
-            m_availableBufferIndexQ.erase(r);
+        int availableIndex = m_findAndClearAvailableIndex();
+        if (0 <= availableIndex) {
+            bufferIndex = availableIndex;
 #ifdef EXYNOS_CAMERA_BUFFER_TRACE
             CLOGI("INFO(%s[%d]):available buffer [index=%d]...",
                 __FUNCTION__, __LINE__, bufferIndex);
 #endif
         }
-        m_availableBufferIndexQLock.unlock();
     } else {
-        m_availableBufferIndexQLock.lock();
         /* get the Buffer of requested */
-        for (r = m_availableBufferIndexQ.begin(); r != m_availableBufferIndexQ.end(); r++) {
-            if (bufferIndex == *r) {
-                m_availableBufferIndexQ.erase(r);
-                break;
-            }
-        }
-        m_availableBufferIndexQLock.unlock();
+        m_testAndClearAvailableIndex(bufferIndex);
     }
 
     if (0 <= bufferIndex && bufferIndex < m_allocatedBufCount) {
@@ -591,9 +684,7 @@ reDo:
                 CLOGE("ERR(%s[%d]):increase the buffer failed, m_allocatedBufCount %d, bufferIndex %d",
                     __FUNCTION__, __LINE__,  m_allocatedBufCount, bufferIndex);
             } else {
-                m_availableBufferIndexQLock.lock();
-                m_availableBufferIndexQ.push_back(m_allocatedBufCount);
-                m_availableBufferIndexQLock.unlock();
+                m_setAvailableIndex(m_allocatedBufCount);
                 bufferIndex = m_allocatedBufCount;
                 m_allocatedBufCount++;
 
@@ -607,6 +698,7 @@ reDo:
         }
 
         if (ret < 0) {
+            m_updateStat(0, true);
 #ifdef EXYNOS_CAMERA_BUFFER_TRACE
             CLOGD("DEBUG(%s[%d]):find free buffer... failed --- dump ---",
                 __FUNCTION__, __LINE__);
@@ -625,6 +717,8 @@ reDo:
     *reqBufIndex = bufferIndex;
     *buffer      = m_buffer[bufferIndex];
 
+    m_updateStat(systemTime(SYSTEM_TIME_MONOTONIC) - startTime, false);
+
 func_exit:
 
     EXYNOS_CAMERA_BUFFER_OUT();
@@ -1041,14 +1135,9 @@ void ExynosCameraBufferManager::printBufferState(int bufIndex, int planeIndex)
 
 void ExynosCameraBufferManager::printBufferQState()
 {
-    List<int>::iterator r;
-    int  bufferIndex;
-
-    Mutex::Autolock lock(m_availableBufferIndexQLock);
-
-    for (r = m_availableBufferIndexQ.begin(); r != m_availableBufferIndexQ.end(); r++) {
-        bufferIndex = *r;
-        CLOGD("DEBUG(%s[%d]):bufferIndex=%d", __FUNCTION__, __LINE__, bufferIndex);
+    for (int bufferIndex = 0; bufferIndex < VIDEO_MAX_FRAME; bufferIndex++) {
+        if (m_isAvailableIndex(bufferIndex) == true)
+            CLOGD("DEBUG(%s[%d]):bufferIndex=%d", __FUNCTION__, __LINE__, bufferIndex);
     }
 
     return;
@@ -1074,6 +1163,14 @@ void ExynosCameraBufferManager::dump(void)
     printBufferState();
     printBufferQState();
 
+    CLOGI("INFO(%s[%d]):getBuffer count(%d) avg(%lld ns) max(%lld ns) starvation(%d) high-water mark(%d/%d)",
+        __FUNCTION__, __LINE__,
+        m_statAcquireCount,
+        (m_statAcquireCount == 0) ? 0LL : (long long)(m_statAcquireTimeTotal / m_statAcquireCount),
+        (long long)m_statAcquireTimeMax,
+        m_statStarvationCount,
+        m_statHighWaterMark, m_allocatedBufCount);
+
     return;
 }
 
@@ -1203,7 +1300,6 @@ status_t InternalExynosCameraBufferManager::m_decrease(void)
     ExynosCameraAutoTimer autoTimer(__FUNCTION__);
 
     status_t ret = true;
-    List<int>::iterator r;
 
     int  bufferIndex = -1;
 
@@ -1231,14 +1327,7 @@ status_t InternalExynosCameraBufferManager::m_decrease(void)
         }
     }
 
-    m_availableBufferIndexQLock.lock();
-    for (r = m_availableBufferIndexQ.begin(); r != m_availableBufferIndexQ.end(); r++) {
-        if (bufferIndex == *r) {
-            m_availableBufferIndexQ.erase(r);
-            break;
-        }
-    }
-    m_availableBufferIndexQLock.unlock();
+    m_testAndClearAvailableIndex(bufferIndex);
     m_allocatedBufCount--;
 
     CLOGD("DEBUG(%s[%d]):Decrease the buffer succeeded (m_allocatedBufCount=%d)" ,
@@ -1801,7 +1890,6 @@ status_t GrallocExynosCameraBufferManager::cancelBuffer(int bufIndex)
     status_t ret = NO_ERROR;
     Mutex::Autolock lock(m_lock);
 
-    List<int>::iterator r;
     bool found = false;
 
     if (bufIndex < 0 || m_reqBufCount <= bufIndex) {
@@ -1835,22 +1923,13 @@ status_t GrallocExynosCameraBufferManager::cancelBuffer(int bufIndex)
         goto func_exit;
     }
 
-    m_availableBufferIndexQLock.lock();
-    for (r = m_availableBufferIndexQ.begin(); r != m_availableBufferIndexQ.end(); r++) {
-        if (bufIndex == *r) {
-            found = true;
-            break;
-        }
-    }
-
+    found = m_isAvailableIndex(bufIndex);
     if (found == true) {
         CLOGI("INFO(%s[%d]):bufIndex=%d is already in (available state)",
             __FUNCTION__, __LINE__, bufIndex);
-        m_availableBufferIndexQLock.unlock();
         goto func_exit;
     }
-    m_availableBufferIndexQ.push_back(m_buffer[bufIndex].index);
-    m_availableBufferIndexQLock.unlock();
+    m_setAvailableIndex(m_buffer[bufIndex].index);
 
 #ifdef EXYNOS_CAMERA_BUFFER_TRACE
     CLOGD("DEBUG(%s[%d]):-- dump buffer status --", __FUNCTION__, __LINE__);
@@ -61,6 +61,10 @@ namespace android {
 #define EXYNOS_CAMERA_BUFFER_OUT()  ((void *)0)
 #endif
 
+/* one bit per buffer index, set when the buffer is available */
+#define BUFFER_INDEX_MAP_BITS   (32)
+#define BUFFER_INDEX_MAP_SIZE   ((VIDEO_MAX_FRAME + BUFFER_INDEX_MAP_BITS - 1) / BUFFER_INDEX_MAP_BITS)
+
 typedef enum buffer_manager_type {
     BUFFER_MANAGER_ION_TYPE         = 0,
     BUFFER_MANAGER_HEAP_BASE_TYPE   = 1,
@@ -170,6 +174,14 @@ protected:
 
     void     m_resetSequenceQ(void);
 
+    void     m_clearAvailableIndex(void);
+    void     m_setAvailableIndex(int bufIndex);
+    bool     m_testAndClearAvailableIndex(int bufIndex);
+    int      m_findAndClearAvailableIndex(void);
+    bool     m_isAvailableIndex(int bufIndex);
+    int      m_getNumOfAvailableIndex(void);
+    void     m_updateStat(nsecs_t acquireTime, bool starved);
+
     virtual status_t m_setAllocator(void *allocator) = 0;
     virtual status_t m_alloc(int bIndex, int eIndex) = 0;
     virtual status_t m_free(int bIndex, int eIndex)  = 0;
@@ -195,8 +207,15 @@ protected:
     ExynosCameraIonAllocator    *m_defaultAllocator;
     struct ExynosCameraBuffer   m_buffer[VIDEO_MAX_FRAME];
     char                        m_name[EXYNOS_CAMERA_NAME_STR_SIZE];
-    List<int>                   m_availableBufferIndexQ;
-    mutable Mutex               m_availableBufferIndexQLock;
+    uint32_t                    m_availableBufferIndexMap[BUFFER_INDEX_MAP_SIZE];
+    int                         m_availableBufferIndexCursor;
+
+    /* getBuffer() statistics, printed by dump() */
+    uint32_t                    m_statAcquireCount;
+    nsecs_t                     m_statAcquireTimeTotal;
+    nsecs_t                     m_statAcquireTimeMax;
+    uint32_t                    m_statStarvationCount;
+    int                         m_statHighWaterMark;
 
     buffer_manager_allocation_mode_t m_allocMode;
 
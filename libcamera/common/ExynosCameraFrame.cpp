@@ -23,6 +23,33 @@
 
 namespace android {
 
+static int32_t s_frameAllocCount = 0;
+static int32_t s_frameEntityAllocCount = 0;
+
+int32_t getFrameAllocCount(void)
+{
+    return __atomic_load_n(&s_frameAllocCount, __ATOMIC_RELAXED);
+}
+
+int32_t getFrameEntityAllocCount(void)
+{
+    return __atomic_load_n(&s_frameEntityAllocCount, __ATOMIC_RELAXED);
+}
+
+void releaseFrame(ExynosCameraFrame *frame)
+{
+    ExynosCameraFramePool *pool = NULL;
+
+    if (frame == NULL)
+        return;
+
+    pool = frame->getFramePool();
+    if (pool != NULL)
+        pool->putFrame(frame);
+    else
+        delete frame;
+}
+
 ExynosCameraFrame::ExynosCameraFrame(
         ExynosCameraParameters *obj_param,
         uint32_t frameCount)
@@ -45,6 +72,14 @@ ExynosCameraFrame::ExynosCameraFrame(
     m_requestSCP = false;
     for (int i = 0; i < PERFRAME_NODE_GROUP_MAX; i++)
         memset(&m_node_gorup[i], 0x0, sizeof(struct camera2_node_group));
+    m_framePool = NULL;
+    m_framePoolIndex = -1;
+
+    for (int i = 0; i < FRAME_ENTITY_TABLE_SIZE; i++)
+        m_entityTable[i] = NULL;
+    m_entityTableCollision = false;
+
+    __atomic_add_fetch(&s_frameAllocCount, 1, __ATOMIC_RELAXED);
 }
 
 ExynosCameraFrame::~ExynosCameraFrame()
@@ -71,11 +106,60 @@ ExynosCameraFrame::~ExynosCameraFrame()
     }
 }
 
+void ExynosCameraFrame::reset(uint32_t frameCount)
+{
+    List<ExynosCameraFrameEntity *>::iterator r;
+    ExynosCameraFrameEntity *curEntity = NULL;
+
+    m_frameCount = frameCount;
+    m_numCompletePipe = 0;
+    m_frameState = FRAME_STATE_READY;
+    m_frameLocked = false;
+    m_metaDataEnable = false;
+    m_zoom = 0;
+    memset(&m_metaData, 0x0, sizeof(struct camera2_shot_ext));
+    m_jpegSize = 0;
+    m_request3AP = false;
+    m_request3AC = false;
+    m_requestISP = false;
+    m_requestSCC = false;
+    m_requestDIS = false;
+    m_requestSCP = false;
+    for (int i = 0; i < PERFRAME_NODE_GROUP_MAX; i++)
+        memset(&m_node_gorup[i], 0x0, sizeof(struct camera2_node_group));
+
+    for (r = m_linkageList.begin(); r != m_linkageList.end(); r++) {
+        curEntity = *r;
+
+        while (curEntity != NULL) {
+            curEntity->reset();
+            curEntity = curEntity->getNextEntity();
+        }
+    }
+}
+
+void ExynosCameraFrame::setFramePool(ExynosCameraFramePool *pool, int index)
+{
+    m_framePool = pool;
+    m_framePoolIndex = index;
+}
+
+ExynosCameraFramePool *ExynosCameraFrame::getFramePool(void)
+{
+    return m_framePool;
+}
+
+int ExynosCameraFrame::getFramePoolIndex(void)
+{
+    return m_framePoolIndex;
+}
+
 status_t ExynosCameraFrame::addSiblingEntity(
         ExynosCameraFrameEntity *curEntity,
         ExynosCameraFrameEntity *newEntity)
 {
     m_linkageList.push_back(newEntity);
+    m_registerEntity(newEntity);
 
     return NO_ERROR;
 }
@@ -101,10 +185,30 @@ status_t ExynosCameraFrame::addChildEntity(
         return ret;
     }
     newEntity->setNextEntity(tmpEntity);
+    m_registerEntity(newEntity);
 
     return NO_ERROR;
 }
 
+void ExynosCameraFrame::m_registerEntity(ExynosCameraFrameEntity *entity)
+{
+    uint32_t index = 0;
+
+    if (entity == NULL)
+        return;
+
+    index = entity->getPipeId() % FRAME_ENTITY_TABLE_SIZE;
+
+    if (m_entityTable[index] == NULL) {
+        m_entityTable[index] = entity;
+    } else if (m_entityTable[index]->getPipeId() != entity->getPipeId()) {
+        /* pipes of different groups share the slot, search the list on a miss */
+        ALOGV("DEBUG(%s):pipeId(%d) collides with pipeId(%d)",
+            __FUNCTION__, entity->getPipeId(), m_entityTable[index]->getPipeId());
+        m_entityTableCollision = true;
+    }
+}
+
 ExynosCameraFrameEntity *ExynosCameraFrame::getFirstEntity(void)
 {
     List<ExynosCameraFrameEntity *>::iterator r;
@@ -155,15 +259,34 @@ ExynosCameraFrameEntity *ExynosCameraFrame::getChildEntity(ExynosCameraFrameEnti
 
 ExynosCameraFrameEntity *ExynosCameraFrame::searchEntityByPipeId(uint32_t pipeId)
 {
-    List<ExynosCameraFrameEntity *>::iterator r;
     ExynosCameraFrameEntity *curEntity = NULL;
-    int listSize = 0;
 
     if (m_linkageList.empty()) {
         ALOGE("ERR(%s):m_linkageList is empty", __FUNCTION__);
         return NULL;
     }
 
+    curEntity = m_entityTable[pipeId % FRAME_ENTITY_TABLE_SIZE];
+    if (curEntity != NULL && curEntity->getPipeId() == pipeId)
+        return curEntity;
+
+    if (m_entityTableCollision == true) {
+        curEntity = m_searchEntityInList(pipeId);
+        if (curEntity != NULL)
+            return curEntity;
+    }
+
+    ALOGD("DEBUG(%s):Cannot find matched entity, frameCount(%d), pipeId(%d)", __FUNCTION__, getFrameCount(), pipeId);
+
+    return NULL;
+}
+
+ExynosCameraFrameEntity *ExynosCameraFrame::m_searchEntityInList(uint32_t pipeId)
+{
+    List<ExynosCameraFrameEntity *>::iterator r;
+    ExynosCameraFrameEntity *curEntity = NULL;
+    int listSize = 0;
+
     listSize = m_linkageList.size();
     r = m_linkageList.begin();
 
@@ -183,8 +306,6 @@ ExynosCameraFrameEntity *ExynosCameraFrame::searchEntityByPipeId(uint32_t pipeId
         r++;
     }
 
-    ALOGD("DEBUG(%s):Cannot find matched entity, frameCount(%d), pipeId(%d)", __FUNCTION__, getFrameCount(), pipeId);
-
     return NULL;
 }
 
@@ -953,6 +1074,19 @@ ExynosCameraFrameEntity::ExynosCameraFrameEntity(
 
     m_prevEntity = NULL;
     m_nextEntity = NULL;
+
+    __atomic_add_fetch(&s_frameEntityAllocCount, 1, __ATOMIC_RELAXED);
+}
+
+void ExynosCameraFrameEntity::reset(void)
+{
+    ExynosCameraBuffer emptyBuf;
+
+    m_setEntityType(m_EntityType);
+
+    m_srcBuf = emptyBuf;
+    m_dstBuf = emptyBuf;
+    m_entityState = ENTITY_STATE_READY;
 }
 
 status_t ExynosCameraFrameEntity::m_setEntityType(entity_type_t type)
@@ -1129,4 +1263,168 @@ status_t ExynosCameraFrameEntity::setNextEntity(ExynosCameraFrameEntity *entity)
     return NO_ERROR;
 }
 
+/*
+ * ExynosCameraFramePool class
+ */
+
+ExynosCameraFramePool::ExynosCameraFramePool(const char *name)
+{
+    memset(m_name, 0x00, sizeof(m_name));
+    strncpy(m_name, name, EXYNOS_CAMERA_NAME_STR_SIZE - 1);
+
+    m_numFrames = 0;
+
+    /* frames are put back from every pipe thread */
+    m_freeQ.setMode(LIST_MODE_RING_MPSC, FRAME_POOL_MAX);
+
+    /* reference of the owner, dropped by release() */
+    m_refCount = 1;
+    m_closed = 0;
+
+    m_hitCount = 0;
+    m_missCount = 0;
+    m_putCount = 0;
+}
+
+ExynosCameraFramePool::~ExynosCameraFramePool()
+{
+}
+
+status_t ExynosCameraFramePool::addFrame(ExynosCameraFrame *frame)
+{
+    Mutex::Autolock lock(m_lock);
+
+    if (frame == NULL) {
+        ALOGE("ERR(%s[%d]):[%s] frame is NULL", __FUNCTION__, __LINE__, m_name);
+        return BAD_VALUE;
+    }
+
+    if (FRAME_POOL_MAX <= m_numFrames) {
+        ALOGE("ERR(%s[%d]):[%s] pool is full(%d)", __FUNCTION__, __LINE__, m_name, m_numFrames);
+        return NO_MEMORY;
+    }
+
+    /* every frame keeps the pool alive until it is deleted */
+    __atomic_add_fetch(&m_refCount, 1, __ATOMIC_RELAXED);
+    frame->setFramePool(this, m_numFrames);
+    m_numFrames++;
+
+    m_freeQ.pushProcessQ(&frame);
+
+    return NO_ERROR;
+}
+
+ExynosCameraFrame *ExynosCameraFramePool::getFrame(uint32_t frameCount)
+{
+    ExynosCameraFrame *frame = NULL;
+
+    if (m_freeQ.popProcessQ(&frame) != OK || frame == NULL) {
+        __atomic_add_fetch(&m_missCount, 1, __ATOMIC_RELAXED);
+        ALOGV("DEBUG(%s[%d]):[%s] pool is exhausted, frameCount(%d)", __FUNCTION__, __LINE__, m_name, frameCount);
+        return NULL;
+    }
+
+    __atomic_add_fetch(&m_hitCount, 1, __ATOMIC_RELAXED);
+    frame->reset(frameCount);
+
+    return frame;
+}
+
+void ExynosCameraFramePool::putFrame(ExynosCameraFrame *frame)
+{
+    if (frame == NULL)
+        return;
+
+    if (frame->getFramePool() != this) {
+        ALOGE("ERR(%s[%d]):[%s] frame(%d) is not from this pool", __FUNCTION__, __LINE__, m_name, frame->getFrameCount());
+        return;
+    }
+
+    __atomic_add_fetch(&m_putCount, 1, __ATOMIC_RELAXED);
+
+    /*
+     * Once pushed, the frame may be drained and deleted by a concurrent
+     * release(), dropping the reference it held: hold one of our own
+     * until the pool is no longer touched.
+     */
+    __atomic_add_fetch(&m_refCount, 1, __ATOMIC_SEQ_CST);
+    m_freeQ.pushProcessQ(&frame);
+
+    /* release() may have drained the queue before the push above */
+    if (__atomic_load_n(&m_closed, __ATOMIC_SEQ_CST) != 0)
+        m_drainFrames();
+
+    m_decRef();
+}
+
+void ExynosCameraFramePool::release(void)
+{
+    int numInUse = 0;
+
+    {
+        Mutex::Autolock lock(m_lock);
+        numInUse = m_numFrames - m_freeQ.getSizeOfProcessQ();
+    }
+
+    if (0 < numInUse)
+        ALOGW("WARN(%s[%d]):[%s] %d frames are still in use, they are deleted on their release",
+            __FUNCTION__, __LINE__, m_name, numInUse);
+
+    __atomic_store_n(&m_closed, 1, __ATOMIC_SEQ_CST);
+
+    /* hold a reference while draining, the last frame may be put concurrently */
+    __atomic_add_fetch(&m_refCount, 1, __ATOMIC_SEQ_CST);
+    m_drainFrames();
+    m_decRef();
+
+    /* reference of the owner */
+    m_decRef();
+}
+
+void ExynosCameraFramePool::m_drainFrames(void)
+{
+    ExynosCameraFrame *frame = NULL;
+    int numFrames = 0;
+
+    /* the ring pop is CASed, concurrent drains never get the same frame */
+    while (m_freeQ.popProcessQ(&frame) == OK && frame != NULL) {
+        delete frame;
+        frame = NULL;
+        numFrames++;
+    }
+
+    /* last: the references held by the frames may be the last ones */
+    for (int i = 0; i < numFrames; i++)
+        m_decRef();
+}
+
+void ExynosCameraFramePool::m_decRef(void)
+{
+    if (__atomic_sub_fetch(&m_refCount, 1, __ATOMIC_ACQ_REL) == 0)
+        delete this;
+}
+
+int ExynosCameraFramePool::getNumOfFrame(void)
+{
+    Mutex::Autolock lock(m_lock);
+    return m_numFrames;
+}
+
+int ExynosCameraFramePool::getNumOfAvailableFrame(void)
+{
+    return m_freeQ.getSizeOfProcessQ();
+}
+
+void ExynosCameraFramePool::dump(void)
+{
+    ALOGI("INFO(%s[%d]):[%s] frames(%d) available(%d) hit(%d) miss(%d) put(%d)",
+        __FUNCTION__, __LINE__, m_name,
+        getNumOfFrame(), getNumOfAvailableFrame(),
+        __atomic_load_n(&m_hitCount, __ATOMIC_RELAXED),
+        __atomic_load_n(&m_missCount, __ATOMIC_RELAXED),
+        __atomic_load_n(&m_putCount, __ATOMIC_RELAXED));
+    ALOGI("INFO(%s[%d]):allocated frames(%d) entities(%d)",
+        __FUNCTION__, __LINE__, getFrameAllocCount(), getFrameEntityAllocCount());
+}
+
 }; /* namespace android */
@@ -23,9 +23,18 @@
 #include "ExynosCameraParameters.h"
 #include "ExynosCameraSensorInfo.h"
 #include "ExynosCameraBuffer.h"
+#include "ExynosCameraList.h"
+
+/* max number of frames pre-built by a frame pool */
+#define FRAME_POOL_MAX      (64)
+
+/* pipeId -> entity lookup table, indexed by (pipeId % FRAME_ENTITY_TABLE_SIZE) */
+#define FRAME_ENTITY_TABLE_SIZE (MAX_PIPE_NUM)
 
 namespace android {
 
+class ExynosCameraFramePool;
+
 typedef enum entity_type {
     ENTITY_TYPE_INPUT_ONLY              = 0, /* Need input buffer only */
     ENTITY_TYPE_OUTPUT_ONLY             = 1, /* Need output buffer only */
@@ -66,6 +75,9 @@ public:
         entity_buffer_type_t bufType);
     uint32_t getPipeId(void);
 
+    /* restore the state of a newly created entity, links are kept */
+    void     reset(void);
+
     status_t setSrcBuf(ExynosCameraBuffer buf);
     status_t setDstBuf(ExynosCameraBuffer buf);
 
@@ -139,6 +151,16 @@ public:
             uint32_t frameCount);
     ~ExynosCameraFrame();
 
+    /*
+     * Restore the state of a newly created frame with frameCount.
+     * The entity topology (m_linkageList, child entities) is kept.
+     */
+    void            reset(uint32_t frameCount);
+
+    void            setFramePool(ExynosCameraFramePool *pool, int index);
+    ExynosCameraFramePool *getFramePool(void);
+    int             getFramePoolIndex(void);
+
     /* If curEntity is NULL, newEntity is added to m_linkageList */
     status_t        addSiblingEntity(
                         ExynosCameraFrameEntity *curEntity,
@@ -269,8 +291,15 @@ public:
     void            getFpsRange(uint32_t *min, uint32_t *max);
 
 private:
+    void            m_registerEntity(ExynosCameraFrameEntity *entity);
+    ExynosCameraFrameEntity *m_searchEntityInList(uint32_t pipeId);
+
+private:
+    /* m_linkageList keeps the traversal order, m_entityTable is for lookup by pipeId */
     List<ExynosCameraFrameEntity *>      m_linkageList;
     List<ExynosCameraFrameEntity *>::iterator m_currentEntity;
+    ExynosCameraFrameEntity    *m_entityTable[FRAME_ENTITY_TABLE_SIZE];
+    bool                        m_entityTableCollision;
 
     ExynosCameraParameters     *m_parameters;
     uint32_t                    m_frameCount;
@@ -296,6 +325,63 @@ private:
     bool                        m_requestSCC;
     bool                        m_requestDIS;
     bool                        m_requestSCP;
+
+    ExynosCameraFramePool      *m_framePool;
+    int                         m_framePoolIndex;
+};
+
+/*
+ * Give the frame back to its frame pool,
+ * or delete it when it was not allocated from a pool.
+ */
+void releaseFrame(ExynosCameraFrame *frame);
+
+/* number of ExynosCameraFrame / ExynosCameraFrameEntity allocated since process start */
+int32_t getFrameAllocCount(void);
+int32_t getFrameEntityAllocCount(void);
+
+/*
+ * Pre-built frames recycled by a frame factory.
+ * getFrame() never allocates, it returns NULL when the pool is exhausted.
+ * putFrame() can be called from any thread.
+ *
+ * The pool is reference counted : its owner and every frame built for it
+ * hold a reference. release() drops the owner's one, the pool is deleted
+ * once the frames still in the pipeline have been put back.
+ */
+class ExynosCameraFramePool {
+public:
+    ExynosCameraFramePool(const char *name);
+
+    status_t            addFrame(ExynosCameraFrame *frame);
+    ExynosCameraFrame  *getFrame(uint32_t frameCount);
+    void                putFrame(ExynosCameraFrame *frame);
+
+    /* delete free frames and drop the owner's reference, the pool must not be used afterwards */
+    void                release(void);
+
+    int                 getNumOfFrame(void);
+    int                 getNumOfAvailableFrame(void);
+    void                dump(void);
+
+private:
+    ~ExynosCameraFramePool();
+
+    void                m_drainFrames(void);
+    void                m_decRef(void);
+
+private:
+    char                        m_name[EXYNOS_CAMERA_NAME_STR_SIZE];
+    int                         m_numFrames;
+    ExynosCameraList<ExynosCameraFrame *> m_freeQ;
+    mutable Mutex               m_lock;
+
+    int32_t                     m_refCount;
+    int32_t                     m_closed;
+
+    int32_t                     m_hitCount;
+    int32_t                     m_missCount;
+    int32_t                     m_putCount;
 };
 
 }; /* namespace android */
@@ -463,6 +463,8 @@ status_t ExynosCameraFrameSelector::m_popQ(ExynosCameraList<ExynosCameraFrame *>
                 iter++;
                 continue;
             }
+            /* NOT_ENOUGH_DATA: empty, retrying does not help */
+            break;
         }
     } while (ret != OK && tryCount > iter);
 
@@ -529,7 +531,7 @@ status_t ExynosCameraFrameSelector::m_frameComplete(ExynosCameraFrame *frame)
         if (frame->getFrameLockState() == false)
         {
             ALOGV("DEBUG(%s[%d]):frame complete, count(%d)", __FUNCTION__, __LINE__, frame->getFrameCount());
-            delete frame;
+            releaseFrame(frame);
             frame = NULL;
         }
     }
@@ -550,7 +552,7 @@ status_t ExynosCameraFrameSelector::m_LockedFrameComplete(ExynosCameraFrame *fra
         {
             ALOGV("DEBUG(%s[%d]):Deallocating locked frame, count(%d)", __FUNCTION__, __LINE__, frame->getFrameCount());
         }
-        delete frame;
+        releaseFrame(frame);
     }
     return ret;
 }
@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -39,6 +40,9 @@
 #include <sys/poll.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sched.h>
 #include <utils/threads.h>
 
 #include <utils/RefBase.h>
@@ -54,6 +58,24 @@ enum LIST_CMD {
     WAKE_UP = 1,
 };
 
+/*
+ * Backend of the process queue.
+ * LIST_MODE_LIST is the default mutex protected android::List.
+ * The ring modes use a bounded, allocation-free ring buffer :
+ * LIST_MODE_RING_SPSC must have only one producer thread,
+ * LIST_MODE_RING_MPSC allows several producers (ex. pipe threads pushing to one doneQ).
+ * Consumers block on a futex only when the ring is empty.
+ * A push never blocks: when the ring is full, entries spill over to the
+ * List until the consumer has drained it, keeping the FIFO order.
+ */
+enum LIST_MODE {
+    LIST_MODE_LIST = 0,
+    LIST_MODE_RING_SPSC,
+    LIST_MODE_RING_MPSC,
+};
+
+#define RING_SPIN_COUNT     (16)
+
 template<typename T>
 class ExynosCameraList {
 public:
@@ -66,6 +88,8 @@ public:
         m_waitProcessQ = false;
         m_waitTime = WAIT_TIME;
         m_thread = NULL;
+
+        m_initRing();
     }
 
     ExynosCameraList(sp<Thread> thread)
@@ -76,16 +100,80 @@ public:
         m_thread = NULL;
 
         m_thread = thread;
+
+        m_initRing();
     }
 
     ~ExynosCameraList()
     {
         release();
+
+        if (m_ring != NULL) {
+            delete[] m_ring;
+            m_ring = NULL;
+        }
+    }
+
+    /*
+     * Switch the process queue to a ring buffer backend.
+     * size is rounded up to a power of 2.
+     * It must be called before the queue is used (no producer/consumer running).
+     */
+    status_t setMode(enum LIST_MODE mode, uint32_t size)
+    {
+        uint32_t ringSize = 1;
+
+        if (mode == LIST_MODE_LIST) {
+            if (m_ring != NULL) {
+                delete[] m_ring;
+                m_ring = NULL;
+            }
+            m_mode = mode;
+            return NO_ERROR;
+        }
+
+        if (size == 0) {
+            ALOGE("ERR(%s):invalid ring size(%d)", __FUNCTION__, size);
+            return BAD_VALUE;
+        }
+
+        while (ringSize < size)
+            ringSize <<= 1;
+
+        if (m_ring != NULL)
+            delete[] m_ring;
+
+        m_ring = new ring_cell_t[ringSize];
+        for (uint32_t i = 0; i < ringSize; i++)
+            m_ring[i].seq = i;
+
+        m_ringMask = ringSize - 1;
+        m_ringHead = 0;
+        m_ringTail = 0;
+        m_ringEvent = 0;
+        m_ringWaiting = 0;
+        m_ringOverflow = 0;
+        m_mode = mode;
+
+        ALOGD("DEBUG(%s):mode(%d) ring size(%d)", __FUNCTION__, m_mode, ringSize);
+
+        return NO_ERROR;
+    }
+
+    enum LIST_MODE getMode(void)
+    {
+        return m_mode;
     }
 
     void wakeupAll(void)
     {
         setStatusException(TIMED_OUT);
+
+        if (m_mode != LIST_MODE_LIST) {
+            m_wakeRing();
+            return;
+        }
+
         if (m_waitProcessQ)
             m_processQCondition.signal();
     }
@@ -117,6 +205,11 @@ public:
     /* Process Queue */
     void pushProcessQ(T *buf)
     {
+        if (m_mode != LIST_MODE_LIST) {
+            m_pushRing(buf);
+            return;
+        }
+
         Mutex::Autolock lock(m_processQMutex);
         m_processQ.push_back(*buf);
 
@@ -126,13 +219,17 @@ public:
             m_thread->run();
     };
 
+    /* returns NOT_ENOUGH_DATA when the queue is empty, whatever the backend */
     status_t popProcessQ(T *buf)
     {
         iterator r;
 
+        if (m_mode != LIST_MODE_LIST)
+            return (m_popRing(buf) == true) ? OK : NOT_ENOUGH_DATA;
+
         Mutex::Autolock lock(m_processQMutex);
         if (m_processQ.empty())
-            return false;
+            return NOT_ENOUGH_DATA;
 
         r = m_processQ.begin()++;
         *buf = *r;
@@ -146,6 +243,10 @@ public:
         iterator r;
 
         status_t ret;
+
+        if (m_mode != LIST_MODE_LIST)
+            return m_waitAndPopRing(buf);
+
         m_processQMutex.lock();
         if (m_processQ.empty()) {
             m_waitProcessQ = true;
@@ -188,6 +289,11 @@ public:
 
     int getSizeOfProcessQ(void)
     {
+        if (m_mode != LIST_MODE_LIST)
+            return (int)(__atomic_load_n(&m_ringTail, __ATOMIC_ACQUIRE)
+                         - __atomic_load_n(&m_ringHead, __ATOMIC_ACQUIRE))
+                   + __atomic_load_n(&m_ringOverflow, __ATOMIC_ACQUIRE);
+
         Mutex::Autolock lock(m_processQMutex);
         return m_processQ.size();
     };
@@ -197,6 +303,14 @@ public:
     {
         setStatusException(TIMED_OUT);
 
+        if (m_mode != LIST_MODE_LIST) {
+            T dummy;
+
+            m_wakeRing();
+            while (m_popRing(&dummy) == true);
+            return;
+        }
+
         m_processQMutex.lock();
         if (m_waitProcessQ)
             m_processQCondition.signal();
@@ -212,11 +326,207 @@ public:
     }
 
     bool isWaiting(void) {
+        if (m_mode != LIST_MODE_LIST)
+            return (__atomic_load_n(&m_ringWaiting, __ATOMIC_ACQUIRE) != 0);
+
         Mutex::Autolock lock(m_processQMutex);
         return m_waitProcessQ;
     }
 
 private:
+    typedef struct ring_cell {
+        uint32_t seq;
+        T        data;
+    } ring_cell_t;
+
+    void m_initRing(void)
+    {
+        m_mode = LIST_MODE_LIST;
+        m_ring = NULL;
+        m_ringMask = 0;
+        m_ringHead = 0;
+        m_ringTail = 0;
+        m_ringEvent = 0;
+        m_ringWaiting = 0;
+        m_ringOverflow = 0;
+    }
+
+    /*
+     * Bounded ring with per-cell sequence numbers.
+     * A cell is writable when seq == pos, readable when seq == pos + 1.
+     */
+    bool m_tryPushRing(T *buf)
+    {
+        ring_cell_t *cell;
+        uint32_t pos = __atomic_load_n(&m_ringTail, __ATOMIC_RELAXED);
+        int32_t diff;
+
+        for (;;) {
+            cell = &m_ring[pos & m_ringMask];
+            diff = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+
+            if (diff == 0) {
+                if (m_mode == LIST_MODE_RING_SPSC) {
+                    __atomic_store_n(&m_ringTail, pos + 1, __ATOMIC_RELAXED);
+                    break;
+                }
+                if (__atomic_compare_exchange_n(&m_ringTail, &pos, pos + 1, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED) == true)
+                    break;
+            } else if (diff < 0) {
+                /* full */
+                return false;
+            } else {
+                pos = __atomic_load_n(&m_ringTail, __ATOMIC_RELAXED);
+            }
+        }
+
+        cell->data = *buf;
+        __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+    bool m_tryPopRing(T *buf)
+    {
+        ring_cell_t *cell;
+        uint32_t pos = __atomic_load_n(&m_ringHead, __ATOMIC_RELAXED);
+        int32_t diff;
+
+        /* head is CASed so that release() can drain while the consumer runs */
+        for (;;) {
+            cell = &m_ring[pos & m_ringMask];
+            diff = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+
+            if (diff == 0) {
+                if (__atomic_compare_exchange_n(&m_ringHead, &pos, pos + 1, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED) == true)
+                    break;
+            } else if (diff < 0) {
+                /* empty */
+                return false;
+            } else {
+                pos = __atomic_load_n(&m_ringHead, __ATOMIC_RELAXED);
+            }
+        }
+
+        *buf = cell->data;
+        __atomic_store_n(&cell->seq, pos + m_ringMask + 1, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+    /* the ring first: an entry only spills over once the ring is full */
+    bool m_popRing(T *buf)
+    {
+        iterator r;
+
+        if (m_tryPopRing(buf) == true)
+            return true;
+
+        if (__atomic_load_n(&m_ringOverflow, __ATOMIC_ACQUIRE) == 0)
+            return false;
+
+        Mutex::Autolock lock(m_processQMutex);
+        if (m_processQ.empty())
+            return false;
+
+        r = m_processQ.begin();
+        *buf = *r;
+        m_processQ.erase(r);
+        __atomic_sub_fetch(&m_ringOverflow, 1, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+    void m_wakeRing(void)
+    {
+        __atomic_add_fetch(&m_ringEvent, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&m_ringWaiting, __ATOMIC_SEQ_CST) != 0)
+            syscall(__NR_futex, &m_ringEvent, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+
+    void m_pushRing(T *buf)
+    {
+        /*
+         * The ring is sized over the buffer count, full means the consumer
+         * is stalled: spill over to the List instead of waiting for it.
+         * Once spilled, later entries follow until the List is drained.
+         */
+        if (__atomic_load_n(&m_ringOverflow, __ATOMIC_ACQUIRE) != 0
+            || m_tryPushRing(buf) == false) {
+            Mutex::Autolock lock(m_processQMutex);
+            if (m_processQ.empty())
+                ALOGW("WARN(%s[%d]):ring is full(%d), spill over", __FUNCTION__, __LINE__, m_ringMask + 1);
+            m_processQ.push_back(*buf);
+            __atomic_add_fetch(&m_ringOverflow, 1, __ATOMIC_RELEASE);
+        }
+
+        m_wakeRing();
+
+        if (m_thread != NULL && m_thread->isRunning() == false
+            && __atomic_load_n(&m_ringWaiting, __ATOMIC_ACQUIRE) == 0)
+            m_thread->run();
+    }
+
+    status_t m_waitAndPopRing(T *buf)
+    {
+        struct timespec ts;
+        uint64_t remain = m_waitTime;
+        nsecs_t start;
+        nsecs_t elapsed;
+        int32_t event;
+        int ret;
+
+        for (int i = 0; i < RING_SPIN_COUNT; i++) {
+            if (m_popRing(buf) == true)
+                return OK;
+            sched_yield();
+        }
+
+        setStatusException(NO_ERROR);
+        start = systemTime(SYSTEM_TIME_MONOTONIC);
+
+        for (;;) {
+            event = __atomic_load_n(&m_ringEvent, __ATOMIC_SEQ_CST);
+            __atomic_store_n(&m_ringWaiting, 1, __ATOMIC_SEQ_CST);
+
+            /* recheck after announcing the waiter, to not miss a push */
+            if (m_popRing(buf) == true) {
+                __atomic_store_n(&m_ringWaiting, 0, __ATOMIC_SEQ_CST);
+                return OK;
+            }
+
+            ts.tv_sec  = remain / 1000000000;
+            ts.tv_nsec = remain % 1000000000;
+
+            ret = syscall(__NR_futex, &m_ringEvent, FUTEX_WAIT_PRIVATE, event, &ts, NULL, 0);
+            __atomic_store_n(&m_ringWaiting, 0, __ATOMIC_SEQ_CST);
+
+            ret = getStatusException();
+            if (ret != NO_ERROR) {
+                ALOGW("WARN(%s[%d]): Exception status(%d)", __FUNCTION__, __LINE__, ret);
+                return ret;
+            }
+
+            if (m_popRing(buf) == true)
+                return OK;
+
+            /*
+             * woken up by a producer whose cell is not published yet (MPSC),
+             * or by a signal : wait again for the remaining time
+             */
+            elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+            if ((uint64_t)elapsed >= m_waitTime) {
+                ALOGV("DEBUG(%s):Time out, Skip to pop process Q", __FUNCTION__);
+                return TIMED_OUT;
+            }
+            remain = m_waitTime - elapsed;
+        }
+
+        return INVALID_OPERATION;
+    }
+
     List<T>             m_processQ;
     Mutex               m_processQMutex;
     Mutex               m_flagMutex;
@@ -226,5 +536,14 @@ private:
     uint64_t            m_waitTime;
 
     sp<Thread>          m_thread;
+
+    enum LIST_MODE      m_mode;
+    ring_cell_t        *m_ring;
+    uint32_t            m_ringMask;
+    uint32_t            m_ringHead;
+    uint32_t            m_ringTail;
+    int32_t             m_ringEvent;
+    int32_t             m_ringWaiting;
+    int32_t             m_ringOverflow;
 };
 #endif
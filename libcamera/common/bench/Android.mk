@@ -0,0 +1,156 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH:= $(call my-dir)
+
+# ExynosCameraList push/pop latency and throughput, List against the rings, host only
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	ExynosCameraListBench.cpp
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/..
+
+LOCAL_STATIC_LIBRARIES := \
+	libutils \
+	libcutils \
+	liblog
+
+LOCAL_LDLIBS := -lpthread -lrt
+
+LOCAL_MODULE := exynos_camera_list_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# ExynosCameraFrame per-pipe accessor cost, pipeId table against the former list walk.
+# The camera HAL is built from the device tree, which holds ExynosCameraConfig.h and
+# ExynosCameraSensorInfo.h; set EXYNOS_CAMERA_CONFIG_DIR to that directory to build it.
+ifneq ($(EXYNOS_CAMERA_CONFIG_DIR),)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	ExynosCameraFrameBench.cpp \
+	../ExynosCameraFrame.cpp
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(EXYNOS_CAMERA_CONFIG_DIR) \
+	$(LOCAL_PATH)/.. \
+	$(LOCAL_PATH)/../Buffers \
+	$(LOCAL_PATH)/../Activities \
+	$(LOCAL_PATH)/../Pipes \
+	$(LOCAL_PATH)/../../54xx \
+	$(LOCAL_PATH)/../../54xx/JpegEncoderForCamera \
+	$(LOCAL_PATH)/../../../include \
+	$(LOCAL_PATH)/../../../libexynosutils \
+	hardware/samsung_slsi-cm/$(TARGET_BOARD_PLATFORM)/include \
+	frameworks/av/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+LOCAL_SHARED_LIBRARIES := \
+	libutils \
+	libcutils \
+	liblog
+
+LOCAL_MODULE := exynos_camera_frame_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+endif
+
+# JPEG burst shot-to-shot latency with a 512x384 EXIF thumbnail, kept thumbnail
+# encoder and buffers against a new encoder per shot. Needs the jpeg device.
+ifneq ($(EXYNOS_CAMERA_CONFIG_DIR),)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	ExynosJpegThumbnailBench.cpp \
+	../../54xx/JpegEncoderForCamera/ExynosJpegEncoderForCamera.cpp
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(EXYNOS_CAMERA_CONFIG_DIR) \
+	$(LOCAL_PATH)/.. \
+	$(LOCAL_PATH)/../Buffers \
+	$(LOCAL_PATH)/../Activities \
+	$(LOCAL_PATH)/../Pipes \
+	$(LOCAL_PATH)/../../54xx \
+	$(LOCAL_PATH)/../../54xx/JpegEncoderForCamera \
+	$(LOCAL_PATH)/../../../include \
+	$(LOCAL_PATH)/../../../libexynosutils \
+	hardware/samsung_slsi-cm/$(TARGET_BOARD_PLATFORM)/include \
+	frameworks/av/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+LOCAL_SHARED_LIBRARIES := \
+	libexynosutils \
+	libhwjpeg \
+	libcsc \
+	libion_exynos \
+	libutils \
+	libcutils \
+	liblog
+
+LOCAL_MODULE := exynos_jpeg_thumbnail_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+endif
+
+# Thumbnail downscaler speed and PSNR against an exact area average, 13MP YUYV and NV16
+# to 512x384 and the other EXIF thumbnail sizes. Runs on the CPU only.
+ifneq ($(EXYNOS_CAMERA_CONFIG_DIR),)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	ExynosJpegThumbnailScaleBench.cpp \
+	../../54xx/JpegEncoderForCamera/ExynosJpegEncoderForCamera.cpp
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(EXYNOS_CAMERA_CONFIG_DIR) \
+	$(LOCAL_PATH)/.. \
+	$(LOCAL_PATH)/../Buffers \
+	$(LOCAL_PATH)/../Activities \
+	$(LOCAL_PATH)/../Pipes \
+	$(LOCAL_PATH)/../../54xx \
+	$(LOCAL_PATH)/../../54xx/JpegEncoderForCamera \
+	$(LOCAL_PATH)/../../../include \
+	$(LOCAL_PATH)/../../../libexynosutils \
+	hardware/samsung_slsi-cm/$(TARGET_BOARD_PLATFORM)/include \
+	frameworks/av/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+LOCAL_SHARED_LIBRARIES := \
+	libexynosutils \
+	libhwjpeg \
+	libcsc \
+	libion_exynos \
+	libutils \
+	libcutils \
+	liblog
+
+LOCAL_MODULE := exynos_jpeg_thumbnail_scale_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+endif
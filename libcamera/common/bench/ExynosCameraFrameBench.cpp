@@ -0,0 +1,195 @@
+/*
+ * Copyright 2013, Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      ExynosCameraFrameBench.cpp
+ * \brief     per-frame cost of the ExynosCameraFrame per-pipe accessors
+ *
+ * A frame is built with the preview entities of
+ * ExynosCameraFrameFactory::createNewFrame() and gets the accessor calls
+ * a preview frame sees on its way through the pipes, BENCH_CALLS_PER_PIPE
+ * per pipe. "table" runs them through the frame, which finds the entity
+ * in its pipeId table. "list walk" finds it the way searchEntityByPipeId()
+ * did before the table, over a copy of m_linkageList and the child
+ * entities, and calls the same entity methods.
+ */
+
+#define LOG_TAG "ExynosCameraFrameBench"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ExynosCameraFrame.h"
+
+#define BENCH_CALLS_PER_PIPE    (8)
+
+using namespace android;
+
+/*
+ * The bench never touches frame metadata. These are the parameters and
+ * utils calls ExynosCameraFrame.cpp links against.
+ */
+status_t ExynosCameraParameters::duplicateCtrlMetadata(void * /* buf */)
+{
+    return NO_ERROR;
+}
+
+namespace android {
+nsecs_t getMetaDmSensorTimeStamp(struct camera2_shot_ext * /* shot_ext */)
+{
+    return 0;
+}
+
+void getMetaCtlAeTargetFpsRange(struct camera2_shot_ext * /* shot_ext */, uint32_t *min, uint32_t *max)
+{
+    *min = 0;
+    *max = 0;
+}
+}; /* namespace android */
+
+static const struct {
+    uint32_t                pipeId;
+    entity_type_t           type;
+    entity_buffer_type_t    bufType;
+} gPreviewEntities[] = {
+    { PIPE_FLITE,     ENTITY_TYPE_OUTPUT_ONLY,  ENTITY_BUFFER_FIXED    },
+    { PIPE_3AA_ISP,   ENTITY_TYPE_INPUT_OUTPUT, ENTITY_BUFFER_FIXED    },
+    { PIPE_3AC,       ENTITY_TYPE_OUTPUT_ONLY,  ENTITY_BUFFER_FIXED    },
+    { PIPE_SCP,       ENTITY_TYPE_OUTPUT_ONLY,  ENTITY_BUFFER_DELIVERY },
+    { PIPE_GSC,       ENTITY_TYPE_INPUT_OUTPUT, ENTITY_BUFFER_FIXED    },
+    { PIPE_GSC_VIDEO, ENTITY_TYPE_INPUT_OUTPUT, ENTITY_BUFFER_FIXED    },
+};
+
+#define BENCH_NUM_PIPES (sizeof(gPreviewEntities) / sizeof(gPreviewEntities[0]))
+
+/* the frame's m_linkageList, in the same order */
+static List<ExynosCameraFrameEntity *> gLinkageList;
+
+/* the former searchEntityByPipeId() */
+static ExynosCameraFrameEntity *Bench_SearchList(uint32_t pipeId)
+{
+    List<ExynosCameraFrameEntity *>::iterator r;
+    ExynosCameraFrameEntity *curEntity = NULL;
+    int listSize = 0;
+
+    listSize = gLinkageList.size();
+    r = gLinkageList.begin();
+
+    for (int i = 0; i < listSize; i++) {
+        curEntity = *r;
+        while (curEntity != NULL) {
+            if (curEntity->getPipeId() == pipeId)
+                return curEntity;
+            curEntity = curEntity->getNextEntity();
+        }
+        r++;
+    }
+
+    return NULL;
+}
+
+static void Bench_FrameTable(ExynosCameraFrame *frame, ExynosCameraBuffer *buf, ExynosRect *rect)
+{
+    entity_state_t state;
+    entity_buffer_state_t bufState;
+
+    for (size_t i = 0; i < BENCH_NUM_PIPES; i++) {
+        uint32_t pipeId = gPreviewEntities[i].pipeId;
+
+        frame->setDstBuffer(pipeId, *buf);
+        frame->setDstBufferState(pipeId, ENTITY_BUFFER_STATE_REQUESTED);
+        frame->setEntityState(pipeId, ENTITY_STATE_PROCESSING);
+        frame->getDstRect(pipeId, rect);
+        frame->getDstBuffer(pipeId, buf);
+        frame->getDstBufferState(pipeId, &bufState);
+        frame->setEntityState(pipeId, ENTITY_STATE_FRAME_DONE);
+        frame->getEntityState(pipeId, &state);
+    }
+}
+
+static void Bench_FrameList(ExynosCameraBuffer *buf, ExynosRect *rect)
+{
+    for (size_t i = 0; i < BENCH_NUM_PIPES; i++) {
+        uint32_t pipeId = gPreviewEntities[i].pipeId;
+
+        Bench_SearchList(pipeId)->setDstBuf(*buf);
+        Bench_SearchList(pipeId)->setDstBufState(ENTITY_BUFFER_STATE_REQUESTED);
+        Bench_SearchList(pipeId)->setEntityState(ENTITY_STATE_PROCESSING);
+        Bench_SearchList(pipeId)->getDstRect(rect);
+        Bench_SearchList(pipeId)->getDstBuf(buf);
+        Bench_SearchList(pipeId)->getDstBufState();
+        Bench_SearchList(pipeId)->setEntityState(ENTITY_STATE_FRAME_DONE);
+        Bench_SearchList(pipeId)->getEntityState();
+    }
+}
+
+/* ns per frame */
+static double Bench_Run(ExynosCameraFrame *frame, bool table, int numFrames)
+{
+    ExynosCameraBuffer buf;
+    ExynosRect rect;
+    nsecs_t start;
+
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i = 0; i < numFrames; i++) {
+        if (table)
+            Bench_FrameTable(frame, &buf, &rect);
+        else
+            Bench_FrameList(&buf, &rect);
+    }
+
+    return (double)(systemTime(SYSTEM_TIME_MONOTONIC) - start) / numFrames;
+}
+
+int main(int argc, char **argv)
+{
+    ExynosCameraFrame *frame;
+    ExynosCameraFrameEntity *entity;
+    double tableNs, listNs;
+    int numFrames = 200000;
+
+    if (1 < argc)
+        numFrames = atoi(argv[1]);
+    if (numFrames <= 0) {
+        printf("usage: %s [frames]\n", argv[0]);
+        return 1;
+    }
+
+    frame = new ExynosCameraFrame(NULL, 0);
+    for (size_t i = 0; i < BENCH_NUM_PIPES; i++) {
+        entity = new ExynosCameraFrameEntity(gPreviewEntities[i].pipeId,
+                                             gPreviewEntities[i].type,
+                                             gPreviewEntities[i].bufType);
+        frame->addSiblingEntity(NULL, entity);
+        gLinkageList.push_back(entity);
+    }
+
+    /* warm up */
+    Bench_Run(frame, true, numFrames / 10 + 1);
+    Bench_Run(frame, false, numFrames / 10 + 1);
+
+    tableNs = Bench_Run(frame, true, numFrames);
+    listNs = Bench_Run(frame, false, numFrames);
+
+    printf("%zu preview entities, %d accessor calls per frame, %d frames:\n",
+           BENCH_NUM_PIPES, (int)(BENCH_NUM_PIPES * BENCH_CALLS_PER_PIPE), numFrames);
+    printf("  list walk : %8.1f ns/frame\n", listNs);
+    printf("  table     : %8.1f ns/frame\n", tableNs);
+
+    delete frame;
+
+    return 0;
+}
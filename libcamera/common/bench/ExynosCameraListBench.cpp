@@ -0,0 +1,189 @@
+/*
+ * Copyright 2012, Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      ExynosCameraListBench.cpp
+ * \brief     push/pop latency and throughput of the ExynosCameraList backends
+ *
+ * Each entry carries its push time, the consumer measures push to pop
+ * latency with waitAndPopProcessQ() as m_mainThreadFunc does. The
+ * producers keep at most BENCH_IN_FLIGHT entries queued, like a pipe
+ * bounded by its buffer count.
+ */
+
+#define LOG_TAG "ExynosCameraListBench"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "ExynosCameraList.h"
+
+#define BENCH_RING_SIZE     (64)
+#define BENCH_IN_FLIGHT     (32)
+#define BENCH_MAX_PRODUCERS (4)
+
+typedef ExynosCameraList<nsecs_t> bench_queue_t;
+
+struct BenchContext {
+    bench_queue_t  *queue;
+    int             numItems;
+    int32_t         inFlight;
+};
+
+struct BenchResult {
+    double          itemsPerSec;
+    double          avgLatencyUs;
+    double          maxLatencyUs;
+    double          cpuPerItemNs;
+};
+
+static double Bench_Cpu(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static void *Bench_Producer(void *data)
+{
+    BenchContext *ctx = (BenchContext *)data;
+    nsecs_t stamp;
+
+    for (int i = 0; i < ctx->numItems; i++) {
+        while (BENCH_IN_FLIGHT <= __atomic_load_n(&ctx->inFlight, __ATOMIC_ACQUIRE))
+            sched_yield();
+        __atomic_add_fetch(&ctx->inFlight, 1, __ATOMIC_ACQ_REL);
+
+        stamp = systemTime(SYSTEM_TIME_MONOTONIC);
+        ctx->queue->pushProcessQ(&stamp);
+    }
+
+    return NULL;
+}
+
+static status_t Bench_Run(enum LIST_MODE mode, int numProducers, int numItems, BenchResult *result)
+{
+    bench_queue_t queue;
+    BenchContext ctx;
+    pthread_t producers[BENCH_MAX_PRODUCERS];
+    nsecs_t stamp;
+    nsecs_t latency;
+    nsecs_t totalLatency = 0;
+    nsecs_t maxLatency = 0;
+    nsecs_t start;
+    double cpuStart;
+    int total = numProducers * numItems;
+    status_t ret;
+
+    if (queue.setMode(mode, BENCH_RING_SIZE) != NO_ERROR)
+        return INVALID_OPERATION;
+
+    ctx.queue = &queue;
+    ctx.numItems = numItems;
+    ctx.inFlight = 0;
+
+    cpuStart = Bench_Cpu();
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    for (int i = 0; i < numProducers; i++)
+        pthread_create(&producers[i], NULL, Bench_Producer, &ctx);
+
+    for (int i = 0; i < total; i++) {
+        ret = queue.waitAndPopProcessQ(&stamp);
+        if (ret != NO_ERROR) {
+            ALOGE("ERR(%s[%d]):waitAndPopProcessQ fail, ret(%d)", __FUNCTION__, __LINE__, ret);
+            break;
+        }
+        latency = systemTime(SYSTEM_TIME_MONOTONIC) - stamp;
+        totalLatency += latency;
+        if (maxLatency < latency)
+            maxLatency = latency;
+        __atomic_sub_fetch(&ctx.inFlight, 1, __ATOMIC_ACQ_REL);
+    }
+
+    for (int i = 0; i < numProducers; i++)
+        pthread_join(producers[i], NULL);
+
+    result->itemsPerSec = total / ((systemTime(SYSTEM_TIME_MONOTONIC) - start) / 1e9);
+    result->avgLatencyUs = totalLatency / 1e3 / total;
+    result->maxLatencyUs = maxLatency / 1e3;
+    result->cpuPerItemNs = (Bench_Cpu() - cpuStart) * 1e9 / total;
+
+    return NO_ERROR;
+}
+
+/* uncontended cost of one push plus one pop on the same thread */
+static double Bench_PushPop(enum LIST_MODE mode, int numItems)
+{
+    bench_queue_t queue;
+    nsecs_t value = 0;
+    nsecs_t start;
+
+    queue.setMode(mode, BENCH_RING_SIZE);
+
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i = 0; i < numItems; i++) {
+        queue.pushProcessQ(&value);
+        queue.popProcessQ(&value);
+    }
+
+    return (double)(systemTime(SYSTEM_TIME_MONOTONIC) - start) / numItems;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char     *name;
+        enum LIST_MODE  mode;
+        int             numProducers;
+    } cases[] = {
+        { "List, 1 producer      ", LIST_MODE_LIST,      1 },
+        { "RING_SPSC, 1 producer ", LIST_MODE_RING_SPSC, 1 },
+        { "List, 3 producers     ", LIST_MODE_LIST,      3 },
+        { "RING_MPSC, 3 producers", LIST_MODE_RING_MPSC, 3 },
+    };
+    BenchResult result;
+    int numItems = 200000;
+
+    if (1 < argc)
+        numItems = atoi(argv[1]);
+    if (numItems <= 0) {
+        printf("usage: %s [items per producer]\n", argv[0]);
+        return 1;
+    }
+
+    printf("push+pop on one thread:\n");
+    printf("  List      : %6.1f ns\n", Bench_PushPop(LIST_MODE_LIST, numItems));
+    printf("  RING_SPSC : %6.1f ns\n", Bench_PushPop(LIST_MODE_RING_SPSC, numItems));
+    printf("  RING_MPSC : %6.1f ns\n", Bench_PushPop(LIST_MODE_RING_MPSC, numItems));
+
+    printf("producers -> waitAndPopProcessQ, %d items each, %d in flight:\n", numItems, BENCH_IN_FLIGHT);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (Bench_Run(cases[i].mode, cases[i].numProducers, numItems, &result) != NO_ERROR) {
+            printf("  %s : failed\n", cases[i].name);
+            return 1;
+        }
+        printf("  %s : %9.0f items/s, latency avg %7.1f us max %8.1f us, %6.0f ns CPU/item\n",
+                cases[i].name, result.itemsPerSec, result.avgLatencyUs,
+                result.maxLatencyUs, result.cpuPerItemNs);
+    }
+
+    return 0;
+}
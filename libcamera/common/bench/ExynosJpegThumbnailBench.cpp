@@ -0,0 +1,241 @@
+/*
+ * Copyright 2013, Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      ExynosJpegThumbnailBench.cpp
+ * \brief     shot-to-shot latency of a JPEG burst with an EXIF thumbnail
+ *
+ * Each shot runs the ExynosJpegEncoderForCamera calls of
+ * ExynosCameraPipeJpeg::m_run(), create() to destroy(), on a 13MP YUYV
+ * picture with a 512x384 thumbnail, on the jpeg device.
+ *
+ *   kept encoder     : one encoder for the burst, as the pipe holds it; the
+ *                      thumbnail encoder and buffers carry over
+ *   new size per shot: the thumbnail size alternates, so its buffers are
+ *                      reallocated every shot
+ *   new encoder      : a new encoder per shot, so every shot opens the
+ *                      thumbnail device and allocates its buffers, which is
+ *                      what each shot paid before they were kept
+ *
+ * usage: exynos_jpeg_thumbnail_bench [shots]
+ */
+
+#define LOG_TAG "ExynosJpegThumbnailBench"
+#include <cutils/log.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/Timers.h>
+#include <videodev2.h>
+
+#include "ExynosJpegEncoderForCamera.h"
+
+#define BENCH_PICTURE_W     (4128)
+#define BENCH_PICTURE_H     (3096)
+#define BENCH_THUMB_W       (512)
+#define BENCH_THUMB_H       (384)
+#define BENCH_THUMB_ALT_W   (320)
+#define BENCH_THUMB_ALT_H   (240)
+#define BENCH_QUALITY       (96)
+#define BENCH_THUMB_QUALITY (90)
+#define BENCH_DEFAULT_SHOTS (20)
+
+struct BenchBuffers {
+    ion_client  client;
+    int         inFd[MAX_IMAGE_PLANE_NUM];
+    int         inSize[MAX_IMAGE_PLANE_NUM];
+    int         outFd;
+    int         outSize;
+};
+
+struct BenchResult {
+    double      firstMs;
+    double      avgMs;
+    double      maxMs;
+};
+
+static int Bench_Shot(ExynosJpegEncoderForCamera *enc, BenchBuffers *buffers, int thumbW, int thumbH)
+{
+    exif_attribute_t exifInfo;
+    int jpegSize[MAX_IMAGE_PLANE_NUM] = {0, };
+    int ret = ExynosJpegEncoderForCamera::ERROR_FAIL;
+
+    memset(&exifInfo, 0, sizeof(exifInfo));
+    exifInfo.enableThumb = true;
+    exifInfo.width = BENCH_PICTURE_W;
+    exifInfo.height = BENCH_PICTURE_H;
+    exifInfo.widthThumb = thumbW;
+    exifInfo.heightThumb = thumbH;
+
+    if (enc->create())
+        goto EXIT;
+    if (enc->setQuality(BENCH_QUALITY) ||
+        enc->setSize(BENCH_PICTURE_W, BENCH_PICTURE_H) ||
+        enc->setColorFormat(V4L2_PIX_FMT_YUYV) ||
+        enc->setJpegFormat(V4L2_PIX_FMT_JPEG_422) ||
+        enc->setThumbnailSize(thumbW, thumbH) ||
+        enc->setThumbnailQuality(BENCH_THUMB_QUALITY))
+        goto EXIT;
+    if (enc->setInBuf(buffers->inFd, buffers->inSize) ||
+        enc->setOutBuf(buffers->outFd, buffers->outSize))
+        goto EXIT;
+    if (enc->updateConfig())
+        goto EXIT;
+
+    ret = enc->encode(jpegSize, &exifInfo);
+
+EXIT:
+    if (enc->flagCreate() == true)
+        enc->destroy();
+
+    return ret;
+}
+
+static int Bench_Burst(BenchBuffers *buffers, int shots, bool alternateSize, bool newEncoder,
+                       BenchResult *result)
+{
+    ExynosJpegEncoderForCamera *enc = NULL;
+    nsecs_t start;
+    double ms, total = 0;
+    int thumbW, thumbH;
+    int ret = 0;
+
+    result->firstMs = 0;
+    result->maxMs = 0;
+
+    for (int i = 0; i < shots; i++) {
+        thumbW = (alternateSize && (i & 1)) ? BENCH_THUMB_ALT_W : BENCH_THUMB_W;
+        thumbH = (alternateSize && (i & 1)) ? BENCH_THUMB_ALT_H : BENCH_THUMB_H;
+
+        start = systemTime(SYSTEM_TIME_MONOTONIC);
+        if (enc == NULL)
+            enc = new ExynosJpegEncoderForCamera();
+        ret = Bench_Shot(enc, buffers, thumbW, thumbH);
+        if (newEncoder == true) {
+            delete enc;
+            enc = NULL;
+        }
+        ms = (systemTime(SYSTEM_TIME_MONOTONIC) - start) / 1e6;
+
+        if (ret != ExynosJpegEncoderForCamera::ERROR_NONE) {
+            ALOGE("ERR(%s[%d]):shot %d fail, ret(%d)", __FUNCTION__, __LINE__, i, ret);
+            break;
+        }
+
+        if (i == 0) {
+            result->firstMs = ms;
+            continue;
+        }
+        total += ms;
+        if (result->maxMs < ms)
+            result->maxMs = ms;
+    }
+
+    delete enc;
+
+    result->avgMs = (1 < shots) ? total / (shots - 1) : 0;
+
+    return ret;
+}
+
+static int Bench_AllocBuffers(BenchBuffers *buffers)
+{
+    char *addr;
+
+    memset(buffers, 0, sizeof(*buffers));
+    for (int i = 0; i < MAX_IMAGE_PLANE_NUM; i++)
+        buffers->inFd[i] = -1;
+    buffers->outFd = -1;
+
+    buffers->client = ion_client_create();
+    if (buffers->client < 0)
+        return -1;
+
+    /* YUYV, one plane */
+    buffers->inSize[0] = BENCH_PICTURE_W * BENCH_PICTURE_H * 2;
+    buffers->inFd[0] = ion_alloc(buffers->client, buffers->inSize[0], 0, ION_HEAP_SYSTEM_MASK, 0);
+    buffers->outSize = BENCH_PICTURE_W * BENCH_PICTURE_H * 2;
+    buffers->outFd = ion_alloc(buffers->client, buffers->outSize, 0, ION_HEAP_SYSTEM_MASK, 0);
+    if (buffers->inFd[0] <= 0 || buffers->outFd <= 0)
+        return -1;
+
+    /* a gradient, so the encoder has detail to code */
+    addr = (char *)ion_map(buffers->inFd[0], buffers->inSize[0], 0);
+    if (addr == (char *)MAP_FAILED || addr == NULL)
+        return -1;
+    for (int i = 0; i < buffers->inSize[0]; i++)
+        addr[i] = (char)((i & 1) ? 128 + (i >> 12) : (i >> 3));
+    ion_unmap(addr, buffers->inSize[0]);
+
+    return 0;
+}
+
+static void Bench_FreeBuffers(BenchBuffers *buffers)
+{
+    if (0 < buffers->inFd[0])
+        ion_free(buffers->inFd[0]);
+    if (0 < buffers->outFd)
+        ion_free(buffers->outFd);
+    if (0 <= buffers->client)
+        ion_client_destroy(buffers->client);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        bool        alternateSize;
+        bool        newEncoder;
+    } cases[] = {
+        { "kept encoder     ", false, false },
+        { "new size per shot", true,  false },
+        { "new encoder      ", false, true  },
+    };
+    BenchBuffers buffers;
+    BenchResult result;
+    int shots = BENCH_DEFAULT_SHOTS;
+    int ret = 0;
+
+    if (1 < argc)
+        shots = atoi(argv[1]);
+    if (shots <= 1) {
+        printf("usage: %s [shots, 2 or more]\n", argv[0]);
+        return 1;
+    }
+
+    if (Bench_AllocBuffers(&buffers) != 0) {
+        printf("ion allocation failed\n");
+        Bench_FreeBuffers(&buffers);
+        return 1;
+    }
+
+    printf("%dx%d YUYV, %dx%d thumbnail, %d shots, ms per shot:\n",
+           BENCH_PICTURE_W, BENCH_PICTURE_H, BENCH_THUMB_W, BENCH_THUMB_H, shots);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (Bench_Burst(&buffers, shots, cases[i].alternateSize, cases[i].newEncoder, &result) != 0) {
+            printf("  %s : failed\n", cases[i].name);
+            ret = 1;
+            break;
+        }
+        printf("  %s : first %7.2f, then avg %7.2f max %7.2f\n",
+               cases[i].name, result.firstMs, result.avgMs, result.maxMs);
+    }
+
+    Bench_FreeBuffers(&buffers);
+
+    return ret;
+}
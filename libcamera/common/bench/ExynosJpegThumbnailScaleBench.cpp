@@ -0,0 +1,263 @@
+/*
+ * Copyright 2013, Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      ExynosJpegThumbnailScaleBench.cpp
+ * \brief     quality and speed of the thumbnail downscalers
+ *
+ * scaleDownYuv422() (YUYV) and scaleDownYuv422_2p() (NV16) scale a 13MP
+ * picture to the EXIF thumbnail. The picture is a zone plate on a
+ * gradient, so aliasing shows. Every component of the output is compared
+ * with an exact fractional area average of the source, in floating point,
+ * and the PSNR printed; the time is per call. A PSNR under
+ * BENCH_MIN_PSNR fails the run.
+ *
+ * usage: exynos_jpeg_thumbnail_scale_bench [iterations]
+ */
+
+#define LOG_TAG "ExynosJpegThumbnailScaleBench"
+#include <cutils/log.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/Timers.h>
+
+#include "ExynosJpegEncoderForCamera.h"
+
+#define BENCH_DEFAULT_ITER  (10)
+#define BENCH_MIN_PSNR      (40.0)
+
+/* one component of a picture: samples srcStep bytes apart from srcOffset in each row */
+struct BenchComponent {
+    const char     *name;
+    int             plane;
+    unsigned int    offset;
+    unsigned int    step;
+    unsigned int    widthDiv;
+};
+
+static const BenchComponent gYuyvComps[] = {
+    { "Y",  0, 0, 2, 1 },
+    { "Cb", 0, 1, 4, 2 },
+    { "Cr", 0, 3, 4, 2 },
+};
+
+static const BenchComponent gNv16Comps[] = {
+    { "Y",  0, 0, 1, 1 },
+    { "Cb", 1, 0, 2, 2 },
+    { "Cr", 1, 1, 2, 2 },
+};
+
+/* YUYV rows are two bytes a pixel, NV16 planes one */
+static unsigned int Bench_Stride(unsigned int w, const BenchComponent *comp)
+{
+    return (comp->plane == 0 && comp->step != 1) ? w * 2 : w;
+}
+
+static unsigned char Bench_Pattern(unsigned int x, unsigned int y, unsigned int w, unsigned int h, int comp)
+{
+    double dx = (double)x - w / 2;
+    double dy = (double)y - h / 2;
+    double v;
+
+    /* zone plate over a gradient, the chroma ones rotated */
+    switch (comp) {
+    case 0:
+        v = 128 + 40 * sin((dx * dx + dy * dy) * (M_PI / w)) + 60 * ((double)x / w - 0.5);
+        break;
+    case 1:
+        v = 128 + 50 * sin(dx * dy * (M_PI / w));
+        break;
+    default:
+        v = 128 + 50 * cos((dx * dx - dy * dy) * (M_PI / h));
+        break;
+    }
+
+    return (unsigned char)(v + 0.5);
+}
+
+static void Bench_Fill(char **buf, unsigned int w, unsigned int h, const BenchComponent *comps)
+{
+    for (int c = 0; c < 3; c++) {
+        unsigned int cw = w / comps[c].widthDiv;
+        unsigned int stride = Bench_Stride(w, &comps[c]);
+
+        for (unsigned int y = 0; y < h; y++) {
+            unsigned char *p = (unsigned char *)buf[comps[c].plane] + (y * stride) + comps[c].offset;
+
+            for (unsigned int x = 0; x < cw; x++) {
+                *p = Bench_Pattern(x * comps[c].widthDiv, y, w, h, c);
+                p += comps[c].step;
+            }
+        }
+    }
+}
+
+/* weight of source sample s in destination sample d, for srcLen samples folded into dstLen */
+static double Bench_Overlap(unsigned int d, unsigned int s, unsigned int srcLen, unsigned int dstLen)
+{
+    double scale = (double)srcLen / dstLen;
+    double start = d * scale;
+    double end = start + scale;
+    double lo = (s > start) ? s : start;
+    double hi = (s + 1 < end) ? s + 1 : end;
+
+    return (hi > lo) ? (hi - lo) / scale : 0;
+}
+
+/* exact area average of one component, compared with the scaler output */
+static double Bench_Psnr(char **src, unsigned int srcW, unsigned int srcH,
+                         char **dst, unsigned int dstW, unsigned int dstH,
+                         const BenchComponent *comp)
+{
+    unsigned int srcCW = srcW / comp->widthDiv;
+    unsigned int dstCW = dstW / comp->widthDiv;
+    unsigned int srcStride = Bench_Stride(srcW, comp);
+    unsigned int dstStride = Bench_Stride(dstW, comp);
+    double *rows = new double[(size_t)dstCW * srcH];
+    double scaleX = (double)srcCW / dstCW;
+    double scaleY = (double)srcH / dstH;
+    double err = 0;
+
+    /* horizontal pass into dstCW x srcH */
+    for (unsigned int y = 0; y < srcH; y++) {
+        const unsigned char *s = (const unsigned char *)src[comp->plane] + (y * srcStride) + comp->offset;
+
+        for (unsigned int x = 0; x < dstCW; x++) {
+            unsigned int first = (unsigned int)(x * scaleX);
+            unsigned int last = (unsigned int)ceil((x + 1) * scaleX);
+            double sum = 0;
+
+            if (last > srcCW)
+                last = srcCW;
+            for (unsigned int i = first; i < last; i++)
+                sum += s[i * comp->step] * Bench_Overlap(x, i, srcCW, dstCW);
+            rows[(size_t)y * dstCW + x] = sum;
+        }
+    }
+
+    /* vertical pass, against the output */
+    for (unsigned int y = 0; y < dstH; y++) {
+        const unsigned char *d = (const unsigned char *)dst[comp->plane] + (y * dstStride) + comp->offset;
+        unsigned int first = (unsigned int)(y * scaleY);
+        unsigned int last = (unsigned int)ceil((y + 1) * scaleY);
+
+        if (last > srcH)
+            last = srcH;
+        for (unsigned int x = 0; x < dstCW; x++) {
+            double ref = 0;
+            double diff;
+
+            for (unsigned int i = first; i < last; i++)
+                ref += rows[(size_t)i * dstCW + x] * Bench_Overlap(y, i, srcH, dstH);
+            diff = d[x * comp->step] - ref;
+            err += diff * diff;
+        }
+    }
+
+    delete [] rows;
+
+    err /= (double)dstCW * dstH;
+    if (err == 0)
+        return 99.99;
+
+    return 10 * log10(255.0 * 255.0 / err);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char     *name;
+        bool            twoPlane;
+        unsigned int    srcW, srcH;
+        unsigned int    dstW, dstH;
+    } cases[] = {
+        { "YUYV 4128x3096 -> 512x384", false, 4128, 3096, 512, 384 },
+        { "YUYV 4208x3120 -> 512x384", false, 4208, 3120, 512, 384 },
+        { "YUYV 4128x2322 -> 512x288", false, 4128, 2322, 512, 288 },
+        { "NV16 4128x3096 -> 512x384", true,  4128, 3096, 512, 384 },
+        { "NV16 4208x3120 -> 320x240", true,  4208, 3120, 320, 240 },
+    };
+    ExynosJpegEncoderForCamera *enc = new ExynosJpegEncoderForCamera();
+    int iterations = BENCH_DEFAULT_ITER;
+    int ret = 0;
+
+    if (1 < argc)
+        iterations = atoi(argv[1]);
+    if (iterations <= 0) {
+        printf("usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    printf("box downscaler, ms per call over %d iterations, PSNR against the exact area average:\n",
+           iterations);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const BenchComponent *comps = cases[i].twoPlane ? gNv16Comps : gYuyvComps;
+        size_t srcSize = (size_t)cases[i].srcW * cases[i].srcH * 2;
+        size_t dstSize = (size_t)cases[i].dstW * cases[i].dstH * 2;
+        char *src[MAX_IMAGE_PLANE_NUM] = {NULL, };
+        char *dst[MAX_IMAGE_PLANE_NUM] = {NULL, };
+        double psnr[3];
+        nsecs_t start;
+        double ms;
+        int err = ExynosJpegEncoderForCamera::ERROR_NONE;
+
+        /* NV16 uses the first half for Y and the second for CbCr */
+        src[0] = new char[srcSize];
+        dst[0] = new char[dstSize];
+        src[1] = src[0] + (srcSize / 2);
+        dst[1] = dst[0] + (dstSize / 2);
+        Bench_Fill(src, cases[i].srcW, cases[i].srcH, comps);
+
+        start = systemTime(SYSTEM_TIME_MONOTONIC);
+        for (int n = 0; n < iterations && err == ExynosJpegEncoderForCamera::ERROR_NONE; n++) {
+            if (cases[i].twoPlane)
+                err = enc->scaleDownYuv422_2p(src, cases[i].srcW, cases[i].srcH,
+                                              dst, cases[i].dstW, cases[i].dstH);
+            else
+                err = enc->scaleDownYuv422(src, cases[i].srcW, cases[i].srcH,
+                                           dst, cases[i].dstW, cases[i].dstH);
+        }
+        ms = (systemTime(SYSTEM_TIME_MONOTONIC) - start) / 1e6 / iterations;
+
+        if (err != ExynosJpegEncoderForCamera::ERROR_NONE) {
+            printf("  %s : failed, ret(%d)\n", cases[i].name, err);
+            ret = 1;
+        } else {
+            for (int c = 0; c < 3; c++) {
+                psnr[c] = Bench_Psnr(src, cases[i].srcW, cases[i].srcH,
+                                     dst, cases[i].dstW, cases[i].dstH, &comps[c]);
+                if (psnr[c] < BENCH_MIN_PSNR)
+                    ret = 1;
+            }
+            printf("  %s : %7.2f ms, PSNR %s %5.2f %s %5.2f %s %5.2f dB\n",
+                   cases[i].name, ms, comps[0].name, psnr[0], comps[1].name, psnr[1],
+                   comps[2].name, psnr[2]);
+        }
+
+        delete [] src[0];
+        delete [] dst[0];
+    }
+
+    delete enc;
+
+    printf("%s\n", (ret == 0) ? "PASS" : "FAIL");
+
+    return ret;
+}
@@ -5,7 +5,8 @@ include $(CLEAR_VARS)
 LOCAL_MODULE_TAGS := optional
 
 LOCAL_SRC_FILES := \
-	csc.c
+	csc.c \
+	csc_kernels.c
 
 LOCAL_C_INCLUDES := \
 	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
@@ -46,3 +47,53 @@ LOCAL_CFLAGS += -DUSE_ION
 LOCAL_SHARED_LIBRARIES += libion_exynos
 
 include $(BUILD_SHARED_LIBRARY)
+
+# Every software kernel set against libswconverter, bit for bit, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	test/csc_kernels_test.c
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)
+
+LOCAL_STATIC_LIBRARIES := libswconverter
+LOCAL_SHARED_LIBRARIES := liblog libcsc
+
+LOCAL_MODULE := exynos_csc_kernels_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+# Per-format time of each software kernel set, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	bench/csc_kernels_bench.c
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)
+
+LOCAL_STATIC_LIBRARIES := libswconverter
+LOCAL_SHARED_LIBRARIES := liblog libcsc
+
+LOCAL_MODULE := exynos_csc_kernels_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+# CSC_METHOD_SW throughput against csc_set_sw_threads(), with the threaded output checked, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	bench/csc_sw_threads_bench.c
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/../include
+
+LOCAL_SHARED_LIBRARIES := liblog libcsc
+
+LOCAL_MODULE := exynos_csc_sw_threads_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
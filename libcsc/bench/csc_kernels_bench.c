@@ -0,0 +1,186 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        csc_kernels_bench.c
+ *
+ * @brief       per-format time of each libcsc software kernel set
+ *
+ * Every conversion runs on a 1080p frame with the C set, each vectorized
+ * set the cpu can run and the libswconverter functions themselves,
+ * and prints the thread CPU time per frame. exynos_csc_kernels_test
+ * checks the results match.
+ *
+ * usage: exynos_csc_kernels_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "csc_kernels.h"
+#include "swconverter.h"
+
+#define BENCH_WIDTH         (1920)
+#define BENCH_HEIGHT        (1080)
+#define BENCH_DEFAULT_ITER  (100)
+
+enum {
+    BENCH_TILED_Y,
+    BENCH_TILED_UV,
+    BENCH_TILED_UV_DEINTERLEAVE,
+    BENCH_INTERLEAVE,
+    BENCH_DEINTERLEAVE,
+    BENCH_ARGB_YUV420SP,
+    BENCH_ARGB_YUV420P,
+    BENCH_OP_MAX,
+};
+
+static const char *gOpNames[BENCH_OP_MAX] = {
+    "NV12T Y -> linear   ",
+    "NV12T UV -> linear  ",
+    "NV12T UV -> U, V    ",
+    "U, V -> UV          ",
+    "UV -> U, V          ",
+    "ARGB8888 -> YUV420SP",
+    "ARGB8888 -> YUV420P ",
+};
+
+/* libswconverter itself, as the set it is */
+static const CSC_SW_KERNELS gSwconverter = {
+    "swconverter",
+    csc_tiled_to_linear_y,
+    csc_tiled_to_linear_uv,
+    csc_tiled_to_linear_uv_deinterleave,
+    csc_interleave_memcpy,
+    csc_deinterleave_memcpy,
+    csc_ARGB8888_to_YUV420SP,
+    csc_ARGB8888_to_YUV420P,
+};
+
+static unsigned char *gSrc;
+static unsigned char *gDst[3];
+
+static double Bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void Bench_Op(const CSC_SW_KERNELS *kernels, int op)
+{
+    unsigned int w = BENCH_WIDTH;
+    unsigned int h = BENCH_HEIGHT;
+
+    switch (op) {
+    case BENCH_TILED_Y:
+        kernels->tiled_to_linear_y(gDst[0], gSrc, w, h);
+        break;
+    case BENCH_TILED_UV:
+        kernels->tiled_to_linear_uv(gDst[0], gSrc, w, h / 2);
+        break;
+    case BENCH_TILED_UV_DEINTERLEAVE:
+        kernels->tiled_to_linear_uv_deinterleave(gDst[0], gDst[1], gSrc, w, h / 2);
+        break;
+    case BENCH_INTERLEAVE:
+        kernels->interleave_memcpy(gDst[0], gSrc, gSrc + (w * h / 4), w * h / 4);
+        break;
+    case BENCH_DEINTERLEAVE:
+        kernels->deinterleave_memcpy(gDst[0], gDst[1], gSrc, w * h / 2);
+        break;
+    case BENCH_ARGB_YUV420SP:
+        kernels->argb8888_to_yuv420sp(gDst[0], gDst[1], gSrc, w, h);
+        break;
+    case BENCH_ARGB_YUV420P:
+        kernels->argb8888_to_yuv420p(gDst[0], gDst[1], gDst[2], gSrc, w, h);
+        break;
+    }
+}
+
+/* us per frame */
+static double Bench_Run(const CSC_SW_KERNELS *kernels, int op, int iterations)
+{
+    double start;
+    int i;
+
+    /* warm the caches and the TLB */
+    Bench_Op(kernels, op);
+
+    start = Bench_Now();
+    for (i = 0; i < iterations; i++)
+        Bench_Op(kernels, op);
+
+    return (Bench_Now() - start) / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    const CSC_SW_KERNELS *sets[8];
+    const CSC_SW_KERNELS *kernels;
+    size_t size = (size_t)BENCH_WIDTH * BENCH_HEIGHT * 4;
+    unsigned int count = 0;
+    unsigned int index;
+    int iterations = BENCH_DEFAULT_ITER;
+    int op;
+    size_t i;
+
+    if (1 < argc)
+        iterations = atoi(argv[1]);
+    if (iterations <= 0) {
+        printf("usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    gSrc = (unsigned char *)malloc(size);
+    for (i = 0; i < 3; i++)
+        gDst[i] = (unsigned char *)malloc(size);
+    if (gSrc == NULL || gDst[0] == NULL || gDst[1] == NULL || gDst[2] == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+    for (i = 0; i < size; i++)
+        gSrc[i] = (unsigned char)(i * 7 + (i >> 9));
+
+    sets[count++] = &gSwconverter;
+    sets[count++] = csc_get_sw_kernels_c();
+    for (index = 0; (kernels = csc_get_sw_kernels_isa(index)) != NULL && count < 8; index++)
+        sets[count++] = kernels;
+
+    printf("us per %ux%u frame, thread CPU time, %d iterations, selected: %s\n",
+           BENCH_WIDTH, BENCH_HEIGHT, iterations, csc_get_sw_kernels()->name);
+
+    printf("  %s", "                    ");
+    for (index = 0; index < count; index++)
+        printf(" %16s", sets[index]->name);
+    printf("\n");
+
+    for (op = 0; op < BENCH_OP_MAX; op++) {
+        printf("  %s", gOpNames[op]);
+        for (index = 0; index < count; index++)
+            printf(" %16.1f", Bench_Run(sets[index], op, iterations));
+        printf("\n");
+    }
+
+    free(gSrc);
+    for (i = 0; i < 3; i++)
+        free(gDst[i]);
+
+    return 0;
+}
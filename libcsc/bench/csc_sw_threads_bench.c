@@ -0,0 +1,183 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        csc_sw_threads_bench.c
+ *
+ * @brief       CSC_METHOD_SW throughput against csc_set_sw_threads()
+ *
+ * Every conversion conv_sw() handles runs on a 3840x2160 frame through
+ * the public csc API, once single-threaded and then with 2, 4, ... band
+ * threads up to the given count. Each threaded output is compared with
+ * the single-threaded one, a mismatch fails the run.
+ *
+ * usage: exynos_csc_sw_threads_bench [iterations] [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <system/graphics.h>
+
+#include "csc.h"
+#include "exynos_format.h"
+
+#define BENCH_WIDTH         (3840)
+#define BENCH_HEIGHT        (2160)
+#define BENCH_PLANE_SIZE    (BENCH_WIDTH * (BENCH_HEIGHT + 64) * 4)
+#define BENCH_DEFAULT_ITER  (20)
+#define BENCH_DEFAULT_THR   (4)
+
+static unsigned char *gSrc[CSC_MAX_PLANES];
+static unsigned char *gRef[CSC_MAX_PLANES];
+static unsigned char *gDst[CSC_MAX_PLANES];
+
+static double Bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* ms per frame, negative on failure */
+static double Bench_Run(unsigned int srcFormat, unsigned int dstFormat,
+                        unsigned int threads, int iterations, unsigned char **dst)
+{
+    void *handle = NULL;
+    double start, ret = -1;
+    int i;
+
+    for (i = 0; i < CSC_MAX_PLANES; i++)
+        memset(dst[i], 0, BENCH_PLANE_SIZE);
+
+    handle = csc_init(CSC_METHOD_SW);
+    if (handle == NULL)
+        goto EXIT;
+
+    if (threads > 1 && csc_set_sw_threads(handle, threads) != CSC_ErrorNone)
+        goto EXIT;
+
+    csc_set_src_format(handle, BENCH_WIDTH, BENCH_HEIGHT, 0, 0, BENCH_WIDTH, BENCH_HEIGHT, srcFormat, 0);
+    csc_set_dst_format(handle, BENCH_WIDTH, BENCH_HEIGHT, 0, 0, BENCH_WIDTH, BENCH_HEIGHT, dstFormat, 0);
+    csc_set_src_buffer(handle, (void **)gSrc, CSC_MEMORY_USERPTR);
+    csc_set_dst_buffer(handle, (void **)dst, CSC_MEMORY_USERPTR);
+
+    /* warm the caches, start the workers */
+    if (csc_convert(handle) != CSC_ErrorNone)
+        goto EXIT;
+
+    start = Bench_Now();
+    for (i = 0; i < iterations; i++)
+        csc_convert(handle);
+    ret = (Bench_Now() - start) / iterations;
+
+EXIT:
+    if (handle != NULL)
+        csc_deinit(handle);
+
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char     *name;
+        unsigned int    srcFormat;
+        unsigned int    dstFormat;
+    } cases[] = {
+        { "NV12T -> NV12 ", HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M_TILED, HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M },
+        { "NV12T -> I420 ", HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M_TILED, HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M  },
+        { "ARGB -> NV12  ", HAL_PIXEL_FORMAT_BGRA_8888,                   HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M },
+        { "ARGB -> YV12  ", HAL_PIXEL_FORMAT_BGRA_8888,                   HAL_PIXEL_FORMAT_YV12                  },
+        { "I420 -> NV12  ", HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M,        HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M },
+        { "NV21 -> YV12  ", HAL_PIXEL_FORMAT_YCrCb_420_SP,                HAL_PIXEL_FORMAT_YV12                  },
+        { "NV12 -> NV12  ", HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M,       HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M },
+    };
+    int iterations = BENCH_DEFAULT_ITER;
+    unsigned int maxThreads = BENCH_DEFAULT_THR;
+    unsigned int threads;
+    double ms, refMs;
+    size_t c, i;
+    int ret = 0;
+
+    if (1 < argc)
+        iterations = atoi(argv[1]);
+    if (2 < argc)
+        maxThreads = (unsigned int)atoi(argv[2]);
+    if (iterations <= 0 || maxThreads < 1 || maxThreads > CSC_SW_THREADS_MAX) {
+        printf("usage: %s [iterations] [threads, 1 to %d]\n", argv[0], CSC_SW_THREADS_MAX);
+        return 1;
+    }
+
+    for (i = 0; i < CSC_MAX_PLANES; i++) {
+        gSrc[i] = (unsigned char *)malloc(BENCH_PLANE_SIZE);
+        gRef[i] = (unsigned char *)malloc(BENCH_PLANE_SIZE);
+        gDst[i] = (unsigned char *)malloc(BENCH_PLANE_SIZE);
+        if (gSrc[i] == NULL || gRef[i] == NULL || gDst[i] == NULL) {
+            printf("out of memory\n");
+            return 1;
+        }
+    }
+    srand(1);
+    for (i = 0; i < BENCH_PLANE_SIZE; i++) {
+        gSrc[0][i] = (unsigned char)rand();
+        gSrc[1][i] = (unsigned char)rand();
+        gSrc[2][i] = (unsigned char)rand();
+    }
+
+    printf("ms per %ux%u frame, %d iterations, speedup against 1 thread\n",
+           BENCH_WIDTH, BENCH_HEIGHT, iterations);
+
+    for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        refMs = Bench_Run(cases[c].srcFormat, cases[c].dstFormat, 1, iterations, gRef);
+        if (refMs < 0) {
+            printf("  %s : failed\n", cases[c].name);
+            return 1;
+        }
+        printf("  %s : 1 thread %7.2f", cases[c].name, refMs);
+
+        for (threads = 2; threads <= maxThreads; threads *= 2) {
+            ms = Bench_Run(cases[c].srcFormat, cases[c].dstFormat, threads, iterations, gDst);
+            if (ms < 0) {
+                printf(", %u threads failed", threads);
+                ret = 1;
+                continue;
+            }
+            printf(", %u threads %7.2f (%.2fx)", threads, ms, refMs / ms);
+
+            for (i = 0; i < CSC_MAX_PLANES; i++) {
+                if (memcmp(gRef[i], gDst[i], BENCH_PLANE_SIZE) != 0) {
+                    printf(" DIFFERS in plane %zu", i);
+                    ret = 1;
+                }
+            }
+        }
+        printf("\n");
+    }
+
+    for (i = 0; i < CSC_MAX_PLANES; i++) {
+        free(gSrc[i]);
+        free(gRef[i]);
+        free(gDst[i]);
+    }
+
+    printf("%s\n", (ret == 0) ? "threaded output matches" : "FAIL");
+
+    return ret;
+}
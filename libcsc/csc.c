@@ -33,12 +33,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <utils/Log.h>
 #include <system/graphics.h>
 
 #include "csc.h"
 #include "exynos_format.h"
+#include "exynos_plane_copy.h"
 #include "swconverter.h"
+#include "csc_kernels.h"
 
 #ifdef ENABLE_FIMC
 #include "exynos_fimc.h"
@@ -59,60 +62,46 @@
 static CSC_ERRORCODE copy_mfc_data(CSC_HANDLE *handle) {
     CSC_ERRORCODE ret = CSC_ErrorNone;
 
-    int i;
-    char *pSrc = NULL;
-    char *pDst = NULL;
+    plane_copy_image_t src;
+    plane_copy_image_t dst;
+    unsigned int crop_width = handle->src_format.crop_width;
+    unsigned int crop_height = handle->src_format.crop_height;
+
+    memset(&src, 0, sizeof(src));
+    memset(&dst, 0, sizeof(dst));
+
+    src.plane[0] = (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE];
+    dst.plane[0] = (unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE];
+    src.stride[0] = handle->src_format.width;
+    dst.stride[0] = crop_width;
 
     switch (handle->src_format.color_format) {
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M:
     case HAL_PIXEL_FORMAT_EXYNOS_YV12_M:
-        pSrc = (char *)handle->src_buffer.planes[CSC_Y_PLANE];
-        pDst = (char *)handle->dst_buffer.planes[CSC_Y_PLANE];
-        for (i = 0; i < (int)handle->src_format.crop_height; i++) {
-            memcpy(pDst + (handle->src_format.crop_width * i),
-                   pSrc + (handle->src_format.width * i),
-                   handle->src_format.crop_width);
-        }
-
-        pSrc = (char *)handle->src_buffer.planes[CSC_U_PLANE];
-        pDst = (char *)handle->dst_buffer.planes[CSC_U_PLANE];
-        for (i = 0; i < (int)(handle->src_format.crop_height >> 1); i++) {
-            memcpy(pDst + ((handle->src_format.crop_width >> 1) * i),
-                   pSrc + (ALIGN((handle->src_format.crop_width >> 1), MFC_IMG_ALIGN_WIDTH) * i),
-                   (handle->src_format.crop_width >> 1));
-        }
-
-        pSrc = (char *)handle->src_buffer.planes[CSC_V_PLANE];
-        pDst = (char *)handle->dst_buffer.planes[CSC_V_PLANE];
-        for (i = 0; i < (int)(handle->src_format.crop_height >> 1); i++) {
-            memcpy(pDst + ((handle->src_format.crop_width >> 1) * i),
-                   pSrc + (ALIGN((handle->src_format.crop_width >> 1), MFC_IMG_ALIGN_WIDTH) * i),
-                   (handle->src_format.crop_width >> 1));
-        }
+        /* chroma planes are kept in place, so both sides use the same order */
+        src.format = dst.format = PLANE_COPY_FMT_I420;
+        src.plane[1] = (unsigned char *)handle->src_buffer.planes[CSC_U_PLANE];
+        src.plane[2] = (unsigned char *)handle->src_buffer.planes[CSC_V_PLANE];
+        dst.plane[1] = (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE];
+        dst.plane[2] = (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE];
+        src.stride[1] = src.stride[2] = ALIGN((crop_width >> 1), MFC_IMG_ALIGN_WIDTH);
+        dst.stride[1] = dst.stride[2] = crop_width >> 1;
         break;
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M:
     case HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M:
-        pSrc = (char *)handle->src_buffer.planes[CSC_Y_PLANE];
-        pDst = (char *)handle->dst_buffer.planes[CSC_Y_PLANE];
-        for (i = 0; i < (int)handle->src_format.crop_height; i++) {
-            memcpy(pDst + (handle->src_format.crop_width * i),
-                   pSrc + (handle->src_format.width * i),
-                   handle->src_format.crop_width);
-        }
-
-        pSrc = (char *)handle->src_buffer.planes[CSC_UV_PLANE];
-        pDst = (char *)handle->dst_buffer.planes[CSC_UV_PLANE];
-        for (i = 0; i < (int)(handle->src_format.crop_height >> 1); i++) {
-            memcpy(pDst + (handle->src_format.crop_width * i),
-                   pSrc + (handle->src_format.width * i),
-                   handle->src_format.crop_width);
-        }
+        src.format = dst.format = PLANE_COPY_FMT_NV12;
+        src.plane[1] = (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE];
+        dst.plane[1] = (unsigned char *)handle->dst_buffer.planes[CSC_UV_PLANE];
+        src.stride[1] = handle->src_format.width;
+        dst.stride[1] = crop_width;
         break;
     default:
-        ret = CSC_ErrorUnsupportFormat;
-        break;
+        return CSC_ErrorUnsupportFormat;
     }
 
+    if (exynos_plane_copy(&src, &dst, 0, 0, crop_width, crop_height) < 0)
+        ret = CSC_Error;
+
     return ret;
 }
 
@@ -125,7 +114,7 @@ static CSC_ERRORCODE conv_sw_src_argb888(
     switch (handle->dst_format.color_format) {
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P:
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M:
-        csc_ARGB8888_to_YUV420P(
+        csc_get_sw_kernels()->argb8888_to_yuv420p(
             (unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
@@ -136,11 +125,7 @@ static CSC_ERRORCODE conv_sw_src_argb888(
         break;
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP:
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M:
-#ifdef __aarch64__
-        csc_ARGB8888_to_YUV420SP(
-#else
-        csc_ARGB8888_to_YUV420SP_NEON(
-#endif
+        csc_get_sw_kernels()->argb8888_to_yuv420sp(
             (unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_UV_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_RGB_PLANE],
@@ -150,7 +135,7 @@ static CSC_ERRORCODE conv_sw_src_argb888(
         break;
     case HAL_PIXEL_FORMAT_YV12:
     case HAL_PIXEL_FORMAT_EXYNOS_YV12_M:
-        csc_ARGB8888_to_YUV420P(
+        csc_get_sw_kernels()->argb8888_to_yuv420p(
             (unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
@@ -176,20 +161,12 @@ static CSC_ERRORCODE conv_sw_src_nv12t(
     switch (handle->dst_format.color_format) {
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P:
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M:
-#ifdef __aarch64__
-        csc_tiled_to_linear_y(
-#else
-        csc_tiled_to_linear_y_neon(
-#endif
+        csc_get_sw_kernels()->tiled_to_linear_y(
             (unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
             handle->src_format.width,
             handle->src_format.height);
-#ifdef __aarch64__
-        csc_tiled_to_linear_uv_deinterleave(
-#else
-        csc_tiled_to_linear_uv_deinterleave_neon(
-#endif
+        csc_get_sw_kernels()->tiled_to_linear_uv_deinterleave(
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE],
@@ -199,20 +176,12 @@ static CSC_ERRORCODE conv_sw_src_nv12t(
         break;
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP:
     case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M:
-#ifdef __aarch64__
-        csc_tiled_to_linear_y(
-#else
-        csc_tiled_to_linear_y_neon(
-#endif
+        csc_get_sw_kernels()->tiled_to_linear_y(
             (unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
             handle->src_format.width,
             handle->src_format.height);
-#ifdef __aarch64__
-        csc_tiled_to_linear_uv(
-#else
-        csc_tiled_to_linear_uv_neon(
-#endif
+        csc_get_sw_kernels()->tiled_to_linear_uv(
             (unsigned char *)handle->dst_buffer.planes[CSC_UV_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE],
             handle->src_format.width,
@@ -256,11 +225,7 @@ static CSC_ERRORCODE conv_sw_src_yuv420p(
         memcpy((unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
                (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
                handle->src_format.width * handle->src_format.height);
-#ifdef __aarch64__
-        csc_interleave_memcpy(
-#else
-        csc_interleave_memcpy_neon(
-#endif
+        csc_get_sw_kernels()->interleave_memcpy(
             (unsigned char *)handle->dst_buffer.planes[CSC_UV_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_V_PLANE],
@@ -304,11 +269,7 @@ static CSC_ERRORCODE conv_sw_src_yvu420p(
         memcpy((unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
                (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
                handle->src_format.width * handle->src_format.height);
-#ifdef __aarch64__
-        csc_interleave_memcpy(
-#else
-        csc_interleave_memcpy_neon(
-#endif
+        csc_get_sw_kernels()->interleave_memcpy(
             (unsigned char *)handle->dst_buffer.planes[CSC_UV_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_U_PLANE],
@@ -349,7 +310,7 @@ static CSC_ERRORCODE conv_sw_src_yuv420sp(
         memcpy((unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
                (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
                handle->src_format.width * handle->src_format.height);
-        csc_deinterleave_memcpy(
+        csc_get_sw_kernels()->deinterleave_memcpy(
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE],
@@ -361,7 +322,7 @@ static CSC_ERRORCODE conv_sw_src_yuv420sp(
         memcpy((unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
                (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
                handle->src_format.width * handle->src_format.height);
-        csc_deinterleave_memcpy(
+        csc_get_sw_kernels()->deinterleave_memcpy(
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE],
@@ -402,7 +363,7 @@ static CSC_ERRORCODE conv_sw_src_yvu420sp(
         memcpy((unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
                (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
                handle->src_format.width * handle->src_format.height);
-        csc_deinterleave_memcpy(
+        csc_get_sw_kernels()->deinterleave_memcpy(
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE],
@@ -414,7 +375,7 @@ static CSC_ERRORCODE conv_sw_src_yvu420sp(
         memcpy((unsigned char *)handle->dst_buffer.planes[CSC_Y_PLANE],
                (unsigned char *)handle->src_buffer.planes[CSC_Y_PLANE],
                handle->src_format.width * handle->src_format.height);
-        csc_deinterleave_memcpy(
+        csc_get_sw_kernels()->deinterleave_memcpy(
             (unsigned char *)handle->dst_buffer.planes[CSC_U_PLANE],
             (unsigned char *)handle->dst_buffer.planes[CSC_V_PLANE],
             (unsigned char *)handle->src_buffer.planes[CSC_UV_PLANE],
@@ -465,6 +426,260 @@ static CSC_ERRORCODE conv_sw(
     return ret;
 }
 
+/*
+ * Band-parallel software conversion.
+ * Each band is a copy of the handle with the plane addresses moved to the
+ * first row of the band and the height trimmed, so conv_sw() runs the same
+ * kernels on it as on the whole frame.
+ */
+#define CSC_SW_BAND_ALIGN        2
+#define CSC_SW_BAND_ALIGN_TILED  128    /* 64x32 tiles come in pairs, for both Y and CbCr */
+#define CSC_SW_BAND_MIN_HEIGHT   64
+
+typedef struct _CSC_SW_POOL {
+    pthread_t       threads[CSC_SW_THREADS_MAX];
+    unsigned int    num_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t  work_cond;
+    pthread_cond_t  done_cond;
+    CSC_HANDLE      jobs[CSC_SW_THREADS_MAX];
+    CSC_ERRORCODE   job_ret[CSC_SW_THREADS_MAX];
+    unsigned int    num_jobs;
+    unsigned int    next_job;
+    unsigned int    pending;
+    int             exit;
+} CSC_SW_POOL;
+
+static int is_semi_planar_format(unsigned int color_format)
+{
+    switch (color_format) {
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M:
+    case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* move the planes of a linear YUV 4:2:0 buffer down by row lines */
+static void offset_yuv420_buffer(
+    CSC_BUFFER   *buffer,
+    unsigned int  color_format,
+    unsigned int  width,
+    unsigned int  row)
+{
+    buffer->planes[CSC_Y_PLANE] = (char *)buffer->planes[CSC_Y_PLANE] + width * row;
+    if (is_semi_planar_format(color_format)) {
+        buffer->planes[CSC_UV_PLANE] = (char *)buffer->planes[CSC_UV_PLANE] + width * (row >> 1);
+    } else {
+        buffer->planes[CSC_U_PLANE] = (char *)buffer->planes[CSC_U_PLANE] + (width >> 1) * (row >> 1);
+        buffer->planes[CSC_V_PLANE] = (char *)buffer->planes[CSC_V_PLANE] + (width >> 1) * (row >> 1);
+    }
+}
+
+/* returns 0 when the conversion cannot be split into bands */
+static int get_sw_band_align(
+    CSC_HANDLE *handle)
+{
+    if (handle->src_buffer.mem_type == CSC_MEMORY_MFC)
+        return 0;
+
+    switch (handle->src_format.color_format) {
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M_TILED:
+        return CSC_SW_BAND_ALIGN_TILED;
+    case HAL_PIXEL_FORMAT_BGRA_8888:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M:
+    case HAL_PIXEL_FORMAT_YV12:
+    case HAL_PIXEL_FORMAT_EXYNOS_YV12_M:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M:
+    case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M:
+        return CSC_SW_BAND_ALIGN;
+    default:
+        return 0;
+    }
+}
+
+static void set_sw_band(
+    CSC_HANDLE  *band,
+    CSC_HANDLE  *handle,
+    unsigned int row,
+    unsigned int height)
+{
+    unsigned int width = handle->src_format.width;
+
+    memcpy(band, handle, sizeof(CSC_HANDLE));
+    band->src_format.height = height;
+    band->dst_format.height = height;
+
+    switch (handle->src_format.color_format) {
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M_TILED:
+        /* a pair of tile rows is ALIGN(width, 128) * 64 bytes in both planes */
+        band->src_buffer.planes[CSC_Y_PLANE] =
+            (char *)handle->src_buffer.planes[CSC_Y_PLANE] + ALIGN(width, 128) * row;
+        band->src_buffer.planes[CSC_UV_PLANE] =
+            (char *)handle->src_buffer.planes[CSC_UV_PLANE] + ALIGN(width, 128) * (row >> 1);
+        break;
+    case HAL_PIXEL_FORMAT_BGRA_8888:
+        band->src_buffer.planes[CSC_RGB_PLANE] =
+            (char *)handle->src_buffer.planes[CSC_RGB_PLANE] + (width << 2) * row;
+        break;
+    default:
+        offset_yuv420_buffer(&band->src_buffer, handle->src_format.color_format, width, row);
+        break;
+    }
+
+    offset_yuv420_buffer(&band->dst_buffer, handle->dst_format.color_format, width, row);
+}
+
+static void *csc_sw_worker(
+    void *arg)
+{
+    CSC_SW_POOL *pool = (CSC_SW_POOL *)arg;
+    unsigned int job;
+    CSC_ERRORCODE ret;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->exit == 0 && pool->next_job >= pool->num_jobs)
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        if (pool->exit != 0)
+            break;
+
+        job = pool->next_job++;
+        pthread_mutex_unlock(&pool->lock);
+        ret = conv_sw(&pool->jobs[job]);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->job_ret[job] = ret;
+        if (--pool->pending == 0)
+            pthread_cond_signal(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static void csc_sw_pool_destroy(
+    CSC_SW_POOL *pool)
+{
+    unsigned int i;
+
+    if (pool == NULL)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->exit = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->num_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+/* the caller runs one band itself, so threads - 1 workers are created */
+static CSC_SW_POOL *csc_sw_pool_create(
+    unsigned int threads)
+{
+    CSC_SW_POOL *pool;
+    unsigned int i;
+
+    pool = (CSC_SW_POOL *)malloc(sizeof(CSC_SW_POOL));
+    if (pool == NULL)
+        return NULL;
+
+    memset(pool, 0, sizeof(CSC_SW_POOL));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool->threads[i], NULL, csc_sw_worker, pool) != 0) {
+            ALOGE("%s:: pthread_create(%d) fail", __func__, i);
+            break;
+        }
+        pool->num_threads++;
+    }
+
+    if (pool->num_threads == 0) {
+        csc_sw_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+static CSC_ERRORCODE conv_sw_parallel(
+    CSC_HANDLE *handle)
+{
+    CSC_SW_POOL *pool = (CSC_SW_POOL *)handle->sw_pool;
+    CSC_ERRORCODE ret = CSC_ErrorNone;
+    unsigned int height = handle->src_format.height;
+    unsigned int align, band_height, row, job, i;
+
+    align = get_sw_band_align(handle);
+    if (pool == NULL || align == 0 || height < CSC_SW_BAND_MIN_HEIGHT * 2)
+        return conv_sw(handle);
+
+    band_height = (height + pool->num_threads) / (pool->num_threads + 1);
+    band_height = ALIGN(band_height, align);
+    if (band_height < CSC_SW_BAND_MIN_HEIGHT)
+        band_height = ALIGN(CSC_SW_BAND_MIN_HEIGHT, align);
+    if (band_height >= height)
+        return conv_sw(handle);
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->num_jobs = 0;
+    for (row = 0; row < height && pool->num_jobs < CSC_SW_THREADS_MAX; row += band_height) {
+        unsigned int rows = (height - row < band_height) ? (height - row) : band_height;
+        if (pool->num_jobs == CSC_SW_THREADS_MAX - 1)
+            rows = height - row;
+        set_sw_band(&pool->jobs[pool->num_jobs], handle, row, rows);
+        pool->job_ret[pool->num_jobs] = CSC_ErrorNone;
+        pool->num_jobs++;
+    }
+    pool->next_job = 0;
+    pool->pending = pool->num_jobs;
+    pthread_cond_broadcast(&pool->work_cond);
+
+    /* the caller takes bands too instead of sleeping */
+    while (pool->next_job < pool->num_jobs) {
+        CSC_ERRORCODE job_ret;
+
+        job = pool->next_job++;
+        pthread_mutex_unlock(&pool->lock);
+        job_ret = conv_sw(&pool->jobs[job]);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->job_ret[job] = job_ret;
+        pool->pending--;
+    }
+
+    while (pool->pending > 0)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+
+    for (i = 0; i < pool->num_jobs; i++) {
+        if (pool->job_ret[i] != CSC_ErrorNone) {
+            ret = pool->job_ret[i];
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return ret;
+}
+
 static CSC_ERRORCODE conv_hw(
     CSC_HANDLE *handle)
 {
@@ -766,6 +981,7 @@ CSC_ERRORCODE csc_deinit(
         }
     }
 
+    csc_sw_pool_destroy((CSC_SW_POOL *)csc_handle->sw_pool);
     free(csc_handle);
     ret = CSC_ErrorNone;
 
@@ -839,6 +1055,40 @@ CSC_ERRORCODE csc_set_hw_property(
     return ret;
 }
 
+CSC_ERRORCODE csc_set_sw_threads(
+    void           *handle,
+    unsigned int    threads)
+{
+    CSC_HANDLE *csc_handle;
+    CSC_ERRORCODE ret = CSC_ErrorNone;
+
+    if (handle == NULL)
+        return CSC_ErrorNotInit;
+
+    csc_handle = (CSC_HANDLE *)handle;
+
+    if (threads > CSC_SW_THREADS_MAX)
+        threads = CSC_SW_THREADS_MAX;
+    if (threads == csc_handle->sw_threads)
+        return ret;
+
+    csc_sw_pool_destroy((CSC_SW_POOL *)csc_handle->sw_pool);
+    csc_handle->sw_pool = NULL;
+    csc_handle->sw_threads = 0;
+
+    if (threads > 1) {
+        csc_handle->sw_pool = csc_sw_pool_create(threads);
+        if (csc_handle->sw_pool == NULL) {
+            ALOGE("%s:: worker pool(%d) create fail, use single thread", __func__, threads);
+            ret = CSC_Error;
+        } else {
+            csc_handle->sw_threads = threads;
+        }
+    }
+
+    return ret;
+}
+
 CSC_ERRORCODE csc_get_eq_property(
     void              *handle,
     CSC_EQ_MODE       *csc_mode,
@@ -1058,7 +1308,7 @@ CSC_ERRORCODE csc_convert(
     if (csc_handle->csc_method == CSC_METHOD_HW)
         ret = conv_hw(csc_handle);
     else
-        ret = conv_sw(csc_handle);
+        ret = conv_sw_parallel(csc_handle);
 
     return ret;
 }
@@ -1094,7 +1344,7 @@ CSC_ERRORCODE csc_convert_with_rotation(
     if (csc_handle->csc_method == CSC_METHOD_HW)
         ret = conv_hw(csc_handle);
     else
-        ret = conv_sw(csc_handle);
+        ret = conv_sw_parallel(csc_handle);
 
     return ret;
 }
@@ -0,0 +1,810 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        csc_kernels.c
+ *
+ * @brief       software conversion kernels, selected at runtime
+ *
+ * The de-tiling and (de)interleave kernels are plain data movement, so every
+ * variant here is bit-exact with the C one. The ARGB8888 conversions redo the
+ * fixed point arithmetic of libswconverter's C functions, which stay the
+ * reference; exynos_csc_kernels_test checks every variant against it.
+ *
+ *   32-bit ARM : libswconverter NEON, in-tree NEON deinterleave and ARGB8888
+ *                to YUV420P
+ *   AArch64    : in-tree NEON
+ *   x86        : in-tree AVX2 or SSE4.1 when the cpu has it, C otherwise
+ */
+#define LOG_TAG "libcsc"
+#include <cutils/log.h>
+
+#include <string.h>
+#include <pthread.h>
+
+#include "csc_kernels.h"
+#include "swconverter.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CSC_KERNELS_NEON
+#endif
+
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define CSC_KERNELS_X86
+#define CSC_TARGET_SSE4  __attribute__((target("sse4.1")))
+#define CSC_TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+#define CSC_ALWAYS_INLINE inline __attribute__((always_inline))
+
+#define TILE_WIDTH  64
+#define TILE_HEIGHT 32
+
+/*
+ * Byte offset of (x_pos, y_pos) in a 64x32 tiled plane, x_pos multiple of 4.
+ * Tiles are laid out in Z order over pairs of tile rows; a last, unpaired
+ * tile row is linear.
+ */
+static int tile_4x2_read(int x_size, int y_size, int x_pos, int y_pos)
+{
+    int pixel_x_m1, pixel_y_m1;
+    int roundup_x;
+    int linear_addr0, linear_addr1, bank_addr;
+    int x_addr;
+
+    pixel_x_m1 = x_size - 1;
+    pixel_y_m1 = y_size - 1;
+
+    roundup_x = ((pixel_x_m1 >> 7) + 1);
+
+    x_addr = x_pos >> 2;
+
+    if ((y_size <= y_pos + 32) && (y_pos < y_size) &&
+        (((pixel_y_m1 >> 5) & 0x1) == 0) && (((y_pos >> 5) & 0x1) == 0)) {
+        linear_addr0 = (((y_pos & 0x1f) << 4) | (x_addr & 0xf));
+        linear_addr1 = (((y_pos >> 6) & 0xff) * roundup_x + ((x_addr >> 6) & 0x3f));
+
+        if (((x_addr >> 5) & 0x1) == ((y_pos >> 5) & 0x1))
+            bank_addr = ((x_addr >> 4) & 0x1);
+        else
+            bank_addr = 0x2 | ((x_addr >> 4) & 0x1);
+    } else {
+        linear_addr0 = (((y_pos & 0x1f) << 4) | (x_addr & 0xf));
+        linear_addr1 = (((y_pos >> 6) & 0xff) * roundup_x + ((x_addr >> 5) & 0x7f));
+
+        if (((x_addr >> 5) & 0x1) == ((y_pos >> 5) & 0x1))
+            bank_addr = ((x_addr >> 4) & 0x1);
+        else
+            bank_addr = 0x2 | ((x_addr >> 4) & 0x1);
+    }
+
+    linear_addr0 = linear_addr0 << 2;
+
+    return (linear_addr1 << 13) | (bank_addr << 11) | linear_addr0;
+}
+
+typedef void (*copy_span_t)(unsigned char *dst, const unsigned char *src);
+typedef void (*deinterleave_span_t)(unsigned char *dst1, unsigned char *dst2, const unsigned char *src);
+typedef void (*interleave_span_t)(unsigned char *dst, const unsigned char *src1, const unsigned char *src2);
+/* 16 ARGB8888 pixels to 16 Y, or to the 8 U and 8 V of their even pixels */
+typedef void (*argb_y_span_t)(unsigned char *y, const unsigned char *src);
+typedef void (*argb_uv_span_t)(unsigned char *u, unsigned char *v, const unsigned char *src);
+typedef void (*argb_uvsp_span_t)(unsigned char *uv, const unsigned char *src);
+
+/*
+ * ARGB8888 is B, G, R, A in memory. libswconverter converts with BT.601
+ * studio swing in 8.8 fixed point and takes the chroma of each 2x2 block
+ * from its top-left pixel. Y stays below 65536 and U, V within +-32767
+ * before the shift, so the vector spans work on 16-bit lanes.
+ */
+#define ARGB_Y(b, g, r)     ((((66 * (r)) + (129 * (g)) + (25 * (b)) + 128) >> 8) + 16)
+#define ARGB_U(b, g, r)     ((((-38 * (r)) - (74 * (g)) + (112 * (b)) + 128) >> 8) + 128)
+#define ARGB_V(b, g, r)     ((((112 * (r)) - (94 * (g)) - (18 * (b)) + 128) >> 8) + 128)
+
+/*
+ * Drivers shared by every variant. They are always inlined into the variant
+ * wrappers, so the span functions become direct calls compiled for that isa.
+ * A span is one 64-byte tile row; partial spans use the C tail.
+ */
+static CSC_ALWAYS_INLINE void tiled_to_linear_driver(
+    unsigned char *dst, const unsigned char *src,
+    unsigned int width, unsigned int height,
+    copy_span_t copy_span)
+{
+    unsigned int x, y, i, rows, cols;
+
+    for (y = 0; y < height; y += TILE_HEIGHT) {
+        rows = (height - y < TILE_HEIGHT) ? (height - y) : TILE_HEIGHT;
+        for (x = 0; x < width; x += TILE_WIDTH) {
+            const unsigned char *tile = src + tile_4x2_read(width, height, x, y);
+            unsigned char *out = dst + (y * width) + x;
+
+            cols = (width - x < TILE_WIDTH) ? (width - x) : TILE_WIDTH;
+            if (cols == TILE_WIDTH) {
+                for (i = 0; i < rows; i++)
+                    copy_span(out + (i * width), tile + (i * TILE_WIDTH));
+            } else {
+                for (i = 0; i < rows; i++)
+                    memcpy(out + (i * width), tile + (i * TILE_WIDTH), cols);
+            }
+        }
+    }
+}
+
+static CSC_ALWAYS_INLINE void tiled_to_linear_deinterleave_driver(
+    unsigned char *u_dst, unsigned char *v_dst, const unsigned char *src,
+    unsigned int width, unsigned int height,
+    deinterleave_span_t deinterleave_span)
+{
+    unsigned int x, y, i, j, rows, cols;
+    unsigned int half = width >> 1;
+
+    for (y = 0; y < height; y += TILE_HEIGHT) {
+        rows = (height - y < TILE_HEIGHT) ? (height - y) : TILE_HEIGHT;
+        for (x = 0; x < width; x += TILE_WIDTH) {
+            const unsigned char *tile = src + tile_4x2_read(width, height, x, y);
+            unsigned char *u = u_dst + (y * half) + (x >> 1);
+            unsigned char *v = v_dst + (y * half) + (x >> 1);
+
+            cols = (width - x < TILE_WIDTH) ? (width - x) : TILE_WIDTH;
+            for (i = 0; i < rows; i++) {
+                const unsigned char *in = tile + (i * TILE_WIDTH);
+                if (cols == TILE_WIDTH) {
+                    deinterleave_span(u + (i * half), v + (i * half), in);
+                } else {
+                    for (j = 0; j < (cols >> 1); j++) {
+                        u[(i * half) + j] = in[(j << 1)];
+                        v[(i * half) + j] = in[(j << 1) + 1];
+                    }
+                }
+            }
+        }
+    }
+}
+
+static CSC_ALWAYS_INLINE void interleave_driver(
+    unsigned char *dest, const unsigned char *src1, const unsigned char *src2,
+    unsigned int src_size, interleave_span_t interleave_span)
+{
+    unsigned int i = 0;
+
+    /* a span is 32 bytes of each source */
+    for (; i + 32 <= src_size; i += 32)
+        interleave_span(dest + (i << 1), src1 + i, src2 + i);
+    for (; i < src_size; i++) {
+        dest[(i << 1)]     = src1[i];
+        dest[(i << 1) + 1] = src2[i];
+    }
+}
+
+static CSC_ALWAYS_INLINE void deinterleave_driver(
+    unsigned char *dest1, unsigned char *dest2, const unsigned char *src,
+    unsigned int src_size, deinterleave_span_t deinterleave_span)
+{
+    unsigned int pairs = src_size >> 1;
+    unsigned int i = 0;
+
+    for (; i + 32 <= pairs; i += 32)
+        deinterleave_span(dest1 + i, dest2 + i, src + (i << 1));
+    for (; i < pairs; i++) {
+        dest1[i] = src[(i << 1)];
+        dest2[i] = src[(i << 1) + 1];
+    }
+}
+
+/*
+ * One chroma row per two pixel rows, ceil(width / 2) samples wide; in
+ * YUV420SP U and V alternate. Partial spans use the C tail.
+ */
+static CSC_ALWAYS_INLINE void argb_to_yuv420sp_driver(
+    unsigned char *y_dst, unsigned char *uv_dst, const unsigned char *src,
+    unsigned int width, unsigned int height,
+    argb_y_span_t y_span, argb_uvsp_span_t uv_span)
+{
+    unsigned int chroma_w = (width + 1) >> 1;
+    unsigned int i, j;
+
+    for (j = 0; j < height; j++) {
+        const unsigned char *in = src + ((j * width) << 2);
+        unsigned char *y = y_dst + (j * width);
+        unsigned char *uv = uv_dst + ((j >> 1) * (chroma_w << 1));
+
+        for (i = 0; i + 16 <= width; i += 16)
+            y_span(y + i, in + (i << 2));
+        for (; i < width; i++)
+            y[i] = ARGB_Y(in[(i << 2)], in[(i << 2) + 1], in[(i << 2) + 2]);
+
+        if (j & 1)
+            continue;
+
+        for (i = 0; i + 16 <= width; i += 16)
+            uv_span(uv + i, in + (i << 2));
+        for (; i < width; i += 2) {
+            uv[i]     = ARGB_U(in[(i << 2)], in[(i << 2) + 1], in[(i << 2) + 2]);
+            uv[i + 1] = ARGB_V(in[(i << 2)], in[(i << 2) + 1], in[(i << 2) + 2]);
+        }
+    }
+}
+
+static CSC_ALWAYS_INLINE void argb_to_yuv420p_driver(
+    unsigned char *y_dst, unsigned char *u_dst, unsigned char *v_dst, const unsigned char *src,
+    unsigned int width, unsigned int height,
+    argb_y_span_t y_span, argb_uv_span_t uv_span)
+{
+    unsigned int chroma_w = (width + 1) >> 1;
+    unsigned int i, j;
+
+    for (j = 0; j < height; j++) {
+        const unsigned char *in = src + ((j * width) << 2);
+        unsigned char *y = y_dst + (j * width);
+        unsigned char *u = u_dst + ((j >> 1) * chroma_w);
+        unsigned char *v = v_dst + ((j >> 1) * chroma_w);
+
+        for (i = 0; i + 16 <= width; i += 16)
+            y_span(y + i, in + (i << 2));
+        for (; i < width; i++)
+            y[i] = ARGB_Y(in[(i << 2)], in[(i << 2) + 1], in[(i << 2) + 2]);
+
+        if (j & 1)
+            continue;
+
+        for (i = 0; i + 16 <= width; i += 16)
+            uv_span(u + (i >> 1), v + (i >> 1), in + (i << 2));
+        for (; i < width; i += 2) {
+            u[i >> 1] = ARGB_U(in[(i << 2)], in[(i << 2) + 1], in[(i << 2) + 2]);
+            v[i >> 1] = ARGB_V(in[(i << 2)], in[(i << 2) + 1], in[(i << 2) + 2]);
+        }
+    }
+}
+
+/* C */
+static CSC_ALWAYS_INLINE void c_copy_span(unsigned char *dst, const unsigned char *src)
+{
+    memcpy(dst, src, TILE_WIDTH);
+}
+
+static CSC_ALWAYS_INLINE void c_deinterleave_span(unsigned char *dst1, unsigned char *dst2, const unsigned char *src)
+{
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        dst1[i] = src[(i << 1)];
+        dst2[i] = src[(i << 1) + 1];
+    }
+}
+
+static CSC_ALWAYS_INLINE void c_interleave_span(unsigned char *dst, const unsigned char *src1, const unsigned char *src2)
+{
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        dst[(i << 1)]     = src1[i];
+        dst[(i << 1) + 1] = src2[i];
+    }
+}
+
+static void c_tiled_to_linear(unsigned char *dst, unsigned char *src, unsigned int width, unsigned int height)
+{
+    tiled_to_linear_driver(dst, src, width, height, c_copy_span);
+}
+
+static void c_tiled_to_linear_deinterleave(unsigned char *u_dst, unsigned char *v_dst, unsigned char *src,
+                                           unsigned int width, unsigned int height)
+{
+    tiled_to_linear_deinterleave_driver(u_dst, v_dst, src, width, height, c_deinterleave_span);
+}
+
+static void c_interleave_memcpy(unsigned char *dest, unsigned char *src1, unsigned char *src2, unsigned int src_size)
+{
+    interleave_driver(dest, src1, src2, src_size, c_interleave_span);
+}
+
+static void c_deinterleave_memcpy(unsigned char *dest1, unsigned char *dest2, unsigned char *src, unsigned int src_size)
+{
+    deinterleave_driver(dest1, dest2, src, src_size, c_deinterleave_span);
+}
+
+static const CSC_SW_KERNELS csc_kernels_c = {
+    "c",
+    c_tiled_to_linear,
+    c_tiled_to_linear,
+    c_tiled_to_linear_deinterleave,
+    c_interleave_memcpy,
+    c_deinterleave_memcpy,
+    csc_ARGB8888_to_YUV420SP,
+    csc_ARGB8888_to_YUV420P,
+};
+
+#ifdef CSC_KERNELS_NEON
+static CSC_ALWAYS_INLINE void neon_copy_span(unsigned char *dst, const unsigned char *src)
+{
+    uint8x16_t a = vld1q_u8(src);
+    uint8x16_t b = vld1q_u8(src + 16);
+    uint8x16_t c = vld1q_u8(src + 32);
+    uint8x16_t d = vld1q_u8(src + 48);
+
+    vst1q_u8(dst, a);
+    vst1q_u8(dst + 16, b);
+    vst1q_u8(dst + 32, c);
+    vst1q_u8(dst + 48, d);
+}
+
+static CSC_ALWAYS_INLINE void neon_deinterleave_span(unsigned char *dst1, unsigned char *dst2, const unsigned char *src)
+{
+    uint8x16x2_t a = vld2q_u8(src);
+    uint8x16x2_t b = vld2q_u8(src + 32);
+
+    vst1q_u8(dst1, a.val[0]);
+    vst1q_u8(dst1 + 16, b.val[0]);
+    vst1q_u8(dst2, a.val[1]);
+    vst1q_u8(dst2 + 16, b.val[1]);
+}
+
+static CSC_ALWAYS_INLINE void neon_interleave_span(unsigned char *dst, const unsigned char *src1, const unsigned char *src2)
+{
+    uint8x16x2_t a, b;
+
+    a.val[0] = vld1q_u8(src1);
+    a.val[1] = vld1q_u8(src2);
+    b.val[0] = vld1q_u8(src1 + 16);
+    b.val[1] = vld1q_u8(src2 + 16);
+    vst2q_u8(dst, a);
+    vst2q_u8(dst + 32, b);
+}
+
+static CSC_ALWAYS_INLINE void neon_argb_y_span(unsigned char *y, const unsigned char *src)
+{
+    uint8x16x4_t p = vld4q_u8(src);
+    uint16x8_t lo = vmull_u8(vget_low_u8(p.val[2]), vdup_n_u8(66));
+    uint16x8_t hi = vmull_u8(vget_high_u8(p.val[2]), vdup_n_u8(66));
+
+    lo = vmlal_u8(lo, vget_low_u8(p.val[1]), vdup_n_u8(129));
+    hi = vmlal_u8(hi, vget_high_u8(p.val[1]), vdup_n_u8(129));
+    lo = vmlal_u8(lo, vget_low_u8(p.val[0]), vdup_n_u8(25));
+    hi = vmlal_u8(hi, vget_high_u8(p.val[0]), vdup_n_u8(25));
+
+    /* vrshrn is (x + 128) >> 8 */
+    vst1q_u8(y, vaddq_u8(vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)), vdupq_n_u8(16)));
+}
+
+static CSC_ALWAYS_INLINE uint8x8_t neon_argb_chroma(
+    int16x8_t b, int16x8_t g, int16x8_t r, int16_t cb, int16_t cg, int16_t cr)
+{
+    int16x8_t c = vmulq_n_s16(r, cr);
+
+    c = vmlaq_n_s16(c, g, cg);
+    c = vmlaq_n_s16(c, b, cb);
+
+    return vqmovun_s16(vaddq_s16(vrshrq_n_s16(c, 8), vdupq_n_s16(128)));
+}
+
+static CSC_ALWAYS_INLINE void neon_argb_uv(uint8x8_t *u, uint8x8_t *v, const unsigned char *src)
+{
+    uint8x16x4_t p = vld4q_u8(src);
+    /* the even pixels */
+    int16x8_t b = vreinterpretq_s16_u16(vmovl_u8(vuzp_u8(vget_low_u8(p.val[0]), vget_high_u8(p.val[0])).val[0]));
+    int16x8_t g = vreinterpretq_s16_u16(vmovl_u8(vuzp_u8(vget_low_u8(p.val[1]), vget_high_u8(p.val[1])).val[0]));
+    int16x8_t r = vreinterpretq_s16_u16(vmovl_u8(vuzp_u8(vget_low_u8(p.val[2]), vget_high_u8(p.val[2])).val[0]));
+
+    *u = neon_argb_chroma(b, g, r, 112, -74, -38);
+    *v = neon_argb_chroma(b, g, r, -18, -94, 112);
+}
+
+static CSC_ALWAYS_INLINE void neon_argb_uv_span(unsigned char *u, unsigned char *v, const unsigned char *src)
+{
+    uint8x8_t cu, cv;
+
+    neon_argb_uv(&cu, &cv, src);
+    vst1_u8(u, cu);
+    vst1_u8(v, cv);
+}
+
+static CSC_ALWAYS_INLINE void neon_argb_uvsp_span(unsigned char *uv, const unsigned char *src)
+{
+    uint8x8x2_t c;
+
+    neon_argb_uv(&c.val[0], &c.val[1], src);
+    vst2_u8(uv, c);
+}
+
+static void neon_deinterleave_memcpy(unsigned char *dest1, unsigned char *dest2, unsigned char *src, unsigned int src_size)
+{
+    deinterleave_driver(dest1, dest2, src, src_size, neon_deinterleave_span);
+}
+
+static void neon_argb8888_to_yuv420p(unsigned char *y_dst, unsigned char *u_dst, unsigned char *v_dst,
+                                     unsigned char *rgb_src, unsigned int width, unsigned int height)
+{
+    argb_to_yuv420p_driver(y_dst, u_dst, v_dst, rgb_src, width, height, neon_argb_y_span, neon_argb_uv_span);
+}
+
+#ifdef __aarch64__
+static void neon_tiled_to_linear(unsigned char *dst, unsigned char *src, unsigned int width, unsigned int height)
+{
+    tiled_to_linear_driver(dst, src, width, height, neon_copy_span);
+}
+
+static void neon_tiled_to_linear_deinterleave(unsigned char *u_dst, unsigned char *v_dst, unsigned char *src,
+                                              unsigned int width, unsigned int height)
+{
+    tiled_to_linear_deinterleave_driver(u_dst, v_dst, src, width, height, neon_deinterleave_span);
+}
+
+static void neon_interleave_memcpy(unsigned char *dest, unsigned char *src1, unsigned char *src2, unsigned int src_size)
+{
+    interleave_driver(dest, src1, src2, src_size, neon_interleave_span);
+}
+
+static void neon_argb8888_to_yuv420sp(unsigned char *y_dst, unsigned char *uv_dst, unsigned char *rgb_src,
+                                      unsigned int width, unsigned int height)
+{
+    argb_to_yuv420sp_driver(y_dst, uv_dst, rgb_src, width, height, neon_argb_y_span, neon_argb_uvsp_span);
+}
+
+static const CSC_SW_KERNELS csc_kernels_neon = {
+    "neon",
+    neon_tiled_to_linear,
+    neon_tiled_to_linear,
+    neon_tiled_to_linear_deinterleave,
+    neon_interleave_memcpy,
+    neon_deinterleave_memcpy,
+    neon_argb8888_to_yuv420sp,
+    neon_argb8888_to_yuv420p,
+};
+#else
+/* libswconverter already carries NEON versions for 32-bit ARM */
+static const CSC_SW_KERNELS csc_kernels_neon = {
+    "swconverter-neon",
+    csc_tiled_to_linear_y_neon,
+    csc_tiled_to_linear_uv_neon,
+    csc_tiled_to_linear_uv_deinterleave_neon,
+    csc_interleave_memcpy_neon,
+    neon_deinterleave_memcpy,
+    csc_ARGB8888_to_YUV420SP_NEON,
+    neon_argb8888_to_yuv420p,
+};
+#endif
+#endif /* CSC_KERNELS_NEON */
+
+#ifdef CSC_KERNELS_X86
+/* SSE4.1 */
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_copy_span(unsigned char *dst, const unsigned char *src)
+{
+    __m128i a = _mm_loadu_si128((const __m128i *)src);
+    __m128i b = _mm_loadu_si128((const __m128i *)(src + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *)(src + 32));
+    __m128i d = _mm_loadu_si128((const __m128i *)(src + 48));
+
+    _mm_storeu_si128((__m128i *)dst, a);
+    _mm_storeu_si128((__m128i *)(dst + 16), b);
+    _mm_storeu_si128((__m128i *)(dst + 32), c);
+    _mm_storeu_si128((__m128i *)(dst + 48), d);
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_deinterleave_span(unsigned char *dst1, unsigned char *dst2, const unsigned char *src)
+{
+    const __m128i mask = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        /* each register becomes [8 even bytes | 8 odd bytes] */
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + (i << 5))), mask);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + (i << 5) + 16)), mask);
+
+        _mm_storeu_si128((__m128i *)(dst1 + (i << 4)), _mm_unpacklo_epi64(a, b));
+        _mm_storeu_si128((__m128i *)(dst2 + (i << 4)), _mm_unpackhi_epi64(a, b));
+    }
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_interleave_span(unsigned char *dst, const unsigned char *src1, const unsigned char *src2)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src1 + (i << 4)));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src2 + (i << 4)));
+
+        _mm_storeu_si128((__m128i *)(dst + (i << 5)), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128((__m128i *)(dst + (i << 5) + 16), _mm_unpackhi_epi8(a, b));
+    }
+}
+
+/* B, G and R of 8 pixels, two registers of 4, as 16-bit lanes */
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_argb_channels(
+    __m128i p0, __m128i p1, __m128i *b, __m128i *g, __m128i *r)
+{
+    const __m128i mask = _mm_set1_epi32(0xff);
+
+    *b = _mm_packus_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+    *g = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+    *r = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+}
+
+/* Y wraps past 32767, so it is shifted as unsigned */
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 __m128i sse4_argb_y(__m128i b, __m128i g, __m128i r)
+{
+    __m128i y = _mm_mullo_epi16(r, _mm_set1_epi16(66));
+
+    y = _mm_add_epi16(y, _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+    y = _mm_add_epi16(y, _mm_set1_epi16(128));
+
+    return _mm_add_epi16(_mm_srli_epi16(y, 8), _mm_set1_epi16(16));
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 __m128i sse4_argb_chroma(
+    __m128i b, __m128i g, __m128i r, short cb, short cg, short cr)
+{
+    __m128i c = _mm_mullo_epi16(r, _mm_set1_epi16(cr));
+
+    c = _mm_add_epi16(c, _mm_mullo_epi16(g, _mm_set1_epi16(cg)));
+    c = _mm_add_epi16(c, _mm_mullo_epi16(b, _mm_set1_epi16(cb)));
+    c = _mm_add_epi16(c, _mm_set1_epi16(128));
+
+    return _mm_add_epi16(_mm_srai_epi16(c, 8), _mm_set1_epi16(128));
+}
+
+/* U and V of the even pixels of 16, as 8 bytes each in the low halves */
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_argb_uv(__m128i *u, __m128i *v, const unsigned char *src)
+{
+    __m128 p0 = _mm_loadu_ps((const float *)src);
+    __m128 p1 = _mm_loadu_ps((const float *)(src + 16));
+    __m128 p2 = _mm_loadu_ps((const float *)(src + 32));
+    __m128 p3 = _mm_loadu_ps((const float *)(src + 48));
+    __m128i b, g, r;
+
+    sse4_argb_channels(_mm_castps_si128(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0))),
+                       _mm_castps_si128(_mm_shuffle_ps(p2, p3, _MM_SHUFFLE(2, 0, 2, 0))),
+                       &b, &g, &r);
+
+    *u = sse4_argb_chroma(b, g, r, 112, -74, -38);
+    *u = _mm_packus_epi16(*u, *u);
+    *v = sse4_argb_chroma(b, g, r, -18, -94, 112);
+    *v = _mm_packus_epi16(*v, *v);
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_argb_y_span(unsigned char *y, const unsigned char *src)
+{
+    __m128i b, g, r, lo, hi;
+
+    sse4_argb_channels(_mm_loadu_si128((const __m128i *)src),
+                       _mm_loadu_si128((const __m128i *)(src + 16)), &b, &g, &r);
+    lo = sse4_argb_y(b, g, r);
+    sse4_argb_channels(_mm_loadu_si128((const __m128i *)(src + 32)),
+                       _mm_loadu_si128((const __m128i *)(src + 48)), &b, &g, &r);
+    hi = sse4_argb_y(b, g, r);
+
+    _mm_storeu_si128((__m128i *)y, _mm_packus_epi16(lo, hi));
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_argb_uv_span(unsigned char *u, unsigned char *v, const unsigned char *src)
+{
+    __m128i cu, cv;
+
+    sse4_argb_uv(&cu, &cv, src);
+    _mm_storel_epi64((__m128i *)u, cu);
+    _mm_storel_epi64((__m128i *)v, cv);
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_SSE4 void sse4_argb_uvsp_span(unsigned char *uv, const unsigned char *src)
+{
+    __m128i cu, cv;
+
+    sse4_argb_uv(&cu, &cv, src);
+    _mm_storeu_si128((__m128i *)uv, _mm_unpacklo_epi8(cu, cv));
+}
+
+static CSC_TARGET_SSE4 void sse4_tiled_to_linear(unsigned char *dst, unsigned char *src, unsigned int width, unsigned int height)
+{
+    tiled_to_linear_driver(dst, src, width, height, sse4_copy_span);
+}
+
+static CSC_TARGET_SSE4 void sse4_tiled_to_linear_deinterleave(unsigned char *u_dst, unsigned char *v_dst, unsigned char *src,
+                                                              unsigned int width, unsigned int height)
+{
+    tiled_to_linear_deinterleave_driver(u_dst, v_dst, src, width, height, sse4_deinterleave_span);
+}
+
+static CSC_TARGET_SSE4 void sse4_interleave_memcpy(unsigned char *dest, unsigned char *src1, unsigned char *src2, unsigned int src_size)
+{
+    interleave_driver(dest, src1, src2, src_size, sse4_interleave_span);
+}
+
+static CSC_TARGET_SSE4 void sse4_deinterleave_memcpy(unsigned char *dest1, unsigned char *dest2, unsigned char *src, unsigned int src_size)
+{
+    deinterleave_driver(dest1, dest2, src, src_size, sse4_deinterleave_span);
+}
+
+static CSC_TARGET_SSE4 void sse4_argb8888_to_yuv420sp(unsigned char *y_dst, unsigned char *uv_dst, unsigned char *rgb_src,
+                                                      unsigned int width, unsigned int height)
+{
+    argb_to_yuv420sp_driver(y_dst, uv_dst, rgb_src, width, height, sse4_argb_y_span, sse4_argb_uvsp_span);
+}
+
+static CSC_TARGET_SSE4 void sse4_argb8888_to_yuv420p(unsigned char *y_dst, unsigned char *u_dst, unsigned char *v_dst,
+                                                     unsigned char *rgb_src, unsigned int width, unsigned int height)
+{
+    argb_to_yuv420p_driver(y_dst, u_dst, v_dst, rgb_src, width, height, sse4_argb_y_span, sse4_argb_uv_span);
+}
+
+static const CSC_SW_KERNELS csc_kernels_sse4 = {
+    "sse4.1",
+    sse4_tiled_to_linear,
+    sse4_tiled_to_linear,
+    sse4_tiled_to_linear_deinterleave,
+    sse4_interleave_memcpy,
+    sse4_deinterleave_memcpy,
+    sse4_argb8888_to_yuv420sp,
+    sse4_argb8888_to_yuv420p,
+};
+
+/* AVX2 */
+static CSC_ALWAYS_INLINE CSC_TARGET_AVX2 void avx2_copy_span(unsigned char *dst, const unsigned char *src)
+{
+    __m256i a = _mm256_loadu_si256((const __m256i *)src);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(src + 32));
+
+    _mm256_storeu_si256((__m256i *)dst, a);
+    _mm256_storeu_si256((__m256i *)(dst + 32), b);
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_AVX2 void avx2_deinterleave_span(unsigned char *dst1, unsigned char *dst2, const unsigned char *src)
+{
+    const __m256i mask = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                                          0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    /* per lane [8 even | 8 odd], then gather the even and odd halves across lanes */
+    __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)src), mask);
+    __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(src + 32)), mask);
+
+    a = _mm256_permute4x64_epi64(a, 0xd8);
+    b = _mm256_permute4x64_epi64(b, 0xd8);
+
+    _mm256_storeu_si256((__m256i *)dst1, _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256((__m256i *)dst2, _mm256_permute2x128_si256(a, b, 0x31));
+}
+
+static CSC_ALWAYS_INLINE CSC_TARGET_AVX2 void avx2_interleave_span(unsigned char *dst, const unsigned char *src1, const unsigned char *src2)
+{
+    __m256i a = _mm256_loadu_si256((const __m256i *)src1);
+    __m256i b = _mm256_loadu_si256((const __m256i *)src2);
+    __m256i lo = _mm256_unpacklo_epi8(a, b);
+    __m256i hi = _mm256_unpackhi_epi8(a, b);
+
+    _mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+/* all 16 pixels in two registers; the chroma of 8 is left to the SSE4.1 span */
+static CSC_ALWAYS_INLINE CSC_TARGET_AVX2 void avx2_argb_y_span(unsigned char *y, const unsigned char *src)
+{
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    __m256i p0 = _mm256_loadu_si256((const __m256i *)src);
+    __m256i p1 = _mm256_loadu_si256((const __m256i *)(src + 32));
+    __m256i b, g, r, sum;
+
+    /* per lane packs, pixels end up as 0-3, 8-11, 4-7, 12-15 */
+    b = _mm256_packus_epi32(_mm256_and_si256(p0, mask), _mm256_and_si256(p1, mask));
+    g = _mm256_packus_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 8), mask),
+                            _mm256_and_si256(_mm256_srli_epi32(p1, 8), mask));
+    r = _mm256_packus_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, 16), mask),
+                            _mm256_and_si256(_mm256_srli_epi32(p1, 16), mask));
+
+    sum = _mm256_mullo_epi16(r, _mm256_set1_epi16(66));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(g, _mm256_set1_epi16(129)));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b, _mm256_set1_epi16(25)));
+    sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+    sum = _mm256_add_epi16(_mm256_srli_epi16(sum, 8), _mm256_set1_epi16(16));
+    sum = _mm256_permute4x64_epi64(sum, 0xd8);
+
+    _mm_storeu_si128((__m128i *)y, _mm_packus_epi16(_mm256_castsi256_si128(sum),
+                                                    _mm256_extracti128_si256(sum, 1)));
+}
+
+static CSC_TARGET_AVX2 void avx2_tiled_to_linear(unsigned char *dst, unsigned char *src, unsigned int width, unsigned int height)
+{
+    tiled_to_linear_driver(dst, src, width, height, avx2_copy_span);
+}
+
+static CSC_TARGET_AVX2 void avx2_tiled_to_linear_deinterleave(unsigned char *u_dst, unsigned char *v_dst, unsigned char *src,
+                                                              unsigned int width, unsigned int height)
+{
+    tiled_to_linear_deinterleave_driver(u_dst, v_dst, src, width, height, avx2_deinterleave_span);
+}
+
+static CSC_TARGET_AVX2 void avx2_interleave_memcpy(unsigned char *dest, unsigned char *src1, unsigned char *src2, unsigned int src_size)
+{
+    interleave_driver(dest, src1, src2, src_size, avx2_interleave_span);
+}
+
+static CSC_TARGET_AVX2 void avx2_deinterleave_memcpy(unsigned char *dest1, unsigned char *dest2, unsigned char *src, unsigned int src_size)
+{
+    deinterleave_driver(dest1, dest2, src, src_size, avx2_deinterleave_span);
+}
+
+static CSC_TARGET_AVX2 void avx2_argb8888_to_yuv420sp(unsigned char *y_dst, unsigned char *uv_dst, unsigned char *rgb_src,
+                                                      unsigned int width, unsigned int height)
+{
+    argb_to_yuv420sp_driver(y_dst, uv_dst, rgb_src, width, height, avx2_argb_y_span, sse4_argb_uvsp_span);
+}
+
+static CSC_TARGET_AVX2 void avx2_argb8888_to_yuv420p(unsigned char *y_dst, unsigned char *u_dst, unsigned char *v_dst,
+                                                     unsigned char *rgb_src, unsigned int width, unsigned int height)
+{
+    argb_to_yuv420p_driver(y_dst, u_dst, v_dst, rgb_src, width, height, avx2_argb_y_span, sse4_argb_uv_span);
+}
+
+static const CSC_SW_KERNELS csc_kernels_avx2 = {
+    "avx2",
+    avx2_tiled_to_linear,
+    avx2_tiled_to_linear,
+    avx2_tiled_to_linear_deinterleave,
+    avx2_interleave_memcpy,
+    avx2_deinterleave_memcpy,
+    avx2_argb8888_to_yuv420sp,
+    avx2_argb8888_to_yuv420p,
+};
+#endif /* CSC_KERNELS_X86 */
+
+static const CSC_SW_KERNELS *csc_kernels = &csc_kernels_c;
+static pthread_once_t csc_kernels_once = PTHREAD_ONCE_INIT;
+
+static void csc_select_sw_kernels(void)
+{
+#if defined(CSC_KERNELS_NEON)
+    csc_kernels = &csc_kernels_neon;
+#elif defined(CSC_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        csc_kernels = &csc_kernels_avx2;
+    else if (__builtin_cpu_supports("sse4.1"))
+        csc_kernels = &csc_kernels_sse4;
+#endif
+
+    ALOGV("%s:: %s kernels", __func__, csc_kernels->name);
+}
+
+const CSC_SW_KERNELS *csc_get_sw_kernels(void)
+{
+    pthread_once(&csc_kernels_once, csc_select_sw_kernels);
+
+    return csc_kernels;
+}
+
+const CSC_SW_KERNELS *csc_get_sw_kernels_c(void)
+{
+    return &csc_kernels_c;
+}
+
+const CSC_SW_KERNELS *csc_get_sw_kernels_isa(unsigned int index)
+{
+    const CSC_SW_KERNELS *isa[2];
+    unsigned int count = 0;
+
+#if defined(CSC_KERNELS_NEON)
+    isa[count++] = &csc_kernels_neon;
+#elif defined(CSC_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1"))
+        isa[count++] = &csc_kernels_sse4;
+    if (__builtin_cpu_supports("avx2"))
+        isa[count++] = &csc_kernels_avx2;
+#endif
+
+    return (index < count) ? isa[index] : NULL;
+}
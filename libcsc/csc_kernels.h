@@ -0,0 +1,82 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        csc_kernels.h
+ *
+ * @brief       software conversion kernels, selected at runtime
+ */
+
+#ifndef CSC_KERNELS_H
+#define CSC_KERNELS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _CSC_SW_KERNELS {
+    const char *name;
+
+    /* NV12T (64x32 tiled) to linear */
+    void (*tiled_to_linear_y)(
+        unsigned char *y_dst, unsigned char *y_src,
+        unsigned int width, unsigned int height);
+    void (*tiled_to_linear_uv)(
+        unsigned char *uv_dst, unsigned char *uv_src,
+        unsigned int width, unsigned int height);
+    void (*tiled_to_linear_uv_deinterleave)(
+        unsigned char *u_dst, unsigned char *v_dst, unsigned char *uv_src,
+        unsigned int width, unsigned int height);
+
+    /* src_size is the size of one source plane */
+    void (*interleave_memcpy)(
+        unsigned char *dest, unsigned char *src1, unsigned char *src2,
+        unsigned int src_size);
+    /* src_size is the size of the interleaved source */
+    void (*deinterleave_memcpy)(
+        unsigned char *dest1, unsigned char *dest2, unsigned char *src,
+        unsigned int src_size);
+
+    void (*argb8888_to_yuv420sp)(
+        unsigned char *y_dst, unsigned char *uv_dst, unsigned char *rgb_src,
+        unsigned int width, unsigned int height);
+    void (*argb8888_to_yuv420p)(
+        unsigned char *y_dst, unsigned char *u_dst, unsigned char *v_dst,
+        unsigned char *rgb_src, unsigned int width, unsigned int height);
+} CSC_SW_KERNELS;
+
+/*
+ * Kernels for the running cpu. Selected once, on first call.
+ */
+const CSC_SW_KERNELS *csc_get_sw_kernels(void);
+
+/*
+ * Portable C kernels, the reference for the vectorized ones.
+ */
+const CSC_SW_KERNELS *csc_get_sw_kernels_c(void);
+
+/*
+ * Vectorized kernel sets built in and usable on the running cpu, for
+ * exynos_csc_kernels_test and exynos_csc_kernels_bench. NULL past the last.
+ */
+const CSC_SW_KERNELS *csc_get_sw_kernels_isa(unsigned int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        csc_kernels_test.c
+ *
+ * @brief       bit-exactness of every libcsc software kernel set against
+ *              the libswconverter C functions
+ *
+ * The C set, each vectorized set the cpu can run and the one
+ * csc_get_sw_kernels() picks are run on the same random input as the
+ * libswconverter reference. Output buffers are filled with a guard byte
+ * first and compared whole, so a write past the end shows up too.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "csc_kernels.h"
+#include "swconverter.h"
+
+#define TEST_GUARD          0xa5
+#define TEST_SLACK          256
+
+static unsigned int gSeed = 1;
+static int          gFailures;
+
+static unsigned char Test_Rand(void)
+{
+    gSeed = gSeed * 1103515245 + 12345;
+    return (unsigned char)(gSeed >> 16);
+}
+
+typedef struct {
+    unsigned char *src;
+    unsigned char *ref[2];
+    unsigned char *out[2];
+    size_t         srcSize;
+    size_t         dstSize;
+} TEST_BUFFERS;
+
+static int Test_Alloc(TEST_BUFFERS *buffers, size_t srcSize, size_t dstSize)
+{
+    size_t i;
+
+    buffers->srcSize = srcSize;
+    buffers->dstSize = dstSize + TEST_SLACK;
+    buffers->src = (unsigned char *)malloc(srcSize);
+    for (i = 0; i < 2; i++) {
+        buffers->ref[i] = (unsigned char *)malloc(buffers->dstSize);
+        buffers->out[i] = (unsigned char *)malloc(buffers->dstSize);
+    }
+
+    if (buffers->src == NULL || buffers->ref[0] == NULL || buffers->ref[1] == NULL ||
+        buffers->out[0] == NULL || buffers->out[1] == NULL)
+        return -1;
+
+    for (i = 0; i < srcSize; i++)
+        buffers->src[i] = Test_Rand();
+
+    return 0;
+}
+
+static void Test_Free(TEST_BUFFERS *buffers)
+{
+    int i;
+
+    free(buffers->src);
+    for (i = 0; i < 2; i++) {
+        free(buffers->ref[i]);
+        free(buffers->out[i]);
+    }
+}
+
+static void Test_Guard(TEST_BUFFERS *buffers)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        memset(buffers->ref[i], TEST_GUARD, buffers->dstSize);
+        memset(buffers->out[i], TEST_GUARD, buffers->dstSize);
+    }
+}
+
+static void Test_Compare(TEST_BUFFERS *buffers, const char *name, const char *op,
+                         unsigned int width, unsigned int height)
+{
+    size_t i;
+    int plane;
+
+    for (plane = 0; plane < 2; plane++) {
+        if (memcmp(buffers->ref[plane], buffers->out[plane], buffers->dstSize) == 0)
+            continue;
+
+        for (i = 0; buffers->ref[plane][i] == buffers->out[plane][i]; i++)
+            ;
+        printf("  FAIL %-16s %-28s %4ux%-4u plane %d byte %zu: %u, reference %u\n",
+               name, op, width, height, plane, i,
+               buffers->out[plane][i], buffers->ref[plane][i]);
+        gFailures++;
+    }
+}
+
+static void Test_Kernels(const CSC_SW_KERNELS *kernels, const char *name)
+{
+    /* NV12T is 64x32 tiled, widths and heights are even */
+    static const unsigned int tiledSizes[][2] = {
+        { 64, 32 }, { 100, 34 }, { 176, 144 }, { 1280, 720 }, { 1366, 770 }, { 1920, 1080 },
+    };
+    /* odd sizes and sizes off the 16 pixel span for the C tails */
+    static const unsigned int argbSizes[][2] = {
+        { 1, 1 }, { 2, 2 }, { 15, 3 }, { 17, 5 }, { 33, 17 }, { 176, 144 }, { 1279, 719 }, { 1920, 1080 },
+    };
+    TEST_BUFFERS buffers;
+    unsigned int w, h, chromaW, chromaH;
+    size_t s;
+    int failures = gFailures;
+
+    for (s = 0; s < sizeof(tiledSizes) / sizeof(tiledSizes[0]); s++) {
+        w = tiledSizes[s][0];
+        h = tiledSizes[s][1];
+
+        /* tiles are allocated in 128x64 blocks */
+        if (Test_Alloc(&buffers, (size_t)((w + 127) & ~127) * ((h + 63) & ~63) * 2, (size_t)w * h * 2) != 0) {
+            printf("  out of memory\n");
+            gFailures++;
+            Test_Free(&buffers);
+            return;
+        }
+
+        Test_Guard(&buffers);
+        csc_tiled_to_linear_y(buffers.ref[0], buffers.src, w, h);
+        kernels->tiled_to_linear_y(buffers.out[0], buffers.src, w, h);
+        Test_Compare(&buffers, name, "NV12T Y -> linear", w, h);
+
+        Test_Guard(&buffers);
+        csc_tiled_to_linear_uv(buffers.ref[0], buffers.src, w, h / 2);
+        kernels->tiled_to_linear_uv(buffers.out[0], buffers.src, w, h / 2);
+        Test_Compare(&buffers, name, "NV12T UV -> linear", w, h);
+
+        Test_Guard(&buffers);
+        csc_tiled_to_linear_uv_deinterleave(buffers.ref[0], buffers.ref[1], buffers.src, w, h / 2);
+        kernels->tiled_to_linear_uv_deinterleave(buffers.out[0], buffers.out[1], buffers.src, w, h / 2);
+        Test_Compare(&buffers, name, "NV12T UV -> U, V", w, h);
+
+        Test_Guard(&buffers);
+        csc_interleave_memcpy(buffers.ref[0], buffers.src, buffers.src + (w * h / 4), w * h / 4);
+        kernels->interleave_memcpy(buffers.out[0], buffers.src, buffers.src + (w * h / 4), w * h / 4);
+        Test_Compare(&buffers, name, "U, V -> UV", w, h);
+
+        Test_Guard(&buffers);
+        csc_deinterleave_memcpy(buffers.ref[0], buffers.ref[1], buffers.src, w * h / 2);
+        kernels->deinterleave_memcpy(buffers.out[0], buffers.out[1], buffers.src, w * h / 2);
+        Test_Compare(&buffers, name, "UV -> U, V", w, h);
+
+        Test_Free(&buffers);
+    }
+
+    for (s = 0; s < sizeof(argbSizes) / sizeof(argbSizes[0]); s++) {
+        w = argbSizes[s][0];
+        h = argbSizes[s][1];
+        chromaW = (w + 1) / 2;
+        chromaH = (h + 1) / 2;
+
+        if (Test_Alloc(&buffers, (size_t)w * h * 4, (size_t)w * h + (size_t)chromaW * chromaH * 2) != 0) {
+            printf("  out of memory\n");
+            gFailures++;
+            Test_Free(&buffers);
+            return;
+        }
+
+        Test_Guard(&buffers);
+        csc_ARGB8888_to_YUV420SP(buffers.ref[0], buffers.ref[1], buffers.src, w, h);
+        kernels->argb8888_to_yuv420sp(buffers.out[0], buffers.out[1], buffers.src, w, h);
+        Test_Compare(&buffers, name, "ARGB8888 -> YUV420SP", w, h);
+
+        /* U and V in the second buffer, one after the other */
+        Test_Guard(&buffers);
+        csc_ARGB8888_to_YUV420P(buffers.ref[0], buffers.ref[1], buffers.ref[1] + (chromaW * chromaH),
+                                buffers.src, w, h);
+        kernels->argb8888_to_yuv420p(buffers.out[0], buffers.out[1], buffers.out[1] + (chromaW * chromaH),
+                                     buffers.src, w, h);
+        Test_Compare(&buffers, name, "ARGB8888 -> YUV420P", w, h);
+
+        Test_Free(&buffers);
+    }
+
+    printf("  %-16s %s\n", name, (gFailures == failures) ? "ok" : "FAIL");
+}
+
+int main(int argc, char **argv)
+{
+    const CSC_SW_KERNELS *kernels;
+    unsigned int index;
+
+    if (argc > 1)
+        gSeed = (unsigned int)strtoul(argv[1], NULL, 0);
+
+    printf("libcsc software kernels against libswconverter, seed %u\n", gSeed);
+
+    Test_Kernels(csc_get_sw_kernels_c(), csc_get_sw_kernels_c()->name);
+    for (index = 0; (kernels = csc_get_sw_kernels_isa(index)) != NULL; index++)
+        Test_Kernels(kernels, kernels->name);
+    Test_Kernels(csc_get_sw_kernels(), "selected");
+    printf("  selected is %s\n", csc_get_sw_kernels()->name);
+
+    printf("%s, %d failures\n", (gFailures == 0) ? "PASS" : "FAIL", gFailures);
+
+    return (gFailures == 0) ? 0 : 1;
+}
@@ -83,3 +83,35 @@ LOCAL_MODULE_TAGS := eng
 LOCAL_MODULE := libdisplay
 include $(BUILD_SHARED_LIBRARY)
 
+
+# Host simulation of the primary display planning, see sim/ExynosHWCSim.cpp
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS += -DLOG_TAG=\"hwcsim\"
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/sim \
+	$(LOCAL_PATH)/../include \
+	$(LOCAL_PATH)/../libhwc \
+	$(LOCAL_PATH)/../libhwcutils \
+	$(LOCAL_PATH) \
+	$(TOP)/hardware/samsung_slsi-cm/$(TARGET_BOARD_PLATFORM)/include \
+	$(TOP)/hardware/samsung_slsi-cm/exynos/libexynosutils \
+	$(TOP)/hardware/samsung_slsi-cm/exynos/libmpp
+
+LOCAL_SRC_FILES := \
+	ExynosDisplay.cpp \
+	ExynosOverlayDisplay.cpp \
+	../libhwcutils/ExynosHWCUtils.cpp \
+	../libhwcutils/ExynosMPP.cpp \
+	../libhwcutils/ExynosBufferPool.cpp \
+	../libhwcutils/ExynosDamageTracker.cpp \
+	../libexynosutils/exynos_format_v4l2.c \
+	sim/ExynosMPPModule.cpp \
+	sim/ExynosHWCSimStubs.cpp \
+	sim/ExynosHWCSim.cpp
+
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := exynos_hwc_sim
+include $(BUILD_HOST_EXECUTABLE)
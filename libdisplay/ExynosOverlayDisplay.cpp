@@ -18,6 +18,19 @@ ExynosOverlayDisplay::ExynosOverlayDisplay(int numMPPs, struct exynos5_hwc_compo
 
     mOtfMode = OTF_OFF;
     this->mHwc = pdev;
+
+    memset(&mPlanCache, 0, sizeof(mPlanCache));
+    mPlanCacheLookups = 0;
+    mPlanCacheHits = 0;
+
+    mPrepareCount = 0;
+    mPrepareTotalTime = 0;
+    mPrepareMaxTime = 0;
+
+    mSetCount = 0;
+    mSetTotalTime = 0;
+    mSetMaxTime = 0;
+    mFenceWaitTime = 0;
 }
 
 ExynosOverlayDisplay::~ExynosOverlayDisplay()
@@ -110,6 +123,8 @@ bool ExynosOverlayDisplay::isOverlaySupported(hwc_layer_1_t &layer, size_t i)
 
 int ExynosOverlayDisplay::prepare(hwc_display_contents_1_t* contents)
 {
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+
     ALOGV("preparing %u layers for FIMD", contents->numHwLayers);
 
     memset(mPostData.gsc_map, 0, sizeof(mPostData.gsc_map));
@@ -169,9 +184,25 @@ int ExynosOverlayDisplay::prepare(hwc_display_contents_1_t* contents)
     SKIP_G2D_OVERLAY:
 #endif
 
-        determineYuvOverlay(contents);
-        determineSupportedOverlays(contents);
-        determineBandwidthSupport(contents);
+        /*
+         * Reuse the last plan when nothing it depends on has changed,
+         * only the window/GSC assignment is redone every frame.
+         */
+        bool planCached = false;
+        makePlanKey(contents, mPlanKey);
+        if (mHwc->hwc_ctrl.plan_cache_mode &&
+                !(contents->flags & HWC_GEOMETRY_CHANGED)) {
+            mPlanCacheLookups++;
+            planCached = restorePlan(contents);
+        }
+
+        if (!planCached) {
+            int totPixels = mHwc->totPixels;
+            determineYuvOverlay(contents);
+            determineSupportedOverlays(contents);
+            determineBandwidthSupport(contents);
+            storePlan(contents, mHwc->totPixels - totPixels);
+        }
         assignWindows(contents);
     } while (mRetry);
 
@@ -212,10 +243,12 @@ CHANGE_COMPOS_MODE:
     }
 #endif
 
-    if (mPopupPlayYuvContents)
+    if (mPopupPlayYuvContents) {
         mVirtualOverlayFlag = 0;
-    else
+        mDamageTracker.reset();
+    } else {
         skipStaticLayers(contents);
+    }
     if (mVirtualOverlayFlag)
         mFbNeeded = 0;
 
@@ -225,6 +258,19 @@ CHANGE_COMPOS_MODE:
         if (mPopupPlayYuvContents)
             mPostData.fb_window = 1;
 
+    nsecs_t prepareTime = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+    mPrepareCount++;
+    mPrepareTotalTime += prepareTime;
+    mPrepareMaxTime = max(mPrepareMaxTime, prepareTime);
+
+    if (mFbNeeded)
+        ALOGV("prepared %u layers: fb [%u, %u], %d gsc layers, %lld us",
+                contents->numHwLayers, mFirstFb, mLastFb, mGscLayers,
+                (long long)ns2us(prepareTime));
+    else
+        ALOGV("prepared %u layers: no fb, %d gsc layers, %lld us",
+                contents->numHwLayers, mGscLayers, (long long)ns2us(prepareTime));
+
     return 0;
 }
 
@@ -356,8 +402,10 @@ void ExynosOverlayDisplay::configureOverlay(hwc_layer_1_t *layer, fb_win_config
         return;
     }
     if ((layer->acquireFenceFd >= 0) && this->mForceFbYuvLayer) {
+        nsecs_t waitStart = systemTime(SYSTEM_TIME_MONOTONIC);
         if (sync_wait(layer->acquireFenceFd, 1000) < 0)
             ALOGE("sync_wait error");
+        mFenceWaitTime += systemTime(SYSTEM_TIME_MONOTONIC) - waitStart;
         close(layer->acquireFenceFd);
         layer->acquireFenceFd = -1;
     }
@@ -514,6 +562,8 @@ int ExynosOverlayDisplay::set(hwc_display_contents_1_t* contents)
         }
     }
 
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    mFenceWaitTime = 0;
     int fence;
     if (!err) {
         fence = postFrame(contents);
@@ -554,25 +604,20 @@ int ExynosOverlayDisplay::set(hwc_display_contents_1_t* contents)
     }
     contents->retireFenceFd = fence;
 
+    nsecs_t setTime = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+    mSetCount++;
+    mSetTotalTime += setTime;
+    mSetMaxTime = max(mSetMaxTime, setTime);
+
     return err;
 }
 
 int ExynosOverlayDisplay::getCompModeSwitch()
 {
-    unsigned int tot_win_size = 0, updateFps = 0;
     unsigned int lcd_size = this->mXres * this->mYres;
-    uint64_t TimeStampDiff;
-    float Temp;
+    int modeSwitch = 0;
 
     if (!mHwc->hwc_ctrl.dynamic_recomp_mode) {
-        mHwc->LastModeSwitchTimeStamp = 0;
-        mHwc->CompModeSwitch = NO_MODE_SWITCH;
-        return 0;
-    }
-
-    /* initialize the Timestamps */
-    if (!mHwc->LastModeSwitchTimeStamp) {
-        mHwc->LastModeSwitchTimeStamp = mHwc->LastUpdateTimeStamp;
         mHwc->CompModeSwitch = NO_MODE_SWITCH;
         return 0;
     }
@@ -580,68 +625,48 @@ int ExynosOverlayDisplay::getCompModeSwitch()
     /* If video layer is there, skip the mode switch */
     for (size_t i = 0; i < NUM_HW_WINDOWS; i++) {
         if (this->mLastGscMap[i].mode != exynos5_gsc_map_t::GSC_NONE) {
-            if (mHwc->CompModeSwitch != HWC_2_GLES) {
-                return 0;
-            } else {
-                mHwc->CompModeSwitch = GLES_2_HWC;
-                mHwc->updateCallCnt = 0;
-                mHwc->LastModeSwitchTimeStamp = mHwc->LastUpdateTimeStamp;
+            if (mHwc->CompModeSwitch == HWC_2_GLES) {
                 //ALOGI("[DYNAMIC_RECOMP] GLES_2_HWC by video layer");
-                return GLES_2_HWC;
+                modeSwitch = GLES_2_HWC;
             }
+            goto out;
         }
     }
 
     /* Mode Switch is not required if total pixels are not more than the threshold */
     if ((uint32_t)mHwc->totPixels <= lcd_size * HWC_FIMD_BW_TH) {
-        if (mHwc->CompModeSwitch != HWC_2_GLES) {
-            return 0;
-        } else {
-            mHwc->CompModeSwitch = GLES_2_HWC;
-            mHwc->updateCallCnt = 0;
-            mHwc->LastModeSwitchTimeStamp = mHwc->LastUpdateTimeStamp;
+        if (mHwc->CompModeSwitch == HWC_2_GLES) {
             //ALOGI("[DYNAMIC_RECOMP] GLES_2_HWC by BW check");
-            return GLES_2_HWC;
+            modeSwitch = GLES_2_HWC;
         }
+        goto out;
     }
 
-    /*
-     * There will be at least one composition call per one minute (because of time update)
-     * To minimize the analysis overhead, just analyze it once in a second
-     */
-    TimeStampDiff = systemTime(SYSTEM_TIME_MONOTONIC) - mHwc->LastModeSwitchTimeStamp;
-
-    /* check fps every 250ms from LastModeSwitchTimeStamp*/
-    if (TimeStampDiff < (VSYNC_INTERVAL * 15)) {
-        return 0;
-    }
-    mHwc->LastModeSwitchTimeStamp = mHwc->LastUpdateTimeStamp;
-    Temp = (VSYNC_INTERVAL * 60) / TimeStampDiff;
-    updateFps = (int)(mHwc->updateCallCnt * Temp + 0.5);
-    mHwc->updateCallCnt = 0;
     /*
      * FPS estimation.
+     * updateFps is an exponentially weighted rate kept by exynos5_prepare(),
+     * and is cleared by the update_stat thread once the screen has been
+     * static for a whole idle interval.
      * If FPS is lower than HWC_FPS_TH, try to switch the mode to GLES
      */
-    if (updateFps < HWC_FPS_TH) {
+    if (mHwc->updateFps < HWC_FPS_TH) {
         if (mHwc->CompModeSwitch != HWC_2_GLES) {
-            mHwc->CompModeSwitch = HWC_2_GLES;
-            //ALOGI("[DYNAMIC_RECOMP] HWC_2_GLES by low FPS(%d)", updateFps);
-            return HWC_2_GLES;
-        } else {
-            return 0;
+            //ALOGI("[DYNAMIC_RECOMP] HWC_2_GLES by low FPS(%.1f)", mHwc->updateFps);
+            modeSwitch = HWC_2_GLES;
         }
     } else {
-         if (mHwc->CompModeSwitch == HWC_2_GLES) {
-            mHwc->CompModeSwitch = GLES_2_HWC;
-            //ALOGI("[DYNAMIC_RECOMP] GLES_2_HWC by high FPS(%d)", updateFps);
-            return GLES_2_HWC;
-        } else {
-            return 0;
+        if (mHwc->CompModeSwitch == HWC_2_GLES) {
+            //ALOGI("[DYNAMIC_RECOMP] GLES_2_HWC by high FPS(%.1f)", mHwc->updateFps);
+            modeSwitch = GLES_2_HWC;
         }
     }
 
-    return 0;
+out:
+    if (modeSwitch) {
+        mHwc->CompModeSwitch = modeSwitch;
+        mHwc->mode_switch_cnt++;
+    }
+    return modeSwitch;
 }
 
 int32_t ExynosOverlayDisplay::getDisplayAttributes(const uint32_t attribute)
@@ -670,20 +695,13 @@ int32_t ExynosOverlayDisplay::getDisplayAttributes(const uint32_t attribute)
 
 void ExynosOverlayDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
 {
-    static int init_flag = 0;
     int last_ovly_lay_idx = -1;
 
     mVirtualOverlayFlag = 0;
     mLastOverlayWindowIndex = -1;
 
-    if (!mHwc->hwc_ctrl.skip_static_layer_mode)
-        return;
-
-    if (mBypassSkipStaticLayer)
-        return;
-
-    if (contents->flags & HWC_GEOMETRY_CHANGED) {
-        init_flag = 0;
+    if (!mHwc->hwc_ctrl.skip_static_layer_mode || mBypassSkipStaticLayer) {
+        mDamageTracker.reset();
         return;
     }
 
@@ -694,42 +712,22 @@ void ExynosOverlayDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
         }
     }
 
-    if ((last_ovly_lay_idx == -1) || !mFbNeeded ||
-        ((mLastFb - mFirstFb + 1) > NUM_VIRT_OVER)) {
-        init_flag = 0;
+    if ((last_ovly_lay_idx == -1) || !mFbNeeded) {
+        mDamageTracker.reset();
         return;
     }
     mLastOverlayLayerIndex = last_ovly_lay_idx;
 
-    if (init_flag == 1) {
-        for (size_t i = mFirstFb; i <= mLastFb; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (!layer.handle || (layer.flags & HWC_SKIP_LAYER) || (mLastLayerHandles[i - mFirstFb] !=  layer.handle)) {
-                init_flag = 0;
-                return;
-            }
-        }
-
-        mVirtualOverlayFlag = 1;
-        for (size_t i = 0; i < contents->numHwLayers-1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (layer.compositionType == HWC_FRAMEBUFFER)
-                layer.compositionType = HWC_OVERLAY;
-        }
-        mLastFbWindow = mPostData.fb_window;
+    if (!mDamageTracker.isFbStatic(contents, mFirstFb, mLastFb))
         return;
-    }
 
-    init_flag = 1;
-    for (size_t i = 0; i < NUM_VIRT_OVER; i++)
-        mLastLayerHandles[i] = 0;
-
-    for (size_t i = mFirstFb; i <= mLastFb; i++) {
+    mVirtualOverlayFlag = 1;
+    for (size_t i = 0; i < contents->numHwLayers-1; i++) {
         hwc_layer_1_t &layer = contents->hwLayers[i];
-        mLastLayerHandles[i - mFirstFb] = layer.handle;
+        if (layer.compositionType == HWC_FRAMEBUFFER)
+            layer.compositionType = HWC_OVERLAY;
     }
-
-    return;
+    mLastFbWindow = mPostData.fb_window;
 }
 
 void ExynosOverlayDisplay::forceYuvLayersToFb(hwc_display_contents_1_t *contents)
@@ -863,61 +861,92 @@ void ExynosOverlayDisplay::determineSupportedOverlays(hwc_display_contents_1_t *
     }
 }
 
+/*
+ * Windows accepted so far on each FIMD DMA channel. Each accepted layer or the
+ * framebuffer adds one rect, so fixed arrays are enough and a planning pass
+ * never allocates.
+ */
+#define BW_PLAN_MAX_RECTS       (NUM_HW_WINDOWS + 1)
+#define BW_PLAN_MAX_OVERLAPS    (BW_PLAN_MAX_RECTS * (BW_PLAN_MAX_RECTS - 1) / 2)
+
+struct bandwidth_plan {
+    uint32_t    pixel_used[MAX_NUM_FIMD_DMA_CH];
+    hwc_rect_t  rects[MAX_NUM_FIMD_DMA_CH][BW_PLAN_MAX_RECTS];
+    size_t      num_rects[MAX_NUM_FIMD_DMA_CH];
+    hwc_rect_t  overlaps[MAX_NUM_FIMD_DMA_CH][BW_PLAN_MAX_OVERLAPS];
+    size_t      num_overlaps[MAX_NUM_FIMD_DMA_CH];
+    uint32_t    win_idx;
+    size_t      windows_left;
+    bool        gsc_used;
+    int         gsc_layers;
+};
+
 void ExynosOverlayDisplay::determineBandwidthSupport(hwc_display_contents_1_t *contents)
 {
-    // Incrementally try to add our supported layers to hardware windows.
-    // If adding a layer would violate a hardware constraint, force it
-    // into the framebuffer and try again.  (Revisiting the entire list is
-    // necessary because adding a layer to the framebuffer can cause other
-    // windows to retroactively violate constraints.)
-    bool changed;
+    // Add our supported layers to hardware windows in order. If adding a
+    // layer would violate a hardware constraint, force it into the
+    // framebuffer. Growing the framebuffer range can retroactively
+    // invalidate the windows placed after mFirstFb, but never the ones
+    // before it, so planning resumes from a snapshot taken at mFirstFb.
+    // Only a move of mFirstFb itself restarts from the first layer.
+    // The decisions are the same as re-running the whole list, which is
+    // what happens with bw_plan_resume_mode off.
+    struct bandwidth_plan plan;
+    struct bandwidth_plan fb_plan;
+    bool fb_plan_valid = false;
+    bool restart = true;
+    size_t i = 0;
     this->mBypassSkipStaticLayer = false;
 
-    uint32_t pixel_used[MAX_NUM_FIMD_DMA_CH];
-    do {
-        android::Vector<hwc_rect> rects[MAX_NUM_FIMD_DMA_CH];
-        android::Vector<hwc_rect> overlaps[MAX_NUM_FIMD_DMA_CH];
+    while (true) {
         int dma_ch_idx;
-        uint32_t win_idx = 0;
-        size_t windows_left;
-        memset(&pixel_used[0], 0, sizeof(pixel_used));
-        mGscUsed = false;
-
-        if (mFbNeeded) {
-            hwc_rect_t fb_rect;
-            fb_rect.top = fb_rect.left = 0;
-            fb_rect.right = this->mXres - 1;
-            fb_rect.bottom = this->mYres - 1;
-            dma_ch_idx = FIMD_DMA_CH_IDX[mFirstFb];
-            pixel_used[dma_ch_idx] = (uint32_t) (this->mXres * this->mYres);
-            win_idx = (win_idx == mFirstFb) ? (win_idx + 1) : win_idx;
+
+        if (restart) {
+            memset(&plan, 0, sizeof(plan));
+            fb_plan_valid = false;
+            restart = false;
+            i = 0;
+
+            if (mFbNeeded) {
+                hwc_rect_t fb_rect;
+                fb_rect.top = fb_rect.left = 0;
+                fb_rect.right = this->mXres - 1;
+                fb_rect.bottom = this->mYres - 1;
+                dma_ch_idx = FIMD_DMA_CH_IDX[mFirstFb];
+                plan.pixel_used[dma_ch_idx] = (uint32_t) (this->mXres * this->mYres);
+                plan.win_idx = (plan.win_idx == mFirstFb) ? (plan.win_idx + 1) : plan.win_idx;
 #ifdef USE_FB_PHY_LINEAR
-            windows_left = 1;
+                plan.windows_left = 1;
 #ifdef G2D_COMPOSITION
-            if (this->mG2dComposition)
-            windows_left = NUM_HW_WIN_FB_PHY - 1;
+                if (this->mG2dComposition)
+                    plan.windows_left = NUM_HW_WIN_FB_PHY - 1;
 #endif
 #else
-            windows_left = NUM_HW_WINDOWS - 1;
+                plan.windows_left = NUM_HW_WINDOWS - 1;
 #endif
-            rects[dma_ch_idx].push_back(fb_rect);
-        }
-        else {
+                plan.rects[dma_ch_idx][plan.num_rects[dma_ch_idx]++] = fb_rect;
+            }
+            else {
 #ifdef USE_FB_PHY_LINEAR
-            windows_left = 1;
+                plan.windows_left = 1;
 #ifdef G2D_COMPOSITION
-            if (this->mG2dComposition)
-                windows_left = NUM_HW_WIN_FB_PHY;
+                if (this->mG2dComposition)
+                    plan.windows_left = NUM_HW_WIN_FB_PHY;
 #endif
 #else
-            windows_left = NUM_HW_WINDOWS;
+                plan.windows_left = NUM_HW_WINDOWS;
 #endif
+            }
         }
 
-        changed = false;
-        mGscLayers = 0;
+        bool changed = false;
         mCurrentGscIndex = 0;
-        for (size_t i = 0; i < contents->numHwLayers; i++) {
+        for (; i < contents->numHwLayers; i++) {
+            if (mFbNeeded && i == mFirstFb && !fb_plan_valid) {
+                fb_plan = plan;
+                fb_plan_valid = true;
+            }
+
             hwc_layer_1_t &layer = contents->hwLayers[i];
             if ((layer.flags & HWC_SKIP_LAYER) ||
                     layer.compositionType == HWC_FRAMEBUFFER_TARGET)
@@ -933,10 +962,10 @@ void ExynosOverlayDisplay::determineBandwidthSupport(hwc_display_contents_1_t *c
             // only layer 0 can be HWC_BACKGROUND, so we can
             // unconditionally allow it without extra checks
             if (layer.compositionType == HWC_BACKGROUND) {
-                windows_left--;
+                plan.windows_left--;
                 continue;
             }
-            dma_ch_idx = FIMD_DMA_CH_IDX[win_idx];
+            dma_ch_idx = FIMD_DMA_CH_IDX[plan.win_idx];
 
             size_t pixels_needed = 0;
             if (getDrmMode(handle->flags) != SECURE_DRM)
@@ -945,16 +974,16 @@ void ExynosOverlayDisplay::determineBandwidthSupport(hwc_display_contents_1_t *c
                 pixels_needed = WIDTH(layer.displayFrame) *
                     HEIGHT(layer.displayFrame);
 
-            bool can_compose = windows_left && (win_idx < NUM_HW_WINDOWS) &&
-                            ((pixel_used[dma_ch_idx] + pixels_needed) <=
+            bool can_compose = plan.windows_left && (plan.win_idx < NUM_HW_WINDOWS) &&
+                            ((plan.pixel_used[dma_ch_idx] + pixels_needed) <=
                             (uint32_t)this->mDmaChannelMaxBandwidth[dma_ch_idx]);
             int gsc_index = getMPPForUHD(layer);
 
             bool gsc_required = mMPPs[gsc_index]->isProcessingRequired(layer, handle->format);
             if (gsc_required) {
-                if (mGscLayers >= MAX_VIDEO_LAYERS)
-                    can_compose = can_compose && !mGscUsed;
-                if (mHwc->hwc_ctrl.num_of_video_ovly <= mGscLayers)
+                if (plan.gsc_layers >= MAX_VIDEO_LAYERS)
+                    can_compose = can_compose && !plan.gsc_used;
+                if (mHwc->hwc_ctrl.num_of_video_ovly <= plan.gsc_layers)
                     can_compose = false;
             }
 
@@ -963,16 +992,19 @@ void ExynosOverlayDisplay::determineBandwidthSupport(hwc_display_contents_1_t *c
             hwc_rect_t visible_rect = layer.displayFrame;
             visible_rect.right--; visible_rect.bottom--;
 
+            const hwc_rect_t *rects = plan.rects[dma_ch_idx];
+            size_t num_rects = plan.num_rects[dma_ch_idx];
+
             if (can_compose) {
                 switch (this->mDmaChannelMaxOverlapCount[dma_ch_idx]) {
                 case 1: // It means, no layer overlap is allowed
-                    for (size_t j = 0; j < rects[dma_ch_idx].size(); j++)
-                         if (intersect(visible_rect, rects[dma_ch_idx].itemAt(j)))
+                    for (size_t j = 0; j < num_rects; j++)
+                         if (intersect(visible_rect, rects[j]))
                             can_compose = false;
                     break;
                 case 2: //It means, upto 2 layer overlap is allowed.
-                    for (size_t j = 0; j < overlaps[dma_ch_idx].size(); j++)
-                        if (intersect(visible_rect, overlaps[dma_ch_idx].itemAt(j)))
+                    for (size_t j = 0; j < plan.num_overlaps[dma_ch_idx]; j++)
+                        if (intersect(visible_rect, plan.overlaps[dma_ch_idx][j]))
                             can_compose = false;
                     break;
                 default:
@@ -987,39 +1019,204 @@ void ExynosOverlayDisplay::determineBandwidthSupport(hwc_display_contents_1_t *c
                 if (!mFbNeeded) {
                     mFirstFb = mLastFb = i;
                     mFbNeeded = true;
+                    restart = true;
                 }
                 else {
+                    if (i < mFirstFb)
+                        restart = true;
                     mFirstFb = min(i, mFirstFb);
                     mLastFb = max(i, mLastFb);
                 }
                 changed = true;
-                mFirstFb = min(mFirstFb, (size_t)NUM_HW_WINDOWS-1);
+                if (mFirstFb > (size_t)NUM_HW_WINDOWS-1) {
+                    mFirstFb = (size_t)NUM_HW_WINDOWS-1;
+                    restart = true;
+                }
                 break;
             }
 
-            for (size_t j = 0; j < rects[dma_ch_idx].size(); j++) {
-                const hwc_rect_t &other_rect = rects[dma_ch_idx].itemAt(j);
-                if (intersect(visible_rect, other_rect))
-                    overlaps[dma_ch_idx].push_back(intersection(visible_rect, other_rect));
+            for (size_t j = 0; j < num_rects; j++) {
+                if (intersect(visible_rect, rects[j]) &&
+                        plan.num_overlaps[dma_ch_idx] < BW_PLAN_MAX_OVERLAPS)
+                    plan.overlaps[dma_ch_idx][plan.num_overlaps[dma_ch_idx]++] =
+                        intersection(visible_rect, rects[j]);
             }
 
-            rects[dma_ch_idx].push_back(visible_rect);
-            pixel_used[dma_ch_idx] += pixels_needed;
-            win_idx++;
-            win_idx = (win_idx == mFirstFb) ? (win_idx + 1) : win_idx;
-            win_idx = min(win_idx, static_cast<uint32_t>(NUM_HW_WINDOWS - 1));
-            windows_left--;
+            if (num_rects < BW_PLAN_MAX_RECTS)
+                plan.rects[dma_ch_idx][plan.num_rects[dma_ch_idx]++] = visible_rect;
+            plan.pixel_used[dma_ch_idx] += pixels_needed;
+            plan.win_idx++;
+            plan.win_idx = (plan.win_idx == mFirstFb) ? (plan.win_idx + 1) : plan.win_idx;
+            plan.win_idx = min(plan.win_idx, static_cast<uint32_t>(NUM_HW_WINDOWS - 1));
+            plan.windows_left--;
             if (gsc_required) {
-                mGscUsed = true;
-                mGscLayers++;
+                plan.gsc_used = true;
+                plan.gsc_layers++;
             }
         }
 
-        if (changed)
-            for (size_t i = mFirstFb; i < mLastFb; i++)
-                contents->hwLayers[i].compositionType = HWC_FRAMEBUFFER;
+        mGscUsed = plan.gsc_used;
+        mGscLayers = plan.gsc_layers;
+
+        if (!changed) {
+            handleTotalBandwidthOverload(contents);
+            break;
+        }
+
+        for (size_t j = mFirstFb; j < mLastFb; j++)
+            contents->hwLayers[j].compositionType = HWC_FRAMEBUFFER;
+
+        // the overload handler may rework any layer; resume only when it
+        // left the layers in front of the framebuffer alone
+        int32_t types_before_fb[NUM_HW_WINDOWS];
+        size_t first_fb = mFirstFb;
+        for (size_t j = 0; j < first_fb; j++)
+            types_before_fb[j] = contents->hwLayers[j].compositionType;
+
         handleTotalBandwidthOverload(contents);
-    } while(changed);
+
+        if (!mFbNeeded || mFirstFb != first_fb)
+            restart = true;
+        for (size_t j = 0; j < first_fb && !restart; j++)
+            if (contents->hwLayers[j].compositionType != types_before_fb[j])
+                restart = true;
+
+        if (!restart) {
+            if (fb_plan_valid && mHwc->hwc_ctrl.bw_plan_resume_mode) {
+                plan = fb_plan;
+                i = mFirstFb;
+            } else {
+                restart = true;
+            }
+        }
+    }
+}
+
+void ExynosOverlayDisplay::makePlanKey(hwc_display_contents_1_t *contents, overlay_plan_key_t &key)
+{
+    memset(&key, 0, sizeof(key));
+    key.numHwLayers = contents->numHwLayers;
+    if (key.numHwLayers > MAX_PLAN_CACHE_LAYERS)
+        return;
+
+    key.geometryChanged = !!(contents->flags & HWC_GEOMETRY_CHANGED);
+    key.forceFb = mForceFb;
+#ifdef G2D_COMPOSITION
+    key.g2dComposition = mG2dComposition;
+#endif
+    key.hdmiHpd = mHwc->hdmi_hpd;
+    key.s3dMode = mHwc->mS3DMode;
+    key.compModeSwitch = mHwc->CompModeSwitch;
+    key.dynamicRecompMode = mHwc->hwc_ctrl.dynamic_recomp_mode;
+    key.numVideoOvly = mHwc->hwc_ctrl.num_of_video_ovly;
+    key.maxHwOverlays = property_get_int32("debug.hwc.max_hw_overlays", contents->numHwLayers);
+
+    for (size_t i = 0; i < contents->numHwLayers; i++) {
+        hwc_layer_1_t &layer = contents->hwLayers[i];
+        overlay_plan_layer_t &l = key.layers[i];
+
+        /* other types are what we returned for the previous frame */
+        if (layer.compositionType == HWC_FRAMEBUFFER_TARGET ||
+                layer.compositionType == HWC_BACKGROUND)
+            l.type = layer.compositionType;
+        else
+            l.type = -1;
+        l.flags = layer.flags;
+        l.displayFrame = layer.displayFrame;
+        l.sourceCropf = layer.sourceCropf;
+        l.transform = layer.transform;
+        l.blending = layer.blending;
+        l.planeAlpha = layer.planeAlpha;
+        if (layer.handle) {
+            private_handle_t *handle = private_handle_t::dynamicCast(layer.handle);
+            l.hasHandle = 1;
+            l.format = handle->format;
+            l.handleFlags = handle->flags;
+            l.stride = handle->stride;
+            l.vstride = handle->vstride;
+        }
+    }
+
+    /* FNV-1a, lets a changed stack miss without a full compare */
+    const uint8_t *p = (const uint8_t *)&key.numHwLayers;
+    const uint8_t *end = (const uint8_t *)&key.layers[key.numHwLayers];
+    uint32_t hash = 2166136261u;
+    while (p < end)
+        hash = (hash ^ *p++) * 16777619u;
+    key.hash = hash;
+}
+
+bool ExynosOverlayDisplay::restorePlan(hwc_display_contents_1_t *contents)
+{
+    overlay_plan_t &plan = mPlanCache;
+
+    if (!plan.valid || mPlanKey.numHwLayers > MAX_PLAN_CACHE_LAYERS ||
+            plan.key.hash != mPlanKey.hash ||
+            plan.key.numHwLayers != mPlanKey.numHwLayers ||
+            memcmp(&plan.key, &mPlanKey,
+                (const char *)&mPlanKey.layers[mPlanKey.numHwLayers] - (const char *)&mPlanKey))
+        return false;
+
+    for (size_t i = 0; i < contents->numHwLayers; i++)
+        contents->hwLayers[i].compositionType = plan.compositionType[i];
+
+    for (size_t i = 0; i < NUM_HW_WINDOWS; i++)
+        mPostData.overlay_map[i] = -1;
+
+    /* plans with DRM or popup video are never stored */
+    mPopupPlayYuvContents = false;
+    mHasDrmSurface = false;
+    mForceOverlayLayerIndex = plan.forceOverlayLayerIndex;
+    mYuvLayers = plan.yuvLayers;
+    mHasCropSurface = plan.hasCropSurface;
+    mForceFb = plan.forceFb;
+    mFbNeeded = plan.fbNeeded;
+    mFirstFb = plan.firstFb;
+    mLastFb = plan.lastFb;
+    mBypassSkipStaticLayer = plan.bypassSkipStaticLayer;
+    mGscUsed = plan.gscUsed;
+    mGscLayers = plan.gscLayers;
+    mCurrentGscIndex = 0;
+    mHwc->mS3DMode = plan.s3dMode;
+    mHwc->totPixels += plan.totPixels;
+
+    mPlanCacheHits++;
+    return true;
+}
+
+void ExynosOverlayDisplay::storePlan(hwc_display_contents_1_t *contents, int totPixels)
+{
+    overlay_plan_t &plan = mPlanCache;
+
+    /*
+     * DRM layers get their crop adjusted in place while being checked,
+     * popup video and G2D composition keep extra state, so plan them
+     * every frame.
+     */
+    plan.valid = (contents->numHwLayers <= MAX_PLAN_CACHE_LAYERS) &&
+                 !mHasDrmSurface && !mPopupPlayYuvContents;
+#ifdef G2D_COMPOSITION
+    plan.valid = plan.valid && !mG2dComposition;
+#endif
+    if (!plan.valid)
+        return;
+
+    memcpy(&plan.key, &mPlanKey, sizeof(plan.key));
+    for (size_t i = 0; i < contents->numHwLayers; i++)
+        plan.compositionType[i] = contents->hwLayers[i].compositionType;
+
+    plan.forceOverlayLayerIndex = mForceOverlayLayerIndex;
+    plan.yuvLayers = mYuvLayers;
+    plan.hasCropSurface = mHasCropSurface;
+    plan.forceFb = mForceFb;
+    plan.fbNeeded = mFbNeeded;
+    plan.firstFb = mFirstFb;
+    plan.lastFb = mLastFb;
+    plan.bypassSkipStaticLayer = mBypassSkipStaticLayer;
+    plan.gscUsed = mGscUsed;
+    plan.gscLayers = mGscLayers;
+    plan.s3dMode = mHwc->mS3DMode;
+    plan.totPixels = totPixels;
 }
 
 void ExynosOverlayDisplay::assignWindows(hwc_display_contents_1_t *contents)
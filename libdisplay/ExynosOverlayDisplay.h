@@ -3,6 +3,7 @@
 
 #include "ExynosHWC.h"
 #include "ExynosDisplay.h"
+#include "ExynosDamageTracker.h"
 
 #ifndef V4L2_DV_1080P60
 #define V4L2_DV_1080P60 18
@@ -14,6 +15,58 @@
 
 class ExynosMPPModule;
 
+#define MAX_PLAN_CACHE_LAYERS   32
+
+/* Everything of a layer that the overlay plan depends on */
+typedef struct overlay_plan_layer {
+    int32_t         type;           /* FRAMEBUFFER_TARGET, BACKGROUND or other */
+    uint32_t        flags;
+    hwc_rect_t      displayFrame;
+    hwc_frect_t     sourceCropf;
+    uint32_t        transform;
+    int32_t         blending;
+    int32_t         planeAlpha;
+    int32_t         hasHandle;
+    int32_t         format;
+    int32_t         handleFlags;
+    int32_t         stride;
+    int32_t         vstride;
+} overlay_plan_layer_t;
+
+typedef struct overlay_plan_key {
+    uint32_t        hash;
+    size_t          numHwLayers;
+    int32_t         geometryChanged;
+    int32_t         forceFb;
+    int32_t         g2dComposition;
+    int32_t         hdmiHpd;
+    int32_t         s3dMode;
+    int32_t         compModeSwitch;
+    int32_t         dynamicRecompMode;
+    int32_t         numVideoOvly;
+    int32_t         maxHwOverlays;
+    overlay_plan_layer_t layers[MAX_PLAN_CACHE_LAYERS];
+} overlay_plan_key_t;
+
+/* Result of determineYuvOverlay/SupportedOverlays/BandwidthSupport */
+typedef struct overlay_plan {
+    bool            valid;
+    overlay_plan_key_t key;
+    int32_t         compositionType[MAX_PLAN_CACHE_LAYERS];
+    bool            fbNeeded;
+    size_t          firstFb;
+    size_t          lastFb;
+    bool            forceFb;
+    bool            bypassSkipStaticLayer;
+    bool            gscUsed;
+    int             gscLayers;
+    int             forceOverlayLayerIndex;
+    int             yuvLayers;
+    bool            hasCropSurface;
+    int             s3dMode;
+    int             totPixels;
+} overlay_plan_t;
+
 class ExynosOverlayDisplay : public ExynosDisplay {
     public:
         /* Methods */
@@ -55,7 +108,7 @@ class ExynosOverlayDisplay : public ExynosDisplay {
         size_t                   mLastFbWindow;
         const void               *mLastHandles[NUM_HW_WINDOWS];
         exynos5_gsc_map_t        mLastGscMap[NUM_HW_WINDOWS];
-        const void               *mLastLayerHandles[NUM_VIRT_OVER];
+        ExynosDamageTracker      mDamageTracker;
         int                      mLastOverlayWindowIndex;
         int                      mLastOverlayLayerIndex;
         int                      mVirtualOverlayFlag;
@@ -86,6 +139,23 @@ class ExynosOverlayDisplay : public ExynosDisplay {
         int                      mForceOverlayLayerIndex;
         bool                     mRetry;
 
+        overlay_plan_key_t       mPlanKey;
+        overlay_plan_t           mPlanCache;
+        uint32_t                 mPlanCacheLookups;
+        uint32_t                 mPlanCacheHits;
+
+        /* cost of prepare(), for dumpsys */
+        uint32_t                 mPrepareCount;
+        nsecs_t                  mPrepareTotalTime;
+        nsecs_t                  mPrepareMaxTime;
+
+        /* cost of set() on the composer thread, for dumpsys */
+        uint32_t                 mSetCount;
+        nsecs_t                  mSetTotalTime;
+        nsecs_t                  mSetMaxTime;
+        /* time the last set() was blocked in sync_wait() */
+        nsecs_t                  mFenceWaitTime;
+
     protected:
         /* Methods */
         void configureOtfWindow(hwc_rect_t &displayFrame,
@@ -98,6 +168,9 @@ class ExynosOverlayDisplay : public ExynosDisplay {
         void determineBandwidthSupport(hwc_display_contents_1_t *contents);
         void determineYuvOverlay(hwc_display_contents_1_t *contents);
         void assignWindows(hwc_display_contents_1_t *contents);
+        void makePlanKey(hwc_display_contents_1_t *contents, overlay_plan_key_t &key);
+        bool restorePlan(hwc_display_contents_1_t *contents);
+        void storePlan(hwc_display_contents_1_t *contents, int totPixels);
         bool assignGscLayer(hwc_layer_1_t &layer, int index, int nextWindow);
         int postGscOtf(hwc_layer_1_t &layer, fb_win_config *config, int win_map, int index);
         void handleStaticLayers(hwc_display_contents_1_t *contents, fb_win_config_data &win_data, int tot_ovly_wins);
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ANDROID_EXYNOS_HWC_MODULE_H_
+#define ANDROID_EXYNOS_HWC_MODULE_H_
+
+/*
+ * SoC module of the host simulation: a 5 window s3c-fb with 2 DMA
+ * channels and 3 GSC units. There is no kernel behind it, the fb
+ * window configuration is declared here instead of coming from s3c-fb.h.
+ *
+ * This SoC is synthetic. It is not copied from any board's libhwcmodule,
+ * and together with the 2560x1600 panel in ExynosHWCSim.cpp it is only
+ * meant to run out of windows, DMA bandwidth and GSC units on ordinary
+ * layer stacks. The decisions it prints show how the planning code
+ * behaves, not what a given device would do. Timings taken with it
+ * compare two builds of the planning code on the host and nothing more.
+ */
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <hardware/hwcomposer.h>
+
+#define VSYNC_DEV_PREFIX "/sys/devices/"
+#define VSYNC_DEV_NAME  "sim/vsync"
+
+#define FIMD_WORD_SIZE_BYTES   16
+#define FIMD_BURSTLEN   16
+
+#define SOC_NUM_HW_WINDOWS  5
+#define S3C_FB_MAX_WIN      SOC_NUM_HW_WINDOWS
+
+const int AVAILABLE_GSC_UNITS[] = { 0, 3, 1 };
+#define FIMD_GSC_IDX        0
+#define FIMD_GSC_SEC_IDX    1
+#define HDMI_GSC_IDX        2
+
+enum s3c_fb_pixel_format {
+    S3C_FB_PIXEL_FORMAT_RGBA_8888 = 0,
+    S3C_FB_PIXEL_FORMAT_RGBX_8888 = 1,
+    S3C_FB_PIXEL_FORMAT_RGBA_5551 = 2,
+    S3C_FB_PIXEL_FORMAT_RGB_565 = 3,
+    S3C_FB_PIXEL_FORMAT_BGRA_8888 = 4,
+    S3C_FB_PIXEL_FORMAT_BGRX_8888 = 5,
+    S3C_FB_PIXEL_FORMAT_MAX = 6,
+};
+
+enum s3c_fb_blending {
+    S3C_FB_BLENDING_NONE = 0,
+    S3C_FB_BLENDING_PREMULT = 1,
+    S3C_FB_BLENDING_COVERAGE = 2,
+    S3C_FB_BLENDING_MAX = 3,
+};
+
+struct s3c_fb_win_config {
+    enum {
+        S3C_FB_WIN_STATE_DISABLED = 0,
+        S3C_FB_WIN_STATE_COLOR,
+        S3C_FB_WIN_STATE_BUFFER,
+        S3C_FB_WIN_STATE_OTF,
+    } state;
+
+    union {
+        uint32_t color;
+        struct {
+            int                         fd;
+            uint32_t                    offset;
+            uint32_t                    stride;
+            enum s3c_fb_pixel_format    format;
+            enum s3c_fb_blending        blending;
+            int                         fence_fd;
+            int                         plane_alpha;
+        };
+    };
+
+    int         x;
+    int         y;
+    uint32_t    w;
+    uint32_t    h;
+};
+
+struct s3c_fb_win_config_data {
+    int                         fence;
+    struct s3c_fb_win_config    config[S3C_FB_MAX_WIN];
+};
+
+#define S3CFB_WIN_CONFIG    _IOW('F', 209, struct s3c_fb_win_config_data)
+
+typedef struct s3c_fb_win_config fb_win_config;
+typedef struct s3c_fb_win_config_data fb_win_config_data;
+
+#define WIN_STATE_COLOR     s3c_fb_win_config::S3C_FB_WIN_STATE_COLOR
+#define WIN_STATE_BUFFER    s3c_fb_win_config::S3C_FB_WIN_STATE_BUFFER
+
+#define PIXEL_FORMAT_MAX    S3C_FB_PIXEL_FORMAT_MAX
+#define BLENDING_NONE       S3C_FB_BLENDING_NONE
+#define BLENDING_MAX        S3C_FB_BLENDING_MAX
+
+inline s3c_fb_pixel_format halFormatToSocFormat(int format)
+{
+    switch (format) {
+    case HAL_PIXEL_FORMAT_RGBA_8888:
+        return S3C_FB_PIXEL_FORMAT_RGBA_8888;
+    case HAL_PIXEL_FORMAT_RGBX_8888:
+        return S3C_FB_PIXEL_FORMAT_RGBX_8888;
+    case HAL_PIXEL_FORMAT_RGB_565:
+        return S3C_FB_PIXEL_FORMAT_RGB_565;
+    case HAL_PIXEL_FORMAT_BGRA_8888:
+        return S3C_FB_PIXEL_FORMAT_BGRA_8888;
+    default:
+        return S3C_FB_PIXEL_FORMAT_MAX;
+    }
+}
+
+inline s3c_fb_blending halBlendingToSocBlending(int32_t blending)
+{
+    switch (blending) {
+    case HWC_BLENDING_NONE:
+        return S3C_FB_BLENDING_NONE;
+    case HWC_BLENDING_PREMULT:
+        return S3C_FB_BLENDING_PREMULT;
+    case HWC_BLENDING_COVERAGE:
+        return S3C_FB_BLENDING_COVERAGE;
+    default:
+        return S3C_FB_BLENDING_MAX;
+    }
+}
+
+#endif
@@ -0,0 +1,726 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host simulation of the primary display planning.
+ *
+ * Layer stacks go through ExynosOverlayDisplay::prepare() the way
+ * exynos5_prepare() drives it, and the composition type, window, GSC and
+ * FB decisions of every frame are printed with the time prepare() took.
+ * set() is not run, there is no fb behind the display; only the state
+ * postFrame() hands back to the next prepare() is carried over.
+ *
+ * usage: exynos_hwc_sim [-q] [-c] [-n frames] [-r repeat] [stack file]
+ *
+ * Without a file the built-in scenarios are run, -n frames each; a file
+ * is replayed -r times, once by default. With -c
+ * every frame is also prepared by a reference display with the plan
+ * cache off and the bandwidth plan restarted from the first layer on
+ * every change, as the planner did before it resumed at the FB. Any
+ * decision that differs is printed and fails the run. A stack
+ * file holds recorded frames, one "frame" line followed by its layers in
+ * z-order, bottom first; the FB target is added by the simulation:
+ *
+ *   # comment
+ *   frame [geometry]
+ *   layer <rgba|rgbx|bgra|rgb565|nv12|nv21|yv12> <w>x<h> \
+ *         <crop l,t,r,b> <frame l,t,r,b> [transform=N] [blending=N] \
+ *         [alpha=N] [skip] [static]
+ *
+ * Layers marked static keep their buffer, the others flip between two
+ * buffers every frame as a producer would. stacks/layer_stacks.txt holds
+ * recorded stacks of 10 to 16 layers that move the FB range.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ExynosHWC.h"
+#include "ExynosHWCUtils.h"
+#include "ExynosOverlayDisplay.h"
+#include "ExynosMPPModule.h"
+
+/* panel and per channel DMA limit of the synthetic SoC, see ExynosHWCModule.h */
+#define SIM_XRES            2560
+#define SIM_YRES            1600
+#define SIM_FPS             60
+#define SIM_DEFAULT_FRAMES  8
+#define SIM_MAX_LAYERS      (MAX_PLAN_CACHE_LAYERS - 1)
+
+struct sim_layer {
+    int             format;
+    int             width;
+    int             height;
+    hwc_frect_t     sourceCropf;
+    hwc_rect_t      displayFrame;
+    uint32_t        transform;
+    int32_t         blending;
+    uint8_t         planeAlpha;
+    uint32_t        flags;
+    bool            isStatic;
+};
+
+struct sim_frame {
+    bool            geometryChanged;
+    size_t          numLayers;
+    sim_layer       layers[SIM_MAX_LAYERS];
+};
+
+struct sim_stats {
+    uint32_t        frames;
+    uint32_t        planHits;
+    uint32_t        fbFrames;
+    uint32_t        gscLayers;
+    nsecs_t         totalTime;
+    nsecs_t         maxTime;
+};
+
+static const struct {
+    const char      *name;
+    int             format;
+} sim_formats[] = {
+    { "rgba",   HAL_PIXEL_FORMAT_RGBA_8888 },
+    { "rgbx",   HAL_PIXEL_FORMAT_RGBX_8888 },
+    { "bgra",   HAL_PIXEL_FORMAT_BGRA_8888 },
+    { "rgb565", HAL_PIXEL_FORMAT_RGB_565 },
+    { "nv12",   HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M },
+    { "nv21",   HAL_PIXEL_FORMAT_YCrCb_420_SP },
+    { "yv12",   HAL_PIXEL_FORMAT_EXYNOS_YV12_M },
+};
+
+/* what prepare() decided for a frame, as -c compares it */
+struct sim_decision {
+    int32_t         compositionType[SIM_MAX_LAYERS];
+    bool            fbNeeded;
+    size_t          firstFb;
+    size_t          lastFb;
+    size_t          fbWindow;
+    int             overlayMap[NUM_HW_WINDOWS];
+    int             gscMode[NUM_HW_WINDOWS];
+    int             gscIdx[NUM_HW_WINDOWS];
+    int             gscLayers;
+    int             virtualOverlay;
+    bool            bypassSkipStatic;
+};
+
+static bool sim_quiet;
+
+static int sim_format(const char *name)
+{
+    for (size_t i = 0; i < sizeof(sim_formats) / sizeof(sim_formats[0]); i++)
+        if (!strcmp(sim_formats[i].name, name))
+            return sim_formats[i].format;
+    return -1;
+}
+
+static const char *sim_format_name(int format)
+{
+    for (size_t i = 0; i < sizeof(sim_formats) / sizeof(sim_formats[0]); i++)
+        if (sim_formats[i].format == format)
+            return sim_formats[i].name;
+    return "?";
+}
+
+static const char *sim_composition_name(int32_t type)
+{
+    switch (type) {
+    case HWC_FRAMEBUFFER:
+        return "FB";
+    case HWC_OVERLAY:
+        return "OVERLAY";
+    case HWC_BACKGROUND:
+        return "BACKGROUND";
+    case HWC_FRAMEBUFFER_TARGET:
+        return "FB_TARGET";
+    default:
+        return "?";
+    }
+}
+
+static sim_layer *sim_add_layer(sim_frame *frame, int format, int w, int h,
+        int left, int top, int right, int bottom, bool isStatic)
+{
+    if (frame->numLayers >= SIM_MAX_LAYERS)
+        return NULL;
+
+    sim_layer *l = &frame->layers[frame->numLayers++];
+    memset(l, 0, sizeof(*l));
+    l->format = format;
+    l->width = w;
+    l->height = h;
+    l->sourceCropf.right = w;
+    l->sourceCropf.bottom = h;
+    l->displayFrame.left = left;
+    l->displayFrame.top = top;
+    l->displayFrame.right = right;
+    l->displayFrame.bottom = bottom;
+    l->blending = isFormatRgb(format) ? HWC_BLENDING_PREMULT : HWC_BLENDING_NONE;
+    l->planeAlpha = 0xff;
+    l->isStatic = isStatic;
+    return l;
+}
+
+static void sim_add_system_bars(sim_frame *frame)
+{
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBA_8888, SIM_XRES, 48,
+            0, 0, SIM_XRES, 48, false);
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBA_8888, SIM_XRES, 96,
+            0, SIM_YRES - 96, SIM_XRES, SIM_YRES, true);
+}
+
+/* wallpaper and icons do not move, only the clock in the status bar does */
+static void sim_scenario_home(sim_frame *frame)
+{
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBX_8888, SIM_XRES, SIM_YRES,
+            0, 0, SIM_XRES, SIM_YRES, true);
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBA_8888, SIM_XRES, SIM_YRES,
+            0, 0, SIM_XRES, SIM_YRES, true);
+    sim_add_system_bars(frame);
+}
+
+/* 1080p NV12 scaled up to the panel width under the player controls */
+static void sim_scenario_video(sim_frame *frame)
+{
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M, 1920, 1080,
+            0, 80, SIM_XRES, 80 + 1440, false);
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBA_8888, SIM_XRES, 240,
+            0, SIM_YRES - 336, SIM_XRES, SIM_YRES - 96, true);
+    sim_add_system_bars(frame);
+}
+
+/* portrait video on the landscape panel, rotated by the GSC */
+static void sim_scenario_rotated_video(sim_frame *frame)
+{
+    sim_layer *l = sim_add_layer(frame, HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M,
+            1088, 1920, 0, 0, SIM_XRES, SIM_YRES, false);
+    l->sourceCropf.right = 1080;
+    l->transform = HAL_TRANSFORM_ROT_90;
+}
+
+static void sim_scenario_game(sim_frame *frame)
+{
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBX_8888, SIM_XRES, SIM_YRES,
+            0, 0, SIM_XRES, SIM_YRES, false);
+    sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBA_8888, 400, 400,
+            SIM_XRES - 440, SIM_YRES - 440, SIM_XRES - 40, SIM_YRES - 40, false);
+}
+
+/* more full screen layers than windows and DMA bandwidth */
+static void sim_scenario_overload(sim_frame *frame)
+{
+    for (int i = 0; i < 7; i++)
+        sim_add_layer(frame, HAL_PIXEL_FORMAT_RGBA_8888, SIM_XRES, SIM_YRES,
+                0, 0, SIM_XRES, SIM_YRES, i < 4);
+}
+
+static const struct {
+    const char      *name;
+    void            (*build)(sim_frame *frame);
+} sim_scenarios[] = {
+    { "home",           sim_scenario_home },
+    { "video",          sim_scenario_video },
+    { "rotated-video",  sim_scenario_rotated_video },
+    { "game",           sim_scenario_game },
+    { "overload",       sim_scenario_overload },
+};
+
+static int sim_parse_layer(sim_frame *frame, const char *line)
+{
+    char format[16];
+    int w, h;
+    hwc_frect_t crop;
+    hwc_rect_t rect;
+    const char *opt;
+
+    if (sscanf(line, "layer %15s %dx%d %f,%f,%f,%f %d,%d,%d,%d", format, &w, &h,
+            &crop.left, &crop.top, &crop.right, &crop.bottom,
+            &rect.left, &rect.top, &rect.right, &rect.bottom) != 11)
+        return -1;
+
+    int halFormat = sim_format(format);
+    if (halFormat < 0)
+        return -1;
+
+    sim_layer *l = sim_add_layer(frame, halFormat, w, h,
+            rect.left, rect.top, rect.right, rect.bottom, strstr(line, " static") != NULL);
+    if (!l)
+        return -1;
+    l->sourceCropf = crop;
+    if ((opt = strstr(line, "transform=")))
+        l->transform = atoi(opt + strlen("transform="));
+    if ((opt = strstr(line, "blending=")))
+        l->blending = strtol(opt + strlen("blending="), NULL, 0);
+    if ((opt = strstr(line, "alpha=")))
+        l->planeAlpha = atoi(opt + strlen("alpha="));
+    if (strstr(line, " skip"))
+        l->flags |= HWC_SKIP_LAYER;
+    return 0;
+}
+
+static sim_frame *sim_load(const char *path, size_t *numFrames)
+{
+    FILE *fp = fopen(path, "r");
+    sim_frame *frames = NULL;
+    size_t n = 0;
+    char line[256];
+    int lineNo = 0;
+
+    if (!fp) {
+        ALOGE("%s: cannot open %s", __func__, path);
+        return NULL;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineNo++;
+        char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\0')
+            continue;
+
+        if (!strncmp(p, "frame", 5)) {
+            sim_frame *grown = (sim_frame *)realloc(frames, (n + 1) * sizeof(*frames));
+            if (!grown)
+                goto err;
+            frames = grown;
+            memset(&frames[n], 0, sizeof(frames[n]));
+            frames[n].geometryChanged = (n == 0) || strstr(p, "geometry");
+            n++;
+        } else if (!n || sim_parse_layer(&frames[n - 1], p) < 0) {
+            ALOGE("%s:%d: bad line", path, lineNo);
+            goto err;
+        }
+    }
+
+    fclose(fp);
+    *numFrames = n;
+    return frames;
+
+err:
+    free(frames);
+    fclose(fp);
+    return NULL;
+}
+
+/* two buffers per layer slot, a static layer stays on the first one */
+static private_handle_t *sim_handles[SIM_MAX_LAYERS][2];
+static private_handle_t *sim_fb_handle;
+
+static void sim_alloc_handles()
+{
+    for (size_t i = 0; i < SIM_MAX_LAYERS; i++)
+        for (size_t j = 0; j < 2; j++)
+            sim_handles[i][j] = new private_handle_t(100 + i * 2 + j, 0, 0,
+                    0, 0, 0, 0, 0);
+    sim_fb_handle = new private_handle_t(99, SIM_XRES * SIM_YRES * 4,
+            private_handle_t::PRIV_FLAGS_FRAMEBUFFER, SIM_XRES, SIM_YRES,
+            HAL_PIXEL_FORMAT_RGBA_8888, SIM_XRES, SIM_YRES);
+}
+
+static void sim_free_handles()
+{
+    for (size_t i = 0; i < SIM_MAX_LAYERS; i++)
+        for (size_t j = 0; j < 2; j++)
+            delete sim_handles[i][j];
+    delete sim_fb_handle;
+}
+
+/*
+ * Fill the contents SurfaceFlinger would hand to prepare() for frame
+ * 'index' of the stack. The composition types of the last frame are kept
+ * unless the geometry changed, as the hwcomposer contract says.
+ */
+static void sim_fill_contents(hwc_display_contents_1_t *contents,
+        const sim_frame *frame, bool geometryChanged, uint32_t index)
+{
+    contents->retireFenceFd = -1;
+    contents->flags = geometryChanged ? HWC_GEOMETRY_CHANGED : 0;
+    contents->numHwLayers = frame->numLayers + 1;
+
+    for (size_t i = 0; i < frame->numLayers; i++) {
+        const sim_layer &l = frame->layers[i];
+        hwc_layer_1_t &layer = contents->hwLayers[i];
+        private_handle_t *handle = sim_handles[i][l.isStatic ? 0 : index & 1];
+
+        handle->format = l.format;
+        handle->width = l.width;
+        handle->height = l.height;
+        handle->stride = ALIGN(l.width, 16);
+        handle->vstride = ALIGN(l.height, 16);
+        handle->size = handle->stride * handle->vstride * 4;
+
+        if (geometryChanged)
+            layer.compositionType = HWC_FRAMEBUFFER;
+        layer.hints = 0;
+        layer.flags = l.flags;
+        layer.handle = handle;
+        layer.transform = l.transform;
+        layer.blending = l.blending;
+        layer.sourceCropf = l.sourceCropf;
+        layer.displayFrame = l.displayFrame;
+        layer.visibleRegionScreen.numRects = 1;
+        layer.visibleRegionScreen.rects = &layer.displayFrame;
+        layer.acquireFenceFd = -1;
+        layer.releaseFenceFd = -1;
+        layer.planeAlpha = l.planeAlpha;
+    }
+
+    hwc_layer_1_t &target = contents->hwLayers[frame->numLayers];
+    memset(&target, 0, sizeof(target));
+    target.compositionType = HWC_FRAMEBUFFER_TARGET;
+    target.handle = sim_fb_handle;
+    target.blending = HWC_BLENDING_PREMULT;
+    target.sourceCropf.right = SIM_XRES;
+    target.sourceCropf.bottom = SIM_YRES;
+    target.displayFrame.right = SIM_XRES;
+    target.displayFrame.bottom = SIM_YRES;
+    target.visibleRegionScreen.numRects = 1;
+    target.visibleRegionScreen.rects = &target.displayFrame;
+    target.acquireFenceFd = -1;
+    target.releaseFenceFd = -1;
+    target.planeAlpha = 0xff;
+}
+
+static void sim_print_frame(ExynosOverlayDisplay *display,
+        hwc_display_contents_1_t *contents, uint32_t index, bool planHit,
+        nsecs_t prepareTime)
+{
+    printf("  frame %u%s: %lld us, plan %s, ", index,
+            (contents->flags & HWC_GEOMETRY_CHANGED) ? " (geometry)" : "",
+            (long long)ns2us(prepareTime), planHit ? "cached" : "computed");
+    if (display->mFbNeeded)
+        printf("fb [%zu, %zu] on window %zu, ", display->mFirstFb, display->mLastFb,
+                display->mPostData.fb_window);
+    else
+        printf("no fb, ");
+    printf("%d gsc layers%s\n", display->mGscLayers,
+            display->mVirtualOverlayFlag ? ", static fb skipped" : "");
+
+    for (size_t i = 0; i < contents->numHwLayers - 1; i++) {
+        hwc_layer_1_t &layer = contents->hwLayers[i];
+        private_handle_t *handle = private_handle_t::dynamicCast(layer.handle);
+
+        printf("    layer %zu %-6s %4dx%-4d [%4d,%4d,%4d,%4d] t%u: %-10s", i,
+                sim_format_name(handle->format), handle->width, handle->height,
+                layer.displayFrame.left, layer.displayFrame.top,
+                layer.displayFrame.right, layer.displayFrame.bottom,
+                layer.transform, sim_composition_name(layer.compositionType));
+        for (size_t w = 0; w < NUM_HW_WINDOWS; w++) {
+            if (display->mPostData.overlay_map[w] != (int)i)
+                continue;
+            printf(" window %zu", w);
+            exynos5_gsc_map_t &map = display->mPostData.gsc_map[w];
+            if (map.mode == exynos5_gsc_map_t::GSC_M2M)
+                printf(", gsc %d m2m", map.idx);
+            else if (map.mode == exynos5_gsc_map_t::GSC_LOCAL)
+                printf(", gsc %d local", map.idx);
+        }
+        printf("\n");
+    }
+}
+
+static ExynosOverlayDisplay *sim_new_display(exynos5_hwc_composer_device_1_t *dev)
+{
+    ExynosOverlayDisplay *display = new ExynosOverlayDisplay(NUM_GSC_UNITS, dev);
+
+    display->mDisplayFd = -1;
+    display->mXres = SIM_XRES;
+    display->mYres = SIM_YRES;
+    display->mVsyncPeriod = 1000000000 / SIM_FPS;
+    for (size_t i = 0; i < MAX_NUM_FIMD_DMA_CH; i++) {
+        display->mDmaChannelMaxBandwidth[i] = SIM_XRES * SIM_YRES;
+        display->mDmaChannelMaxOverlapCount[i] = 1;
+    }
+    memset(&display->mPostData, 0, sizeof(display->mPostData));
+    memset(display->mLastGscMap, 0, sizeof(display->mLastGscMap));
+    display->mLastFbWindow = NO_FB_NEEDED;
+
+    return display;
+}
+
+static hwc_display_contents_1_t *sim_alloc_contents(const sim_frame *frames, size_t numFrames)
+{
+    size_t maxLayers = 0;
+
+    for (size_t i = 0; i < numFrames; i++)
+        maxLayers = max(maxLayers, frames[i].numLayers + 1);
+    return (hwc_display_contents_1_t *)calloc(1,
+            sizeof(hwc_display_contents_1_t) + maxLayers * sizeof(hwc_layer_1_t));
+}
+
+/* as exynos5_prepare(), returns the time prepare() took */
+static nsecs_t sim_prepare(exynos5_hwc_composer_device_1_t *dev,
+        ExynosOverlayDisplay *display, hwc_display_contents_1_t *contents,
+        const sim_frame *frame, bool geometryChanged, uint32_t index)
+{
+    sim_fill_contents(contents, frame, geometryChanged, index);
+
+    display->getCompModeSwitch();
+    dev->totPixels = 0;
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    display->prepare(contents);
+    nsecs_t prepareTime = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+
+    /* the state postFrame() leaves for the next prepare() */
+    memcpy(display->mLastGscMap, display->mPostData.gsc_map,
+            sizeof(display->mPostData.gsc_map));
+    if (!display->mVirtualOverlayFlag)
+        display->mLastFbWindow = display->mPostData.fb_window;
+
+    return prepareTime;
+}
+
+static void sim_get_decision(ExynosOverlayDisplay *display,
+        hwc_display_contents_1_t *contents, sim_decision *d)
+{
+    memset(d, 0, sizeof(*d));
+    for (size_t i = 0; i < contents->numHwLayers - 1; i++)
+        d->compositionType[i] = contents->hwLayers[i].compositionType;
+    d->fbNeeded = display->mFbNeeded;
+    if (d->fbNeeded) {
+        d->firstFb = display->mFirstFb;
+        d->lastFb = display->mLastFb;
+        d->fbWindow = display->mPostData.fb_window;
+    }
+    for (size_t w = 0; w < NUM_HW_WINDOWS; w++) {
+        d->overlayMap[w] = display->mPostData.overlay_map[w];
+        d->gscMode[w] = display->mPostData.gsc_map[w].mode;
+        d->gscIdx[w] = display->mPostData.gsc_map[w].idx;
+    }
+    d->gscLayers = display->mGscLayers;
+    d->virtualOverlay = display->mVirtualOverlayFlag;
+    d->bypassSkipStatic = display->mBypassSkipStaticLayer;
+}
+
+/* print what differs, returns true when nothing does */
+static bool sim_same_decision(const sim_decision *ref, const sim_decision *d,
+        size_t numLayers, const char *name, uint32_t index)
+{
+    bool same = true;
+
+    for (size_t i = 0; i < numLayers; i++) {
+        if (ref->compositionType[i] != d->compositionType[i]) {
+            printf("  %s frame %u: layer %zu %s, reference %s\n", name, index, i,
+                    sim_composition_name(d->compositionType[i]),
+                    sim_composition_name(ref->compositionType[i]));
+            same = false;
+        }
+    }
+    if (ref->fbNeeded != d->fbNeeded || ref->firstFb != d->firstFb ||
+            ref->lastFb != d->lastFb || ref->fbWindow != d->fbWindow) {
+        printf("  %s frame %u: fb %d [%zu, %zu] window %zu, reference %d [%zu, %zu] window %zu\n",
+                name, index, d->fbNeeded, d->firstFb, d->lastFb, d->fbWindow,
+                ref->fbNeeded, ref->firstFb, ref->lastFb, ref->fbWindow);
+        same = false;
+    }
+    for (size_t w = 0; w < NUM_HW_WINDOWS; w++) {
+        if (ref->overlayMap[w] != d->overlayMap[w] || ref->gscMode[w] != d->gscMode[w] ||
+                ref->gscIdx[w] != d->gscIdx[w]) {
+            printf("  %s frame %u: window %zu layer %d gsc %d/%d, reference layer %d gsc %d/%d\n",
+                    name, index, w, d->overlayMap[w], d->gscMode[w], d->gscIdx[w],
+                    ref->overlayMap[w], ref->gscMode[w], ref->gscIdx[w]);
+            same = false;
+        }
+    }
+    if (ref->gscLayers != d->gscLayers || ref->virtualOverlay != d->virtualOverlay ||
+            ref->bypassSkipStatic != d->bypassSkipStatic) {
+        printf("  %s frame %u: %d gsc layers, static fb %d, bypass %d, reference %d, %d, %d\n",
+                name, index, d->gscLayers, d->virtualOverlay, d->bypassSkipStatic,
+                ref->gscLayers, ref->virtualOverlay, ref->bypassSkipStatic);
+        same = false;
+    }
+
+    return same;
+}
+
+static void sim_set_reference(exynos5_hwc_composer_device_1_t *dev, bool reference)
+{
+    dev->hwc_ctrl.plan_cache_mode = !reference;
+    dev->hwc_ctrl.bw_plan_resume_mode = !reference;
+}
+
+static int sim_run(exynos5_hwc_composer_device_1_t *dev, const char *name,
+        const sim_frame *frames, size_t numFrames, uint32_t repeat, bool compare)
+{
+    ExynosOverlayDisplay *display = sim_new_display(dev);
+    ExynosOverlayDisplay *refDisplay = compare ? sim_new_display(dev) : NULL;
+    hwc_display_contents_1_t *contents = sim_alloc_contents(frames, numFrames);
+    hwc_display_contents_1_t *refContents = compare ? sim_alloc_contents(frames, numFrames) : NULL;
+    sim_decision decision, refDecision;
+    sim_stats stats, refStats;
+    uint32_t mismatches = 0;
+
+    dev->mS3DMode = S3D_MODE_DISABLED;
+    dev->CompModeSwitch = NO_MODE_SWITCH;
+
+    if (!contents || (compare && !refContents)) {
+        ALOGE("%s: out of memory", __func__);
+        free(contents);
+        free(refContents);
+        delete display;
+        delete refDisplay;
+        return -1;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    memset(&refStats, 0, sizeof(refStats));
+    printf("%s: %zu frames x %u\n", name, numFrames, repeat);
+
+    for (uint32_t r = 0; r < repeat; r++) {
+        for (size_t f = 0; f < numFrames; f++) {
+            uint32_t index = r * numFrames + f;
+            bool geometryChanged = (frames[f].geometryChanged && !r) || !index;
+            uint32_t planHits = display->mPlanCacheHits;
+
+            if (compare) {
+                sim_set_reference(dev, true);
+                nsecs_t refTime = sim_prepare(dev, refDisplay, refContents, &frames[f],
+                        geometryChanged, index);
+                refStats.frames++;
+                refStats.totalTime += refTime;
+                refStats.maxTime = max(refStats.maxTime, refTime);
+                sim_get_decision(refDisplay, refContents, &refDecision);
+                sim_set_reference(dev, false);
+            }
+
+            nsecs_t prepareTime = sim_prepare(dev, display, contents, &frames[f],
+                    geometryChanged, index);
+
+            bool planHit = display->mPlanCacheHits != planHits;
+            stats.frames++;
+            stats.planHits += planHit;
+            stats.fbFrames += display->mFbNeeded;
+            stats.gscLayers += display->mGscLayers;
+            stats.totalTime += prepareTime;
+            stats.maxTime = max(stats.maxTime, prepareTime);
+
+            if (!sim_quiet)
+                sim_print_frame(display, contents, index, planHit, prepareTime);
+
+            if (compare) {
+                sim_get_decision(display, contents, &decision);
+                if (!sim_same_decision(&refDecision, &decision, frames[f].numLayers, name, index))
+                    mismatches++;
+            }
+        }
+    }
+
+    printf("%s: prepare avg %lld us, max %lld us, plan cache %u/%u, "
+            "fb on %u frames, %.2f gsc layers/frame\n", name,
+            (long long)ns2us(stats.totalTime / stats.frames),
+            (long long)ns2us(stats.maxTime), display->mPlanCacheHits,
+            display->mPlanCacheLookups, stats.fbFrames,
+            (float)stats.gscLayers / stats.frames);
+    if (compare)
+        printf("%s: reference prepare avg %lld us, max %lld us, %u of %u frames differ\n",
+                name, (long long)ns2us(refStats.totalTime / refStats.frames),
+                (long long)ns2us(refStats.maxTime), mismatches, refStats.frames);
+    printf("\n");
+
+    free(contents);
+    free(refContents);
+    delete display;
+    delete refDisplay;
+
+    return mismatches ? -1 : 0;
+}
+
+static void sim_usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-q] [-c] [-n frames] [-r repeat] [stack file]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    exynos5_hwc_composer_device_1_t *dev;
+    uint32_t numFrames = SIM_DEFAULT_FRAMES;
+    uint32_t repeat = 1;
+    bool compare = false;
+    int ret = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qcn:r:")) != -1) {
+        switch (opt) {
+        case 'q':
+            sim_quiet = true;
+            break;
+        case 'c':
+            compare = true;
+            break;
+        case 'n':
+            numFrames = atoi(optarg);
+            break;
+        case 'r':
+            repeat = atoi(optarg);
+            break;
+        default:
+            sim_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!numFrames || !repeat) {
+        sim_usage(argv[0]);
+        return 1;
+    }
+
+    dev = (exynos5_hwc_composer_device_1_t *)calloc(1, sizeof(*dev));
+    if (!dev) {
+        ALOGE("%s: out of memory", __func__);
+        return 1;
+    }
+
+    /* the defaults of exynos5_open() */
+    dev->hwc_ctrl.max_num_ovly = NUM_HW_WINDOWS;
+    dev->hwc_ctrl.num_of_video_ovly = 2;
+    dev->hwc_ctrl.dynamic_recomp_mode = true;
+    dev->hwc_ctrl.dynamic_recomp_idle_ms = HWC_IDLE_INTERVAL_MS;
+    dev->hwc_ctrl.skip_static_layer_mode = true;
+    dev->hwc_ctrl.dma_bw_balance_mode = true;
+    dev->hwc_ctrl.plan_cache_mode = true;
+    dev->hwc_ctrl.bw_plan_resume_mode = true;
+    dev->updateFps = SIM_FPS;
+
+    sim_alloc_handles();
+
+    if (optind < argc) {
+        size_t n;
+        sim_frame *frames = sim_load(argv[optind], &n);
+        if (!frames) {
+            sim_free_handles();
+            free(dev);
+            return 1;
+        }
+        if (sim_run(dev, argv[optind], frames, n, repeat, compare) < 0)
+            ret = 1;
+        free(frames);
+    } else {
+        sim_frame frame;
+        for (size_t i = 0; i < sizeof(sim_scenarios) / sizeof(sim_scenarios[0]); i++) {
+            memset(&frame, 0, sizeof(frame));
+            frame.geometryChanged = true;
+            sim_scenarios[i].build(&frame);
+            if (sim_run(dev, sim_scenarios[i].name, &frame, 1, numFrames, compare) < 0)
+                ret = 1;
+        }
+    }
+
+    if (compare)
+        printf("%s\n", ret ? "decisions differ from the reference" : "decisions match the reference");
+
+    sim_free_handles();
+    free(dev);
+    return ret;
+}
@@ -0,0 +1,17 @@
+#include "ExynosMPP.h"
+
+/*
+ * Link time stand-ins of the device libraries the planning code refers
+ * to but the simulation never reaches: there are no fences to wait for,
+ * and ExynosMPPModule does not open a GSC through the factory.
+ */
+int sync_wait(int fd, int timeout)
+{
+    return 0;
+}
+
+LibMpp *MppFactory::CreateMpp(int id, int mode, int outputMode, int drm)
+{
+    ALOGE("%s: no gscaler in the simulation", __func__);
+    return NULL;
+}
@@ -0,0 +1,56 @@
+#include "ExynosMPPModule.h"
+#include "ExynosHWCUtils.h"
+
+ExynosMPPModule::ExynosMPPModule()
+    : ExynosMPP()
+{
+    mNumConfigs = 0;
+    mNumRuns = 0;
+}
+
+ExynosMPPModule::ExynosMPPModule(ExynosDisplay *display, int gscIndex)
+    : ExynosMPP(display, gscIndex)
+{
+    mNumConfigs = 0;
+    mNumRuns = 0;
+}
+
+void *ExynosMPPModule::createMPP(int id, int mode, int outputMode, int drm)
+{
+    ALOGV("%s: gsc %d, mode %d, output %d, drm %d", __func__, id, mode, outputMode, drm);
+    /* any non NULL handle, it is never dereferenced */
+    return this;
+}
+
+int ExynosMPPModule::configMPP(void *handle, exynos_mpp_img *src, exynos_mpp_img *dst)
+{
+    mNumConfigs++;
+    return 0;
+}
+
+int ExynosMPPModule::runMPP(void *handle, exynos_mpp_img *src, exynos_mpp_img *dst)
+{
+    mNumRuns++;
+    /* the job is done at once, there is no release fence to wait for */
+    dst->releaseFenceFd = -1;
+    return 0;
+}
+
+int ExynosMPPModule::stopMPP(void *handle)
+{
+    return 0;
+}
+
+void ExynosMPPModule::destroyMPP(void *handle)
+{
+}
+
+int ExynosMPPModule::setCSCProperty(void *handle, unsigned int eqAuto, unsigned int fullRange, unsigned int colorspace)
+{
+    return 0;
+}
+
+int ExynosMPPModule::freeMPP(void *handle)
+{
+    return 0;
+}
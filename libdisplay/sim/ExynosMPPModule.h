@@ -0,0 +1,29 @@
+#ifndef EXYNOS_MPP_MODULE_H
+#define EXYNOS_MPP_MODULE_H
+
+#include "ExynosMPP.h"
+
+/*
+ * MPP of the host simulation: the placement decisions are the ones of
+ * ExynosMPP, the GSC backend only counts the jobs it is given.
+ */
+class ExynosMPPModule : public ExynosMPP {
+    public:
+        ExynosMPPModule();
+        ExynosMPPModule(ExynosDisplay *display, int gscIndex);
+
+        /* Fields */
+        uint32_t                mNumConfigs;
+        uint32_t                mNumRuns;
+
+    protected:
+        virtual void *createMPP(int id, int mode, int outputMode, int drm);
+        virtual int configMPP(void *handle, exynos_mpp_img *src, exynos_mpp_img *dst);
+        virtual int runMPP(void *handle, exynos_mpp_img *src, exynos_mpp_img *dst);
+        virtual int stopMPP(void *handle);
+        virtual void destroyMPP(void *handle);
+        virtual int setCSCProperty(void *handle, unsigned int eqAuto, unsigned int fullRange, unsigned int colorspace);
+        virtual int freeMPP(void *handle);
+};
+
+#endif
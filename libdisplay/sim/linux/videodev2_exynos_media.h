@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ANDROID_EXYNOS_HWC_SIM_VIDEODEV2_EXYNOS_MEDIA_H_
+#define ANDROID_EXYNOS_HWC_SIM_VIDEODEV2_EXYNOS_MEDIA_H_
+
+/*
+ * Host stand-in for the Exynos kernel header of the same name, which only
+ * exists in the kernel tree of a device build. The simulation reaches it
+ * through s5p_fimc_v4l2.h from ../libexynosutils/exynos_format_v4l2.c;
+ * every pixel format that file maps is in the upstream videodev2.h of the
+ * host, so nothing Exynos specific is declared here. s5p_fimc_v4l2.h uses
+ * size_t without including stddef.h.
+ */
+#include <stddef.h>
+#include <linux/videodev2.h>
+
+#endif
@@ -0,0 +1,270 @@
+/*
+ * Copyright@ Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+ * file ExynosPlaneCopyBench.c
+ *
+ * exynos_plane_copy() throughput at 720p, 1080p and WQHD, in bytes written
+ * per CPU cycle. The source has a padded stride like a gralloc preview
+ * buffer, the destination is packed like the preview callback heap, as in
+ * ExynosCamera::m_doPreviewToCallbackFunc. A single memcpy of the same
+ * number of bytes is printed as the ceiling.
+ *
+ * Cycles come from the perf cycle counter when the kernel offers one, and
+ * from the thread CPU time at the clock given with -m (or read from cpufreq
+ * or /proc/cpuinfo) otherwise; the source is printed.
+ *
+ * usage: exynos_plane_copy_bench [-m MHz] [iterations]
+ */
+
+#define LOG_TAG "ExynosPlaneCopyBench"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "exynos_plane_copy.h"
+
+#define BENCH_STRIDE_PAD    (64)
+#define BENCH_DEFAULT_ITER  (200)
+
+static int    gPerfFd = -1;
+static double gMHz;
+
+static void Bench_InitCycles(double mhz)
+{
+    struct perf_event_attr attr;
+    char   line[256];
+    FILE  *fp;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    gPerfFd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (gPerfFd >= 0) {
+        printf("cycles: perf cycle counter\n");
+        return;
+    }
+
+    gMHz = mhz;
+    if (gMHz <= 0) {
+        fp = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "r");
+        if (fp != NULL) {
+            if (fgets(line, sizeof(line), fp) != NULL)
+                gMHz = atof(line) / 1000;
+            fclose(fp);
+        }
+    }
+    if (gMHz <= 0) {
+        fp = fopen("/proc/cpuinfo", "r");
+        if (fp != NULL) {
+            while (fgets(line, sizeof(line), fp) != NULL) {
+                if (strncmp(line, "cpu MHz", 7) == 0 && strchr(line, ':') != NULL) {
+                    gMHz = atof(strchr(line, ':') + 1);
+                    break;
+                }
+            }
+            fclose(fp);
+        }
+    }
+
+    printf("cycles: thread CPU time x %.0f MHz (no perf cycle counter)\n", gMHz);
+}
+
+static double Bench_Cycles(void)
+{
+    struct timespec ts;
+    long long count = 0;
+
+    if (gPerfFd >= 0) {
+        if (read(gPerfFd, &count, sizeof(count)) != sizeof(count))
+            return 0;
+        return (double)count;
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (ts.tv_sec * 1e9 + ts.tv_nsec) * gMHz / 1e3;
+}
+
+static void Bench_SetImage(plane_copy_image_t *image, unsigned char *base,
+                           int format, unsigned int w, unsigned int h, unsigned int stride)
+{
+    unsigned int lumaSize = stride * h;
+
+    image->format = format;
+    image->plane[0] = base;
+    image->stride[0] = stride;
+
+    if (format == PLANE_COPY_FMT_NV12 || format == PLANE_COPY_FMT_NV21) {
+        image->plane[1] = base + lumaSize;
+        image->stride[1] = stride;
+        image->plane[2] = NULL;
+        image->stride[2] = 0;
+    } else {
+        image->plane[1] = base + lumaSize;
+        image->stride[1] = stride / 2;
+        image->plane[2] = image->plane[1] + (stride / 2) * (h / 2);
+        image->stride[2] = stride / 2;
+    }
+}
+
+/* bytes written per cycle, 0 on failure */
+static double Bench_Copy(int srcFormat, int dstFormat, unsigned int w, unsigned int h, int iterations)
+{
+    plane_copy_image_t src, dst;
+    unsigned int srcStride = w + BENCH_STRIDE_PAD;
+    unsigned char *srcBuf = (unsigned char *)malloc(srcStride * h * 3 / 2);
+    unsigned char *dstBuf = (unsigned char *)malloc(w * h * 3 / 2);
+    double start, cycles;
+    double ret = 0;
+
+    if (srcBuf == NULL || dstBuf == NULL)
+        goto EXIT;
+
+    memset(srcBuf, 0x80, srcStride * h * 3 / 2);
+    memset(dstBuf, 0, w * h * 3 / 2);
+    Bench_SetImage(&src, srcBuf, srcFormat, w, h, srcStride);
+    Bench_SetImage(&dst, dstBuf, dstFormat, w, h, w);
+
+    /* warm the caches and the TLB */
+    if (exynos_plane_copy(&src, &dst, 0, 0, w, h) < 0)
+        goto EXIT;
+
+    start = Bench_Cycles();
+    for (int i = 0; i < iterations; i++)
+        exynos_plane_copy(&src, &dst, 0, 0, w, h);
+    cycles = Bench_Cycles() - start;
+
+    if (cycles > 0)
+        ret = (double)w * h * 3 / 2 * iterations / cycles;
+
+EXIT:
+    free(srcBuf);
+    free(dstBuf);
+
+    return ret;
+}
+
+static double Bench_Memcpy(unsigned int w, unsigned int h, int iterations)
+{
+    size_t size = (size_t)w * h * 3 / 2;
+    unsigned char *srcBuf = (unsigned char *)malloc(size);
+    unsigned char *dstBuf = (unsigned char *)malloc(size);
+    double start, cycles;
+    double ret = 0;
+
+    if (srcBuf == NULL || dstBuf == NULL)
+        goto EXIT;
+
+    memset(srcBuf, 0x80, size);
+    memcpy(dstBuf, srcBuf, size);
+
+    start = Bench_Cycles();
+    for (int i = 0; i < iterations; i++) {
+        memcpy(dstBuf, srcBuf, size);
+        /* keep the copies from being merged */
+        __asm__ __volatile__("" : : "r"(dstBuf) : "memory");
+    }
+    cycles = Bench_Cycles() - start;
+
+    if (cycles > 0)
+        ret = (double)size * iterations / cycles;
+
+EXIT:
+    free(srcBuf);
+    free(dstBuf);
+
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char   *name;
+        unsigned int  w;
+        unsigned int  h;
+    } sizes[] = {
+        { "720p ", 1280,  720 },
+        { "1080p", 1920, 1080 },
+        { "WQHD ", 2560, 1440 },
+    };
+    static const struct {
+        const char   *name;
+        int           srcFormat;
+        int           dstFormat;
+    } cases[] = {
+        { "NV21 -> NV21", PLANE_COPY_FMT_NV21, PLANE_COPY_FMT_NV21 },
+        { "NV12 -> NV21", PLANE_COPY_FMT_NV12, PLANE_COPY_FMT_NV21 },
+        { "NV21 -> YV12", PLANE_COPY_FMT_NV21, PLANE_COPY_FMT_YV12 },
+        { "YV12 -> NV21", PLANE_COPY_FMT_YV12, PLANE_COPY_FMT_NV21 },
+        { "I420 -> YV12", PLANE_COPY_FMT_I420, PLANE_COPY_FMT_YV12 },
+    };
+    double mhz = 0;
+    double bytesPerCycle;
+    int iterations = BENCH_DEFAULT_ITER;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:")) != -1) {
+        switch (opt) {
+        case 'm':
+            mhz = atof(optarg);
+            break;
+        default:
+            printf("usage: %s [-m MHz] [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind < argc)
+        iterations = atoi(argv[optind]);
+    if (iterations <= 0) {
+        printf("usage: %s [-m MHz] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    Bench_InitCycles(mhz);
+    if (gPerfFd < 0 && gMHz <= 0) {
+        printf("no cycle counter and no clock rate, give one with -m\n");
+        return 1;
+    }
+
+    printf("bytes written per cycle, %d iterations, source stride = width + %d\n",
+           iterations, BENCH_STRIDE_PAD);
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        printf("%s (%ux%u):\n", sizes[s].name, sizes[s].w, sizes[s].h);
+        printf("  memcpy       : %6.2f\n", Bench_Memcpy(sizes[s].w, sizes[s].h, iterations));
+
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            bytesPerCycle = Bench_Copy(cases[i].srcFormat, cases[i].dstFormat,
+                                       sizes[s].w, sizes[s].h, iterations);
+            if (bytesPerCycle <= 0) {
+                printf("  %s : failed\n", cases[i].name);
+                return 1;
+            }
+            printf("  %s : %6.2f\n", cases[i].name, bytesPerCycle);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright@ Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/*
+ * file exynos_plane_copy.c
+ *
+ * Stride-aware YUV 4:2:0 plane copy shared by libcamera and libcsc.
+ * Straight copies go through memcpy, which is already NEON-tuned in bionic;
+ * chroma swap and (de)interleave use NEON when available, with a scalar
+ * fallback otherwise.
+ */
+
+#define LOG_TAG "exynos_plane_copy"
+
+#include <string.h>
+#include <utils/Log.h>
+#include <system/graphics.h>
+#include <linux/videodev2.h>
+
+#include "exynos_format.h"
+#include "exynos_plane_copy.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PLANE_COPY_USE_NEON
+#endif
+
+int exynos_plane_copy_v4l2_format(
+    unsigned int v4l2_pixel_format)
+{
+    switch (v4l2_pixel_format) {
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV12M:
+        return PLANE_COPY_FMT_NV12;
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_NV21M:
+        return PLANE_COPY_FMT_NV21;
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YUV420M:
+        return PLANE_COPY_FMT_I420;
+    case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_YVU420M:
+        return PLANE_COPY_FMT_YV12;
+    default:
+        return PLANE_COPY_FMT_NONE;
+    }
+}
+
+int exynos_plane_copy_hal_format(
+    int hal_pixel_format)
+{
+    switch (hal_pixel_format) {
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_SP_M:
+        return PLANE_COPY_FMT_NV12;
+    case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+    case HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M:
+        return PLANE_COPY_FMT_NV21;
+    case HAL_PIXEL_FORMAT_EXYNOS_YCbCr_420_P_M:
+        return PLANE_COPY_FMT_I420;
+    case HAL_PIXEL_FORMAT_YV12:
+    case HAL_PIXEL_FORMAT_EXYNOS_YV12_M:
+        return PLANE_COPY_FMT_YV12;
+    default:
+        return PLANE_COPY_FMT_NONE;
+    }
+}
+
+void exynos_copy_plane(
+    unsigned char *dst,
+    unsigned int   dst_stride,
+    const unsigned char *src,
+    unsigned int   src_stride,
+    unsigned int   width,
+    unsigned int   height)
+{
+    unsigned int i;
+
+    if (dst_stride == width && src_stride == width) {
+        memcpy(dst, src, (size_t)width * height);
+        return;
+    }
+
+    for (i = 0; i < height; i++) {
+        memcpy(dst, src, width);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+/* CbCr <-> CrCb, pairs of bytes */
+static void swap_uv_row(
+    unsigned char *dst,
+    const unsigned char *src,
+    unsigned int pairs)
+{
+    unsigned int i = 0;
+
+#ifdef PLANE_COPY_USE_NEON
+    for (; i + 8 <= pairs; i += 8) {
+        vst1q_u8(dst + (i << 1), vrev16q_u8(vld1q_u8(src + (i << 1))));
+    }
+#endif
+    for (; i < pairs; i++) {
+        dst[(i << 1)]     = src[(i << 1) + 1];
+        dst[(i << 1) + 1] = src[(i << 1)];
+    }
+}
+
+static void deinterleave_row(
+    unsigned char *dst0,
+    unsigned char *dst1,
+    const unsigned char *src,
+    unsigned int pairs)
+{
+    unsigned int i = 0;
+
+#ifdef PLANE_COPY_USE_NEON
+    for (; i + 16 <= pairs; i += 16) {
+        uint8x16x2_t uv = vld2q_u8(src + (i << 1));
+        vst1q_u8(dst0 + i, uv.val[0]);
+        vst1q_u8(dst1 + i, uv.val[1]);
+    }
+#endif
+    for (; i < pairs; i++) {
+        dst0[i] = src[(i << 1)];
+        dst1[i] = src[(i << 1) + 1];
+    }
+}
+
+static void interleave_row(
+    unsigned char *dst,
+    const unsigned char *src0,
+    const unsigned char *src1,
+    unsigned int pairs)
+{
+    unsigned int i = 0;
+
+#ifdef PLANE_COPY_USE_NEON
+    for (; i + 16 <= pairs; i += 16) {
+        uint8x16x2_t uv;
+        uv.val[0] = vld1q_u8(src0 + i);
+        uv.val[1] = vld1q_u8(src1 + i);
+        vst2q_u8(dst + (i << 1), uv);
+    }
+#endif
+    for (; i < pairs; i++) {
+        dst[(i << 1)]     = src0[i];
+        dst[(i << 1) + 1] = src1[i];
+    }
+}
+
+static int is_semi_planar(int format)
+{
+    return (format == PLANE_COPY_FMT_NV12 || format == PLANE_COPY_FMT_NV21);
+}
+
+/* plane index of Cb and Cr for the planar formats */
+static void get_planar_order(int format, int *cb, int *cr)
+{
+    if (format == PLANE_COPY_FMT_YV12) {
+        *cb = 2;
+        *cr = 1;
+    } else {
+        *cb = 1;
+        *cr = 2;
+    }
+}
+
+int exynos_plane_copy(
+    const plane_copy_image_t *src,
+    const plane_copy_image_t *dst,
+    unsigned int crop_x,
+    unsigned int crop_y,
+    unsigned int width,
+    unsigned int height)
+{
+    unsigned int cw, ch, i;
+    int src_cb, src_cr, dst_cb, dst_cr;
+
+    if (src == NULL || dst == NULL ||
+        src->format < PLANE_COPY_FMT_NV12 || PLANE_COPY_FMT_YV12 < src->format ||
+        dst->format < PLANE_COPY_FMT_NV12 || PLANE_COPY_FMT_YV12 < dst->format) {
+        ALOGE("%s: invalid image", __func__);
+        return -1;
+    }
+
+    crop_x &= ~1;
+    crop_y &= ~1;
+    cw = width >> 1;
+    ch = height >> 1;
+
+    if (src->stride[0] < crop_x + width || dst->stride[0] < width) {
+        ALOGE("%s: stride(%u, %u) is smaller than width(%u) + crop_x(%u)",
+            __func__, src->stride[0], dst->stride[0], width, crop_x);
+        return -1;
+    }
+
+    exynos_copy_plane(dst->plane[0], dst->stride[0],
+                      src->plane[0] + (src->stride[0] * crop_y) + crop_x, src->stride[0],
+                      width, height);
+
+    if (is_semi_planar(src->format)) {
+        const unsigned char *s = src->plane[1] + (src->stride[1] * (crop_y >> 1)) + crop_x;
+
+        if (src->format == dst->format) {
+            exynos_copy_plane(dst->plane[1], dst->stride[1], s, src->stride[1], cw << 1, ch);
+        } else if (is_semi_planar(dst->format)) {
+            unsigned char *d = dst->plane[1];
+            for (i = 0; i < ch; i++) {
+                swap_uv_row(d, s, cw);
+                d += dst->stride[1];
+                s += src->stride[1];
+            }
+        } else {
+            int first, second;
+            unsigned char *d0, *d1;
+
+            get_planar_order(dst->format, &dst_cb, &dst_cr);
+            /* NV12 carries Cb first, NV21 carries Cr first */
+            first  = (src->format == PLANE_COPY_FMT_NV12) ? dst_cb : dst_cr;
+            second = (src->format == PLANE_COPY_FMT_NV12) ? dst_cr : dst_cb;
+            d0 = dst->plane[first];
+            d1 = dst->plane[second];
+            for (i = 0; i < ch; i++) {
+                deinterleave_row(d0, d1, s, cw);
+                d0 += dst->stride[first];
+                d1 += dst->stride[second];
+                s  += src->stride[1];
+            }
+        }
+    } else {
+        const unsigned char *s_cb, *s_cr;
+
+        get_planar_order(src->format, &src_cb, &src_cr);
+        s_cb = src->plane[src_cb] + (src->stride[src_cb] * (crop_y >> 1)) + (crop_x >> 1);
+        s_cr = src->plane[src_cr] + (src->stride[src_cr] * (crop_y >> 1)) + (crop_x >> 1);
+
+        if (is_semi_planar(dst->format)) {
+            int nv12 = (dst->format == PLANE_COPY_FMT_NV12);
+            const unsigned char *s0 = nv12 ? s_cb : s_cr;
+            const unsigned char *s1 = nv12 ? s_cr : s_cb;
+            unsigned int s0_stride = src->stride[nv12 ? src_cb : src_cr];
+            unsigned int s1_stride = src->stride[nv12 ? src_cr : src_cb];
+            unsigned char *d = dst->plane[1];
+            for (i = 0; i < ch; i++) {
+                interleave_row(d, s0, s1, cw);
+                d  += dst->stride[1];
+                s0 += s0_stride;
+                s1 += s1_stride;
+            }
+        } else {
+            get_planar_order(dst->format, &dst_cb, &dst_cr);
+            exynos_copy_plane(dst->plane[dst_cb], dst->stride[dst_cb], s_cb, src->stride[src_cb], cw, ch);
+            exynos_copy_plane(dst->plane[dst_cr], dst->stride[dst_cr], s_cr, src->stride[src_cr], cw, ch);
+        }
+    }
+
+    return 0;
+}
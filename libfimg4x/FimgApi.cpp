@@ -272,10 +272,14 @@ extern "C" int stretchFimgApi_fast(struct fimg2d_blit *cmd, unsigned long tmpbuf
     if (cmd->src->fmt >= CF_RGB_565)
         return stretchFimgApi(cmd);
 
+    /* as in stretchFimgApi(), and no other blit between the two steps on tmpbuf */
+    pthread_mutex_lock(&s_g2d_lock);
+
     FimgApi * fimgApi = createFimgApi();
 
     if (fimgApi == NULL) {
         PRINT("%s::createFimgApi() fail\n", __func__);
+        pthread_mutex_unlock(&s_g2d_lock);
         return -1;
     }
 
@@ -378,6 +382,8 @@ extern "C" int stretchFimgApi_fast(struct fimg2d_blit *cmd, unsigned long tmpbuf
     if (fimgApi->Stretch(&cmd1st) == false) {
         if (fimgApi != NULL)
             destroyFimgApi(fimgApi);
+
+        pthread_mutex_unlock(&s_g2d_lock);
         return -1;
     }
 
@@ -385,12 +391,15 @@ extern "C" int stretchFimgApi_fast(struct fimg2d_blit *cmd, unsigned long tmpbuf
     if (fimgApi->Stretch(&cmd2nd) == false) {
         if (fimgApi != NULL)
             destroyFimgApi(fimgApi);
+
+        pthread_mutex_unlock(&s_g2d_lock);
         return -1;
     }
 
     if (fimgApi != NULL)
         destroyFimgApi(fimgApi);
 
+    pthread_mutex_unlock(&s_g2d_lock);
     return 0;
 }
 
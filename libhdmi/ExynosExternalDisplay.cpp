@@ -432,20 +432,13 @@ int ExynosExternalDisplay::set(hwc_display_contents_1_t* contents)
 
 void ExynosExternalDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
 {
-    static int init_flag = 0;
     int last_ovly_lay_idx = -1;
 
     mVirtualOverlayFlag = 0;
     mLastOverlayWindowIndex = -1;
 
-    if (!mHwc->hwc_ctrl.skip_static_layer_mode)
-        return;
-
-    if (mBypassSkipStaticLayer)
-        return;
-
-    if (contents->flags & HWC_GEOMETRY_CHANGED) {
-        init_flag = 0;
+    if (!mHwc->hwc_ctrl.skip_static_layer_mode || mBypassSkipStaticLayer) {
+        mDamageTracker.reset();
         return;
     }
 
@@ -456,40 +449,22 @@ void ExynosExternalDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
         }
     }
 
-    if ((last_ovly_lay_idx == -1) || ((uint32_t)last_ovly_lay_idx >= (contents->numHwLayers - 2)) ||
-        ((contents->numHwLayers - last_ovly_lay_idx - 1) >= NUM_VIRT_OVER)) {
-        init_flag = 0;
+    if ((last_ovly_lay_idx == -1) || ((uint32_t)last_ovly_lay_idx >= (contents->numHwLayers - 2))) {
+        mDamageTracker.reset();
         return;
     }
     mLastOverlayLayerIndex = last_ovly_lay_idx;
     last_ovly_lay_idx++;
-    if (init_flag == 1) {
-        for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers -1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (!layer.handle || (layer.flags & HWC_SKIP_LAYER) || (mLastLayerHandles[i - last_ovly_lay_idx] !=  layer.handle)) {
-                init_flag = 0;
-                return;
-            }
-        }
 
-        mVirtualOverlayFlag = 1;
-        for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers-1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (layer.compositionType == HWC_FRAMEBUFFER)
-                layer.compositionType = HWC_OVERLAY;
-        }
+    if (!mDamageTracker.isFbStatic(contents, last_ovly_lay_idx, contents->numHwLayers - 2))
         return;
-    }
 
-    init_flag = 1;
-    for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers; i++) {
+    mVirtualOverlayFlag = 1;
+    for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers-1; i++) {
         hwc_layer_1_t &layer = contents->hwLayers[i];
-        mLastLayerHandles[i - last_ovly_lay_idx] = layer.handle;
+        if (layer.compositionType == HWC_FRAMEBUFFER)
+            layer.compositionType = HWC_OVERLAY;
     }
-    for (size_t i = contents->numHwLayers - last_ovly_lay_idx; i < NUM_VIRT_OVER; i++)
-        mLastLayerHandles[i] = 0;
-
-    return;
 }
 
 void ExynosExternalDisplay::determineYuvOverlay(hwc_display_contents_1_t *contents)
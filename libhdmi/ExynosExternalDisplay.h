@@ -3,6 +3,7 @@
 
 #include "ExynosHWC.h"
 #include "ExynosDisplay.h"
+#include "ExynosDamageTracker.h"
 #include <linux/videodev2.h>
 #include <linux/v4l2-dv-timings.h>
 
@@ -81,7 +82,7 @@ class ExynosExternalDisplay : public ExynosDisplay {
         bool                    mEnabled;
         bool                    mBlanked;
 
-        const void              *mLastLayerHandles[NUM_VIRT_OVER_HDMI];
+        ExynosDamageTracker     mDamageTracker;
         int                     mVirtualOverlayFlag;
 
         exynos5_hwc_post_data_t  mPostData;
@@ -75,7 +75,6 @@ ExynosExternalDisplay::ExynosExternalDisplay(struct exynos5_hwc_composer_device_
 
     mMPPs[0] = new ExynosMPPModule(this, HDMI_GSC_IDX);
     memset(mMixerLayers, 0, sizeof(mMixerLayers));
-    memset(mLastLayerHandles, 0, sizeof(mLastLayerHandles));
 }
 
 ExynosExternalDisplay::~ExynosExternalDisplay()
@@ -645,52 +644,26 @@ err:
 
 void ExynosExternalDisplay::skipStaticLayers(hwc_display_contents_1_t *contents, int ovly_idx)
 {
-    static int init_flag = 0;
     mVirtualOverlayFlag = 0;
     mHasSkipLayer = false;
 
-    if (contents->flags & HWC_GEOMETRY_CHANGED) {
-        init_flag = 0;
-        return;
-    }
-
-    if ((ovly_idx == -1) || (ovly_idx >= ((int)contents->numHwLayers - 2)) ||
-        ((contents->numHwLayers - ovly_idx - 1) >= NUM_VIRT_OVER_HDMI)) {
-        init_flag = 0;
+    if ((ovly_idx == -1) || (ovly_idx >= ((int)contents->numHwLayers - 2))) {
+        mDamageTracker.reset();
         return;
     }
 
     ovly_idx++;
-    if (init_flag == 1) {
-        for (size_t i = ovly_idx; i < contents->numHwLayers - 1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (!layer.handle || (mLastLayerHandles[i - ovly_idx] !=  layer.handle)) {
-                init_flag = 0;
-                return;
-            }
-        }
-
-        mVirtualOverlayFlag = 1;
-        for (size_t i = ovly_idx; i < contents->numHwLayers - 1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (layer.compositionType == HWC_FRAMEBUFFER) {
-                layer.compositionType = HWC_OVERLAY;
-                mHasSkipLayer = true;
-            }
-        }
+    if (!mDamageTracker.isFbStatic(contents, ovly_idx, contents->numHwLayers - 2))
         return;
-    }
 
-    init_flag = 1;
-    for (size_t i = ovly_idx; i < contents->numHwLayers; i++) {
+    mVirtualOverlayFlag = 1;
+    for (size_t i = ovly_idx; i < contents->numHwLayers - 1; i++) {
         hwc_layer_1_t &layer = contents->hwLayers[i];
-        mLastLayerHandles[i - ovly_idx] = layer.handle;
+        if (layer.compositionType == HWC_FRAMEBUFFER) {
+            layer.compositionType = HWC_OVERLAY;
+            mHasSkipLayer = true;
+        }
     }
-
-    for (size_t i = contents->numHwLayers - ovly_idx; i < NUM_VIRT_OVER_HDMI; i++)
-        mLastLayerHandles[i - ovly_idx] = 0;
-
-    return;
 }
 
 void ExynosExternalDisplay::setPreset(int preset)
@@ -910,6 +883,10 @@ int ExynosExternalDisplay::prepare(hwc_display_contents_1_t* contents)
         }
     }
 #endif
+    /* only a single video layer gets static UI skipping */
+    if (numVideoLayers != 1)
+        mDamageTracker.reset();
+
     mHasFbComposition = false;
     for (size_t i = 0; i < contents->numHwLayers; i++) {
         hwc_layer_1_t &layer = contents->hwLayers[i];
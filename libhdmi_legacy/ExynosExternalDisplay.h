@@ -3,6 +3,7 @@
 
 #include "ExynosHWC.h"
 #include "ExynosDisplay.h"
+#include "ExynosDamageTracker.h"
 
 #define VIDEO_LAYER_INDEX       2
 #define NUM_VIRT_OVER_HDMI 5
@@ -91,7 +92,7 @@ class ExynosExternalDisplay : public ExynosDisplay {
         int                     mUiIndex;
         int                     mVideoIndex;
         bool                    mUseSubtitles;
-        const void              *mLastLayerHandles[NUM_VIRT_OVER_HDMI];
+        ExynosDamageTracker     mDamageTracker;
         int                     mVirtualOverlayFlag;
 };
 
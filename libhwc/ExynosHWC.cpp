@@ -37,6 +37,8 @@ namespace android {
 
 #include "ExynosHWC.h"
 #include "ExynosHWCUtils.h"
+#include "ExynosBufferPool.h"
+#include "ExynosFrameTrace.h"
 #include "ExynosMPPModule.h"
 #include "ExynosOverlayDisplay.h"
 #include "ExynosExternalDisplayModule.h"
@@ -229,6 +231,89 @@ void exynos5_boot_finished(exynos5_hwc_composer_device_1_t *dev)
     }
 }
 
+/*
+ * Exponentially weighted update rate. The previous estimate is kept with a
+ * weight of exp(-gap / idle interval): frames close together average over
+ * several updates, while the first update after a pause of a few idle
+ * intervals replaces the estimate with its own, low, instantaneous rate.
+ */
+static void hwc_update_fps(struct exynos5_hwc_composer_device_1_t *pdev, uint64_t now)
+{
+    if (pdev->LastUpdateTimeStamp && now > pdev->LastUpdateTimeStamp) {
+        float interval = (float)(now - pdev->LastUpdateTimeStamp);
+        float weight = expf(-interval / (pdev->hwc_ctrl.dynamic_recomp_idle_ms * 1000000.0f));
+        pdev->updateFps = pdev->updateFps * weight +
+                (1.0f - weight) * (1000000000.0f / interval);
+    }
+    pdev->LastUpdateTimeStamp = now;
+}
+
+/*
+ * (Re)arm one of the one-shot timers of the update_stat thread. A zero
+ * interval_ms wakes the thread right away.
+ */
+static void hwc_arm_timer(int timer_fd, int interval_ms)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = interval_ms / 1000;
+    its.it_value.tv_nsec = (interval_ms % 1000) * 1000000 + (interval_ms ? 0 : 1);
+    if (timerfd_settime(timer_fd, 0, &its, NULL) < 0)
+        ALOGE("%s: timerfd_settime failed: %s", __func__, strerror(errno));
+}
+
+static void hwc_arm_idle_timer(struct exynos5_hwc_composer_device_1_t *pdev, int interval_ms)
+{
+    hwc_arm_timer(pdev->update_timer_fd, interval_ms);
+}
+
+static void hwc_trace_prepared(struct exynos5_hwc_composer_device_1_t *pdev,
+        hwc_display_contents_1_t *contents, hwc_frame_record *record)
+{
+    ExynosOverlayDisplay *display = pdev->primaryDisplay;
+
+    record->numLayers = contents->numHwLayers;
+    for (size_t i = 0; i < contents->numHwLayers; i++) {
+        if (contents->hwLayers[i].compositionType == HWC_FRAMEBUFFER)
+            record->fbLayers++;
+        else if (contents->hwLayers[i].compositionType == HWC_OVERLAY)
+            record->overlayLayers++;
+    }
+    for (size_t i = 0; i < NUM_HW_WINDOWS; i++) {
+        if (display->mPostData.gsc_map[i].mode == exynos5_gsc_map_t::GSC_M2M)
+            record->gscM2M++;
+        else if (display->mPostData.gsc_map[i].mode == exynos5_gsc_map_t::GSC_LOCAL)
+            record->gscOtf++;
+    }
+#ifdef G2D_COMPOSITION
+    record->g2dLayers = display->mG2dComposition ? display->mG2dLayers : 0;
+#endif
+    record->fbWindow = display->mPostData.fb_window == NO_FB_NEEDED ?
+            -1 : display->mPostData.fb_window;
+    record->compMode = pdev->CompModeSwitch;
+}
+
+static void hwc_trace_set(struct exynos5_hwc_composer_device_1_t *pdev,
+        hwc_frame_record *record, nsecs_t now)
+{
+    ExynosOverlayDisplay *display = pdev->primaryDisplay;
+
+    record->setTime = now - record->setStart;
+    record->fenceWaitTime = display->mFenceWaitTime;
+    for (size_t i = 0; i < NUM_HW_WINDOWS; i++) {
+        fb_win_config &config = display->mLastConfig[i];
+        if (config.state == WIN_STATE_DISABLED || config.state == WIN_STATE_COLOR)
+            continue;
+#ifdef DECON_FB
+        record->winPixels[i] = config.dst.w * config.dst.h;
+#else
+        record->winPixels[i] = config.w * config.h;
+#endif
+    }
+    pdev->frameTrace->commit();
+}
+
 int exynos5_prepare(hwc_composer_device_1_t *dev,
         size_t numDisplays, hwc_display_contents_1_t** displays)
 {
@@ -246,9 +331,10 @@ int exynos5_prepare(hwc_composer_device_1_t *dev,
         pdev->virtualDisplay->deInit();
 #endif
 
-    pdev->updateCallCnt++;
-    pdev->update_event_cnt++;
-    pdev->LastUpdateTimeStamp = systemTime(SYSTEM_TIME_MONOTONIC);
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    hwc_frame_record *trace = NULL;
+
+    hwc_update_fps(pdev, startTime);
     pdev->primaryDisplay->getCompModeSwitch();
 
     pdev->totPixels = 0;
@@ -256,9 +342,11 @@ int exynos5_prepare(hwc_composer_device_1_t *dev,
     pdev->externalDisplay->setHdmiStatus(pdev->hdmi_hpd);
 
     if (fimd_contents) {
+        trace = pdev->frameTrace->begin(startTime);
         int err = pdev->primaryDisplay->prepare(fimd_contents);
         if (err)
             return err;
+        hwc_trace_prepared(pdev, fimd_contents, trace);
     }
 
     if (hdmi_contents) {
@@ -277,6 +365,9 @@ int exynos5_prepare(hwc_composer_device_1_t *dev,
     }
 #endif
 
+    if (trace)
+        trace->prepareTime = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+
     return 0;
 }
 
@@ -295,6 +386,10 @@ int exynos5_set(struct hwc_composer_device_1 *dev,
     int virtual_err = 0;
     hwc_display_contents_1_t *virtual_contents = displays[HWC_DISPLAY_VIRTUAL];
 #endif
+    hwc_frame_record *trace = pdev->frameTrace->current();
+
+    if (trace)
+        trace->setStart = systemTime(SYSTEM_TIME_MONOTONIC);
 
     if (fimd_contents)
         fimd_err = pdev->primaryDisplay->set(fimd_contents);
@@ -328,6 +423,26 @@ int exynos5_set(struct hwc_composer_device_1 *dev,
 
     pdev->notifyPSRExit = true;
 
+    if (trace)
+        hwc_trace_set(pdev, trace, systemTime(SYSTEM_TIME_MONOTONIC));
+
+    /*
+     * Nothing to detect while GLES composition is already favored, the
+     * switch back comes from exynos5_prepare() as the update rate rises.
+     */
+    if (pdev->hwc_ctrl.dynamic_recomp_mode && pdev->CompModeSwitch != HWC_2_GLES)
+        hwc_arm_idle_timer(pdev, pdev->hwc_ctrl.dynamic_recomp_idle_ms);
+
+    /*
+     * Free pool buffers are trimmed by the update_stat thread once they
+     * are old enough, whatever the composition mode; it rearms the timer
+     * itself while younger ones are left.
+     */
+    if (!pdev->pool_trim_armed && pdev->mppBufferPool->hasFree()) {
+        pdev->pool_trim_armed = true;
+        hwc_arm_timer(pdev->pool_trim_timer_fd, MPP_POOL_TRIM_AGE_MS);
+    }
+
     if (fimd_err)
         return fimd_err;
 
@@ -468,20 +583,50 @@ void *hwc_update_stat_thread(void *data)
 {
     struct exynos5_hwc_composer_device_1_t *pdev =
             (struct exynos5_hwc_composer_device_1_t *)data;
-    int event_cnt = 0;
+    uint64_t expirations;
+    struct pollfd fds[2];
+
+    fds[0].fd = pdev->update_timer_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = pdev->pool_trim_timer_fd;
+    fds[1].events = POLLIN;
 
     while (pdev->update_stat_thread_flag) {
-        event_cnt = pdev->update_event_cnt;
         /*
-         * If there is no update for more than 100ms, favor the 3D composition mode.
+         * Sleep until exynos5_set() has not been called for a whole idle
+         * interval, or free MPP buffers are due for trimming; neither
+         * timer is armed while the screen stays static.
+         */
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("error in update_stat thread: %s", strerror(errno));
+            break;
+        }
+        if (!pdev->update_stat_thread_flag)
+            break;
+        pdev->update_stat_wakeups++;
+
+        if (fds[1].revents & POLLIN) {
+            read(pdev->pool_trim_timer_fd, &expirations, sizeof(expirations));
+            int next_ms = pdev->mppBufferPool->trim(MPP_POOL_TRIM_AGE_MS);
+            pdev->pool_trim_armed = next_ms >= 0;
+            if (next_ms >= 0)
+                hwc_arm_timer(pdev->pool_trim_timer_fd, next_ms);
+        }
+
+        if (!(fds[0].revents & POLLIN))
+            continue;
+        read(pdev->update_timer_fd, &expirations, sizeof(expirations));
+
+        /*
+         * No update within the idle interval, favor the 3D composition mode.
          * If all other conditions are met, mode will be switched to 3D composition.
          */
-        usleep(100000);
-        if (event_cnt == pdev->update_event_cnt) {
-            if (pdev->primaryDisplay->getCompModeSwitch() == HWC_2_GLES) {
-                if ((pdev->procs) && (pdev->procs->invalidate))
-                    pdev->procs->invalidate(pdev->procs);
-            }
+        pdev->updateFps = 0;
+        if (pdev->primaryDisplay->getCompModeSwitch() == HWC_2_GLES) {
+            if ((pdev->procs) && (pdev->procs->invalidate))
+                pdev->procs->invalidate(pdev->procs);
         }
     }
     return NULL;
@@ -579,6 +724,7 @@ int exynos5_blank(struct hwc_composer_device_1 *dev, int disp, int blank)
         if (pthread_kill(pdev->update_stat_thread, 0) != ESRCH) { //check if the thread is alive
            if (fb_blank == FB_BLANK_POWERDOWN) {
                 pdev->update_stat_thread_flag = false;
+                hwc_arm_idle_timer(pdev, 0);
             }
         } else { // thread is not alive
             if (fb_blank == FB_BLANK_UNBLANK) {
@@ -589,6 +735,10 @@ int exynos5_blank(struct hwc_composer_device_1 *dev, int disp, int blank)
                 }
             }
         }
+        /* nothing is composed until unblank, give back every free MPP buffer */
+        if (fb_blank == FB_BLANK_POWERDOWN)
+            pdev->mppBufferPool->trim(0);
+
         int err = ioctl(pdev->primaryDisplay->mDisplayFd, FBIOBLANK, fb_blank);
         if (err < 0) {
             if (errno == EBUSY)
@@ -679,6 +829,37 @@ void exynos5_dump(hwc_composer_device_1* dev, char *buff, int buff_len)
         result.append("\n");
     }
 
+    uint32_t prepares = pdev->primaryDisplay->mPrepareCount;
+    result.appendFormat("  prepare: %u frames, avg %lld us, max %lld us\n", prepares,
+            prepares ? (long long)ns2us(pdev->primaryDisplay->mPrepareTotalTime / prepares) : 0LL,
+            (long long)ns2us(pdev->primaryDisplay->mPrepareMaxTime));
+    uint32_t sets = pdev->primaryDisplay->mSetCount;
+    result.appendFormat("  set: %u frames, avg %lld us, max %lld us\n", sets,
+            sets ? (long long)ns2us(pdev->primaryDisplay->mSetTotalTime / sets) : 0LL,
+            (long long)ns2us(pdev->primaryDisplay->mSetMaxTime));
+    uint32_t lookups = pdev->primaryDisplay->mPlanCacheLookups;
+    uint32_t hits = pdev->primaryDisplay->mPlanCacheHits;
+    result.appendFormat("  prepare plan cache: %u hits / %u lookups (%u%%)\n",
+            hits, lookups, lookups ? (uint32_t)((uint64_t)hits * 100 / lookups) : 0);
+    pdev->mppBufferPool->dump(result);
+    result.appendFormat("  dynamic recomposition: %s, %.1f fps, %u mode switches, %u idle wakeups\n",
+            pdev->CompModeSwitch == HWC_2_GLES ? "GLES" : "HWC", pdev->updateFps,
+            pdev->mode_switch_cnt, pdev->update_stat_wakeups);
+    result.appendFormat("  static layer skip: %u GLES compositions saved on primary\n",
+            pdev->primaryDisplay->mDamageTracker.mSavedCompositions);
+#if !defined(HDMI_INCAPABLE)
+    result.appendFormat("  static layer skip: %u GLES compositions saved on external\n",
+            pdev->externalDisplay->mDamageTracker.mSavedCompositions);
+#endif
+    pdev->frameTrace->dump(result, pdev->hwc_ctrl.trace_dump_frames);
+
+    char path[PROPERTY_VALUE_MAX];
+    if (property_get("debug.hwc.trace_file", path, NULL) > 0) {
+        int frames = pdev->frameTrace->exportChromeTrace(path);
+        if (frames >= 0)
+            result.appendFormat("  trace of %d frames written to %s\n", frames, path);
+    }
+
     strlcpy(buff, result.string(), buff_len);
 }
 
@@ -809,6 +990,8 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
 #ifdef USES_VIRTUAL_DISPLAY
     dev->virtualDisplay->mAllocDevice = dev->primaryDisplay->mAllocDevice;
 #endif
+    dev->mppBufferPool = new ExynosBufferPool(dev->primaryDisplay->mAllocDevice);
+    dev->frameTrace = new ExynosFrameTrace();
 
     dev->primaryDisplay->mDisplayFd = open("/dev/graphics/fb0", O_RDWR);
     if (dev->primaryDisplay->mDisplayFd < 0) {
@@ -842,6 +1025,13 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
     property_get("debug.hwc.force_gpu", value, "0");
     dev->force_gpu = atoi(value);
 
+    dev->hwc_ctrl.dynamic_recomp_idle_ms = property_get_int32("debug.hwc.idle_interval_ms",
+            HWC_IDLE_INTERVAL_MS);
+    if (dev->hwc_ctrl.dynamic_recomp_idle_ms <= 0)
+        dev->hwc_ctrl.dynamic_recomp_idle_ms = HWC_IDLE_INTERVAL_MS;
+    dev->hwc_ctrl.trace_dump_frames = property_get_int32("debug.hwc.trace_dump_frames",
+            HWC_TRACE_DUMP_FRAMES);
+
     /* restore physical lcd width, height from reserved[] */
     int lcd_xres, lcd_yres;
     lcd_xres = info.reserved[0];
@@ -864,6 +1054,7 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
     dev->primaryDisplay->mXdpi = 1000 * (lcd_xres * 25.4f) / info.width;
     dev->primaryDisplay->mYdpi = 1000 * (lcd_yres * 25.4f) / info.height;
     dev->primaryDisplay->mVsyncPeriod  = 1000000000 / refreshRate;
+    dev->updateFps = refreshRate;
 
     ALOGD("using\n"
           "xres         = %d px\n"
@@ -1008,11 +1199,27 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
 #ifdef G2D_COMPOSITION
     dev->primaryDisplay->num_of_allocated_lay = 0;
 #endif
+    dev->update_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (dev->update_timer_fd < 0) {
+        ALOGE("failed to create update_stat timer: %s", strerror(errno));
+        ret = -errno;
+        goto err_vsync;
+    }
+    dev->pool_trim_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (dev->pool_trim_timer_fd < 0) {
+        ALOGE("failed to create MPP pool trim timer: %s", strerror(errno));
+        ret = -errno;
+        close(dev->update_timer_fd);
+        goto err_vsync;
+    }
+    dev->pool_trim_armed = false;
     dev->update_stat_thread_flag = true;
     ret = pthread_create(&dev->update_stat_thread, NULL, hwc_update_stat_thread, dev);
     if (ret) {
         ALOGE("failed to start update_stat thread: %s", strerror(ret));
         ret = -ret;
+        close(dev->pool_trim_timer_fd);
+        close(dev->update_timer_fd);
         goto err_vsync;
     }
 
@@ -1021,6 +1228,8 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
     dev->hwc_ctrl.dynamic_recomp_mode = (dev->psrMode == PSR_NONE);
     dev->hwc_ctrl.skip_static_layer_mode = true;
     dev->hwc_ctrl.dma_bw_balance_mode = true;
+    dev->hwc_ctrl.plan_cache_mode = true;
+    dev->hwc_ctrl.bw_plan_resume_mode = true;
 
     return 0;
 
@@ -1034,6 +1243,8 @@ err_hdmi_open:
 err_ioctl:
     close(dev->primaryDisplay->mDisplayFd);
 err_open_fb:
+    delete dev->frameTrace;
+    delete dev->mppBufferPool;
     gralloc_close(dev->primaryDisplay->mAllocDevice);
 err_get_module:
     free(dev);
@@ -1047,11 +1258,16 @@ int exynos5_close(hw_device_t *device)
     pthread_kill(dev->vsync_thread, SIGTERM);
     pthread_join(dev->vsync_thread, NULL);
     if (pthread_kill(dev->update_stat_thread, 0) != ESRCH) {
-        pthread_kill(dev->update_stat_thread, SIGTERM);
+        dev->update_stat_thread_flag = false;
+        hwc_arm_idle_timer(dev, 0);
         pthread_join(dev->update_stat_thread, NULL);
     }
+    close(dev->update_timer_fd);
+    close(dev->pool_trim_timer_fd);
     for (size_t i = 0; i < NUM_GSC_UNITS; i++)
         dev->primaryDisplay->mMPPs[i]->cleanupM2M();
+    delete dev->frameTrace;
+    delete dev->mppBufferPool;
     gralloc_close(dev->primaryDisplay->mAllocDevice);
     close(dev->vsync_fd);
 
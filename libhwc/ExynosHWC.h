@@ -27,6 +27,7 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#include <sys/timerfd.h>
 #include <sys/resource.h>
 
 #include <EGL/egl.h>
@@ -138,7 +139,8 @@ const size_t NUM_HDMI_BUFFERS = 3;
 
 #define HWC_FIMD_BW_TH  1   /* valid range 1 to 5 */
 #define HWC_FPS_TH          5    /* valid range 1 to 60 */
-#define VSYNC_INTERVAL (1000000000.0 / 60)
+#define HWC_TRACE_DUMP_FRAMES   16
+#define HWC_IDLE_INTERVAL_MS    100  /* no update for this long favors GLES */
 #define NUM_CONFIG_STABLE   10
 
 typedef enum _COMPOS_MODE_SWITCH {
@@ -209,8 +211,14 @@ struct hwc_ctrl_t {
     int     max_num_ovly;
     int     num_of_video_ovly;
     int     dynamic_recomp_mode;
+    int     dynamic_recomp_idle_ms;
     int     skip_static_layer_mode;
     int     dma_bw_balance_mode;
+    int     trace_dump_frames;
+    /* reuse the last overlay plan when the stack is unchanged */
+    int     plan_cache_mode;
+    /* resume the bandwidth plan at the FB instead of replanning every layer */
+    int     bw_plan_resume_mode;
 };
 
 #if defined(G2D_COMPOSITION)
@@ -227,6 +235,8 @@ struct exynos5_g2d_data_t {
 class ExynosPrimaryDisplay;
 class ExynosExternalDisplay;
 class ExynosVirtualDisplay;
+class ExynosBufferPool;
+class ExynosFrameTrace;
 
 struct exynos5_hwc_composer_device_1_t {
     hwc_composer_device_1_t base;
@@ -234,6 +244,8 @@ struct exynos5_hwc_composer_device_1_t {
     ExynosPrimaryDisplay    *primaryDisplay;
     ExynosExternalDisplay    *externalDisplay;
     ExynosVirtualDisplay    *virtualDisplay;
+    ExynosBufferPool        *mppBufferPool;
+    ExynosFrameTrace        *frameTrace;
     struct v4l2_rect        mVirtualDisplayRect;
 
     int                     vsync_fd;
@@ -257,12 +269,15 @@ struct exynos5_hwc_composer_device_1_t {
     int VsyncInterruptStatus;
     int CompModeSwitch;
     uint64_t LastUpdateTimeStamp;
-    uint64_t LastModeSwitchTimeStamp;
+    float updateFps;
     int totPixels;
-    int updateCallCnt;
     pthread_t   update_stat_thread;
-    int update_event_cnt;
+    int update_timer_fd;
+    int pool_trim_timer_fd;
+    volatile bool pool_trim_armed;
     volatile bool update_stat_thread_flag;
+    uint32_t mode_switch_cnt;
+    uint32_t update_stat_wakeups;
 
     struct hwc_ctrl_t    hwc_ctrl;
 
@@ -87,7 +87,10 @@ endif
 
 LOCAL_SRC_FILES += \
 	ExynosHWCUtils.cpp \
-	ExynosMPP.cpp
+	ExynosMPP.cpp \
+	ExynosBufferPool.cpp \
+	ExynosDamageTracker.cpp \
+	ExynosFrameTrace.cpp
 
 ifeq ($(BOARD_USES_VIRTUAL_DISPLAY), true)
 	LOCAL_CFLAGS += -DUSES_VIRTUAL_DISPLAY
@@ -0,0 +1,169 @@
+#include "ExynosBufferPool.h"
+#include "ExynosHWCUtils.h"
+
+ExynosBufferPool::ExynosBufferPool(alloc_device_t *allocDevice)
+    : mAllocDevice(allocDevice),
+      mNumFree(0),
+      mHits(0),
+      mMisses(0),
+      mTrimmed(0)
+{
+}
+
+ExynosBufferPool::~ExynosBufferPool()
+{
+    android::Mutex::Autolock lock(mLock);
+
+    while (!mEntries.isEmpty()) {
+        if (mEntries[0].inUse)
+            ALOGW("freeing MPP buffer %p still in use", mEntries[0].handle);
+        freeEntry(0);
+    }
+}
+
+int ExynosBufferPool::acquire(int w, int h, int format, int usage,
+        buffer_handle_t *handle, int *fence)
+{
+    android::Mutex::Autolock lock(mLock);
+    int stride;
+    int ret;
+
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        pool_entry &entry = mEntries.editItemAt(i);
+        if (entry.inUse || entry.w != w || entry.h != h ||
+                entry.format != format || entry.usage != usage)
+            continue;
+
+        entry.inUse = true;
+        *handle = entry.handle;
+        *fence = entry.fence;
+        entry.fence = -1;
+        mNumFree--;
+        mHits++;
+        return 0;
+    }
+
+    pool_entry entry;
+    memset(&entry, 0, sizeof(entry));
+    ret = mAllocDevice->alloc(mAllocDevice, w, h, format, usage, &entry.handle, &stride);
+    if (ret < 0)
+        return ret;
+
+    entry.w = w;
+    entry.h = h;
+    entry.format = format;
+    entry.usage = usage;
+    entry.fence = -1;
+    entry.inUse = true;
+    mEntries.add(entry);
+    mMisses++;
+
+    *handle = entry.handle;
+    *fence = -1;
+    return 0;
+}
+
+void ExynosBufferPool::release(buffer_handle_t handle, int fence)
+{
+    android::Mutex::Autolock lock(mLock);
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        pool_entry &entry = mEntries.editItemAt(i);
+        if (entry.handle != handle)
+            continue;
+
+        if (!entry.inUse) {
+            ALOGE("%s: MPP buffer %p released twice", __func__, handle);
+            if (fence >= 0)
+                close(fence);
+            return;
+        }
+        entry.inUse = false;
+        entry.fence = fence;
+        entry.releaseTime = now;
+        mNumFree++;
+        trimLocked(now, MPP_POOL_TRIM_AGE_MS);
+        return;
+    }
+
+    /* not from acquire(), keep the old ownership and free it */
+    ALOGW("%s: MPP buffer %p is not from the pool", __func__, handle);
+    if (fence >= 0)
+        close(fence);
+    mAllocDevice->free(mAllocDevice, handle);
+}
+
+int ExynosBufferPool::trim(int maxAgeMs)
+{
+    android::Mutex::Autolock lock(mLock);
+
+    return trimLocked(systemTime(SYSTEM_TIME_MONOTONIC), maxAgeMs);
+}
+
+bool ExynosBufferPool::hasFree()
+{
+    android::Mutex::Autolock lock(mLock);
+
+    return mNumFree > 0;
+}
+
+int ExynosBufferPool::trimLocked(nsecs_t now, int maxAgeMs)
+{
+    nsecs_t maxAge = ms2ns(maxAgeMs);
+    size_t i = 0;
+
+    while (i < mEntries.size()) {
+        const pool_entry &entry = mEntries[i];
+        if (!entry.inUse && now - entry.releaseTime >= maxAge) {
+            freeEntry(i);
+            mTrimmed++;
+        } else {
+            i++;
+        }
+    }
+
+    /* over the limit, drop the least recently released ones */
+    while (mNumFree > MPP_POOL_MAX_FREE_BUFS) {
+        size_t oldest = mEntries.size();
+        for (i = 0; i < mEntries.size(); i++) {
+            if (mEntries[i].inUse)
+                continue;
+            if (oldest == mEntries.size() ||
+                    mEntries[i].releaseTime < mEntries[oldest].releaseTime)
+                oldest = i;
+        }
+        freeEntry(oldest);
+        mTrimmed++;
+    }
+
+    nsecs_t next = -1;
+    for (i = 0; i < mEntries.size(); i++) {
+        if (mEntries[i].inUse)
+            continue;
+        nsecs_t left = maxAge - (now - mEntries[i].releaseTime);
+        if (next < 0 || left < next)
+            next = left;
+    }
+    return next < 0 ? -1 : (int)ns2ms(next + ms2ns(1) - 1);
+}
+
+void ExynosBufferPool::freeEntry(size_t index)
+{
+    const pool_entry &entry = mEntries[index];
+
+    if (entry.fence >= 0)
+        close(entry.fence);
+    mAllocDevice->free(mAllocDevice, entry.handle);
+    if (!entry.inUse)
+        mNumFree--;
+    mEntries.removeAt(index);
+}
+
+void ExynosBufferPool::dump(android::String8 &result)
+{
+    android::Mutex::Autolock lock(mLock);
+
+    result.appendFormat("  mpp buffer pool: %u hits / %u misses, %u trimmed, %zu buffers (%zu free)\n",
+            mHits, mMisses, mTrimmed, mEntries.size(), mNumFree);
+}
@@ -0,0 +1,69 @@
+#ifndef EXYNOS_BUFFER_POOL_H
+#define EXYNOS_BUFFER_POOL_H
+
+#include <utils/Mutex.h>
+#include "ExynosHWC.h"
+
+#define MPP_POOL_MAX_FREE_BUFS  (NUM_GSC_DST_BUFS * 4)
+#define MPP_POOL_TRIM_AGE_MS    1000
+
+/*
+ * Gralloc buffers for MPP destinations, shared by all the ExynosMPP objects
+ * of the device. Released buffers are kept with their release fence, keyed
+ * by (aligned w, h, format, usage), and handed out again on the next request
+ * with the same key, so a GSC moving between sizes or displays does not wait
+ * for an allocation. Free buffers are trimmed once they have not been reused
+ * for MPP_POOL_TRIM_AGE_MS, the owner calls trim() when that is due.
+ */
+class ExynosBufferPool {
+    public:
+        /* Methods */
+        ExynosBufferPool(alloc_device_t *allocDevice);
+        ~ExynosBufferPool();
+
+        /*
+         * Returns a buffer matching the key in *handle. *fence is -1 or a
+         * fence the caller must wait on before writing the buffer.
+         */
+        int acquire(int w, int h, int format, int usage,
+                buffer_handle_t *handle, int *fence);
+
+        /* Give back a buffer from acquire(); the pool owns fence from now on */
+        void release(buffer_handle_t handle, int fence);
+
+        /*
+         * Free buffers that have not been reused for maxAgeMs. Returns the
+         * time in ms until the next free buffer is that old, or -1 when no
+         * free buffer is left.
+         */
+        int trim(int maxAgeMs);
+
+        bool hasFree();
+
+        void dump(android::String8 &result);
+
+    private:
+        struct pool_entry {
+            buffer_handle_t     handle;
+            int                 w;
+            int                 h;
+            int                 format;
+            int                 usage;
+            int                 fence;
+            nsecs_t             releaseTime;
+            bool                inUse;
+        };
+
+        void freeEntry(size_t index);
+        int trimLocked(nsecs_t now, int maxAgeMs);
+
+        alloc_device_t                  *mAllocDevice;
+        android::Mutex                  mLock;
+        android::Vector<pool_entry>     mEntries;
+        size_t                          mNumFree;
+        uint32_t                        mHits;
+        uint32_t                        mMisses;
+        uint32_t                        mTrimmed;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "ExynosDamageTracker.h"
+#include "ExynosHWCUtils.h"
+
+ExynosDamageTracker::ExynosDamageTracker()
+    : mSavedCompositions(0),
+      mLayers(NULL),
+      mNumLayers(0),
+      mCapacity(0),
+      mFirstFb(0),
+      mLastFb(0),
+      mValid(false)
+{
+}
+
+ExynosDamageTracker::~ExynosDamageTracker()
+{
+    delete[] mLayers;
+}
+
+void ExynosDamageTracker::reset()
+{
+    mValid = false;
+}
+
+bool ExynosDamageTracker::isFbStatic(hwc_display_contents_1_t *contents, size_t firstFb, size_t lastFb)
+{
+    if (lastFb < firstFb || lastFb >= contents->numHwLayers) {
+        mValid = false;
+        return false;
+    }
+
+    bool unchanged = mValid && mNumLayers == contents->numHwLayers &&
+            mFirstFb == firstFb && mLastFb == lastFb;
+
+    for (size_t i = 0; unchanged && i < contents->numHwLayers; i++) {
+        hwc_layer_1_t &layer = contents->hwLayers[i];
+        const layer_state &last = mLayers[i];
+
+        /* the target itself gets a new buffer every frame */
+        if (layer.compositionType == HWC_FRAMEBUFFER_TARGET) {
+            unchanged = (last.compositionType == HWC_FRAMEBUFFER_TARGET);
+            continue;
+        }
+
+        if (i >= firstFb && i <= lastFb) {
+            /* nothing is known about the content of skipped layers */
+            if (!layer.handle || (layer.flags & HWC_SKIP_LAYER) ||
+                    layer.handle != last.handle) {
+                unchanged = false;
+                break;
+            }
+        }
+
+        unchanged = layer.compositionType == last.compositionType &&
+                layer.flags == last.flags &&
+                layer.transform == last.transform &&
+                layer.blending == last.blending &&
+                layer.planeAlpha == last.planeAlpha &&
+                !memcmp(&layer.displayFrame, &last.displayFrame, sizeof(layer.displayFrame)) &&
+                !memcmp(&layer.sourceCropf, &last.sourceCropf, sizeof(layer.sourceCropf));
+    }
+
+    if (unchanged) {
+        mSavedCompositions++;
+        return true;
+    }
+
+    record(contents, firstFb, lastFb);
+    return false;
+}
+
+void ExynosDamageTracker::record(hwc_display_contents_1_t *contents, size_t firstFb, size_t lastFb)
+{
+    if (contents->numHwLayers > mCapacity) {
+        size_t capacity = max(contents->numHwLayers, mCapacity * 2);
+        layer_state *layers = new layer_state[capacity];
+        if (layers == NULL) {
+            mValid = false;
+            return;
+        }
+        delete[] mLayers;
+        mLayers = layers;
+        mCapacity = capacity;
+    }
+
+    for (size_t i = 0; i < contents->numHwLayers; i++) {
+        hwc_layer_1_t &layer = contents->hwLayers[i];
+        layer_state &state = mLayers[i];
+
+        state.handle = layer.handle;
+        state.compositionType = layer.compositionType;
+        state.flags = layer.flags;
+        state.displayFrame = layer.displayFrame;
+        state.sourceCropf = layer.sourceCropf;
+        state.transform = layer.transform;
+        state.blending = layer.blending;
+        state.planeAlpha = layer.planeAlpha;
+    }
+
+    mNumLayers = contents->numHwLayers;
+    mFirstFb = firstFb;
+    mLastFb = lastFb;
+    mValid = true;
+}
@@ -0,0 +1,54 @@
+#ifndef EXYNOS_DAMAGE_TRACKER_H
+#define EXYNOS_DAMAGE_TRACKER_H
+
+#include "ExynosHWC.h"
+
+/*
+ * Remembers the layer stack composed into the last framebuffer target, so a
+ * display can keep showing that target instead of asking for another GLES
+ * composition when nothing in it has changed.
+ */
+class ExynosDamageTracker {
+    public:
+        /* Methods */
+        ExynosDamageTracker();
+        ~ExynosDamageTracker();
+
+        /* Forget the recorded stack; the next framebuffer target must be composed */
+        void reset();
+
+        /*
+         * Layers [firstFb, lastFb] are the ones going to GLES. Returns true when
+         * they still show the same buffers and no layer of the stack changed its
+         * geometry or composition type since the recorded frame, i.e. the last
+         * framebuffer target is still valid. Otherwise records contents for the
+         * next frame and returns false.
+         */
+        bool isFbStatic(hwc_display_contents_1_t *contents, size_t firstFb, size_t lastFb);
+
+        /* Fields */
+        uint32_t                mSavedCompositions;
+
+    private:
+        struct layer_state {
+            buffer_handle_t     handle;
+            int32_t             compositionType;
+            uint32_t            flags;
+            hwc_rect_t          displayFrame;
+            hwc_frect_t         sourceCropf;
+            uint32_t            transform;
+            int32_t             blending;
+            uint8_t             planeAlpha;
+        };
+
+        void record(hwc_display_contents_1_t *contents, size_t firstFb, size_t lastFb);
+
+        layer_state             *mLayers;
+        size_t                  mNumLayers;
+        size_t                  mCapacity;
+        size_t                  mFirstFb;
+        size_t                  mLastFb;
+        bool                    mValid;
+};
+
+#endif
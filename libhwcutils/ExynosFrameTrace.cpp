@@ -0,0 +1,136 @@
+#include <stdio.h>
+
+#include "ExynosFrameTrace.h"
+
+ExynosFrameTrace::ExynosFrameTrace()
+    : mNextFrame(0),
+      mCurrent(NULL)
+{
+    memset(mSlots, 0, sizeof(mSlots));
+}
+
+ExynosFrameTrace::~ExynosFrameTrace()
+{
+}
+
+hwc_frame_record *ExynosFrameTrace::begin(nsecs_t now)
+{
+    uint32_t frame = mNextFrame;
+    trace_slot *slot = &mSlots[frame % HWC_TRACE_FRAMES];
+
+    /*
+     * Odd while the slot is written. A frame that was prepared but never
+     * set keeps its number and is written again by the next begin().
+     */
+    __atomic_store_n(&slot->seq, frame * 2 + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memset(&slot->record, 0, sizeof(slot->record));
+    slot->record.frame = frame;
+    slot->record.prepareStart = now;
+    slot->record.fbWindow = -1;
+    mCurrent = slot;
+    return &slot->record;
+}
+
+hwc_frame_record *ExynosFrameTrace::current()
+{
+    return mCurrent ? &mCurrent->record : NULL;
+}
+
+void ExynosFrameTrace::commit()
+{
+    if (!mCurrent)
+        return;
+
+    uint32_t frame = mCurrent->record.frame;
+    __atomic_store_n(&mCurrent->seq, frame * 2 + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&mNextFrame, frame + 1, __ATOMIC_RELEASE);
+    mCurrent = NULL;
+}
+
+/* Copies the committed records, newest first, and returns how many */
+int ExynosFrameTrace::snapshot(hwc_frame_record *records, int maxFrames)
+{
+    uint32_t next = __atomic_load_n(&mNextFrame, __ATOMIC_ACQUIRE);
+    int count = 0;
+
+    if (maxFrames > HWC_TRACE_FRAMES)
+        maxFrames = HWC_TRACE_FRAMES;
+
+    for (uint32_t frame = next; frame > 0 && count < maxFrames; frame--) {
+        const trace_slot *slot = &mSlots[(frame - 1) % HWC_TRACE_FRAMES];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+        if (seq != frame * 2)
+            break;
+        records[count] = slot->record;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)
+            break;
+        count++;
+    }
+
+    return count;
+}
+
+void ExynosFrameTrace::dump(android::String8 &result, int maxFrames)
+{
+    hwc_frame_record records[HWC_TRACE_FRAMES];
+    int count = snapshot(records, maxFrames);
+
+    result.appendFormat("  last %d frames (prepare/set/fence wait in us, layers fb/ovly/m2m/otf/g2d):\n",
+            count);
+    for (int i = 0; i < count; i++) {
+        const hwc_frame_record &r = records[i];
+        result.appendFormat("    #%-6u %6lld %6lld %6lld | %2u: %2u/%2u/%u/%u/%u | fb %2d %s |",
+                r.frame, (long long)ns2us(r.prepareTime), (long long)ns2us(r.setTime),
+                (long long)ns2us(r.fenceWaitTime), r.numLayers, r.fbLayers,
+                r.overlayLayers, r.gscM2M, r.gscOtf, r.g2dLayers, r.fbWindow,
+                r.compMode == HWC_2_GLES ? "GLES" : "HWC ");
+        for (size_t w = 0; w < NUM_HW_WINDOWS; w++)
+            result.appendFormat(" %7u", r.winPixels[w]);
+        result.append("\n");
+    }
+}
+
+int ExynosFrameTrace::exportChromeTrace(const char *path)
+{
+    hwc_frame_record records[HWC_TRACE_FRAMES];
+    int count = snapshot(records, HWC_TRACE_FRAMES);
+    FILE *fp = fopen(path, "w");
+
+    if (!fp) {
+        ALOGE("%s: failed to open %s: %s", __func__, path, strerror(errno));
+        return -errno;
+    }
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (int i = count - 1; i >= 0; i--) {
+        const hwc_frame_record &r = records[i];
+        long long ts = (long long)ns2us(r.prepareStart);
+
+        fprintf(fp, "{\"name\":\"prepare\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lld,\"dur\":%lld,"
+                "\"args\":{\"frame\":%u,\"comp\":\"%s\"}},\n",
+                ts, (long long)ns2us(r.prepareTime), r.frame,
+                r.compMode == HWC_2_GLES ? "GLES" : "HWC");
+        fprintf(fp, "{\"name\":\"set\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lld,\"dur\":%lld,"
+                "\"args\":{\"frame\":%u,\"fence_wait_us\":%lld}},\n",
+                (long long)ns2us(r.setStart), (long long)ns2us(r.setTime), r.frame,
+                (long long)ns2us(r.fenceWaitTime));
+        fprintf(fp, "{\"name\":\"layers\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,"
+                "\"args\":{\"fb\":%u,\"overlay\":%u,\"gsc_m2m\":%u,\"gsc_otf\":%u,\"g2d\":%u}},\n",
+                ts, r.fbLayers, r.overlayLayers, r.gscM2M, r.gscOtf, r.g2dLayers);
+        fprintf(fp, "{\"name\":\"window pixels\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{", ts);
+        for (size_t w = 0; w < NUM_HW_WINDOWS; w++)
+            fprintf(fp, "%s\"win%zu\":%u", w ? "," : "", w, r.winPixels[w]);
+        fprintf(fp, "}}%s\n", i ? "," : "");
+    }
+    fprintf(fp, "]}\n");
+
+    if (fclose(fp) < 0) {
+        ALOGE("%s: failed to write %s: %s", __func__, path, strerror(errno));
+        return -errno;
+    }
+    return count;
+}
@@ -0,0 +1,66 @@
+#ifndef EXYNOS_FRAME_TRACE_H
+#define EXYNOS_FRAME_TRACE_H
+
+#include "ExynosHWC.h"
+
+#define HWC_TRACE_FRAMES    128
+
+/* what the primary display did in one prepare()/set() cycle */
+struct hwc_frame_record {
+    uint32_t    frame;
+    nsecs_t     prepareStart;
+    nsecs_t     prepareTime;
+    nsecs_t     setStart;
+    nsecs_t     setTime;
+    /* time set() spent blocked in sync_wait() on the composer thread */
+    nsecs_t     fenceWaitTime;
+    uint8_t     numLayers;
+    uint8_t     fbLayers;
+    uint8_t     overlayLayers;
+    uint8_t     gscM2M;
+    uint8_t     gscOtf;
+    uint8_t     g2dLayers;
+    int8_t      fbWindow;
+    uint8_t     compMode;
+    /* pixels fetched by each window DMA channel */
+    uint32_t    winPixels[NUM_HW_WINDOWS];
+};
+
+/*
+ * Fixed-size history of the last HWC_TRACE_FRAMES frames. The composer
+ * thread is the only writer and never takes a lock: every slot carries a
+ * sequence number that is odd while the slot is being written, so dump()
+ * can run from the binder thread and simply drops the slots that changed
+ * under it.
+ */
+class ExynosFrameTrace {
+    public:
+        /* Methods */
+        ExynosFrameTrace();
+        ~ExynosFrameTrace();
+
+        /* Composer thread only: start the record of a new frame */
+        hwc_frame_record *begin(nsecs_t now);
+        /* Composer thread only: the record from begin(), NULL once committed */
+        hwc_frame_record *current();
+        /* Composer thread only: make the current record visible to readers */
+        void commit();
+
+        void dump(android::String8 &result, int maxFrames);
+        /* Write the trace as Chrome JSON trace events, for ui.perfetto.dev */
+        int exportChromeTrace(const char *path);
+
+    private:
+        struct trace_slot {
+            uint32_t            seq;
+            hwc_frame_record    record;
+        };
+
+        int snapshot(hwc_frame_record *records, int maxFrames);
+
+        trace_slot              mSlots[HWC_TRACE_FRAMES];
+        uint32_t                mNextFrame;
+        trace_slot              *mCurrent;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "ExynosMPP.h"
 #include "ExynosHWCUtils.h"
+#include "ExynosBufferPool.h"
 
 ExynosMPP::ExynosMPP()
 {
@@ -504,11 +505,31 @@ void ExynosMPP::setupM2MDestination(exynos_mpp_img &src_img, exynos_mpp_img &dst
                 GSC_DST_CROP_W_ALIGNMENT_RGB888);
 }
 
+void ExynosMPP::releaseBuffers()
+{
+    ExynosBufferPool *pool = mDisplay->mHwc->mppBufferPool;
+
+    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
+        if (mDstBuffers[i])
+            pool->release(mDstBuffers[i], mDstBufFence[i]);
+        else if (mDstBufFence[i] >= 0)
+            close(mDstBufFence[i]);
+        mDstBuffers[i] = NULL;
+        mDstBufFence[i] = -1;
+
+        if (mMidBuffers[i])
+            pool->release(mMidBuffers[i], mMidBufFence[i]);
+        else if (mMidBufFence[i] >= 0)
+            close(mMidBufFence[i]);
+        mMidBuffers[i] = NULL;
+        mMidBufFence[i] = -1;
+    }
+}
+
 int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &dst_img, exynos_mpp_img &mid_img, bool need_gsc_op_twice)
 {
-    alloc_device_t* alloc_device = mDisplay->mAllocDevice;
+    ExynosBufferPool *pool = mDisplay->mHwc->mppBufferPool;
     int ret = 0;
-    int dst_stride;
     int usage = GRALLOC_USAGE_SW_READ_NEVER |
             GRALLOC_USAGE_SW_WRITE_NEVER |
 #ifdef USE_FB_PHY_LINEAR
@@ -556,31 +577,16 @@ int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &d
         }
     }
 
-    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
-        if (mDstBuffers[i]) {
-            alloc_device->free(alloc_device, mDstBuffers[i]);
-            mDstBuffers[i] = NULL;
-        }
-
-        if (mDstBufFence[i] >= 0) {
-            close(mDstBufFence[i]);
-            mDstBufFence[i] = -1;
-        }
-
-        if (mMidBuffers[i] != NULL) {
-            alloc_device->free(alloc_device, mMidBuffers[i]);
-            mMidBuffers[i] = NULL;
-        }
-
-        if (mMidBufFence[i] >= 0) {
-            close(mMidBufFence[i]);
-            mMidBufFence[i] = -1;
-        }
+    /*
+     * Buffers go back to the shared pool first, so a configuration change
+     * that keeps the destination size reuses them without allocating.
+     */
+    releaseBuffers();
 
+    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
         int format = dst_img.format;
-        ret = alloc_device->alloc(alloc_device, w, h,
-                format, usage, &mDstBuffers[i],
-                &dst_stride);
+        ret = pool->acquire(w, h, format, usage,
+                &mDstBuffers[i], &mDstBufFence[i]);
         if (ret < 0) {
             ALOGE("failed to allocate destination buffer(%dx%d): %s", w, h,
                     strerror(-ret));
@@ -588,9 +594,9 @@ int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &d
         }
 
         if (need_gsc_op_twice) {
-            ret = alloc_device->alloc(alloc_device, mid_img.w, mid_img.h,
-                     HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M, usage, &mMidBuffers[i],
-                     &dst_stride);
+            ret = pool->acquire(mid_img.w, mid_img.h,
+                     HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M, usage,
+                     &mMidBuffers[i], &mMidBufFence[i]);
             if (ret < 0) {
                 ALOGE("failed to allocate intermediate buffer(%dx%d): %s", mid_img.w, mid_img.h,
                         strerror(-ret));
@@ -609,7 +615,6 @@ int ExynosMPP::processM2M(hwc_layer_1_t &layer, int dst_format, hwc_frect_t *sou
 {
     ALOGV("configuring gscaler %u for memory-to-memory", AVAILABLE_GSC_UNITS[mIndex]);
 
-    alloc_device_t* alloc_device = mDisplay->mAllocDevice;
     private_handle_t *src_handle = private_handle_t::dynamicCast(layer.handle);
     buffer_handle_t dst_buf;
     private_handle_t *dst_handle;
@@ -827,24 +832,7 @@ err_alloc:
 #ifdef USES_VIRTUAL_DISPLAY
     if (isNeedBufferAlloc) {
 #endif
-    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
-       if (mDstBuffers[i]) {
-           alloc_device->free(alloc_device, mDstBuffers[i]);
-           mDstBuffers[i] = NULL;
-       }
-       if (mDstBufFence[i] >= 0) {
-           close(mDstBufFence[i]);
-           mDstBufFence[i] = -1;
-       }
-       if (mMidBuffers[i]) {
-           alloc_device->free(alloc_device, mMidBuffers[i]);
-           mMidBuffers[i] = NULL;
-       }
-       if (mMidBufFence[i] >= 0) {
-           close(mMidBufFence[i]);
-           mMidBufFence[i] = -1;
-       }
-    }
+    releaseBuffers();
 #ifdef USES_VIRTUAL_DISPLAY
     }
 #endif
@@ -861,12 +849,12 @@ void ExynosMPP::cleanupM2M()
 
     ALOGV("closing gscaler %u", AVAILABLE_GSC_UNITS[mIndex]);
 
+    /*
+     * The destination fences are not waited here: releaseBuffers() hands
+     * them to the buffer pool with their buffers, and whoever gets a buffer
+     * next waits for its fence on the scaler side.
+     */
     for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
-#ifndef FORCEFB_YUVLAYER
-        if (mDstBufFence[i] >= 0)
-            if (sync_wait(mDstBufFence[i], 1000) < 0)
-                ALOGE("sync_wait error");
-#endif
         if (mMidBufFence[i] >= 0)
             if (sync_wait(mMidBufFence[i], 1000) < 0)
                 ALOGE("sync_wait error");
@@ -874,33 +862,15 @@ void ExynosMPP::cleanupM2M()
 
     stopMPP(mGscHandle);
     destroyMPP(mGscHandle);
-    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
-        if (mDstBuffers[i])
-            mDisplay->mAllocDevice->free(mDisplay->mAllocDevice, mDstBuffers[i]);
-        if (mDstBufFence[i] >= 0)
-            close(mDstBufFence[i]);
-        if (mMidBuffers[i]) {
-            mDisplay->mAllocDevice->free(mDisplay->mAllocDevice, mMidBuffers[i]);
-            mMidBuffers[i] = NULL;
-        }
-        if (mMidBufFence[i] >= 0)
-            close(mMidBufFence[i]);
-    }
+    releaseBuffers();
 
     mGscHandle = NULL;
     memset(&mSrcConfig, 0, sizeof(mSrcConfig));
     memset(&mMidConfig, 0, sizeof(mMidConfig));
     memset(&mDstConfig, 0, sizeof(mDstConfig));
-    memset(mDstBuffers, 0, sizeof(mDstBuffers));
-    memset(mMidBuffers, 0, sizeof(mMidBuffers));
     mCurrentBuf = 0;
     mGSCMode = 0;
     mLastGSCLayerHandle = NULL;
-    
-    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
-        mDstBufFence[i] = -1;
-        mMidBufFence[i] = -1;
-    }
 }
 
 void ExynosMPP::cleanupOTF()
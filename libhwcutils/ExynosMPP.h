@@ -78,6 +78,7 @@ class ExynosMPP {
         virtual void setupM2MDestination(exynos_mpp_img &src_img, exynos_mpp_img &dst_img, int dst_format, hwc_layer_1_t &layer, hwc_frect_t *sourceCrop);
         bool setupDoubleOperation(exynos_mpp_img &src_img, exynos_mpp_img &mid_img, hwc_layer_1_t &layer);
         int reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &dst_img, exynos_mpp_img &mid_img, bool need_gsc_op_twice);
+        void releaseBuffers();
 
         /*
          * Override these virtual functions in chip directory to handle per-chip differences
@@ -19,11 +19,13 @@ include $(CLEAR_VARS)
 LOCAL_SRC_FILES := \
 	exynos_v4l2.c \
 	exynos_subdev.c \
-	exynos_mc.c
+	exynos_mc.c \
+	ExynosVideoSession.c
 
 LOCAL_C_INCLUDES := \
 	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
 	$(LOCAL_PATH)/../include \
+	$(LOCAL_PATH)/../libvideocodec/include \
 	$(TOP)/hardware/samsung_slsi-cm/exynos/libexynosutils
 
 LOCAL_ADDITIONAL_DEPENDENCIES := \
@@ -38,3 +40,20 @@ LOCAL_MODULE := libexynosv4l2
 LOCAL_MODULE_TAGS := eng
 
 include $(BUILD_SHARED_LIBRARY)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	exynos_v4l2_fake_mfc.c
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(LOCAL_PATH)/../include
+
+LOCAL_ADDITIONAL_DEPENDENCIES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+LOCAL_MODULE := libexynosv4l2_fakemfc
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,338 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        ExynosVideoSession.c
+ * @brief       MFC load scheduler shared by the decoder/encoder instances
+ * @version     1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "ExynosVideoApi.h"
+#include "ExynosVideoSession.h"
+
+/* #define LOG_NDEBUG 0 */
+#define LOG_TAG "ExynosVideoSession"
+#include <utils/Log.h>
+
+typedef struct _ExynosVideoSession {
+    ExynosVideoBoolType         bUsed;
+    int                         hDevice;
+    int                         nBaseQosRatio;      /* asked by the client */
+    ExynosVideoFrameSkipMode    eBaseFrameSkip;     /* asked by the client */
+    ExynosVideoSessionInfo      info;               /* nQosRatio/eFrameSkip: set on the device */
+} ExynosVideoSession;
+
+static pthread_mutex_t    gSessionLock = PTHREAD_MUTEX_INITIALIZER;
+static ExynosVideoSession gSessions[VIDEO_SESSION_MAX];
+static unsigned int       gBudgetMBps  = 0;
+static unsigned int       gDemandMBps  = 0;
+
+static int Session_FrameSkipToV4L2(ExynosVideoFrameSkipMode eMode)
+{
+    switch (eMode) {
+    case VIDEO_FRAME_SKIP_MODE_LEVEL_LIMIT:
+        return V4L2_MPEG_MFC51_VIDEO_FRAME_SKIP_MODE_LEVEL_LIMIT;
+    case VIDEO_FRAME_SKIP_MODE_BUF_LIMIT:
+        return V4L2_MPEG_MFC51_VIDEO_FRAME_SKIP_MODE_BUF_LIMIT;
+    default:
+        return V4L2_MPEG_MFC51_VIDEO_FRAME_SKIP_MODE_DISABLED;
+    }
+}
+
+static ExynosVideoSession *Session_Get(int nId)
+{
+    if ((nId < 0) || (nId >= VIDEO_SESSION_MAX) || (gSessions[nId].bUsed != VIDEO_TRUE))
+        return NULL;
+
+    return &gSessions[nId];
+}
+
+static ExynosVideoErrorType Session_Apply(
+    ExynosVideoSession       *pSession,
+    int                       nQosRatio,
+    ExynosVideoFrameSkipMode  eFrameSkip)
+{
+    ExynosVideoErrorType ret = VIDEO_ERROR_NONE;
+
+    if (pSession->info.nQosRatio != nQosRatio) {
+        if (exynos_v4l2_s_ctrl(pSession->hDevice, V4L2_CID_MPEG_VIDEO_QOS_RATIO, nQosRatio) != 0) {
+            ALOGE("%s: Failed to s_ctrl QOS_RATIO(%d) of session %d", __func__, nQosRatio, pSession->info.nId);
+            ret = VIDEO_ERROR_APIFAIL;
+        } else {
+            pSession->info.nQosRatio = nQosRatio;
+        }
+    }
+
+    if ((pSession->info.bIsDec == VIDEO_FALSE) &&
+        (pSession->info.eFrameSkip != eFrameSkip)) {
+        if (exynos_v4l2_s_ctrl(pSession->hDevice, V4L2_CID_MPEG_MFC51_VIDEO_FRAME_SKIP_MODE,
+                               Session_FrameSkipToV4L2(eFrameSkip)) != 0) {
+            ALOGE("%s: Failed to s_ctrl FRAME_SKIP_MODE(%d) of session %d", __func__, eFrameSkip, pSession->info.nId);
+            ret = VIDEO_ERROR_APIFAIL;
+        } else {
+            pSession->info.eFrameSkip = eFrameSkip;
+        }
+    }
+
+    /* a failed setting is kept unapplied, the next scheduling retries it */
+    pSession->info.eApplyError = ret;
+    if (ret != VIDEO_ERROR_NONE)
+        pSession->info.nApplyFailures++;
+
+    return ret;
+}
+
+/*
+ * Recomputes every session against the budget, gSessionLock held. The
+ * lock also keeps the devices of the other sessions open: they close
+ * their session before their fd. Failures of the other sessions are
+ * reported in their eApplyError/nApplyFailures.
+ * Returns the result of applying the settings of nId.
+ */
+static ExynosVideoErrorType Session_Schedule(int nId)
+{
+    ExynosVideoErrorType     ret    = VIDEO_ERROR_NONE;
+    ExynosVideoErrorType     status;
+    ExynosVideoSession      *pSession;
+    ExynosVideoFrameSkipMode eFrameSkip;
+    unsigned long long       demand = 0;
+    int                      scale  = 100;
+    int                      ratio;
+    int                      i;
+
+    for (i = 0; i < VIDEO_SESSION_MAX; i++) {
+        if (gSessions[i].bUsed == VIDEO_TRUE)
+            demand += gSessions[i].info.nMBps;
+    }
+    gDemandMBps = (demand > 0xffffffffULL) ? 0xffffffff : (unsigned int)demand;
+
+    if ((gBudgetMBps != 0) && (demand > gBudgetMBps)) {
+        scale = (int)((unsigned long long)gBudgetMBps * 100 / demand);
+        if (scale < VIDEO_SESSION_MIN_SCALE)
+            scale = VIDEO_SESSION_MIN_SCALE;
+    }
+
+    for (i = 0; i < VIDEO_SESSION_MAX; i++) {
+        pSession = &gSessions[i];
+        if (pSession->bUsed != VIDEO_TRUE)
+            continue;
+
+        ratio = pSession->nBaseQosRatio * scale / 100;
+        if (ratio < 1)
+            ratio = 1;
+
+        eFrameSkip = pSession->eBaseFrameSkip;
+        if ((scale < 100) && (eFrameSkip == VIDEO_FRAME_SKIP_DISABLED))
+            eFrameSkip = VIDEO_FRAME_SKIP_MODE_LEVEL_LIMIT;
+
+        status = Session_Apply(pSession, ratio, eFrameSkip);
+        if (i == nId)
+            ret = status;
+    }
+
+    ALOGV("%s: demand %u MB/s, budget %u MB/s, scale %d%%", __func__, gDemandMBps, gBudgetMBps, scale);
+
+    return ret;
+}
+
+int Exynos_Video_Session_Open(
+    int                   hDevice,
+    ExynosVideoBoolType   bIsDec,
+    ExynosVideoCodingType eCodecType)
+{
+    ExynosVideoSession *pSession = NULL;
+    int                 nId      = -1;
+    int                 i;
+
+    pthread_mutex_lock(&gSessionLock);
+
+    for (i = 0; i < VIDEO_SESSION_MAX; i++) {
+        if (gSessions[i].bUsed != VIDEO_TRUE) {
+            nId = i;
+            break;
+        }
+    }
+
+    if (nId < 0) {
+        ALOGE("%s: No free session, the instance is not scheduled", __func__);
+        goto EXIT;
+    }
+
+    pSession = &gSessions[nId];
+    memset(pSession, 0, sizeof(*pSession));
+    pSession->bUsed = VIDEO_TRUE;
+    pSession->hDevice = hDevice;
+    pSession->nBaseQosRatio = 100;
+    pSession->eBaseFrameSkip = VIDEO_FRAME_SKIP_DISABLED;
+    pSession->info.nId = nId;
+    pSession->info.bIsDec = bIsDec;
+    pSession->info.eCodecType = eCodecType;
+    pSession->info.nFramerate = VIDEO_SESSION_DEFAULT_FRAMERATE;
+    /* driver defaults */
+    pSession->info.nQosRatio = 100;
+    pSession->info.eFrameSkip = VIDEO_FRAME_SKIP_DISABLED;
+    pSession->info.eApplyError = VIDEO_ERROR_NONE;
+
+EXIT:
+    pthread_mutex_unlock(&gSessionLock);
+
+    return nId;
+}
+
+void Exynos_Video_Session_Close(int nId)
+{
+    ExynosVideoSession *pSession;
+
+    pthread_mutex_lock(&gSessionLock);
+
+    pSession = Session_Get(nId);
+    if (pSession == NULL)
+        goto EXIT;
+
+    pSession->bUsed = VIDEO_FALSE;
+
+    /* the others may get their share back */
+    Session_Schedule(-1);
+
+EXIT:
+    pthread_mutex_unlock(&gSessionLock);
+}
+
+void Exynos_Video_Session_Set_Format(
+    int          nId,
+    unsigned int nWidth,
+    unsigned int nHeight,
+    unsigned int nFramerate)
+{
+    ExynosVideoSession *pSession;
+
+    pthread_mutex_lock(&gSessionLock);
+
+    pSession = Session_Get(nId);
+    if (pSession == NULL)
+        goto EXIT;
+
+    if (nWidth != 0)
+        pSession->info.nWidth = nWidth;
+    if (nHeight != 0)
+        pSession->info.nHeight = nHeight;
+    if (nFramerate != 0)
+        pSession->info.nFramerate = nFramerate;
+
+    pSession->info.nMBps = ((pSession->info.nWidth + 15) / 16) *
+                           ((pSession->info.nHeight + 15) / 16) *
+                           pSession->info.nFramerate;
+
+    Session_Schedule(nId);
+
+EXIT:
+    pthread_mutex_unlock(&gSessionLock);
+}
+
+ExynosVideoErrorType Exynos_Video_Session_Set_QosRatio(
+    int nId,
+    int nRatio)
+{
+    ExynosVideoErrorType  ret = VIDEO_ERROR_NONE;
+    ExynosVideoSession   *pSession;
+
+    pthread_mutex_lock(&gSessionLock);
+
+    pSession = Session_Get(nId);
+    if (pSession == NULL) {
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    pSession->nBaseQosRatio = nRatio;
+    ret = Session_Schedule(nId);
+
+EXIT:
+    pthread_mutex_unlock(&gSessionLock);
+
+    return ret;
+}
+
+ExynosVideoErrorType Exynos_Video_Session_Set_FrameSkip(
+    int                      nId,
+    ExynosVideoFrameSkipMode eMode,
+    ExynosVideoBoolType      bApplied)
+{
+    ExynosVideoErrorType  ret = VIDEO_ERROR_NONE;
+    ExynosVideoSession   *pSession;
+
+    pthread_mutex_lock(&gSessionLock);
+
+    pSession = Session_Get(nId);
+    if (pSession == NULL) {
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    pSession->eBaseFrameSkip = eMode;
+    if (bApplied == VIDEO_TRUE)
+        pSession->info.eFrameSkip = eMode;
+    ret = Session_Schedule(nId);
+
+EXIT:
+    pthread_mutex_unlock(&gSessionLock);
+
+    return ret;
+}
+
+ExynosVideoErrorType Exynos_Video_Set_LoadBudget(
+    unsigned int nBudgetMBps)
+{
+    pthread_mutex_lock(&gSessionLock);
+
+    gBudgetMBps = nBudgetMBps;
+    Session_Schedule(-1);
+
+    pthread_mutex_unlock(&gSessionLock);
+
+    return VIDEO_ERROR_NONE;
+}
+
+ExynosVideoErrorType Exynos_Video_Get_Load(
+    ExynosVideoLoadInfo *pLoadInfo)
+{
+    int i;
+
+    if (pLoadInfo == NULL) {
+        ALOGE("%s: Load info must be supplied", __func__);
+        return VIDEO_ERROR_BADPARAM;
+    }
+
+    memset(pLoadInfo, 0, sizeof(*pLoadInfo));
+
+    pthread_mutex_lock(&gSessionLock);
+
+    pLoadInfo->nBudgetMBps = gBudgetMBps;
+    pLoadInfo->nDemandMBps = gDemandMBps;
+    for (i = 0; i < VIDEO_SESSION_MAX; i++) {
+        if (gSessions[i].bUsed == VIDEO_TRUE)
+            pLoadInfo->sessions[pLoadInfo->nSessions++] = gSessions[i].info;
+    }
+
+    pthread_mutex_unlock(&gSessionLock);
+
+    return VIDEO_ERROR_NONE;
+}
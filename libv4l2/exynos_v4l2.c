@@ -32,8 +32,11 @@
 #include <stdarg.h>
 #include <fcntl.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 #include "exynos_v4l2.h"
@@ -44,6 +47,8 @@
 #include "Exynos_log.h"
 
 #define VIDEODEV_MAX 255
+#define BACKEND_MAX 4
+#define BACKEND_FD_MAX 32
 
 //#define EXYNOS_V4L2_TRACE 0
 #ifdef EXYNOS_V4L2_TRACE
@@ -75,6 +80,144 @@ static bool __v4l2_check_buf_type(enum v4l2_buf_type type)
     return supported;
 }
 
+static pthread_mutex_t backend_lock = PTHREAD_MUTEX_INITIALIZER;
+static const struct exynos_v4l2_backend *backends[BACKEND_MAX];
+static struct {
+    int fd;
+    const struct exynos_v4l2_backend *backend;
+} backend_fds[BACKEND_FD_MAX];
+/* read without the lock so that devices on the kernel don't pay for it */
+static int backend_fd_count;
+
+int exynos_v4l2_register_backend(const struct exynos_v4l2_backend *backend)
+{
+    int i, ret = -1;
+
+    if (!backend || !backend->match || !backend->open || !backend->close || !backend->ioctl) {
+        ALOGE("%s: incomplete backend", __func__);
+        return ret;
+    }
+
+    pthread_mutex_lock(&backend_lock);
+    for (i = 0; i < BACKEND_MAX; i++) {
+        if (backends[i] == NULL) {
+            backends[i] = backend;
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&backend_lock);
+
+    if (ret)
+        ALOGE("%s: no room for backend %s", __func__, backend->name);
+    else
+        ALOGI("backend %s registered", backend->name);
+
+    return ret;
+}
+
+int exynos_v4l2_unregister_backend(const struct exynos_v4l2_backend *backend)
+{
+    int i, ret = -1;
+
+    pthread_mutex_lock(&backend_lock);
+    for (i = 0; i < BACKEND_FD_MAX; i++) {
+        if (backend_fds[i].backend == backend) {
+            ALOGE("%s: backend %s still has fd %d open", __func__, backend->name, backend_fds[i].fd);
+            pthread_mutex_unlock(&backend_lock);
+            return ret;
+        }
+    }
+    for (i = 0; i < BACKEND_MAX; i++) {
+        if (backends[i] == backend) {
+            backends[i] = NULL;
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&backend_lock);
+
+    return ret;
+}
+
+static const struct exynos_v4l2_backend *__v4l2_match_backend(const char *name)
+{
+    const struct exynos_v4l2_backend *backend = NULL;
+    int i;
+
+    pthread_mutex_lock(&backend_lock);
+    for (i = 0; i < BACKEND_MAX; i++) {
+        if (backends[i] && backends[i]->match(name)) {
+            backend = backends[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&backend_lock);
+
+    return backend;
+}
+
+static int __v4l2_backend_open(const struct exynos_v4l2_backend *backend,
+        const char *name, int oflag)
+{
+    int i, fd;
+
+    fd = backend->open(name, oflag);
+    if (fd < 0)
+        return fd;
+
+    pthread_mutex_lock(&backend_lock);
+    for (i = 0; i < BACKEND_FD_MAX; i++) {
+        if (backend_fds[i].backend == NULL) {
+            backend_fds[i].fd = fd;
+            backend_fds[i].backend = backend;
+            __atomic_add_fetch(&backend_fd_count, 1, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&backend_lock);
+
+    if (i == BACKEND_FD_MAX) {
+        ALOGE("%s: too many %s devices open", __func__, backend->name);
+        backend->close(fd);
+        return -1;
+    }
+
+    ALOGI("open %s on backend %s (fd %d)", name, backend->name, fd);
+
+    return fd;
+}
+
+static const struct exynos_v4l2_backend *__v4l2_fd_backend(int fd)
+{
+    const struct exynos_v4l2_backend *backend = NULL;
+    int i;
+
+    if (__atomic_load_n(&backend_fd_count, __ATOMIC_ACQUIRE) == 0)
+        return NULL;
+
+    pthread_mutex_lock(&backend_lock);
+    for (i = 0; i < BACKEND_FD_MAX; i++) {
+        if (backend_fds[i].backend && backend_fds[i].fd == fd) {
+            backend = backend_fds[i].backend;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&backend_lock);
+
+    return backend;
+}
+
+static int __v4l2_ioctl(int fd, unsigned long request, void *arg)
+{
+    const struct exynos_v4l2_backend *backend = __v4l2_fd_backend(fd);
+
+    if (backend)
+        return backend->ioctl(fd, request, arg);
+
+    return ioctl(fd, request, arg);
+}
+
 static int __v4l2_open(const char *filename, int oflag, va_list ap)
 {
     mode_t mode = 0;
@@ -90,11 +233,19 @@ static int __v4l2_open(const char *filename, int oflag, va_list ap)
 
 int exynos_v4l2_open(const char *filename, int oflag, ...)
 {
+    const struct exynos_v4l2_backend *backend;
     va_list ap;
     int fd;
 
     Exynos_v4l2_In();
 
+    backend = __v4l2_match_backend(filename);
+    if (backend) {
+        fd = __v4l2_backend_open(backend, filename, oflag);
+        Exynos_v4l2_Out();
+        return fd;
+    }
+
     va_start(ap, oflag);
     fd = __v4l2_open(filename, oflag, ap);
     va_end(ap);
@@ -114,9 +265,17 @@ int exynos_v4l2_open_devname(const char *devname, int oflag, ...)
     char filename[64], name[64];
     int i = 0;
     char *rc = NULL;
+    const struct exynos_v4l2_backend *backend;
 
     Exynos_v4l2_In();
 
+    backend = __v4l2_match_backend(devname);
+    if (backend) {
+        fd = __v4l2_backend_open(backend, devname, oflag);
+        Exynos_v4l2_Out();
+        return fd;
+    }
+
     do {
         if (i > VIDEODEV_MAX)
             break;
@@ -180,20 +339,48 @@ int exynos_v4l2_open_devname(const char *devname, int oflag, ...)
 
 int exynos_v4l2_close(int fd)
 {
+    const struct exynos_v4l2_backend *backend;
     int ret = -1;
+    int i;
 
     Exynos_v4l2_In();
 
-    if (fd < 0)
+    if (fd < 0) {
         ALOGE("%s: invalid fd: %d", __func__, fd);
-    else
+        return ret;
+    }
+
+    backend = __v4l2_fd_backend(fd);
+    if (backend) {
+        pthread_mutex_lock(&backend_lock);
+        for (i = 0; i < BACKEND_FD_MAX; i++) {
+            if (backend_fds[i].backend && backend_fds[i].fd == fd) {
+                backend_fds[i].backend = NULL;
+                __atomic_sub_fetch(&backend_fd_count, 1, __ATOMIC_RELEASE);
+                break;
+            }
+        }
+        pthread_mutex_unlock(&backend_lock);
+        ret = backend->close(fd);
+    } else {
         ret = close(fd);
+    }
 
     Exynos_v4l2_Out();
 
     return ret;
 }
 
+void *exynos_v4l2_mmap(int fd, size_t length, int prot, int flags, off_t offset)
+{
+    const struct exynos_v4l2_backend *backend = __v4l2_fd_backend(fd);
+
+    if (backend && backend->mmap)
+        return backend->mmap(fd, length, prot, flags, offset);
+
+    return mmap(NULL, length, prot, flags, fd, offset);
+}
+
 bool exynos_v4l2_enuminput(int fd, int index, char *input_name_buf)
 {
     int ret = -1;
@@ -208,7 +395,7 @@ bool exynos_v4l2_enuminput(int fd, int index, char *input_name_buf)
         return NULL;
     }
 
-    ret = ioctl(fd, VIDIOC_ENUMINPUT, &input, 32);
+    ret = __v4l2_ioctl(fd, VIDIOC_ENUMINPUT, &input);
     if (ret) {
         ALOGE("%s: no matching index founds", __func__);
         return false;
@@ -237,7 +424,7 @@ int exynos_v4l2_s_input(int fd, int index)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_S_INPUT, &input);
+    ret = __v4l2_ioctl(fd, VIDIOC_S_INPUT, &input);
     if (ret){
         ALOGE("failed to ioctl: VIDIOC_S_INPUT (%d - %s)", errno, strerror(errno));
         return ret;
@@ -271,7 +458,7 @@ bool exynos_v4l2_querycap(int fd, unsigned int need_caps)
 
     memset(&cap, 0, sizeof(cap));
 
-    ret = ioctl(fd, VIDIOC_QUERYCAP, &cap);
+    ret = __v4l2_ioctl(fd, VIDIOC_QUERYCAP, &cap);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_QUERYCAP (%d - %s)", errno, strerror(errno));
         return false;
@@ -297,7 +484,7 @@ bool exynos_v4l2_enum_fmt(int fd, enum v4l2_buf_type type, unsigned int fmt)
 
     Exynos_v4l2_In();
 
-    while (ioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) == 0) {
+    while (__v4l2_ioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) == 0) {
         if (fmtdesc.pixelformat == fmt) {
             ALOGE("Passed fmt = %#x found pixel format[%d]: %s", fmt, fmtdesc.index, fmtdesc.description);
             found = 1;
@@ -338,7 +525,7 @@ int exynos_v4l2_g_fmt(int fd, struct v4l2_format *fmt)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_G_FMT, fmt);
+    ret = __v4l2_ioctl(fd, VIDIOC_G_FMT, fmt);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_G_FMT (%d - %s)", errno, strerror(errno));
         return ret;
@@ -369,7 +556,7 @@ static int __v4l2_s_fmt(int fd, unsigned int request, struct v4l2_format *fmt)
         ALOGE("%s: unsupported buffer type", __func__);
         return ret;
     } else {
-        ret = ioctl(fd, request, fmt);
+        ret = __v4l2_ioctl(fd, request, fmt);
         if (ret) {
             if (request == VIDIOC_TRY_FMT)
                 ALOGE("failed to ioctl: VIDIOC_TRY_FMT (%d - %s)", errno, strerror(errno));
@@ -426,7 +613,7 @@ int exynos_v4l2_reqbufs(int fd, struct v4l2_requestbuffers *req)
 
     count = req->count;
 
-    ret = ioctl(fd, VIDIOC_REQBUFS, req);
+    ret = __v4l2_ioctl(fd, VIDIOC_REQBUFS, req);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_REQBUFS (%d - %s)", ret, strerror(errno));
         return ret;
@@ -468,7 +655,7 @@ int exynos_v4l2_querybuf(int fd, struct v4l2_buffer *buf)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_QUERYBUF, buf);
+    ret = __v4l2_ioctl(fd, VIDIOC_QUERYBUF, buf);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_QUERYBUF (%d - %s)", errno, strerror(errno));
         return ret;
@@ -507,7 +694,7 @@ int exynos_v4l2_qbuf(int fd, struct v4l2_buffer *buf)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_QBUF, buf);
+    ret = __v4l2_ioctl(fd, VIDIOC_QBUF, buf);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_QBUF (%d - %s)", errno, strerror(errno));
         return ret;
@@ -546,7 +733,7 @@ int exynos_v4l2_dqbuf(int fd, struct v4l2_buffer *buf)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_DQBUF, buf);
+    ret = __v4l2_ioctl(fd, VIDIOC_DQBUF, buf);
     if (ret) {
         if (errno == EAGAIN)
             return -errno;
@@ -576,7 +763,7 @@ int exynos_v4l2_streamon(int fd, enum v4l2_buf_type type)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_STREAMON, &type);
+    ret = __v4l2_ioctl(fd, VIDIOC_STREAMON, &type);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_STREAMON (%d - %s)", errno, strerror(errno));
         return ret;
@@ -603,7 +790,7 @@ int exynos_v4l2_streamoff(int fd, enum v4l2_buf_type type)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_STREAMOFF, &type);
+    ret = __v4l2_ioctl(fd, VIDIOC_STREAMOFF, &type);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_STREAMOFF (%d - %s)", errno, strerror(errno));
         return ret;
@@ -635,7 +822,7 @@ int exynos_v4l2_cropcap(int fd, struct v4l2_cropcap *crop)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_CROPCAP, crop);
+    ret = __v4l2_ioctl(fd, VIDIOC_CROPCAP, crop);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_CROPCAP (%d - %s)", errno, strerror(errno));
         return ret;
@@ -667,7 +854,7 @@ int exynos_v4l2_g_crop(int fd, struct v4l2_crop *crop)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_G_CROP, crop);
+    ret = __v4l2_ioctl(fd, VIDIOC_G_CROP, crop);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_G_CROP (%d - %s)", errno, strerror(errno));
         return ret;
@@ -699,7 +886,7 @@ int exynos_v4l2_s_crop(int fd, struct v4l2_crop *crop)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_S_CROP, crop);
+    ret = __v4l2_ioctl(fd, VIDIOC_S_CROP, crop);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_S_CROP (%d - %s)", errno, strerror(errno));
         return ret;
@@ -724,7 +911,7 @@ int exynos_v4l2_g_ctrl(int fd, unsigned int id, int *value)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_G_CTRL, &ctrl);
+    ret = __v4l2_ioctl(fd, VIDIOC_G_CTRL, &ctrl);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_G_CTRL (%d - %s)", errno, strerror(errno));
         return ret;
@@ -752,7 +939,7 @@ int exynos_v4l2_s_ctrl(int fd, unsigned int id, int value)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_S_CTRL, &ctrl);
+    ret = __v4l2_ioctl(fd, VIDIOC_S_CTRL, &ctrl);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_S_CTRL (%d)", errno);
         return ret;
@@ -779,7 +966,7 @@ int exynos_v4l2_g_parm(int fd, struct v4l2_streamparm *streamparm)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_G_PARM, streamparm);
+    ret = __v4l2_ioctl(fd, VIDIOC_G_PARM, streamparm);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_G_PARM (%d - %s)", errno, strerror(errno));
         return ret;
@@ -806,7 +993,7 @@ int exynos_v4l2_s_parm(int fd, struct v4l2_streamparm *streamparm)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_S_PARM, streamparm);
+    ret = __v4l2_ioctl(fd, VIDIOC_S_PARM, streamparm);
     if (ret) {
         ALOGE("failed to ioctl: VIDIOC_S_PARM (%d - %s)", errno, strerror(errno));
         return ret;
@@ -833,7 +1020,7 @@ int exynos_v4l2_g_ext_ctrl(int fd, struct v4l2_ext_controls *ctrl)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, ctrl);
+    ret = __v4l2_ioctl(fd, VIDIOC_G_EXT_CTRLS, ctrl);
     if (ret)
         ALOGE("failed to ioctl: VIDIOC_G_EXT_CTRLS (%d - %s)", errno, strerror(errno));
 
@@ -858,7 +1045,7 @@ int exynos_v4l2_s_ext_ctrl(int fd, struct v4l2_ext_controls *ctrl)
         return ret;
     }
 
-    ret = ioctl(fd, VIDIOC_S_EXT_CTRLS, ctrl);
+    ret = __v4l2_ioctl(fd, VIDIOC_S_EXT_CTRLS, ctrl);
     if (ret)
         ALOGE("failed to ioctl: VIDIOC_S_EXT_CTRLS (%d - %s)", errno, strerror(errno));
 
@@ -0,0 +1,968 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      exynos_v4l2_fake_mfc.c
+ * \brief     in-process MFC backend for libv4l2
+ *
+ * Implements the part of the s5p-mfc V4L2 interface libvideocodec uses:
+ * formats, buffer queues, stream on/off and the MFC controls that report
+ * the state of the last dequeued picture. See exynos_v4l2_fake_mfc.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+#include "exynos_v4l2.h"
+#include "exynos_v4l2_fake_mfc.h"
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "libexynosv4l2-fakemfc"
+#include <utils/Log.h>
+
+#define FAKE_MFC_INSTANCE_MAX   8
+#define FAKE_MFC_BUFFER_MAX     32
+#define FAKE_MFC_PLANE_MAX      3
+#define FAKE_MFC_CTRL_MAX       64
+#define FAKE_MFC_GOP            30
+
+#define FAKE_MFC_ALIGN(x, a)    (((x) + (a) - 1) & ~((a) - 1))
+
+/* values of V4L2_CID_MPEG_MFC51_VIDEO_DISPLAY_STATUS */
+#define DISPLAY_STATUS_DISPLAY_DECODING 1
+#define DISPLAY_STATUS_NO_MORE_DISPLAY  3
+/* value of V4L2_CID_MPEG_MFC51_VIDEO_CHECK_STATE */
+#define CHECK_STATE_RESOLUTION_CHANGE   1
+
+enum fake_buf_state {
+    FAKE_BUF_DEQUEUED,
+    FAKE_BUF_QUEUED,
+    FAKE_BUF_DONE,
+};
+
+struct fake_buffer {
+    enum fake_buf_state state;
+    struct v4l2_plane   planes[FAKE_MFC_PLANE_MAX];
+    unsigned int        nplanes;
+    struct timeval      timestamp;
+    unsigned int        flags;
+    int                 tag;
+    int                 display_status;
+    int                 check_state;
+    long long           qbuf_time;
+};
+
+struct fake_queue {
+    struct v4l2_format  fmt;
+    unsigned int        memory;
+    unsigned int        count;
+    bool                streaming;
+    struct fake_buffer  bufs[FAKE_MFC_BUFFER_MAX];
+    /* buffer indices in QBUF order and in completion order */
+    int                 queued[FAKE_MFC_BUFFER_MAX];
+    int                 nqueued;
+    int                 done[FAKE_MFC_BUFFER_MAX];
+    int                 ndone;
+};
+
+/*
+ * Per capture index, what the driver writes into the buffer handed over
+ * with V4L2_CID_MPEG_MFC_SET_USER_SHARED_HANDLE (PrivateDataShareBuffer of
+ * libvideocodec): the fds of the pictures no longer referenced, -1 ended.
+ */
+struct fake_dpb_release {
+    int index;
+    struct {
+        int fd;
+        int fd1;
+        int fd2;
+    } dpb[FAKE_MFC_BUFFER_MAX];
+};
+
+struct fake_mfc {
+    int                 fd;
+    int                 oflag;
+    bool                decoder;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    pthread_t           worker;
+    bool                exiting;
+
+    struct fake_queue   src;    /* V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE */
+    struct fake_queue   dst;    /* V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE */
+
+    unsigned int        width;
+    unsigned int        height;
+    bool                header_parsed;
+    unsigned int        frames;
+    long long           busy_until;
+
+    struct {
+        unsigned int    id;
+        int             value;
+    } ctrls[FAKE_MFC_CTRL_MAX];
+    int                 nctrls;
+
+    /* frame tag for the next stream buffer */
+    int                 tag;
+    /* state of the last dequeued picture */
+    int                 display_status;
+    int                 check_state;
+    int                 last_tag;
+
+    /* referenced pictures, by fd with dynamic DPB and by index without */
+    bool                dynamic_dpb;
+    int                 refs[FAKE_MFC_BUFFER_MAX];
+    int                 nrefs;
+    int                 released[FAKE_MFC_BUFFER_MAX];
+    int                 nreleased;
+    struct fake_dpb_release *shared;
+};
+
+static pthread_mutex_t fake_mfc_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct exynos_v4l2_fake_mfc_config fake_mfc_config;
+static struct fake_mfc *fake_mfc_instances[FAKE_MFC_INSTANCE_MAX];
+static bool fake_mfc_installed;
+
+static long long __fake_mfc_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static struct fake_mfc *__fake_mfc_get(int fd)
+{
+    struct fake_mfc *mfc = NULL;
+    int i;
+
+    pthread_mutex_lock(&fake_mfc_lock);
+    for (i = 0; i < FAKE_MFC_INSTANCE_MAX; i++) {
+        if (fake_mfc_instances[i] && fake_mfc_instances[i]->fd == fd) {
+            mfc = fake_mfc_instances[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&fake_mfc_lock);
+
+    return mfc;
+}
+
+static struct fake_queue *__fake_mfc_queue(struct fake_mfc *mfc, unsigned int type)
+{
+    switch (type) {
+    case V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE:
+        return &mfc->src;
+    case V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE:
+        return &mfc->dst;
+    default:
+        return NULL;
+    }
+}
+
+static void __fake_mfc_signal(struct fake_mfc *mfc)
+{
+    uint64_t one = 1;
+
+    if (write(mfc->fd, &one, sizeof(one)) != sizeof(one))
+        ALOGE("%s: failed to signal fd %d (%s)", __func__, mfc->fd, strerror(errno));
+}
+
+static void __fake_mfc_unsignal(struct fake_mfc *mfc, int count)
+{
+    uint64_t value;
+
+    while (count-- > 0) {
+        if (read(mfc->fd, &value, sizeof(value)) != sizeof(value))
+            break;
+    }
+}
+
+static void __fake_mfc_remove(int *list, int *n, int pos)
+{
+    memmove(&list[pos], &list[pos + 1], sizeof(*list) * (*n - pos - 1));
+    (*n)--;
+}
+
+static void __fake_mfc_complete(struct fake_mfc *mfc, struct fake_queue *q, int index)
+{
+    q->bufs[index].state = FAKE_BUF_DONE;
+    q->done[q->ndone++] = index;
+    __fake_mfc_signal(mfc);
+    /* only wake the pollers, POLLIN stays for the capture queue */
+    if (q == &mfc->src)
+        __fake_mfc_unsignal(mfc, 1);
+    pthread_cond_broadcast(&mfc->cond);
+}
+
+static void __fake_mfc_flush(struct fake_mfc *mfc, struct fake_queue *q)
+{
+    unsigned int i;
+
+    for (i = 0; i < q->count; i++)
+        q->bufs[i].state = FAKE_BUF_DEQUEUED;
+
+    if (q == &mfc->dst)
+        __fake_mfc_unsignal(mfc, q->ndone);
+    q->nqueued = 0;
+    q->ndone = 0;
+}
+
+static int __fake_mfc_ref_key(struct fake_mfc *mfc, int index)
+{
+    return mfc->dynamic_dpb ? mfc->dst.bufs[index].planes[0].m.fd : index;
+}
+
+static bool __fake_mfc_is_ref(struct fake_mfc *mfc, int key)
+{
+    int i;
+
+    for (i = 0; i < mfc->nrefs; i++) {
+        if (mfc->refs[i] == key)
+            return true;
+    }
+
+    return false;
+}
+
+static void __fake_mfc_release_refs(struct fake_mfc *mfc, int count)
+{
+    while ((count-- > 0) && (mfc->nrefs > 0)) {
+        if (mfc->dynamic_dpb && (mfc->nreleased < FAKE_MFC_BUFFER_MAX - 1))
+            mfc->released[mfc->nreleased++] = mfc->refs[0];
+        __fake_mfc_remove(mfc->refs, &mfc->nrefs, 0);
+    }
+}
+
+/* first queued picture buffer the decoder may write, -1 if none */
+static int __fake_mfc_pick_dst(struct fake_mfc *mfc)
+{
+    int i;
+
+    if (!mfc->dst.streaming)
+        return -1;
+
+    for (i = 0; i < mfc->dst.nqueued; i++) {
+        int index = mfc->dst.queued[i];
+        if (!mfc->decoder || !__fake_mfc_is_ref(mfc, __fake_mfc_ref_key(mfc, index)))
+            return i;
+    }
+
+    return -1;
+}
+
+static void __fake_mfc_report_released(struct fake_mfc *mfc, int index)
+{
+    struct fake_dpb_release *rel;
+    int i;
+
+    if (!mfc->shared)
+        return;
+
+    rel = &mfc->shared[index];
+    rel->index = index;
+    for (i = 0; i < mfc->nreleased; i++) {
+        rel->dpb[i].fd = mfc->released[i];
+        rel->dpb[i].fd1 = -1;
+        rel->dpb[i].fd2 = -1;
+    }
+    rel->dpb[i].fd = -1;
+    mfc->nreleased = 0;
+}
+
+static void __fake_mfc_run(struct fake_mfc *mfc, int dst_pos)
+{
+    struct fake_buffer *s, *d;
+    int src, dst;
+    unsigned int i;
+
+    src = mfc->src.queued[0];
+    s = &mfc->src.bufs[src];
+    __fake_mfc_remove(mfc->src.queued, &mfc->src.nqueued, 0);
+    __fake_mfc_complete(mfc, &mfc->src, src);
+
+    if (mfc->decoder && !mfc->header_parsed) {
+        mfc->header_parsed = true;
+        ALOGV("%s: header parsed, %ux%u", __func__, mfc->width, mfc->height);
+        return;
+    }
+
+    dst = mfc->dst.queued[dst_pos];
+    d = &mfc->dst.bufs[dst];
+    __fake_mfc_remove(mfc->dst.queued, &mfc->dst.nqueued, dst_pos);
+
+    mfc->frames++;
+    d->timestamp = s->timestamp;
+    d->tag = s->tag;
+    d->check_state = 0;
+
+    if (mfc->decoder && (fake_mfc_config.resolution_change_frame == mfc->frames)) {
+        for (i = 0; i < d->nplanes; i++)
+            d->planes[i].bytesused = 0;
+        d->flags = 0;
+        d->display_status = DISPLAY_STATUS_NO_MORE_DISPLAY;
+        d->check_state = CHECK_STATE_RESOLUTION_CHANGE;
+        mfc->width = fake_mfc_config.new_width;
+        mfc->height = fake_mfc_config.new_height;
+        __fake_mfc_release_refs(mfc, mfc->nrefs);
+        ALOGV("%s: resolution change to %ux%u", __func__, mfc->width, mfc->height);
+    } else {
+        for (i = 0; i < d->nplanes; i++)
+            d->planes[i].bytesused = mfc->decoder ? d->planes[i].length : d->planes[i].length / 8;
+        d->flags = (((mfc->frames - 1) % FAKE_MFC_GOP) == 0) ? V4L2_BUF_FLAG_KEYFRAME : V4L2_BUF_FLAG_PFRAME;
+        d->display_status = DISPLAY_STATUS_DISPLAY_DECODING;
+
+        if (mfc->decoder && (fake_mfc_config.ref_frames > 0)) {
+            mfc->refs[mfc->nrefs++] = __fake_mfc_ref_key(mfc, dst);
+            if (mfc->nrefs > (int)fake_mfc_config.ref_frames)
+                __fake_mfc_release_refs(mfc, mfc->nrefs - fake_mfc_config.ref_frames);
+        }
+    }
+
+    if (mfc->decoder && mfc->dynamic_dpb)
+        __fake_mfc_report_released(mfc, dst);
+
+    __fake_mfc_complete(mfc, &mfc->dst, dst);
+}
+
+/* plays the firmware: one stream buffer at a time, decode_latency_us each */
+static void *__fake_mfc_worker(void *arg)
+{
+    struct fake_mfc *mfc = (struct fake_mfc *)arg;
+    long long start, due, now;
+    int dst_pos;
+
+    pthread_mutex_lock(&mfc->lock);
+    while (!mfc->exiting) {
+        if (!mfc->src.streaming || (mfc->src.nqueued == 0)) {
+            pthread_cond_wait(&mfc->cond, &mfc->lock);
+            continue;
+        }
+
+        dst_pos = -1;
+        if (!mfc->decoder || mfc->header_parsed) {
+            dst_pos = __fake_mfc_pick_dst(mfc);
+            if (dst_pos < 0) {
+                pthread_cond_wait(&mfc->cond, &mfc->lock);
+                continue;
+            }
+        }
+
+        start = mfc->src.bufs[mfc->src.queued[0]].qbuf_time;
+        if (start < mfc->busy_until)
+            start = mfc->busy_until;
+        due = start + (long long)fake_mfc_config.decode_latency_us * 1000;
+
+        now = __fake_mfc_now();
+        if (now < due) {
+            pthread_mutex_unlock(&mfc->lock);
+            usleep((useconds_t)((due - now + 999) / 1000));
+            pthread_mutex_lock(&mfc->lock);
+            continue;
+        }
+
+        mfc->busy_until = due;
+        __fake_mfc_run(mfc, dst_pos);
+    }
+    pthread_mutex_unlock(&mfc->lock);
+
+    return NULL;
+}
+
+static unsigned int __fake_mfc_plane_size(struct fake_mfc *mfc, struct fake_queue *q, unsigned int plane)
+{
+    unsigned int size = q->fmt.fmt.pix_mp.plane_fmt[plane].sizeimage;
+    unsigned int luma;
+
+    if (size)
+        return size;
+
+    luma = FAKE_MFC_ALIGN(mfc->width, 16) * FAKE_MFC_ALIGN(mfc->height, 16);
+    if ((q == &mfc->dst) == mfc->decoder)
+        return plane ? luma / 2 : luma;
+
+    /* stream buffer */
+    return FAKE_MFC_ALIGN(luma / 2, 4096);
+}
+
+static int __fake_mfc_g_fmt(struct fake_mfc *mfc, struct v4l2_format *fmt)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, fmt->type);
+    struct v4l2_pix_format_mplane *pix = &fmt->fmt.pix_mp;
+    unsigned int luma;
+
+    if (!q)
+        return -EINVAL;
+
+    if (!mfc->decoder || (q == &mfc->src)) {
+        *fmt = q->fmt;
+        return 0;
+    }
+
+    if (!mfc->header_parsed)
+        return -EAGAIN;
+
+    luma = FAKE_MFC_ALIGN(mfc->width, 16) * FAKE_MFC_ALIGN(mfc->height, 16);
+    memset(pix, 0, sizeof(*pix));
+    pix->width = mfc->width;
+    pix->height = mfc->height;
+    pix->pixelformat = q->fmt.fmt.pix_mp.pixelformat ? q->fmt.fmt.pix_mp.pixelformat : V4L2_PIX_FMT_NV12M;
+    pix->field = V4L2_FIELD_NONE;
+    pix->num_planes = 2;
+    pix->plane_fmt[0].sizeimage = luma;
+    pix->plane_fmt[0].bytesperline = FAKE_MFC_ALIGN(mfc->width, 16);
+    pix->plane_fmt[1].sizeimage = luma / 2;
+    pix->plane_fmt[1].bytesperline = FAKE_MFC_ALIGN(mfc->width, 16);
+
+    return 0;
+}
+
+static int __fake_mfc_s_fmt(struct fake_mfc *mfc, struct v4l2_format *fmt, bool try_only)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, fmt->type);
+
+    if (!q)
+        return -EINVAL;
+
+    if (fmt->fmt.pix_mp.num_planes > FAKE_MFC_PLANE_MAX)
+        fmt->fmt.pix_mp.num_planes = FAKE_MFC_PLANE_MAX;
+
+    if (try_only)
+        return 0;
+
+    if (q->count)
+        return -EBUSY;
+
+    q->fmt = *fmt;
+
+    /* the encoder is told the size, the decoder finds it in the stream */
+    if (!mfc->decoder && (q == &mfc->src) && fmt->fmt.pix_mp.width) {
+        mfc->width = fmt->fmt.pix_mp.width;
+        mfc->height = fmt->fmt.pix_mp.height;
+    }
+
+    return 0;
+}
+
+static int __fake_mfc_reqbufs(struct fake_mfc *mfc, struct v4l2_requestbuffers *req)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, req->type);
+    unsigned int i, count = req->count;
+
+    if (!q)
+        return -EINVAL;
+
+    if (q->streaming)
+        return -EBUSY;
+
+    if (count > FAKE_MFC_BUFFER_MAX)
+        count = FAKE_MFC_BUFFER_MAX;
+    if (count && mfc->decoder && (q == &mfc->dst) && (count < fake_mfc_config.min_dpb))
+        count = fake_mfc_config.min_dpb;
+
+    __fake_mfc_flush(mfc, q);
+    memset(q->bufs, 0, sizeof(q->bufs));
+    for (i = 0; i < count; i++)
+        q->bufs[i].nplanes = q->fmt.fmt.pix_mp.num_planes ? q->fmt.fmt.pix_mp.num_planes : 1;
+
+    q->memory = req->memory;
+    q->count = count;
+    req->count = count;
+
+    if (q == &mfc->dst) {
+        mfc->nrefs = 0;
+        mfc->nreleased = 0;
+    }
+
+    return 0;
+}
+
+static int __fake_mfc_querybuf(struct fake_mfc *mfc, struct v4l2_buffer *buf)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, buf->type);
+    unsigned int i;
+
+    if (!q || (buf->index >= q->count) || !buf->m.planes)
+        return -EINVAL;
+
+    if (buf->length > FAKE_MFC_PLANE_MAX)
+        buf->length = FAKE_MFC_PLANE_MAX;
+
+    for (i = 0; i < buf->length; i++) {
+        memset(&buf->m.planes[i], 0, sizeof(buf->m.planes[i]));
+        buf->m.planes[i].length = __fake_mfc_plane_size(mfc, q, i);
+        buf->m.planes[i].m.mem_offset = ((buf->index * FAKE_MFC_PLANE_MAX) + i) << 20;
+    }
+    buf->memory = q->memory;
+    buf->flags = (q->bufs[buf->index].state == FAKE_BUF_QUEUED) ? V4L2_BUF_FLAG_QUEUED :
+                 (q->bufs[buf->index].state == FAKE_BUF_DONE) ? V4L2_BUF_FLAG_DONE : 0;
+
+    return 0;
+}
+
+static int __fake_mfc_qbuf(struct fake_mfc *mfc, struct v4l2_buffer *buf)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, buf->type);
+    struct fake_buffer *b;
+    unsigned int i;
+
+    if (!q || (buf->index >= q->count) || !buf->m.planes || (buf->memory != q->memory))
+        return -EINVAL;
+
+    b = &q->bufs[buf->index];
+    if (b->state != FAKE_BUF_DEQUEUED)
+        return -EINVAL;
+
+    b->nplanes = (buf->length < FAKE_MFC_PLANE_MAX) ? buf->length : FAKE_MFC_PLANE_MAX;
+    for (i = 0; i < b->nplanes; i++) {
+        b->planes[i] = buf->m.planes[i];
+        if (b->planes[i].length == 0)
+            b->planes[i].length = __fake_mfc_plane_size(mfc, q, i);
+    }
+    b->timestamp = buf->timestamp;
+    b->flags = 0;
+    b->qbuf_time = __fake_mfc_now();
+    if (q == &mfc->src)
+        b->tag = mfc->tag;
+
+    b->state = FAKE_BUF_QUEUED;
+    q->queued[q->nqueued++] = buf->index;
+    pthread_cond_broadcast(&mfc->cond);
+
+    return 0;
+}
+
+static int __fake_mfc_dqbuf(struct fake_mfc *mfc, struct v4l2_buffer *buf)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, buf->type);
+    struct fake_buffer *b;
+    unsigned int i, n;
+    int index;
+
+    if (!q || !buf->m.planes)
+        return -EINVAL;
+
+    while (q->ndone == 0) {
+        if (!q->streaming || mfc->exiting)
+            return -EINVAL;
+        /* poll() can't tell that one apart, see exynos_v4l2_fake_mfc.h */
+        if ((mfc->oflag & O_NONBLOCK) || (q == &mfc->src))
+            return -EAGAIN;
+        pthread_cond_wait(&mfc->cond, &mfc->lock);
+    }
+
+    index = q->done[0];
+    __fake_mfc_remove(q->done, &q->ndone, 0);
+    if (q == &mfc->dst)
+        __fake_mfc_unsignal(mfc, 1);
+
+    b = &q->bufs[index];
+    b->state = FAKE_BUF_DEQUEUED;
+
+    buf->index = index;
+    buf->memory = q->memory;
+    buf->flags = b->flags;
+    buf->timestamp = b->timestamp;
+    n = (buf->length < b->nplanes) ? buf->length : b->nplanes;
+    for (i = 0; i < n; i++)
+        buf->m.planes[i] = b->planes[i];
+    buf->length = n;
+
+    if (q == &mfc->dst) {
+        mfc->display_status = b->display_status;
+        mfc->check_state = b->check_state;
+        mfc->last_tag = b->tag;
+    }
+
+    return 0;
+}
+
+static int __fake_mfc_stream(struct fake_mfc *mfc, unsigned int *type, bool on)
+{
+    struct fake_queue *q = __fake_mfc_queue(mfc, *type);
+
+    if (!q)
+        return -EINVAL;
+
+    q->streaming = on;
+    if (!on) {
+        __fake_mfc_flush(mfc, q);
+        if (q == &mfc->dst) {
+            mfc->nrefs = 0;
+            mfc->nreleased = 0;
+        }
+    }
+    pthread_cond_broadcast(&mfc->cond);
+
+    return 0;
+}
+
+static int __fake_mfc_g_ctrl(struct fake_mfc *mfc, unsigned int id, int *value)
+{
+    int i;
+
+    switch (id) {
+    case V4L2_CID_MIN_BUFFERS_FOR_CAPTURE:
+        *value = fake_mfc_config.min_dpb;
+        return 0;
+    case V4L2_CID_MPEG_MFC51_VIDEO_DISPLAY_STATUS:
+        *value = mfc->display_status;
+        return 0;
+    case V4L2_CID_MPEG_MFC51_VIDEO_CHECK_STATE:
+        *value = mfc->check_state;
+        return 0;
+    case V4L2_CID_MPEG_MFC51_VIDEO_FRAME_TAG:
+        *value = mfc->last_tag;
+        return 0;
+    default:
+        break;
+    }
+
+    *value = 0;
+    for (i = 0; i < mfc->nctrls; i++) {
+        if (mfc->ctrls[i].id == id) {
+            *value = mfc->ctrls[i].value;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static int __fake_mfc_s_ctrl(struct fake_mfc *mfc, unsigned int id, int value)
+{
+    int i;
+
+    switch (id) {
+    case V4L2_CID_MPEG_MFC51_VIDEO_FRAME_TAG:
+        mfc->tag = value;
+        break;
+    case V4L2_CID_MPEG_MFC_SET_DYNAMIC_DPB_MODE:
+        mfc->dynamic_dpb = (value != 0);
+        break;
+    case V4L2_CID_MPEG_MFC_SET_USER_SHARED_HANDLE:
+        if (mfc->shared)
+            munmap(mfc->shared, sizeof(*mfc->shared) * FAKE_MFC_BUFFER_MAX);
+        mfc->shared = (struct fake_dpb_release *)mmap(NULL, sizeof(*mfc->shared) * FAKE_MFC_BUFFER_MAX,
+                PROT_READ | PROT_WRITE, MAP_SHARED, value, 0);
+        if (mfc->shared == MAP_FAILED) {
+            mfc->shared = NULL;
+            return -errno;
+        }
+        break;
+    default:
+        break;
+    }
+
+    for (i = 0; i < mfc->nctrls; i++) {
+        if (mfc->ctrls[i].id == id)
+            break;
+    }
+    if (i == FAKE_MFC_CTRL_MAX)
+        return 0;
+    if (i == mfc->nctrls)
+        mfc->nctrls++;
+    mfc->ctrls[i].id = id;
+    mfc->ctrls[i].value = value;
+
+    return 0;
+}
+
+static int __fake_mfc_ext_ctrls(struct fake_mfc *mfc, struct v4l2_ext_controls *ctrls, bool set)
+{
+    unsigned int i;
+    int ret = 0;
+
+    for (i = 0; (i < ctrls->count) && (ret == 0); i++) {
+        int value = ctrls->controls[i].value;
+
+        if (set) {
+            ret = __fake_mfc_s_ctrl(mfc, ctrls->controls[i].id, value);
+        } else {
+            ret = __fake_mfc_g_ctrl(mfc, ctrls->controls[i].id, &value);
+            ctrls->controls[i].value = value;
+        }
+    }
+    if (ret)
+        ctrls->error_idx = i - 1;
+
+    return ret;
+}
+
+static int fake_mfc_ioctl(int fd, unsigned long request, void *arg)
+{
+    struct fake_mfc *mfc = __fake_mfc_get(fd);
+    int ret = -ENOTTY;
+
+    if (!mfc) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&mfc->lock);
+
+    switch (request) {
+    case VIDIOC_QUERYCAP: {
+        struct v4l2_capability *cap = (struct v4l2_capability *)arg;
+        memset(cap, 0, sizeof(*cap));
+        strncpy((char *)cap->driver, "fake-mfc", sizeof(cap->driver) - 1);
+        strncpy((char *)cap->card, mfc->decoder ? "fake-mfc-dec" : "fake-mfc-enc", sizeof(cap->card) - 1);
+        cap->capabilities = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_VIDEO_OUTPUT |
+                            V4L2_CAP_VIDEO_CAPTURE_MPLANE | V4L2_CAP_VIDEO_OUTPUT_MPLANE |
+                            V4L2_CAP_STREAMING;
+        ret = 0;
+        break;
+    }
+    case VIDIOC_G_FMT:
+        ret = __fake_mfc_g_fmt(mfc, (struct v4l2_format *)arg);
+        break;
+    case VIDIOC_S_FMT:
+        ret = __fake_mfc_s_fmt(mfc, (struct v4l2_format *)arg, false);
+        break;
+    case VIDIOC_TRY_FMT:
+        ret = __fake_mfc_s_fmt(mfc, (struct v4l2_format *)arg, true);
+        break;
+    case VIDIOC_REQBUFS:
+        ret = __fake_mfc_reqbufs(mfc, (struct v4l2_requestbuffers *)arg);
+        break;
+    case VIDIOC_QUERYBUF:
+        ret = __fake_mfc_querybuf(mfc, (struct v4l2_buffer *)arg);
+        break;
+    case VIDIOC_QBUF:
+        ret = __fake_mfc_qbuf(mfc, (struct v4l2_buffer *)arg);
+        break;
+    case VIDIOC_DQBUF:
+        ret = __fake_mfc_dqbuf(mfc, (struct v4l2_buffer *)arg);
+        break;
+    case VIDIOC_STREAMON:
+        ret = __fake_mfc_stream(mfc, (unsigned int *)arg, true);
+        break;
+    case VIDIOC_STREAMOFF:
+        ret = __fake_mfc_stream(mfc, (unsigned int *)arg, false);
+        break;
+    case VIDIOC_G_CROP: {
+        struct v4l2_crop *crop = (struct v4l2_crop *)arg;
+        crop->c.left = 0;
+        crop->c.top = 0;
+        crop->c.width = mfc->width;
+        crop->c.height = mfc->height;
+        ret = 0;
+        break;
+    }
+    case VIDIOC_G_CTRL: {
+        struct v4l2_control *ctrl = (struct v4l2_control *)arg;
+        ret = __fake_mfc_g_ctrl(mfc, ctrl->id, &ctrl->value);
+        break;
+    }
+    case VIDIOC_S_CTRL: {
+        struct v4l2_control *ctrl = (struct v4l2_control *)arg;
+        ret = __fake_mfc_s_ctrl(mfc, ctrl->id, ctrl->value);
+        break;
+    }
+    case VIDIOC_G_EXT_CTRLS:
+        ret = __fake_mfc_ext_ctrls(mfc, (struct v4l2_ext_controls *)arg, false);
+        break;
+    case VIDIOC_S_EXT_CTRLS:
+        ret = __fake_mfc_ext_ctrls(mfc, (struct v4l2_ext_controls *)arg, true);
+        break;
+    case VIDIOC_G_PARM:
+    case VIDIOC_S_PARM:
+        ret = 0;
+        break;
+    default:
+        ALOGW("%s: unsupported ioctl 0x%lx", __func__, request);
+        break;
+    }
+
+    pthread_mutex_unlock(&mfc->lock);
+
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+
+    return ret;
+}
+
+static bool fake_mfc_match(const char *name)
+{
+    return (strstr(name, "mfc-dec") != NULL) ||
+           (strstr(name, "mfc-enc") != NULL) ||
+           (strstr(name, "hevc-dec") != NULL);
+}
+
+static int fake_mfc_open(const char *name, int oflag)
+{
+    struct fake_mfc *mfc;
+    int i;
+
+    mfc = (struct fake_mfc *)calloc(1, sizeof(*mfc));
+    if (!mfc) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    mfc->fd = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mfc->fd < 0) {
+        ALOGE("%s: failed to create eventfd (%s)", __func__, strerror(errno));
+        free(mfc);
+        return -1;
+    }
+
+    mfc->oflag = oflag;
+    mfc->decoder = (strstr(name, "-dec") != NULL);
+    mfc->width = fake_mfc_config.width;
+    mfc->height = fake_mfc_config.height;
+    pthread_mutex_init(&mfc->lock, NULL);
+    pthread_cond_init(&mfc->cond, NULL);
+
+    pthread_mutex_lock(&fake_mfc_lock);
+    for (i = 0; i < FAKE_MFC_INSTANCE_MAX; i++) {
+        if (fake_mfc_instances[i] == NULL) {
+            fake_mfc_instances[i] = mfc;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&fake_mfc_lock);
+
+    if ((i == FAKE_MFC_INSTANCE_MAX) ||
+        (pthread_create(&mfc->worker, NULL, __fake_mfc_worker, mfc) != 0)) {
+        ALOGE("%s: failed to start instance for %s", __func__, name);
+        pthread_mutex_lock(&fake_mfc_lock);
+        if (i < FAKE_MFC_INSTANCE_MAX)
+            fake_mfc_instances[i] = NULL;
+        pthread_mutex_unlock(&fake_mfc_lock);
+        close(mfc->fd);
+        pthread_cond_destroy(&mfc->cond);
+        pthread_mutex_destroy(&mfc->lock);
+        free(mfc);
+        errno = EBUSY;
+        return -1;
+    }
+
+    return mfc->fd;
+}
+
+static int fake_mfc_close(int fd)
+{
+    struct fake_mfc *mfc = __fake_mfc_get(fd);
+    int i;
+
+    if (!mfc) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&fake_mfc_lock);
+    for (i = 0; i < FAKE_MFC_INSTANCE_MAX; i++) {
+        if (fake_mfc_instances[i] == mfc)
+            fake_mfc_instances[i] = NULL;
+    }
+    pthread_mutex_unlock(&fake_mfc_lock);
+
+    pthread_mutex_lock(&mfc->lock);
+    mfc->exiting = true;
+    pthread_cond_broadcast(&mfc->cond);
+    pthread_mutex_unlock(&mfc->lock);
+    pthread_join(mfc->worker, NULL);
+
+    if (mfc->shared)
+        munmap(mfc->shared, sizeof(*mfc->shared) * FAKE_MFC_BUFFER_MAX);
+    close(mfc->fd);
+    pthread_cond_destroy(&mfc->cond);
+    pthread_mutex_destroy(&mfc->lock);
+    free(mfc);
+
+    return 0;
+}
+
+/* MMAP buffers only need to be memory, nothing is decoded into them */
+static void *fake_mfc_mmap(int fd, size_t length, int prot, int flags, off_t offset)
+{
+    return mmap(NULL, length, prot, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+}
+
+static const struct exynos_v4l2_backend fake_mfc_backend = {
+    .name  = "fake-mfc",
+    .match = fake_mfc_match,
+    .open  = fake_mfc_open,
+    .close = fake_mfc_close,
+    .ioctl = fake_mfc_ioctl,
+    .mmap  = fake_mfc_mmap,
+};
+
+int exynos_v4l2_fake_mfc_install(const struct exynos_v4l2_fake_mfc_config *config)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&fake_mfc_lock);
+
+    if (fake_mfc_installed) {
+        ALOGE("%s: already installed", __func__);
+        goto EXIT;
+    }
+
+    memset(&fake_mfc_config, 0, sizeof(fake_mfc_config));
+    if (config) {
+        fake_mfc_config = *config;
+    } else {
+        fake_mfc_config.width = 1920;
+        fake_mfc_config.height = 1080;
+        fake_mfc_config.min_dpb = 4;
+        fake_mfc_config.ref_frames = 2;
+    }
+
+    if (fake_mfc_config.ref_frames >= FAKE_MFC_BUFFER_MAX)
+        fake_mfc_config.ref_frames = FAKE_MFC_BUFFER_MAX - 1;
+    if (fake_mfc_config.min_dpb > FAKE_MFC_BUFFER_MAX)
+        fake_mfc_config.min_dpb = FAKE_MFC_BUFFER_MAX;
+
+    ret = exynos_v4l2_register_backend(&fake_mfc_backend);
+    if (ret == 0)
+        fake_mfc_installed = true;
+
+EXIT:
+    pthread_mutex_unlock(&fake_mfc_lock);
+
+    return ret;
+}
+
+int exynos_v4l2_fake_mfc_uninstall(void)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&fake_mfc_lock);
+    if (fake_mfc_installed) {
+        ret = exynos_v4l2_unregister_backend(&fake_mfc_backend);
+        if (ret == 0)
+            fake_mfc_installed = false;
+    }
+    pthread_mutex_unlock(&fake_mfc_lock);
+
+    return ret;
+}
@@ -8,6 +8,7 @@ endif
 
 LOCAL_SRC_FILES := \
 	ExynosVideoInterface.c \
+	ExynosVideoBufferIndex.c \
 	dec/ExynosVideoDecoder.c \
 	enc/ExynosVideoEncoder.c
 
@@ -59,3 +60,143 @@ LOCAL_MODULE_TAGS := optional
 LOCAL_ARM_MODE := arm
 
 include $(BUILD_STATIC_LIBRARY)
+
+# Dynamic DPB slot bookkeeping of the decoder on the fake MFC, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	test/ExynosVideoDynamicDpbTest.c
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(LOCAL_PATH)/include \
+	$(TOP)/hardware/samsung_slsi-cm/exynos/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES += \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
+LOCAL_C_INCLUDES += $(TOP)/hardware/samsung_slsi-cm/openmax/include/khronos
+else
+LOCAL_C_INCLUDES += $(TOP)/frameworks/native/include/media/openmax
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+	libExynosVideoApi \
+	libexynosv4l2_fakemfc
+
+LOCAL_SHARED_LIBRARIES := \
+	liblog \
+	libdl \
+	libion_exynos \
+	libexynosv4l2
+
+LOCAL_MODULE := exynos_video_dynamic_dpb_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+# Enqueue_Multiple/Dequeue_Multiple throughput on the fake MFC, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	bench/ExynosVideoBatchBench.c
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(LOCAL_PATH)/include \
+	$(TOP)/hardware/samsung_slsi-cm/exynos/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES += \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
+LOCAL_C_INCLUDES += $(TOP)/hardware/samsung_slsi-cm/openmax/include/khronos
+else
+LOCAL_C_INCLUDES += $(TOP)/frameworks/native/include/media/openmax
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+	libExynosVideoApi \
+	libexynosv4l2_fakemfc
+
+LOCAL_SHARED_LIBRARIES := \
+	liblog \
+	libdl \
+	libion_exynos \
+	libexynosv4l2
+
+LOCAL_MODULE := exynos_video_batch_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+# Decoder CPU per frame, dequeue threads against Start_EventLoop, on the fake MFC, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	bench/ExynosVideoEventLoopBench.c
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(LOCAL_PATH)/include \
+	$(TOP)/hardware/samsung_slsi-cm/exynos/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES += \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
+LOCAL_C_INCLUDES += $(TOP)/hardware/samsung_slsi-cm/openmax/include/khronos
+else
+LOCAL_C_INCLUDES += $(TOP)/frameworks/native/include/media/openmax
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+	libExynosVideoApi \
+	libexynosv4l2_fakemfc
+
+LOCAL_SHARED_LIBRARIES := \
+	liblog \
+	libdl \
+	libion_exynos \
+	libexynosv4l2
+
+LOCAL_MODULE := exynos_video_eventloop_bench
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+# Buffer index against the linear slot scans, decoder and encoder on the fake MFC, not installed by default
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	test/ExynosVideoBufferIndexTest.c
+
+LOCAL_C_INCLUDES := \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include \
+	$(LOCAL_PATH)/include \
+	$(TOP)/hardware/samsung_slsi-cm/exynos/include
+
+LOCAL_ADDITIONAL_DEPENDENCIES += \
+	$(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+ifeq ($(BOARD_USE_KHRONOS_OMX_HEADER), true)
+LOCAL_C_INCLUDES += $(TOP)/hardware/samsung_slsi-cm/openmax/include/khronos
+else
+LOCAL_C_INCLUDES += $(TOP)/frameworks/native/include/media/openmax
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+	libExynosVideoApi \
+	libexynosv4l2_fakemfc
+
+LOCAL_SHARED_LIBRARIES := \
+	liblog \
+	libdl \
+	libion_exynos \
+	libexynosv4l2
+
+LOCAL_MODULE := exynos_video_buffer_index_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,157 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        ExynosVideoBufferIndex.c
+ * @brief       O(1) slot lookups for the MFC buffer arrays
+ * @version     1.0
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ExynosVideoBufferIndex.h"
+
+static unsigned int Index_AddrBucket(void *pAddr)
+{
+    /* buffers are page aligned, mix the page number */
+    uint32_t page = (uint32_t)((uintptr_t)pAddr >> 12);
+
+    return (page * 2654435761u) >> 26;
+}
+
+static unsigned int Index_FdBucket(int fd)
+{
+    return (unsigned int)fd & (VIDEO_BUFFER_INDEX_BUCKETS - 1);
+}
+
+void Exynos_Video_Index_Rebuild(
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBuffer      *pBuffers,
+    int                     nBuffers)
+{
+    int i;
+
+    memset(pIndex, 0, sizeof(*pIndex));
+
+    if ((pBuffers == NULL) || (nBuffers <= 0) || (nBuffers > VIDEO_BUFFER_MAX_NUM))
+        return;
+
+    pIndex->nBuffers = nBuffers;
+    pIndex->validMask = (nBuffers == 32) ? 0xffffffff : ((1u << nBuffers) - 1);
+    for (i = 0; i < nBuffers; i++) {
+        pIndex->addrKey[i] = NULL;
+        pIndex->fdKey[i] = -1;
+        pIndex->addrBucket[Index_AddrBucket(NULL)] |= 1u << i;
+        pIndex->fdBucket[Index_FdBucket(-1)] |= 1u << i;
+        Exynos_Video_Index_Sync(pIndex, pBuffers, i);
+    }
+}
+
+void Exynos_Video_Index_Sync(
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBuffer      *pBuffers,
+    int                     nIndex)
+{
+    ExynosVideoBuffer *pBuffer;
+    unsigned int bit;
+
+    if ((nIndex < 0) || (nIndex >= pIndex->nBuffers))
+        return;
+
+    pBuffer = &pBuffers[nIndex];
+    bit = 1u << nIndex;
+
+    if (pIndex->addrKey[nIndex] != pBuffer->planes[0].addr) {
+        pIndex->addrBucket[Index_AddrBucket(pIndex->addrKey[nIndex])] &= ~bit;
+        pIndex->addrKey[nIndex] = pBuffer->planes[0].addr;
+        pIndex->addrBucket[Index_AddrBucket(pIndex->addrKey[nIndex])] |= bit;
+    }
+
+    if (pIndex->fdKey[nIndex] != pBuffer->planes[0].fd) {
+        pIndex->fdBucket[Index_FdBucket(pIndex->fdKey[nIndex])] &= ~bit;
+        pIndex->fdKey[nIndex] = pBuffer->planes[0].fd;
+        pIndex->fdBucket[Index_FdBucket(pIndex->fdKey[nIndex])] |= bit;
+    }
+
+    if (pBuffer->bQueued == VIDEO_TRUE)
+        pIndex->queuedMask |= bit;
+    else
+        pIndex->queuedMask &= ~bit;
+
+    if (pBuffer->bSlotUsed == VIDEO_TRUE)
+        pIndex->slotUsedMask |= bit;
+    else
+        pIndex->slotUsedMask &= ~bit;
+}
+
+int Exynos_Video_Index_Find(
+    ExynosVideoBufferIndex *pIndex,
+    void                   *pAddr)
+{
+    unsigned int mask;
+
+    if (pIndex->nBuffers == 0)
+        return VIDEO_BUFFER_INDEX_SCAN;
+
+    mask = pIndex->validMask & ~pIndex->queuedMask;
+    if (pAddr != NULL)
+        mask &= pIndex->addrBucket[Index_AddrBucket(pAddr)];
+
+    /* lowest slot first, as the linear scan did */
+    while (mask != 0) {
+        int nIndex = __builtin_ctz(mask);
+        if ((pAddr == NULL) || (pIndex->addrKey[nIndex] == pAddr))
+            return nIndex;
+        mask &= mask - 1;
+    }
+
+    return -1;
+}
+
+int Exynos_Video_Index_FindEmpty(
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBoolType     bCheckSlotUsed)
+{
+    unsigned int mask;
+
+    if (pIndex->nBuffers == 0)
+        return VIDEO_BUFFER_INDEX_SCAN;
+
+    mask = pIndex->validMask & ~pIndex->queuedMask;
+    if (bCheckSlotUsed == VIDEO_TRUE)
+        mask &= ~pIndex->slotUsedMask;
+
+    return (mask != 0) ? __builtin_ctz(mask) : -1;
+}
+
+unsigned int Exynos_Video_Index_FdMask(
+    ExynosVideoBufferIndex *pIndex,
+    int                     fd)
+{
+    unsigned int mask = pIndex->fdBucket[Index_FdBucket(fd)];
+    unsigned int result = 0;
+
+    while (mask != 0) {
+        int nIndex = __builtin_ctz(mask);
+        if (pIndex->fdKey[nIndex] == fd)
+            result |= 1u << nIndex;
+        mask &= mask - 1;
+    }
+
+    return result;
+}
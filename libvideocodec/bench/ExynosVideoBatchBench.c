@@ -0,0 +1,274 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        ExynosVideoBatchBench.c
+ * @brief       Encoder throughput of Enqueue/Dequeue against
+ *              Enqueue_Multiple/Dequeue_Multiple, on the fake MFC
+ * @version     1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "ExynosVideoApi.h"
+#include "exynos_v4l2_fake_mfc.h"
+#include "OMX_Core.h"
+
+#define BENCH_WIDTH         1280
+#define BENCH_HEIGHT        720
+#define BENCH_NUM_INBUF     8
+#define BENCH_NUM_OUTBUF    8
+#define BENCH_OUTBUF_SIZE   (1024 * 1024)
+
+typedef struct _BenchResult {
+    double fps;
+    double cpuPerFrame;     /* us */
+} BenchResult;
+
+static double Bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double Bench_Cpu(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static int Bench_Setup(
+    ExynosVideoEncOps        *pOps,
+    ExynosVideoEncBufferOps  *pInOps,
+    ExynosVideoEncBufferOps  *pOutOps,
+    void                    **phEnc)
+{
+    ExynosVideoInstInfo  instInfo;
+    ExynosVideoGeometry  geometry;
+    ExynosVideoBuffer   *pBuffer = NULL;
+    void                *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long        dataSize[VIDEO_BUFFER_MAX_PLANES];
+    void                *hEnc;
+    int                  i;
+
+    memset(pOps, 0, sizeof(*pOps));
+    memset(pInOps, 0, sizeof(*pInOps));
+    memset(pOutOps, 0, sizeof(*pOutOps));
+    pOps->nSize = sizeof(*pOps);
+    pInOps->nSize = sizeof(*pInOps);
+    pOutOps->nSize = sizeof(*pOutOps);
+
+    if (Exynos_Video_Register_Encoder(pOps, pInOps, pOutOps) != VIDEO_ERROR_NONE) {
+        printf("Exynos_Video_Register_Encoder failed\n");
+        return -1;
+    }
+
+    memset(&instInfo, 0, sizeof(instInfo));
+    instInfo.eCodecType = VIDEO_CODING_AVC;
+    instInfo.nWidth = BENCH_WIDTH;
+    instInfo.nHeight = BENCH_HEIGHT;
+    instInfo.nMemoryType = V4L2_MEMORY_MMAP;
+
+    hEnc = pOps->Init(&instInfo);
+    if (hEnc == NULL) {
+        printf("Init failed\n");
+        return -1;
+    }
+
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.nFrameWidth = BENCH_WIDTH;
+    geometry.nFrameHeight = BENCH_HEIGHT;
+    geometry.eColorFormat = VIDEO_COLORFORMAT_NV12;
+    geometry.nPlaneCnt = 2;
+    pInOps->Set_Geometry(hEnc, &geometry);
+
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.eCompressionFormat = VIDEO_CODING_AVC;
+    geometry.nSizeImage = BENCH_OUTBUF_SIZE;
+    geometry.nPlaneCnt = 1;
+    pOutOps->Set_Geometry(hEnc, &geometry);
+
+    if ((pInOps->Setup(hEnc, BENCH_NUM_INBUF) != VIDEO_ERROR_NONE) ||
+        (pOutOps->Setup(hEnc, BENCH_NUM_OUTBUF) != VIDEO_ERROR_NONE)) {
+        printf("Setup failed\n");
+        pOps->Finalize(hEnc);
+        return -1;
+    }
+
+    pInOps->Run(hEnc);
+    pOutOps->Run(hEnc);
+
+    for (i = 0; i < BENCH_NUM_OUTBUF; i++) {
+        pOutOps->Get_Buffer(hEnc, i, &pBuffer);
+        pAddr[0] = pBuffer->planes[0].addr;
+        dataSize[0] = 0;
+        pOutOps->Enqueue(hEnc, pAddr, dataSize, 1, NULL);
+    }
+
+    *phEnc = hEnc;
+
+    return 0;
+}
+
+/* nBatch 0: one Enqueue/Dequeue per buffer, otherwise the _Multiple ops */
+static int Bench_Run(
+    int           nBatch,
+    int           nFrames,
+    unsigned int  latencyUs,
+    BenchResult  *pResult)
+{
+    struct exynos_v4l2_fake_mfc_config config;
+    ExynosVideoEncOps        ops;
+    ExynosVideoEncBufferOps  inOps;
+    ExynosVideoEncBufferOps  outOps;
+    ExynosVideoBatchEntry    entries[BENCH_NUM_INBUF];
+    ExynosVideoBuffer       *pBuffers[BENCH_NUM_OUTBUF];
+    ExynosVideoBuffer       *pBuffer;
+    OMX_BUFFERHEADERTYPE     headers[BENCH_NUM_INBUF];
+    void                    *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long            dataSize[VIDEO_BUFFER_MAX_PLANES];
+    void                    *hEnc = NULL;
+    int nSent = 0, nDone = 0, nFreeIn = BENCH_NUM_INBUF;
+    int nEntries, nCount, i;
+    double start, cpu;
+
+    memset(&config, 0, sizeof(config));
+    config.decode_latency_us = latencyUs;
+    config.width = BENCH_WIDTH;
+    config.height = BENCH_HEIGHT;
+    config.min_dpb = 4;
+    config.ref_frames = 2;
+
+    if (exynos_v4l2_fake_mfc_install(&config) != 0) {
+        printf("exynos_v4l2_fake_mfc_install failed\n");
+        return -1;
+    }
+
+    if (Bench_Setup(&ops, &inOps, &outOps, &hEnc) != 0) {
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+
+    memset(headers, 0, sizeof(headers));
+    memset(entries, 0, sizeof(entries));
+
+    start = Bench_Now();
+    cpu = Bench_Cpu();
+
+    while (nDone < nFrames) {
+        /* source frames, NULL picks a free MMAP slot */
+        nEntries = 0;
+        while ((0 < nFreeIn) && (nSent < nFrames) && (nEntries < ((nBatch > 0) ? nBatch : 1))) {
+            entries[nEntries].pBuffer[0] = NULL;
+            entries[nEntries].pBuffer[1] = NULL;
+            entries[nEntries].dataSize[0] = BENCH_WIDTH * BENCH_HEIGHT;
+            entries[nEntries].dataSize[1] = BENCH_WIDTH * BENCH_HEIGHT / 2;
+            entries[nEntries].nPlanes = 2;
+            entries[nEntries].pPrivate = &headers[nSent % BENCH_NUM_INBUF];
+            nEntries++;
+            nSent++;
+            nFreeIn--;
+        }
+
+        if (nBatch > 0) {
+            if (nEntries > 0)
+                inOps.Enqueue_Multiple(hEnc, entries, nEntries, &nCount);
+
+            nCount = 0;
+            outOps.Dequeue_Multiple(hEnc, pBuffers, BENCH_NUM_OUTBUF, &nCount);
+            for (i = 0; i < nCount; i++) {
+                pAddr[0] = pBuffers[i]->planes[0].addr;
+                dataSize[0] = 0;
+                outOps.Enqueue(hEnc, pAddr, dataSize, 1, NULL);
+            }
+            nDone += nCount;
+
+            nCount = 0;
+            inOps.Dequeue_Multiple(hEnc, pBuffers, BENCH_NUM_INBUF, &nCount);
+            nFreeIn += nCount;
+        } else {
+            for (i = 0; i < nEntries; i++)
+                inOps.Enqueue(hEnc, entries[i].pBuffer, entries[i].dataSize, 2, entries[i].pPrivate);
+
+            pBuffer = outOps.Dequeue(hEnc);
+            if (pBuffer != NULL) {
+                pAddr[0] = pBuffer->planes[0].addr;
+                dataSize[0] = 0;
+                outOps.Enqueue(hEnc, pAddr, dataSize, 1, NULL);
+                nDone++;
+            }
+
+            if (inOps.Dequeue(hEnc) != NULL)
+                nFreeIn++;
+        }
+    }
+
+    pResult->fps = nFrames / (Bench_Now() - start);
+    pResult->cpuPerFrame = (Bench_Cpu() - cpu) * 1e6 / nFrames;
+
+    inOps.Stop(hEnc);
+    outOps.Stop(hEnc);
+    ops.Finalize(hEnc);
+    exynos_v4l2_fake_mfc_uninstall();
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const int batches[] = { 0, 2, 4, 8 };
+    BenchResult  result;
+    int          nFrames   = 600;
+    unsigned int latencyUs = 0;
+    unsigned int i;
+
+    if (argc > 1)
+        nFrames = atoi(argv[1]);
+    if (argc > 2)
+        latencyUs = (unsigned int)atoi(argv[2]);
+
+    if (nFrames <= 0) {
+        printf("usage: %s [frames] [latency_us]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%dx%d AVC encode, %d frames, %u us per frame on the fake MFC\n",
+           BENCH_WIDTH, BENCH_HEIGHT, nFrames, latencyUs);
+
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        if (Bench_Run(batches[i], nFrames, latencyUs, &result) != 0)
+            return 1;
+
+        if (batches[i] == 0)
+            printf("  Enqueue/Dequeue          : %9.1f fps, %7.1f us CPU/frame\n",
+                   result.fps, result.cpuPerFrame);
+        else
+            printf("  Enqueue_Multiple batch %d : %9.1f fps, %7.1f us CPU/frame\n",
+                   batches[i], result.fps, result.cpuPerFrame);
+    }
+
+    return 0;
+}
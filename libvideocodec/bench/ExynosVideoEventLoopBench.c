@@ -0,0 +1,384 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        ExynosVideoEventLoopBench.c
+ * @brief       Decoder CPU time and context switches per frame, with a
+ *              blocking dequeue thread per port or with Start_EventLoop,
+ *              on the fake MFC
+ * @version     1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "ExynosVideoApi.h"
+#include "exynos_v4l2_fake_mfc.h"
+#include "OMX_Core.h"
+
+#define BENCH_WIDTH         1280
+#define BENCH_HEIGHT        720
+#define BENCH_NUM_INBUF     4
+#define BENCH_NUM_OUTBUF    6
+#define BENCH_INBUF_SIZE    (1024 * 1024)
+#define BENCH_STREAM_SIZE   100
+
+typedef struct _BenchContext {
+    ExynosVideoDecOps        ops;
+    ExynosVideoDecBufferOps  inOps;
+    ExynosVideoDecBufferOps  outOps;
+    void                    *hDec;
+
+    pthread_mutex_t          lock;
+    pthread_cond_t           cond;
+    int                      nInputDone;
+    int                      nOutputDone;
+    int                      nResolutionChanged;
+    volatile int             bExit;
+} BenchContext;
+
+typedef struct _BenchResult {
+    int    nFrames;
+    double fps;
+    double cpuPerFrame;     /* us */
+    double cswPerFrame;
+} BenchResult;
+
+static double Bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void Bench_Usage(double *pCpu, long *pCsw)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    *pCpu = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+            (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+    *pCsw = ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+static void Bench_Requeue(BenchContext *pBench, ExynosVideoBuffer *pBuffer)
+{
+    void          *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long  dataSize[VIDEO_BUFFER_MAX_PLANES];
+
+    pAddr[0] = pBuffer->planes[0].addr;
+    pAddr[1] = pBuffer->planes[1].addr;
+    dataSize[0] = 0;
+    dataSize[1] = 0;
+    pBench->outOps.Enqueue(pBench->hDec, pAddr, dataSize, 2, NULL);
+}
+
+static void Bench_Count(BenchContext *pBench, int *pCounter)
+{
+    pthread_mutex_lock(&pBench->lock);
+    (*pCounter)++;
+    pthread_cond_broadcast(&pBench->cond);
+    pthread_mutex_unlock(&pBench->lock);
+}
+
+static void Bench_InputDone(void *pUserData, ExynosVideoBuffer *pBuffer)
+{
+    BenchContext *pBench = (BenchContext *)pUserData;
+
+    Bench_Count(pBench, &pBench->nInputDone);
+}
+
+static void Bench_OutputReady(void *pUserData, ExynosVideoBuffer *pBuffer)
+{
+    BenchContext *pBench = (BenchContext *)pUserData;
+
+    Bench_Requeue(pBench, pBuffer);
+    Bench_Count(pBench, &pBench->nOutputDone);
+}
+
+static void Bench_ResolutionChanged(void *pUserData, ExynosVideoBuffer *pBuffer)
+{
+    BenchContext *pBench = (BenchContext *)pUserData;
+
+    Bench_Count(pBench, &pBench->nResolutionChanged);
+}
+
+static void Bench_Error(void *pUserData, ExynosVideoErrorType error)
+{
+    printf("  event loop error %d\n", error);
+}
+
+/* thread model, output port : blocking Dequeue */
+static void *Bench_OutputThread(void *pArg)
+{
+    BenchContext      *pBench = (BenchContext *)pArg;
+    ExynosVideoBuffer *pBuffer;
+
+    while (pBench->bExit == 0) {
+        pBuffer = pBench->outOps.Dequeue(pBench->hDec);
+        if (pBuffer == NULL)
+            continue;
+
+        if (pBuffer->displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL)
+            Bench_ResolutionChanged(pBench, pBuffer);
+        else
+            Bench_OutputReady(pBench, pBuffer);
+    }
+
+    return NULL;
+}
+
+/*
+ * thread model, input port : the fake always reports POLLOUT, a Dequeue
+ * without a finished stream buffer fails at once, so this one sleeps
+ */
+static void *Bench_InputThread(void *pArg)
+{
+    BenchContext *pBench = (BenchContext *)pArg;
+
+    while (pBench->bExit == 0) {
+        if (pBench->inOps.Dequeue(pBench->hDec) != NULL)
+            Bench_InputDone(pBench, NULL);
+        else
+            usleep(1000);
+    }
+
+    return NULL;
+}
+
+static int Bench_Run(
+    ExynosVideoBoolType  bEventLoop,
+    int                  nFrames,
+    unsigned int         latencyUs,
+    unsigned int         resolutionChangeFrame,
+    BenchResult         *pResult)
+{
+    struct exynos_v4l2_fake_mfc_config config;
+    BenchContext             bench;
+    ExynosVideoDecCallbacks  callbacks;
+    ExynosVideoInstInfo      instInfo;
+    ExynosVideoGeometry      geometry;
+    ExynosVideoBuffer       *pBuffer;
+    OMX_BUFFERHEADERTYPE     header;
+    pthread_t                inThread, outThread;
+    void                    *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long            dataSize[VIDEO_BUFFER_MAX_PLANES];
+    struct timespec          ts;
+    double start, cpu, cpuEnd;
+    long   csw, cswEnd;
+    int    bOutThread = 0;
+    int    nSent = 0, nDone, i;
+
+    memset(&config, 0, sizeof(config));
+    config.decode_latency_us = latencyUs;
+    config.width = BENCH_WIDTH;
+    config.height = BENCH_HEIGHT;
+    config.min_dpb = 4;
+    config.ref_frames = 2;
+    config.resolution_change_frame = resolutionChangeFrame;
+    config.new_width = BENCH_WIDTH / 2;
+    config.new_height = BENCH_HEIGHT / 2;
+
+    if (exynos_v4l2_fake_mfc_install(&config) != 0) {
+        printf("exynos_v4l2_fake_mfc_install failed\n");
+        return -1;
+    }
+
+    memset(&bench, 0, sizeof(bench));
+    pthread_mutex_init(&bench.lock, NULL);
+    pthread_cond_init(&bench.cond, NULL);
+    bench.ops.nSize = sizeof(bench.ops);
+    bench.inOps.nSize = sizeof(bench.inOps);
+    bench.outOps.nSize = sizeof(bench.outOps);
+
+    if (Exynos_Video_Register_Decoder(&bench.ops, &bench.inOps, &bench.outOps) != VIDEO_ERROR_NONE) {
+        printf("Exynos_Video_Register_Decoder failed\n");
+        goto EXIT_UNINSTALL;
+    }
+
+    memset(&instInfo, 0, sizeof(instInfo));
+    instInfo.eCodecType = VIDEO_CODING_AVC;
+    instInfo.nMemoryType = V4L2_MEMORY_MMAP;
+
+    bench.hDec = bench.ops.Init(&instInfo);
+    if (bench.hDec == NULL) {
+        printf("Init failed\n");
+        goto EXIT_UNINSTALL;
+    }
+
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.eCompressionFormat = VIDEO_CODING_AVC;
+    geometry.nSizeImage = BENCH_INBUF_SIZE;
+    geometry.nPlaneCnt = 1;
+    bench.inOps.Set_Geometry(bench.hDec, &geometry);
+    if (bench.inOps.Setup(bench.hDec, BENCH_NUM_INBUF) != VIDEO_ERROR_NONE) {
+        printf("input Setup failed\n");
+        goto EXIT_FINALIZE;
+    }
+    bench.inOps.Run(bench.hDec);
+
+    callbacks.InputDone = Bench_InputDone;
+    callbacks.OutputReady = Bench_OutputReady;
+    callbacks.ResolutionChanged = Bench_ResolutionChanged;
+    callbacks.Error = Bench_Error;
+
+    if (bEventLoop == VIDEO_TRUE) {
+        if (bench.ops.Start_EventLoop(bench.hDec, &callbacks, &bench) != VIDEO_ERROR_NONE) {
+            printf("Start_EventLoop failed\n");
+            goto EXIT_FINALIZE;
+        }
+    } else {
+        pthread_create(&inThread, NULL, Bench_InputThread, &bench);
+    }
+
+    /* the header, then the capture port */
+    memset(&header, 0, sizeof(header));
+    pAddr[0] = NULL;
+    dataSize[0] = BENCH_STREAM_SIZE;
+    bench.inOps.Enqueue(bench.hDec, pAddr, dataSize, 1, &header);
+
+    pthread_mutex_lock(&bench.lock);
+    while (bench.nInputDone < 1)
+        pthread_cond_wait(&bench.cond, &bench.lock);
+    pthread_mutex_unlock(&bench.lock);
+
+    bench.outOps.Get_Geometry(bench.hDec, &geometry);
+    geometry.nPlaneCnt = 2;
+    bench.outOps.Set_Geometry(bench.hDec, &geometry);
+    if (bench.outOps.Setup(bench.hDec, BENCH_NUM_OUTBUF) != VIDEO_ERROR_NONE) {
+        printf("output Setup failed\n");
+        goto EXIT_STOP;
+    }
+
+    for (i = 0; i < BENCH_NUM_OUTBUF; i++) {
+        bench.outOps.Get_Buffer(bench.hDec, i, &pBuffer);
+        Bench_Requeue(&bench, pBuffer);
+    }
+    bench.outOps.Run(bench.hDec);
+
+    if (bEventLoop == VIDEO_FALSE) {
+        pthread_create(&outThread, NULL, Bench_OutputThread, &bench);
+        bOutThread = 1;
+    }
+
+    start = Bench_Now();
+    Bench_Usage(&cpu, &csw);
+
+    pthread_mutex_lock(&bench.lock);
+    while ((bench.nOutputDone < nFrames) && (bench.nResolutionChanged == 0)) {
+        if ((nSent < nFrames) && ((nSent - (bench.nInputDone - 1)) < BENCH_NUM_INBUF)) {
+            pthread_mutex_unlock(&bench.lock);
+            if (bench.inOps.Enqueue(bench.hDec, pAddr, dataSize, 1, &header) == VIDEO_ERROR_NONE)
+                nSent++;
+            pthread_mutex_lock(&bench.lock);
+            continue;
+        }
+
+        /* the thread model drops wakeups while its input thread sleeps */
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 2000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&bench.cond, &bench.lock, &ts);
+    }
+    nDone = bench.nOutputDone;
+    pthread_mutex_unlock(&bench.lock);
+
+    Bench_Usage(&cpuEnd, &cswEnd);
+
+    pResult->nFrames = nDone;
+    pResult->fps = nDone / (Bench_Now() - start);
+    pResult->cpuPerFrame = (cpuEnd - cpu) * 1e6 / ((nDone > 0) ? nDone : 1);
+    pResult->cswPerFrame = (double)(cswEnd - csw) / ((nDone > 0) ? nDone : 1);
+
+    if (bench.nResolutionChanged > 0)
+        printf("  resolution change reported after %d frames\n", nDone);
+
+EXIT_STOP:
+    if (bEventLoop == VIDEO_TRUE) {
+        bench.ops.Stop_EventLoop(bench.hDec);
+    } else {
+        bench.bExit = 1;
+        bench.inOps.Stop(bench.hDec);
+        bench.outOps.Stop(bench.hDec);
+        pthread_join(inThread, NULL);
+        if (bOutThread != 0)
+            pthread_join(outThread, NULL);
+    }
+
+    bench.inOps.Stop(bench.hDec);
+    bench.outOps.Stop(bench.hDec);
+
+EXIT_FINALIZE:
+    bench.ops.Finalize(bench.hDec);
+
+EXIT_UNINSTALL:
+    exynos_v4l2_fake_mfc_uninstall();
+    pthread_cond_destroy(&bench.cond);
+    pthread_mutex_destroy(&bench.lock);
+
+    return 0;
+}
+
+static void Bench_Print(const char *pName, BenchResult *pResult)
+{
+    printf("  %-10s: %4d frames, %7.1f fps, %6.1f us CPU/frame, %5.2f context switches/frame\n",
+           pName, pResult->nFrames, pResult->fps, pResult->cpuPerFrame, pResult->cswPerFrame);
+}
+
+int main(int argc, char **argv)
+{
+    BenchResult  result;
+    int          nFrames   = 300;
+    unsigned int latencyUs = 2000;
+
+    if (argc > 1)
+        nFrames = atoi(argv[1]);
+    if (argc > 2)
+        latencyUs = (unsigned int)atoi(argv[2]);
+
+    if (nFrames <= 0) {
+        printf("usage: %s [frames] [latency_us]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%dx%d AVC decode, %d frames, %u us per frame on the fake MFC\n",
+           BENCH_WIDTH, BENCH_HEIGHT, nFrames, latencyUs);
+
+    memset(&result, 0, sizeof(result));
+    Bench_Run(VIDEO_FALSE, nFrames, latencyUs, 0, &result);
+    Bench_Print("threads", &result);
+
+    memset(&result, 0, sizeof(result));
+    Bench_Run(VIDEO_TRUE, nFrames, latencyUs, 0, &result);
+    Bench_Print("event loop", &result);
+
+    /* ResolutionChanged is delivered by the event loop */
+    memset(&result, 0, sizeof(result));
+    Bench_Run(VIDEO_TRUE, nFrames, latencyUs, (nFrames / 2) + 1, &result);
+    Bench_Print("event loop", &result);
+
+    return 0;
+}
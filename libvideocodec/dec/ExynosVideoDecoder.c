@@ -38,11 +38,15 @@
 #include <pthread.h>
 
 #include <sys/poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include "ion.h"
 
 #include "ExynosVideoApi.h"
+#include "ExynosVideoBufferIndex.h"
 #include "ExynosVideoDec.h"
+#include "ExynosVideoSession.h"
 #include "OMX_Core.h"
 
 /* #define LOG_NDEBUG 0 */
@@ -212,6 +216,8 @@ static ExynosVideoColorFormatType __V4L2PixelFormat_To_ColorFormatType(unsigned
     return colorFormatType;
 }
 
+static ExynosVideoErrorType MFC_Decoder_Stop_EventLoop(void *pHandle);
+
 /*
  * [Decoder OPS] Init
  */
@@ -235,6 +241,8 @@ static void *MFC_Decoder_Init(ExynosVideoInstInfo *pVideoInfo)
     }
 
     memset(pCtx, 0, sizeof(*pCtx));
+    pCtx->hEventPoll = -1;
+    pCtx->hEventWake = -1;
 
 #ifdef USE_HEVC_HWIP
     if (pVideoInfo->eCodecType == VIDEO_CODING_HEVC) {
@@ -322,6 +330,11 @@ static void *MFC_Decoder_Init(ExynosVideoInstInfo *pVideoInfo)
 
     memset(pCtx->pPrivateDataShareAddress, -1, sizeof(PrivateDataShareBuffer) * VIDEO_BUFFER_MAX_NUM);
 
+    /* xFramerate is Q16, the stream size is known once the header is parsed */
+    pCtx->nSessionId = Exynos_Video_Session_Open(pCtx->hDec, VIDEO_TRUE, pVideoInfo->eCodecType);
+    Exynos_Video_Session_Set_Format(pCtx->nSessionId, pVideoInfo->nWidth, pVideoInfo->nHeight,
+                                    pVideoInfo->xFramerate >> 16);
+
     return (void *)pCtx;
 
 EXIT_QUERYCAP_FAIL:
@@ -371,6 +384,10 @@ static ExynosVideoErrorType MFC_Decoder_Finalize(void *pHandle)
         goto EXIT;
     }
 
+    MFC_Decoder_Stop_EventLoop(pCtx);
+
+    Exynos_Video_Session_Close(pCtx->nSessionId);
+
     if (pCtx->pPrivateDataShareAddress != NULL) {
         ion_unmap(pCtx->pPrivateDataShareAddress, sizeof(PrivateDataShareBuffer) * VIDEO_BUFFER_MAX_NUM);
         pCtx->pPrivateDataShareAddress = NULL;
@@ -790,6 +807,12 @@ static ExynosVideoErrorType MFC_Decoder_Set_QosRatio(
         goto EXIT;
     }
 
+    if (pCtx->nSessionId >= 0) {
+        /* scaled down while the instances exceed the load budget */
+        ret = Exynos_Video_Session_Set_QosRatio(pCtx->nSessionId, ratio);
+        goto EXIT;
+    }
+
     if (exynos_v4l2_s_ctrl(pCtx->hDec, V4L2_CID_MPEG_VIDEO_QOS_RATIO, ratio) != 0) {
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -1131,6 +1154,8 @@ static ExynosVideoErrorType MFC_Decoder_Get_Geometry_Outbuf(
     bufferConf->nFrameHeight = fmt.fmt.pix_mp.height;
     bufferConf->eColorFormat = __V4L2PixelFormat_To_ColorFormatType(fmt.fmt.pix_mp.pixelformat);
 
+    Exynos_Video_Session_Set_Format(pCtx->nSessionId, fmt.fmt.pix_mp.width, fmt.fmt.pix_mp.height, 0);
+
     if ((fmt.fmt.pix_mp.field == V4L2_FIELD_INTERLACED) ||
         (fmt.fmt.pix_mp.field == V4L2_FIELD_INTERLACED_TB) ||
         (fmt.fmt.pix_mp.field == V4L2_FIELD_INTERLACED_BT))
@@ -1229,9 +1254,9 @@ static ExynosVideoErrorType MFC_Decoder_Setup_Inbuf(
 
             pVideoPlane = &pCtx->pInbuf[i].planes[0];
 
-            pVideoPlane->addr = mmap(NULL,
+            pVideoPlane->addr = exynos_v4l2_mmap(pCtx->hDec,
                     buf.m.planes[0].length, PROT_READ | PROT_WRITE,
-                    MAP_SHARED, pCtx->hDec, buf.m.planes[0].m.mem_offset);
+                    MAP_SHARED, buf.m.planes[0].m.mem_offset);
 
             if (pVideoPlane->addr == MAP_FAILED) {
                 ret = VIDEO_ERROR_MAPFAIL;
@@ -1247,6 +1272,8 @@ static ExynosVideoErrorType MFC_Decoder_Setup_Inbuf(
         }
     }
 
+    Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
+
     return ret;
 
 EXIT:
@@ -1265,6 +1292,7 @@ EXIT:
 
         free(pCtx->pInbuf);
         pCtx->pInbuf = NULL;
+        Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, NULL, 0);
     }
 
     return ret;
@@ -1348,9 +1376,9 @@ static ExynosVideoErrorType MFC_Decoder_Setup_Outbuf(
 
             for (j = 0; j < pCtx->nOutbufPlanes; j++) {
                 pVideoPlane = &pCtx->pOutbuf[i].planes[j];
-                pVideoPlane->addr = mmap(NULL,
+                pVideoPlane->addr = exynos_v4l2_mmap(pCtx->hDec,
                         buf.m.planes[j].length, PROT_READ | PROT_WRITE,
-                        MAP_SHARED, pCtx->hDec, buf.m.planes[j].m.mem_offset);
+                        MAP_SHARED, buf.m.planes[j].m.mem_offset);
 
                 if (pVideoPlane->addr == MAP_FAILED) {
                     ret = VIDEO_ERROR_MAPFAIL;
@@ -1369,6 +1397,8 @@ static ExynosVideoErrorType MFC_Decoder_Setup_Outbuf(
         }
     }
 
+    Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+
     return ret;
 
 EXIT:
@@ -1389,6 +1419,7 @@ EXIT:
 
         free(pCtx->pOutbuf);
         pCtx->pOutbuf = NULL;
+        Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, NULL, 0);
     }
 
     return ret;
@@ -1475,6 +1506,7 @@ static ExynosVideoErrorType MFC_Decoder_Stop_Inbuf(void *pHandle)
     for (i = 0; i <  pCtx->nInbufs; i++) {
         pCtx->pInbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->inbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -1509,6 +1541,8 @@ static ExynosVideoErrorType MFC_Decoder_Stop_Outbuf(void *pHandle)
         pCtx->pOutbuf[i].bSlotUsed    = VIDEO_FALSE;
         pCtx->pOutbuf[i].nIndexUseCnt = 0;
     }
+    pCtx->outbufIndex.queuedMask   = 0;
+    pCtx->outbufIndex.slotUsedMask = 0;
 
 EXIT:
     return ret;
@@ -1581,6 +1615,7 @@ static ExynosVideoErrorType MFC_Decoder_Register_Inbuf(
                   planes[plane].addr, planes[plane].allocSize, planes[plane].fd);
             }
             pCtx->pInbuf[nIndex].bRegistered = VIDEO_TRUE;
+            Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, nIndex);
             break;
         }
     }
@@ -1619,6 +1654,7 @@ static ExynosVideoErrorType MFC_Decoder_Register_Outbuf(
                       __func__, nIndex, plane, planes[plane].addr, planes[plane].allocSize, planes[plane].fd);
             }
             pCtx->pOutbuf[nIndex].bRegistered = VIDEO_TRUE;
+            Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, nIndex);
 
             break;
         }
@@ -1653,6 +1689,7 @@ static ExynosVideoErrorType MFC_Decoder_Clear_RegisteredBuffer_Inbuf(void *pHand
 
         pCtx->pInbuf[nIndex].bRegistered = VIDEO_FALSE;
     }
+    Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
 
 EXIT:
     return ret;
@@ -1677,6 +1714,7 @@ static ExynosVideoErrorType MFC_Decoder_Clear_RegisteredBuffer_Outbuf(void *pHan
         }
         pCtx->pOutbuf[nIndex].bRegistered = VIDEO_FALSE;
     }
+    Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
 
 EXIT:
     return ret;
@@ -1697,6 +1735,10 @@ static int MFC_Decoder_Find_Inbuf(
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_Find(&pCtx->inbufIndex, pBuffer);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nInbufs; nIndex++) {
         if (pCtx->pInbuf[nIndex].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -1727,6 +1769,10 @@ static int MFC_Decoder_Find_Outbuf(
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_Find(&pCtx->outbufIndex, pBuffer);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nOutbufs; nIndex++) {
         if (pCtx->pOutbuf[nIndex].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -1834,6 +1880,7 @@ static ExynosVideoErrorType MFC_Decoder_Enqueue_Inbuf(
 
     pCtx->pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hDec, &buf) != 0) {
@@ -1841,6 +1888,7 @@ static ExynosVideoErrorType MFC_Decoder_Enqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->pInbuf[buf.index].pPrivate = NULL;
         pCtx->pInbuf[buf.index].bQueued  = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -1922,12 +1970,14 @@ static ExynosVideoErrorType MFC_Decoder_Enqueue_Outbuf(
 
     pCtx->pOutbuf[buf.index].pPrivate = pPrivate;
     pCtx->pOutbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hDec, &buf) != 0) {
         pthread_mutex_lock(pMutex);
         pCtx->pOutbuf[buf.index].pPrivate = NULL;
         pCtx->pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
         exynos_v4l2_g_ctrl(pCtx->hDec, V4L2_CID_MPEG_MFC51_VIDEO_CHECK_STATE, &state);
         if (state == 1) {
             /* The case of Resolution is changed */
@@ -1993,6 +2043,7 @@ static ExynosVideoBuffer *MFC_Decoder_Dequeue_Inbuf(void *pHandle)
     }
 
     pCtx->pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
 
     if (pCtx->bStreamonInbuf == VIDEO_FALSE)
         pInbuf = NULL;
@@ -2114,6 +2165,7 @@ static ExynosVideoBuffer *MFC_Decoder_Dequeue_Outbuf(void *pHandle)
     };
 
     pOutbuf->bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
 
     pthread_mutex_unlock(pMutex);
 
@@ -2121,6 +2173,321 @@ EXIT:
     return pOutbuf;
 }
 
+/*
+ * [Decoder Buffer OPS] Enqueue Multiple (Common)
+ */
+static ExynosVideoErrorType MFC_Decoder_Enqueue_Multiple(
+    void                  *pHandle,
+    ExynosVideoBoolType    bInput,
+    ExynosVideoBatchEntry *pEntries,
+    int                    nEntries,
+    int                   *pnCount)
+{
+    ExynosVideoErrorType ret = VIDEO_ERROR_NONE;
+    int i;
+
+    if ((pHandle == NULL) || (pEntries == NULL) || (pnCount == NULL)) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    for (i = 0; i < nEntries; i++) {
+        if (bInput == VIDEO_TRUE)
+            ret = MFC_Decoder_Enqueue_Inbuf(pHandle, pEntries[i].pBuffer, pEntries[i].dataSize,
+                                            pEntries[i].nPlanes, pEntries[i].pPrivate);
+        else
+            ret = MFC_Decoder_Enqueue_Outbuf(pHandle, pEntries[i].pBuffer, pEntries[i].dataSize,
+                                             pEntries[i].nPlanes, pEntries[i].pPrivate);
+        if (ret != VIDEO_ERROR_NONE)
+            break;
+    }
+
+    *pnCount = i;
+
+EXIT:
+    return ret;
+}
+
+/*
+ * [Decoder Buffer OPS] Dequeue Multiple (Common)
+ */
+static ExynosVideoErrorType MFC_Decoder_Dequeue_Multiple(
+    void               *pHandle,
+    ExynosVideoBoolType bInput,
+    ExynosVideoBuffer  *pBuffers[],
+    int                 nMaxBuffers,
+    int                 nTimeout,
+    int                *pnCount)
+{
+    ExynosVideoDecContext  *pCtx    = (ExynosVideoDecContext *)pHandle;
+    ExynosVideoErrorType    ret     = VIDEO_ERROR_NONE;
+    ExynosVideoBufferIndex *pIndex  = NULL;
+    ExynosVideoBuffer      *pBuffer = NULL;
+
+    struct pollfd poll_events;
+    int poll_state;
+    int nCount = 0;
+
+    if ((pCtx == NULL) || (pBuffers == NULL) || (pnCount == NULL)) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    pIndex = (bInput == VIDEO_TRUE) ? &pCtx->inbufIndex : &pCtx->outbufIndex;
+
+    poll_events.fd = pCtx->hDec;
+    poll_events.events = ((bInput == VIDEO_TRUE) ? POLLOUT : POLLIN) | POLLERR;
+
+    while (nCount < nMaxBuffers) {
+        /* only a bound, a stale mask costs one more poll */
+        if ((pIndex->nBuffers > 0) && (pIndex->queuedMask == 0))
+            break;
+
+        /* wait for the first buffer only, then take what is already done */
+        poll_events.revents = 0;
+        poll_state = poll((struct pollfd*)&poll_events, 1, (nCount == 0) ? nTimeout : 0);
+        if (poll_state == 0)
+            break;
+
+        if ((poll_state < 0) || !(poll_events.revents & (POLLIN | POLLOUT))) {
+            ALOGE("%s: Poll return error", __func__);
+            ret = VIDEO_ERROR_POLL;
+            break;
+        }
+
+        if (bInput == VIDEO_TRUE)
+            pBuffer = MFC_Decoder_Dequeue_Inbuf(pCtx);
+        else
+            pBuffer = MFC_Decoder_Dequeue_Outbuf(pCtx);
+
+        if (pBuffer == (ExynosVideoBuffer *)VIDEO_ERROR_DQBUF_EIO) {
+            ret = VIDEO_ERROR_DQBUF_EIO;
+            break;
+        }
+
+        if (pBuffer == NULL)
+            break;
+
+        pBuffers[nCount++] = pBuffer;
+    }
+
+    *pnCount = nCount;
+
+EXIT:
+    return ret;
+}
+
+static ExynosVideoErrorType MFC_Decoder_Enqueue_Multiple_Inbuf(
+    void                  *pHandle,
+    ExynosVideoBatchEntry *pEntries,
+    int                    nEntries,
+    int                   *pnCount)
+{
+    return MFC_Decoder_Enqueue_Multiple(pHandle, VIDEO_TRUE, pEntries, nEntries, pnCount);
+}
+
+static ExynosVideoErrorType MFC_Decoder_Enqueue_Multiple_Outbuf(
+    void                  *pHandle,
+    ExynosVideoBatchEntry *pEntries,
+    int                    nEntries,
+    int                   *pnCount)
+{
+    return MFC_Decoder_Enqueue_Multiple(pHandle, VIDEO_FALSE, pEntries, nEntries, pnCount);
+}
+
+static ExynosVideoErrorType MFC_Decoder_Dequeue_Multiple_Inbuf(
+    void              *pHandle,
+    ExynosVideoBuffer *pBuffers[],
+    int                nMaxBuffers,
+    int               *pnCount)
+{
+    return MFC_Decoder_Dequeue_Multiple(pHandle, VIDEO_TRUE, pBuffers, nMaxBuffers, VIDEO_DECODER_POLL_TIMEOUT, pnCount);
+}
+
+static ExynosVideoErrorType MFC_Decoder_Dequeue_Multiple_Outbuf(
+    void              *pHandle,
+    ExynosVideoBuffer *pBuffers[],
+    int                nMaxBuffers,
+    int               *pnCount)
+{
+    return MFC_Decoder_Dequeue_Multiple(pHandle, VIDEO_FALSE, pBuffers, nMaxBuffers, VIDEO_DECODER_POLL_TIMEOUT, pnCount);
+}
+
+/*
+ * [Decoder OPS] Event Loop
+ */
+static void *MFC_Decoder_EventLoop(void *pArg)
+{
+    ExynosVideoDecContext   *pCtx       = (ExynosVideoDecContext *)pArg;
+    ExynosVideoDecCallbacks *pCallbacks = &pCtx->eventCallbacks;
+    ExynosVideoBuffer       *pBuffers[VIDEO_BUFFER_MAX_NUM];
+    ExynosVideoErrorType     ret;
+
+    struct epoll_event events[2];
+    int nEvents, nCount;
+    int i;
+
+    while (1) {
+        nEvents = epoll_wait(pCtx->hEventPoll, events, 2, -1);
+        if (nEvents < 0) {
+            if (errno == EINTR)
+                continue;
+
+            ALOGE("%s: epoll_wait failed (%s)", __func__, strerror(errno));
+            if (pCallbacks->Error != NULL)
+                pCallbacks->Error(pCtx->pEventUserData, VIDEO_ERROR_POLL);
+            break;
+        }
+
+        for (i = 0; i < nEvents; i++) {
+            if (events[i].data.fd == pCtx->hEventWake)
+                goto EXIT;
+        }
+
+        /*
+         * the fd is edge triggered, so everything already done is taken before
+         * waiting again. POLLERR alone only means a queue is not streaming.
+         */
+        ret = MFC_Decoder_Dequeue_Multiple(pCtx, VIDEO_TRUE, pBuffers, VIDEO_BUFFER_MAX_NUM, 0, &nCount);
+        for (i = 0; i < nCount; i++) {
+            if (pCallbacks->InputDone != NULL)
+                pCallbacks->InputDone(pCtx->pEventUserData, pBuffers[i]);
+        }
+        if ((ret != VIDEO_ERROR_NONE) && (ret != VIDEO_ERROR_POLL) && (pCallbacks->Error != NULL))
+            pCallbacks->Error(pCtx->pEventUserData, ret);
+
+        ret = MFC_Decoder_Dequeue_Multiple(pCtx, VIDEO_FALSE, pBuffers, VIDEO_BUFFER_MAX_NUM, 0, &nCount);
+        for (i = 0; i < nCount; i++) {
+            if ((pBuffers[i]->displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) &&
+                (pCallbacks->ResolutionChanged != NULL))
+                pCallbacks->ResolutionChanged(pCtx->pEventUserData, pBuffers[i]);
+            else if (pCallbacks->OutputReady != NULL)
+                pCallbacks->OutputReady(pCtx->pEventUserData, pBuffers[i]);
+        }
+        if ((ret != VIDEO_ERROR_NONE) && (ret != VIDEO_ERROR_POLL) && (pCallbacks->Error != NULL))
+            pCallbacks->Error(pCtx->pEventUserData, ret);
+    }
+
+EXIT:
+    return NULL;
+}
+
+/*
+ * [Decoder OPS] Start Event Loop
+ */
+static ExynosVideoErrorType MFC_Decoder_Start_EventLoop(
+    void                    *pHandle,
+    ExynosVideoDecCallbacks *pCallbacks,
+    void                    *pUserData)
+{
+    ExynosVideoDecContext *pCtx = (ExynosVideoDecContext *)pHandle;
+    ExynosVideoErrorType   ret  = VIDEO_ERROR_NONE;
+
+    struct epoll_event event;
+
+    if ((pCtx == NULL) || (pCallbacks == NULL)) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    if (pCtx->bEventLoop == VIDEO_TRUE) {
+        ALOGE("%s: Event loop is already running", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    pCtx->hEventPoll = epoll_create1(EPOLL_CLOEXEC);
+    pCtx->hEventWake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((pCtx->hEventPoll < 0) || (pCtx->hEventWake < 0)) {
+        ALOGE("%s: Failed to create event fds (%s)", __func__, strerror(errno));
+        ret = VIDEO_ERROR_APIFAIL;
+        goto EXIT_FAIL;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.fd = pCtx->hDec;
+    if (epoll_ctl(pCtx->hEventPoll, EPOLL_CTL_ADD, pCtx->hDec, &event) != 0) {
+        ALOGE("%s: Failed to watch decoder fd (%s)", __func__, strerror(errno));
+        ret = VIDEO_ERROR_APIFAIL;
+        goto EXIT_FAIL;
+    }
+
+    event.events = EPOLLIN;
+    event.data.fd = pCtx->hEventWake;
+    if (epoll_ctl(pCtx->hEventPoll, EPOLL_CTL_ADD, pCtx->hEventWake, &event) != 0) {
+        ALOGE("%s: Failed to watch wake fd (%s)", __func__, strerror(errno));
+        ret = VIDEO_ERROR_APIFAIL;
+        goto EXIT_FAIL;
+    }
+
+    memcpy(&pCtx->eventCallbacks, pCallbacks, sizeof(pCtx->eventCallbacks));
+    pCtx->pEventUserData = pUserData;
+
+    if (pthread_create(&pCtx->eventThread, NULL, MFC_Decoder_EventLoop, pCtx) != 0) {
+        ALOGE("%s: Failed to create event thread", __func__);
+        ret = VIDEO_ERROR_APIFAIL;
+        goto EXIT_FAIL;
+    }
+
+    pCtx->bEventLoop = VIDEO_TRUE;
+
+    return ret;
+
+EXIT_FAIL:
+    if (pCtx->hEventPoll >= 0)
+        close(pCtx->hEventPoll);
+    if (pCtx->hEventWake >= 0)
+        close(pCtx->hEventWake);
+    pCtx->hEventPoll = -1;
+    pCtx->hEventWake = -1;
+
+EXIT:
+    return ret;
+}
+
+/*
+ * [Decoder OPS] Stop Event Loop
+ */
+static ExynosVideoErrorType MFC_Decoder_Stop_EventLoop(void *pHandle)
+{
+    ExynosVideoDecContext *pCtx = (ExynosVideoDecContext *)pHandle;
+    ExynosVideoErrorType   ret  = VIDEO_ERROR_NONE;
+    uint64_t               wake = 1;
+
+    if (pCtx == NULL) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    if (pCtx->bEventLoop == VIDEO_FALSE)
+        goto EXIT;
+
+    if (pthread_equal(pthread_self(), pCtx->eventThread)) {
+        ALOGE("%s: Event loop can't be stopped from its callbacks", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    if (write(pCtx->hEventWake, &wake, sizeof(wake)) != sizeof(wake))
+        ALOGE("%s: Failed to wake event loop (%s)", __func__, strerror(errno));
+
+    pthread_join(pCtx->eventThread, NULL);
+
+    close(pCtx->hEventPoll);
+    close(pCtx->hEventWake);
+    pCtx->hEventPoll = -1;
+    pCtx->hEventWake = -1;
+    pCtx->bEventLoop = VIDEO_FALSE;
+
+EXIT:
+    return ret;
+}
+
 static ExynosVideoErrorType MFC_Decoder_Clear_Queued_Inbuf(void *pHandle)
 {
     ExynosVideoDecContext *pCtx = (ExynosVideoDecContext *)pHandle;
@@ -2136,6 +2503,7 @@ static ExynosVideoErrorType MFC_Decoder_Clear_Queued_Inbuf(void *pHandle)
     for (i = 0; i < pCtx->nInbufs; i++) {
         pCtx->pInbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->inbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -2156,6 +2524,7 @@ static ExynosVideoErrorType MFC_Decoder_Clear_Queued_Outbuf(void *pHandle)
     for (i = 0; i < pCtx->nOutbufs; i++) {
         pCtx->pOutbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->outbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -2201,6 +2570,7 @@ static ExynosVideoErrorType MFC_Decoder_Cleanup_Buffer_Inbuf(void *pHandle)
         free(pCtx->pInbuf);
         pCtx->pInbuf = NULL;
     }
+    Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, NULL, 0);
 
 EXIT:
     return ret;
@@ -2246,6 +2616,7 @@ static ExynosVideoErrorType MFC_Decoder_Cleanup_Buffer_Outbuf(void *pHandle)
         free(pCtx->pOutbuf);
         pCtx->pOutbuf = NULL;
     }
+    Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, NULL, 0);
 
 EXIT:
     return ret;
@@ -2294,6 +2665,10 @@ static int MFC_Decoder_FindEmpty_Inbuf(void *pHandle)
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_FindEmpty(&pCtx->inbufIndex, VIDEO_FALSE);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nInbufs; nIndex++) {
         if (pCtx->pInbuf[nIndex].bQueued == VIDEO_FALSE)
             break;
@@ -2392,6 +2767,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Inbuf(
 
     pCtx->pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hDec, &buf) != 0) {
@@ -2399,6 +2775,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->pInbuf[buf.index].pPrivate = NULL;
         pCtx->pInbuf[buf.index].bQueued  = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2453,6 +2830,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionDequeue_Inbuf(
     memset(&pCtx->pInbuf[buf.index], 0, sizeof(ExynosVideoBuffer));
 
     pCtx->pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2473,6 +2851,10 @@ static int MFC_Decoder_FindEmpty_Outbuf(void *pHandle)
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_FindEmpty(&pCtx->outbufIndex, VIDEO_TRUE);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nOutbufs; nIndex++) {
         if ((pCtx->pOutbuf[nIndex].bQueued == VIDEO_FALSE) &&
             (pCtx->pOutbuf[nIndex].bSlotUsed == VIDEO_FALSE))
@@ -2489,42 +2871,64 @@ EXIT:
 /*
  * [Decoder Buffer OPS] BufferIndexFree (Output)
  */
+static void __Release_DPB_Outbuf(
+    ExynosVideoDecContext *pCtx,
+    int                    fd,
+    int                    j)
+{
+    if (pCtx->pOutbuf[j].bQueued == VIDEO_FALSE) {
+        if (pCtx->pOutbuf[j].nIndexUseCnt > 0)
+            pCtx->pOutbuf[j].nIndexUseCnt--;
+    } else if(pCtx->pOutbuf[j].bQueued == VIDEO_TRUE) {
+        if (pCtx->pOutbuf[j].nIndexUseCnt > 1) {
+            /* The buffer being used as the reference buffer came again. */
+            pCtx->pOutbuf[j].nIndexUseCnt--;
+        } else {
+            /* Reference DPB buffer is internally reused. */
+        }
+    }
+    ALOGV("dec Cnt : FD:%d, pCtx->pOutbuf[%d].nIndexUseCnt:%d", fd, j, pCtx->pOutbuf[j].nIndexUseCnt);
+    if ((pCtx->pOutbuf[j].nIndexUseCnt == 0) &&
+        (pCtx->pOutbuf[j].bQueued == VIDEO_FALSE)) {
+        pCtx->pOutbuf[j].bSlotUsed = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, j);
+    }
+}
+
 void MFC_Decoder_BufferIndexFree_Outbuf(
     void                   *pHandle,
     PrivateDataShareBuffer *pPDSB,
     int                     index)
 {
     ExynosVideoDecContext *pCtx = (ExynosVideoDecContext *)pHandle;
+    unsigned int fdMask;
     int i, j;
 
     ALOGV("De-queue buf.index:%d, fd:%d", index, pCtx->pOutbuf[index].planes[0].fd);
 
-    if (pCtx->pOutbuf[index].nIndexUseCnt == 0)
+    if (pCtx->pOutbuf[index].nIndexUseCnt == 0) {
         pCtx->pOutbuf[index].bSlotUsed = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, index);
+    }
 
     for (i = 0; i < VIDEO_BUFFER_MAX_NUM; i++) {
         if (pPDSB->dpbFD[i].fd < 0)
             break;
 
         ALOGV("pPDSB->dpbFD[%d].fd:%d", i, pPDSB->dpbFD[i].fd);
-        for (j = 0; j < pCtx->nOutbufs; j++) {
-            if (pPDSB->dpbFD[i].fd == pCtx->pOutbuf[j].planes[0].fd) {
-                if (pCtx->pOutbuf[j].bQueued == VIDEO_FALSE) {
-                    if (pCtx->pOutbuf[j].nIndexUseCnt > 0)
-                        pCtx->pOutbuf[j].nIndexUseCnt--;
-                } else if(pCtx->pOutbuf[j].bQueued == VIDEO_TRUE) {
-                    if (pCtx->pOutbuf[j].nIndexUseCnt > 1) {
-                        /* The buffer being used as the reference buffer came again. */
-                        pCtx->pOutbuf[j].nIndexUseCnt--;
-                    } else {
-                        /* Reference DPB buffer is internally reused. */
-                    }
-                }
-                ALOGV("dec Cnt : FD:%d, pCtx->pOutbuf[%d].nIndexUseCnt:%d", pPDSB->dpbFD[i].fd, j, pCtx->pOutbuf[j].nIndexUseCnt);
-                if ((pCtx->pOutbuf[j].nIndexUseCnt == 0) &&
-                    (pCtx->pOutbuf[j].bQueued == VIDEO_FALSE))
-                    pCtx->pOutbuf[j].bSlotUsed = VIDEO_FALSE;
+        if (pCtx->outbufIndex.nBuffers > 0) {
+            fdMask = Exynos_Video_Index_FdMask(&pCtx->outbufIndex, pPDSB->dpbFD[i].fd);
+            while (fdMask != 0) {
+                j = __builtin_ctz(fdMask);
+                __Release_DPB_Outbuf(pCtx, pPDSB->dpbFD[i].fd, j);
+                fdMask &= fdMask - 1;
             }
+            continue;
+        }
+
+        for (j = 0; j < pCtx->nOutbufs; j++) {
+            if (pPDSB->dpbFD[i].fd == pCtx->pOutbuf[j].planes[0].fd)
+                __Release_DPB_Outbuf(pCtx, pPDSB->dpbFD[i].fd, j);
         }
     }
     memset((char *)pPDSB, -1, sizeof(PrivateDataShareBuffer));
@@ -2615,6 +3019,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Outbuf(
     pCtx->pOutbuf[buf.index].bQueued = VIDEO_TRUE;
     pCtx->pOutbuf[buf.index].bSlotUsed = VIDEO_TRUE;
     pCtx->pOutbuf[buf.index].nIndexUseCnt++;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hDec, &buf) != 0) {
@@ -2624,6 +3029,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionEnqueue_Outbuf(
         pCtx->pOutbuf[buf.index].bQueued = VIDEO_FALSE;
         if (pCtx->pOutbuf[buf.index].nIndexUseCnt == 0)
             pCtx->pOutbuf[buf.index].bSlotUsed = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
         exynos_v4l2_g_ctrl(pCtx->hDec, V4L2_CID_MPEG_MFC51_VIDEO_CHECK_STATE, &state);
         if (state == 1) {
             /* The case of Resolution is changed */
@@ -2756,6 +3162,7 @@ static ExynosVideoErrorType MFC_Decoder_ExtensionDequeue_Outbuf(
 
     MFC_Decoder_BufferIndexFree_Outbuf(pHandle, pPDSB, buf.index);
     pCtx->pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2785,6 +3192,8 @@ static ExynosVideoDecOps defDecOps = {
     .Set_QosRatio           = MFC_Decoder_Set_QosRatio,
     .Enable_DualDPBMode     = MFC_Decoder_Enable_DualDPBMode,
     .Enable_DynamicDPB      = MFC_Decoder_Enable_DynamicDPB,
+    .Start_EventLoop        = MFC_Decoder_Start_EventLoop,
+    .Stop_EventLoop         = MFC_Decoder_Stop_EventLoop,
 };
 
 /*
@@ -2810,6 +3219,8 @@ static ExynosVideoDecBufferOps defInbufOps = {
     .Apply_RegisteredBuffer = NULL,
     .ExtensionEnqueue       = MFC_Decoder_ExtensionEnqueue_Inbuf,
     .ExtensionDequeue       = MFC_Decoder_ExtensionDequeue_Inbuf,
+    .Enqueue_Multiple       = MFC_Decoder_Enqueue_Multiple_Inbuf,
+    .Dequeue_Multiple       = MFC_Decoder_Dequeue_Multiple_Inbuf,
 };
 
 /*
@@ -2835,6 +3246,8 @@ static ExynosVideoDecBufferOps defOutbufOps = {
     .Apply_RegisteredBuffer = MFC_Decoder_Apply_RegisteredBuffer_Outbuf,
     .ExtensionEnqueue       = MFC_Decoder_ExtensionEnqueue_Outbuf,
     .ExtensionDequeue       = MFC_Decoder_ExtensionDequeue_Outbuf,
+    .Enqueue_Multiple       = MFC_Decoder_Enqueue_Multiple_Outbuf,
+    .Dequeue_Multiple       = MFC_Decoder_Dequeue_Multiple_Outbuf,
 };
 
 ExynosVideoErrorType MFC_Exynos_Video_GetInstInfo_Decoder(
@@ -42,7 +42,9 @@
 #include <sys/poll.h>
 
 #include "ExynosVideoApi.h"
+#include "ExynosVideoBufferIndex.h"
 #include "ExynosVideoEnc.h"
+#include "ExynosVideoSession.h"
 #include "OMX_Core.h"
 
 /* #define LOG_NDEBUG 0 */
@@ -253,6 +255,10 @@ static void *MFC_Encoder_Init(ExynosVideoInstInfo *pVideoInfo)
     }
     pCtx->pOutMutex = (void*)pMutex;
 
+    pCtx->nSessionId = Exynos_Video_Session_Open(pCtx->hEnc, VIDEO_FALSE, pVideoInfo->eCodecType);
+    Exynos_Video_Session_Set_Format(pCtx->nSessionId, pVideoInfo->nWidth, pVideoInfo->nHeight,
+                                    pVideoInfo->xFramerate >> 16);
+
     return (void *)pCtx;
 
 EXIT_QUERYCAP_FAIL:
@@ -292,6 +298,8 @@ static ExynosVideoErrorType MFC_Encoder_Finalize(void *pHandle)
         goto EXIT;
     }
 
+    Exynos_Video_Session_Close(pCtx->nSessionId);
+
     if (pCtx->pOutMutex != NULL) {
         pMutex = (pthread_mutex_t*)pCtx->pOutMutex;
         pthread_mutex_destroy(pMutex);
@@ -375,6 +383,7 @@ static ExynosVideoErrorType MFC_Encoder_Set_EncParam (
     ExynosVideoErrorType       ret          = VIDEO_ERROR_NONE;
 
     int i;
+    unsigned int framerate = 0;
     struct v4l2_ext_control  ext_ctrl[MAX_CTRL_NUM];
     struct v4l2_ext_controls ext_ctrls;
 
@@ -479,6 +488,7 @@ static ExynosVideoErrorType MFC_Encoder_Set_EncParam (
         ext_ctrl[24].value = pH264Param->Transform8x8Mode;
         ext_ctrl[25].id = V4L2_CID_MPEG_MFC51_VIDEO_H264_RC_FRAME_RATE;
         ext_ctrl[25].value = pH264Param->FrameRate;
+        framerate = pH264Param->FrameRate;
         ext_ctrl[26].id =  V4L2_CID_MPEG_VIDEO_H264_B_FRAME_QP;
         ext_ctrl[26].value = pH264Param->FrameQp_B;
         ext_ctrl[27].id =  V4L2_CID_MPEG_MFC51_VIDEO_H264_ADAPTIVE_RC_DARK;
@@ -639,6 +649,8 @@ static ExynosVideoErrorType MFC_Encoder_Set_EncParam (
         ext_ctrl[19].value = pMpeg4Param->TimeIncreamentRes;
         ext_ctrl[20].id = V4L2_CID_MPEG_MFC51_VIDEO_MPEG4_VOP_FRM_DELTA;
         ext_ctrl[20].value = pMpeg4Param->VopTimeIncreament;
+        if (pMpeg4Param->VopTimeIncreament > 0)
+            framerate = pMpeg4Param->TimeIncreamentRes / pMpeg4Param->VopTimeIncreament;
         ext_ctrl[21].id =  V4L2_CID_MPEG_VIDEO_MPEG4_B_FRAME_QP;
         ext_ctrl[21].value = pMpeg4Param->FrameQp_B;
         ext_ctrl[22].id = V4L2_CID_MPEG_VIDEO_VBV_SIZE;
@@ -688,6 +700,7 @@ static ExynosVideoErrorType MFC_Encoder_Set_EncParam (
         /* H263 specific parameters */
         ext_ctrl[13].id = V4L2_CID_MPEG_MFC51_VIDEO_H263_RC_FRAME_RATE;
         ext_ctrl[13].value = pH263Param->FrameRate;
+        framerate = pH263Param->FrameRate;
         ext_ctrl[14].id = V4L2_CID_MPEG_VIDEO_VBV_SIZE;
         ext_ctrl[14].value = 0;
         ext_ctrl[15].id = V4L2_CID_MPEG_VIDEO_HEADER_MODE;
@@ -736,6 +749,7 @@ static ExynosVideoErrorType MFC_Encoder_Set_EncParam (
         /* H263 specific parameters */
         ext_ctrl[13].id = V4L2_CID_MPEG_MFC70_VIDEO_VP8_RC_FRAME_RATE;
         ext_ctrl[13].value = pVp8Param->FrameRate;
+        framerate = pVp8Param->FrameRate;
         ext_ctrl[14].id = V4L2_CID_MPEG_VIDEO_VBV_SIZE;
         ext_ctrl[14].value = 0;
         ext_ctrl[15].id = V4L2_CID_MPEG_VIDEO_HEADER_MODE;
@@ -815,6 +829,11 @@ static ExynosVideoErrorType MFC_Encoder_Set_EncParam (
         goto EXIT;
     }
 
+    /* the frame skip mode is on the device already, the scheduler may override it */
+    Exynos_Video_Session_Set_Format(pCtx->nSessionId, pCommonParam->SourceWidth,
+                                    pCommonParam->SourceHeight, framerate);
+    Exynos_Video_Session_Set_FrameSkip(pCtx->nSessionId, pInitParam->FrameSkip, VIDEO_TRUE);
+
 EXIT:
     return ret;
 }
@@ -918,6 +937,9 @@ static ExynosVideoErrorType MFC_Encoder_Set_FrameRate(
         goto EXIT;
     }
 
+    if (frameRate > 0)
+        Exynos_Video_Session_Set_Format(pCtx->nSessionId, 0, 0, frameRate);
+
 EXIT:
     return ret;
 }
@@ -1059,6 +1081,12 @@ static ExynosVideoErrorType MFC_Encoder_Set_FrameSkip(
         goto EXIT;
     }
 
+    if (pCtx->nSessionId >= 0) {
+        /* forced to level limit while the instances exceed the load budget */
+        ret = Exynos_Video_Session_Set_FrameSkip(pCtx->nSessionId, (ExynosVideoFrameSkipMode)frameSkip, VIDEO_FALSE);
+        goto EXIT;
+    }
+
     if (exynos_v4l2_s_ctrl(pCtx->hEnc, V4L2_CID_MPEG_MFC51_VIDEO_FRAME_SKIP_MODE, frameSkip) != 0) {
         ALOGE("%s: Failed to s_ctrl", __func__);
         ret = VIDEO_ERROR_APIFAIL;
@@ -1135,6 +1163,12 @@ static ExynosVideoErrorType MFC_Encoder_Set_QosRatio(
         goto EXIT;
     }
 
+    if (pCtx->nSessionId >= 0) {
+        /* scaled down while the instances exceed the load budget */
+        ret = Exynos_Video_Session_Set_QosRatio(pCtx->nSessionId, ratio);
+        goto EXIT;
+    }
+
     if (exynos_v4l2_s_ctrl(pCtx->hEnc, V4L2_CID_MPEG_VIDEO_QOS_RATIO, ratio) != 0) {
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -1532,9 +1566,9 @@ static ExynosVideoErrorType MFC_Encoder_Setup_Inbuf(
 
             for (j = 0; j < pCtx->nInbufPlanes; j++) {
                 pVideoPlane = &pCtx->pInbuf[i].planes[j];
-                pVideoPlane->addr = mmap(NULL,
+                pVideoPlane->addr = exynos_v4l2_mmap(pCtx->hEnc,
                         buf.m.planes[j].length, PROT_READ | PROT_WRITE,
-                        MAP_SHARED, pCtx->hEnc, buf.m.planes[j].m.mem_offset);
+                        MAP_SHARED, buf.m.planes[j].m.mem_offset);
 
                 if (pVideoPlane->addr == MAP_FAILED) {
                     ALOGE("%s: Failed to map", __func__);
@@ -1559,6 +1593,8 @@ static ExynosVideoErrorType MFC_Encoder_Setup_Inbuf(
         }
     }
 
+    Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
+
     return ret;
 
 EXIT:
@@ -1579,6 +1615,7 @@ EXIT:
 
         free(pCtx->pInbuf);
         pCtx->pInbuf = NULL;
+        Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, NULL, 0);
     }
 
     return ret;
@@ -1655,9 +1692,9 @@ static ExynosVideoErrorType MFC_Encoder_Setup_Outbuf(
 
             for (j = 0; j < pCtx->nOutbufPlanes; j++) {
                 pVideoPlane = &pCtx->pOutbuf[i].planes[j];
-                pVideoPlane->addr = mmap(NULL,
+                pVideoPlane->addr = exynos_v4l2_mmap(pCtx->hEnc,
                         buf.m.planes[j].length, PROT_READ | PROT_WRITE,
-                        MAP_SHARED, pCtx->hEnc, buf.m.planes[j].m.mem_offset);
+                        MAP_SHARED, buf.m.planes[j].m.mem_offset);
 
                 if (pVideoPlane->addr == MAP_FAILED) {
                     ALOGE("%s: Failed to map", __func__);
@@ -1681,6 +1718,8 @@ static ExynosVideoErrorType MFC_Encoder_Setup_Outbuf(
         }
     }
 
+    Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+
     return ret;
 
 EXIT:
@@ -1701,6 +1740,7 @@ EXIT:
 
         free(pCtx->pOutbuf);
         pCtx->pOutbuf = NULL;
+        Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, NULL, 0);
     }
 
     return ret;
@@ -1787,6 +1827,7 @@ static ExynosVideoErrorType MFC_Encoder_Stop_Inbuf(void *pHandle)
     for (i = 0; i <  pCtx->nInbufs; i++) {
         pCtx->pInbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->inbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -1819,6 +1860,7 @@ static ExynosVideoErrorType MFC_Encoder_Stop_Outbuf(void *pHandle)
     for (i = 0; i < pCtx->nOutbufs; i++) {
         pCtx->pOutbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->outbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -1935,6 +1977,7 @@ static ExynosVideoErrorType MFC_Encoder_Register_Inbuf(
                 pCtx->pInbuf[nIndex].planes[plane].fd = planes[plane].fd;
             }
             pCtx->pInbuf[nIndex].bRegistered = VIDEO_TRUE;
+            Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, nIndex);
             break;
         }
     }
@@ -1972,6 +2015,7 @@ static ExynosVideoErrorType MFC_Encoder_Register_Outbuf(
                 pCtx->pOutbuf[nIndex].planes[plane].fd = planes[plane].fd;
             }
             pCtx->pOutbuf[nIndex].bRegistered = VIDEO_TRUE;
+            Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, nIndex);
             break;
         }
     }
@@ -2002,6 +2046,7 @@ static ExynosVideoErrorType MFC_Encoder_Clear_RegisteredBuffer_Inbuf(void *pHand
             pCtx->pInbuf[nIndex].planes[plane].addr = NULL;
         pCtx->pInbuf[nIndex].bRegistered = VIDEO_FALSE;
     }
+    Exynos_Video_Index_Rebuild(&pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
 
 EXIT:
     return ret;
@@ -2024,6 +2069,7 @@ static ExynosVideoErrorType MFC_Encoder_Clear_RegisteredBuffer_Outbuf(void *pHan
             pCtx->pOutbuf[nIndex].planes[plane].addr = NULL;
         pCtx->pOutbuf[nIndex].bRegistered = VIDEO_FALSE;
     }
+    Exynos_Video_Index_Rebuild(&pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
 
 EXIT:
     return ret;
@@ -2044,6 +2090,10 @@ static int MFC_Encoder_Find_Inbuf(
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_Find(&pCtx->inbufIndex, pBuffer);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nInbufs; nIndex++) {
         if (pCtx->pInbuf[nIndex].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -2074,6 +2124,10 @@ static int MFC_Encoder_Find_Outbuf(
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_Find(&pCtx->outbufIndex, pBuffer);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nOutbufs; nIndex++) {
         if (pCtx->pOutbuf[nIndex].bQueued == VIDEO_FALSE) {
             if ((pBuffer == NULL) ||
@@ -2174,6 +2228,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Inbuf(
 
     pCtx->pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hEnc, &buf) != 0) {
@@ -2181,6 +2236,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->pInbuf[buf.index].pPrivate = NULL;
         pCtx->pInbuf[buf.index].bQueued = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2255,6 +2311,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Outbuf(
 
     pCtx->pOutbuf[buf.index].pPrivate = pPrivate;
     pCtx->pOutbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hEnc, &buf) != 0) {
@@ -2262,6 +2319,7 @@ static ExynosVideoErrorType MFC_Encoder_Enqueue_Outbuf(
         pthread_mutex_lock(pMutex);
         pCtx->pOutbuf[buf.index].pPrivate = NULL;
         pCtx->pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2349,6 +2407,7 @@ static ExynosVideoBuffer *MFC_Encoder_Dequeue_Inbuf(void *pHandle)
     }
 
     pCtx->pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2429,12 +2488,154 @@ static ExynosVideoBuffer *MFC_Encoder_Dequeue_Outbuf(void *pHandle)
     };
 
     pOutbuf->bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
     return pOutbuf;
 }
 
+/*
+ * [Encoder Buffer OPS] Enqueue Multiple (Common)
+ */
+static ExynosVideoErrorType MFC_Encoder_Enqueue_Multiple(
+    void                  *pHandle,
+    ExynosVideoBoolType    bInput,
+    ExynosVideoBatchEntry *pEntries,
+    int                    nEntries,
+    int                   *pnCount)
+{
+    ExynosVideoErrorType ret = VIDEO_ERROR_NONE;
+    int i;
+
+    if ((pHandle == NULL) || (pEntries == NULL) || (pnCount == NULL)) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    for (i = 0; i < nEntries; i++) {
+        if (bInput == VIDEO_TRUE)
+            ret = MFC_Encoder_Enqueue_Inbuf(pHandle, pEntries[i].pBuffer, pEntries[i].dataSize,
+                                            pEntries[i].nPlanes, pEntries[i].pPrivate);
+        else
+            ret = MFC_Encoder_Enqueue_Outbuf(pHandle, pEntries[i].pBuffer, pEntries[i].dataSize,
+                                             pEntries[i].nPlanes, pEntries[i].pPrivate);
+        if (ret != VIDEO_ERROR_NONE)
+            break;
+    }
+
+    *pnCount = i;
+
+EXIT:
+    return ret;
+}
+
+/*
+ * [Encoder Buffer OPS] Dequeue Multiple (Common)
+ */
+static ExynosVideoErrorType MFC_Encoder_Dequeue_Multiple(
+    void               *pHandle,
+    ExynosVideoBoolType bInput,
+    ExynosVideoBuffer  *pBuffers[],
+    int                 nMaxBuffers,
+    int                *pnCount)
+{
+    ExynosVideoEncContext  *pCtx    = (ExynosVideoEncContext *)pHandle;
+    ExynosVideoErrorType    ret     = VIDEO_ERROR_NONE;
+    ExynosVideoBufferIndex *pIndex  = NULL;
+    ExynosVideoBuffer      *pBuffer = NULL;
+
+    struct pollfd poll_events;
+    int poll_state;
+    int nCount = 0;
+
+    if ((pCtx == NULL) || (pBuffers == NULL) || (pnCount == NULL)) {
+        ALOGE("%s: Video context info must be supplied", __func__);
+        ret = VIDEO_ERROR_BADPARAM;
+        goto EXIT;
+    }
+
+    pIndex = (bInput == VIDEO_TRUE) ? &pCtx->inbufIndex : &pCtx->outbufIndex;
+
+    poll_events.fd = pCtx->hEnc;
+    poll_events.events = ((bInput == VIDEO_TRUE) ? POLLOUT : POLLIN) | POLLERR;
+
+    while (nCount < nMaxBuffers) {
+        /* only a bound, a stale mask costs one more poll */
+        if ((pIndex->nBuffers > 0) && (pIndex->queuedMask == 0))
+            break;
+
+        /* wait for the first buffer only, then take what is already done */
+        poll_events.revents = 0;
+        poll_state = poll((struct pollfd*)&poll_events, 1, (nCount == 0) ? VIDEO_ENCODER_POLL_TIMEOUT : 0);
+        if (poll_state == 0)
+            break;
+
+        if ((poll_state < 0) || !(poll_events.revents & (POLLIN | POLLOUT))) {
+            ALOGE("%s: Poll return error", __func__);
+            ret = VIDEO_ERROR_POLL;
+            break;
+        }
+
+        if (bInput == VIDEO_TRUE)
+            pBuffer = MFC_Encoder_Dequeue_Inbuf(pCtx);
+        else
+            pBuffer = MFC_Encoder_Dequeue_Outbuf(pCtx);
+
+        if (pBuffer == (ExynosVideoBuffer *)VIDEO_ERROR_DQBUF_EIO) {
+            ret = VIDEO_ERROR_DQBUF_EIO;
+            break;
+        }
+
+        if (pBuffer == NULL)
+            break;
+
+        pBuffers[nCount++] = pBuffer;
+    }
+
+    *pnCount = nCount;
+
+EXIT:
+    return ret;
+}
+
+static ExynosVideoErrorType MFC_Encoder_Enqueue_Multiple_Inbuf(
+    void                  *pHandle,
+    ExynosVideoBatchEntry *pEntries,
+    int                    nEntries,
+    int                   *pnCount)
+{
+    return MFC_Encoder_Enqueue_Multiple(pHandle, VIDEO_TRUE, pEntries, nEntries, pnCount);
+}
+
+static ExynosVideoErrorType MFC_Encoder_Enqueue_Multiple_Outbuf(
+    void                  *pHandle,
+    ExynosVideoBatchEntry *pEntries,
+    int                    nEntries,
+    int                   *pnCount)
+{
+    return MFC_Encoder_Enqueue_Multiple(pHandle, VIDEO_FALSE, pEntries, nEntries, pnCount);
+}
+
+static ExynosVideoErrorType MFC_Encoder_Dequeue_Multiple_Inbuf(
+    void              *pHandle,
+    ExynosVideoBuffer *pBuffers[],
+    int                nMaxBuffers,
+    int               *pnCount)
+{
+    return MFC_Encoder_Dequeue_Multiple(pHandle, VIDEO_TRUE, pBuffers, nMaxBuffers, pnCount);
+}
+
+static ExynosVideoErrorType MFC_Encoder_Dequeue_Multiple_Outbuf(
+    void              *pHandle,
+    ExynosVideoBuffer *pBuffers[],
+    int                nMaxBuffers,
+    int               *pnCount)
+{
+    return MFC_Encoder_Dequeue_Multiple(pHandle, VIDEO_FALSE, pBuffers, nMaxBuffers, pnCount);
+}
+
 static ExynosVideoErrorType MFC_Encoder_Clear_Queued_Inbuf(void *pHandle)
 {
     ExynosVideoEncContext *pCtx = (ExynosVideoEncContext *)pHandle;
@@ -2450,6 +2651,7 @@ static ExynosVideoErrorType MFC_Encoder_Clear_Queued_Inbuf(void *pHandle)
     for (i = 0; i < pCtx->nInbufs; i++) {
         pCtx->pInbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->inbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -2470,6 +2672,7 @@ static ExynosVideoErrorType MFC_Encoder_Clear_Queued_Outbuf(void *pHandle)
     for (i = 0; i < pCtx->nOutbufs; i++) {
         pCtx->pOutbuf[i].bQueued = VIDEO_FALSE;
     }
+    pCtx->outbufIndex.queuedMask = 0;
 
 EXIT:
     return ret;
@@ -2489,6 +2692,10 @@ static int MFC_Encoder_FindEmpty_Inbuf(void *pHandle)
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_FindEmpty(&pCtx->inbufIndex, VIDEO_FALSE);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nInbufs; nIndex++) {
         if (pCtx->pInbuf[nIndex].bQueued == VIDEO_FALSE) {
             break;
@@ -2515,12 +2722,16 @@ static int MFC_Encoder_FindEmpty_Outbuf(void *pHandle)
         goto EXIT;
     }
 
+    nIndex = Exynos_Video_Index_FindEmpty(&pCtx->outbufIndex, VIDEO_FALSE);
+    if (nIndex != VIDEO_BUFFER_INDEX_SCAN)
+        goto EXIT;
+
     for (nIndex = 0; nIndex < pCtx->nOutbufs; nIndex++) {
         if (pCtx->pOutbuf[nIndex].bQueued == VIDEO_FALSE)
             break;
     }
 
-    if (nIndex == pCtx->nInbufs)
+    if (nIndex == pCtx->nOutbufs)
         nIndex = -1;
 
 EXIT:
@@ -2611,6 +2822,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Inbuf(
 
     pCtx->pInbuf[buf.index].pPrivate = pPrivate;
     pCtx->pInbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hEnc, &buf) != 0) {
@@ -2618,6 +2830,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Inbuf(
         pthread_mutex_lock(pMutex);
         pCtx->pInbuf[buf.index].pPrivate = NULL;
         pCtx->pInbuf[buf.index].bQueued = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2672,6 +2885,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionDequeue_Inbuf(
     memset(&pCtx->pInbuf[buf.index], 0, sizeof(ExynosVideoBuffer));
 
     pCtx->pInbuf[buf.index].bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->inbufIndex, pCtx->pInbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2747,6 +2961,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Outbuf(
 
     pCtx->pOutbuf[buf.index].pPrivate = pPrivate;
     pCtx->pOutbuf[buf.index].bQueued = VIDEO_TRUE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
     if (exynos_v4l2_qbuf(pCtx->hEnc, &buf) != 0) {
@@ -2754,6 +2969,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionEnqueue_Outbuf(
         pthread_mutex_lock(pMutex);
         pCtx->pOutbuf[buf.index].pPrivate = NULL;
         pCtx->pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+        Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
         pthread_mutex_unlock(pMutex);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
@@ -2840,6 +3056,7 @@ static ExynosVideoErrorType MFC_Encoder_ExtensionDequeue_Outbuf(
     memset(pOutbuf, 0, sizeof(ExynosVideoBuffer));
 
     pCtx->pOutbuf[buf.index].bQueued = VIDEO_FALSE;
+    Exynos_Video_Index_Sync(&pCtx->outbufIndex, pCtx->pOutbuf, buf.index);
     pthread_mutex_unlock(pMutex);
 
 EXIT:
@@ -2887,6 +3104,8 @@ static ExynosVideoEncBufferOps defInbufOps = {
     .Clear_Queue            = MFC_Encoder_Clear_Queued_Inbuf,
     .ExtensionEnqueue       = MFC_Encoder_ExtensionEnqueue_Inbuf,
     .ExtensionDequeue       = MFC_Encoder_ExtensionDequeue_Inbuf,
+    .Enqueue_Multiple       = MFC_Encoder_Enqueue_Multiple_Inbuf,
+    .Dequeue_Multiple       = MFC_Encoder_Dequeue_Multiple_Inbuf,
 };
 
 /*
@@ -2910,6 +3129,8 @@ static ExynosVideoEncBufferOps defOutbufOps = {
     .Clear_Queue            = MFC_Encoder_Clear_Queued_Outbuf,
     .ExtensionEnqueue       = MFC_Encoder_ExtensionEnqueue_Outbuf,
     .ExtensionDequeue       = MFC_Encoder_ExtensionDequeue_Outbuf,
+    .Enqueue_Multiple       = MFC_Encoder_Enqueue_Multiple_Outbuf,
+    .Dequeue_Multiple       = MFC_Encoder_Dequeue_Multiple_Outbuf,
 };
 
 ExynosVideoErrorType MFC_Exynos_Video_GetInstInfo_Encoder(
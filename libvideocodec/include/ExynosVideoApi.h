@@ -171,6 +171,50 @@ typedef struct _ExynosVideoBuffer {
     int                         nIndexUseCnt;
 } ExynosVideoBuffer;
 
+/* arguments of one Enqueue call, for Enqueue_Multiple */
+typedef struct _ExynosVideoBatchEntry {
+    void                       *pBuffer[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long               dataSize[VIDEO_BUFFER_MAX_PLANES];
+    int                         nPlanes;
+    void                       *pPrivate;
+} ExynosVideoBatchEntry;
+
+/*
+ * Completions of the decoder event loop, called on its thread. A picture
+ * reporting VIDEO_FRAME_STATUS_CHANGE_RESOL goes to ResolutionChanged
+ * instead of OutputReady. Any callback may be NULL.
+ */
+typedef struct _ExynosVideoDecCallbacks {
+    void (*InputDone)(void *pUserData, ExynosVideoBuffer *pBuffer);
+    void (*OutputReady)(void *pUserData, ExynosVideoBuffer *pBuffer);
+    void (*ResolutionChanged)(void *pUserData, ExynosVideoBuffer *pBuffer);
+    void (*Error)(void *pUserData, ExynosVideoErrorType error);
+} ExynosVideoDecCallbacks;
+
+#define VIDEO_SESSION_MAX   16
+
+/* one open MFC instance, as seen by the load scheduler */
+typedef struct _ExynosVideoSessionInfo {
+    int                         nId;
+    ExynosVideoBoolType         bIsDec;
+    ExynosVideoCodingType       eCodecType;
+    unsigned int                nWidth;
+    unsigned int                nHeight;
+    unsigned int                nFramerate;
+    unsigned int                nMBps;          /* macroblocks per second */
+    int                         nQosRatio;      /* applied ratio */
+    ExynosVideoFrameSkipMode    eFrameSkip;     /* applied mode, encoders only */
+    ExynosVideoErrorType        eApplyError;    /* result of the last write of the settings */
+    unsigned int                nApplyFailures; /* writes failed since the session opened */
+} ExynosVideoSessionInfo;
+
+typedef struct _ExynosVideoLoadInfo {
+    unsigned int                nBudgetMBps;    /* 0: no budget */
+    unsigned int                nDemandMBps;
+    int                         nSessions;
+    ExynosVideoSessionInfo      sessions[VIDEO_SESSION_MAX];
+} ExynosVideoLoadInfo;
+
 typedef struct _ExynosVideoFramePacking{
     int           available;
     unsigned int  arrangement_id;
@@ -339,6 +383,13 @@ typedef struct _ExynosVideoDecOps {
     ExynosVideoErrorType  (*Set_QosRatio)(void *pHandle, int ratio);
     ExynosVideoErrorType  (*Enable_DualDPBMode)(void *pHandle);
     ExynosVideoErrorType  (*Enable_DynamicDPB)(void *pHandle);
+    /*
+     * Dequeues both ports on a thread of the instance and reports them through
+     * pCallbacks, so the buffer Dequeue ops must not be called meanwhile.
+     * Stop_EventLoop can't be called from a callback.
+     */
+    ExynosVideoErrorType  (*Start_EventLoop)(void *pHandle, ExynosVideoDecCallbacks *pCallbacks, void *pUserData);
+    ExynosVideoErrorType  (*Stop_EventLoop)(void *pHandle);
 } ExynosVideoDecOps;
 
 typedef struct _ExynosVideoEncOps {
@@ -382,6 +433,14 @@ typedef struct _ExynosVideoDecBufferOps {
     ExynosVideoErrorType  (*Apply_RegisteredBuffer)(void *pHandle);
     ExynosVideoErrorType  (*ExtensionEnqueue)(void *pHandle, void *pBuffer[], int pFd[], unsigned long allocLen[], unsigned long dataSize[], int nPlanes, void *pPrivate);
     ExynosVideoErrorType  (*ExtensionDequeue)(void *pHandle, ExynosVideoBuffer *pVideoBuffer);
+    /*
+     * Enqueue_Multiple stops at the first entry that fails and returns its error.
+     * Dequeue_Multiple waits up to one poll timeout for the queue, then takes every
+     * buffer that is ready without waiting again, at most nMaxBuffers.
+     * Both report how many buffers they handled in *pnCount.
+     */
+    ExynosVideoErrorType  (*Enqueue_Multiple)(void *pHandle, ExynosVideoBatchEntry *pEntries, int nEntries, int *pnCount);
+    ExynosVideoErrorType  (*Dequeue_Multiple)(void *pHandle, ExynosVideoBuffer *pBuffers[], int nMaxBuffers, int *pnCount);
 } ExynosVideoDecBufferOps;
 
 typedef struct _ExynosVideoEncBufferOps {
@@ -404,6 +463,9 @@ typedef struct _ExynosVideoEncBufferOps {
     ExynosVideoErrorType  (*Clear_Queue)(void *pHandle);
     ExynosVideoErrorType  (*ExtensionEnqueue)(void *pHandle, void *pBuffer[], int pFd[], unsigned long allocLen[], unsigned long dataSize[], int nPlanes, void *pPrivate);
     ExynosVideoErrorType  (*ExtensionDequeue)(void *pHandle, ExynosVideoBuffer *pVideoBuffer);
+    /* same as ExynosVideoDecBufferOps */
+    ExynosVideoErrorType  (*Enqueue_Multiple)(void *pHandle, ExynosVideoBatchEntry *pEntries, int nEntries, int *pnCount);
+    ExynosVideoErrorType  (*Dequeue_Multiple)(void *pHandle, ExynosVideoBuffer *pBuffers[], int nMaxBuffers, int *pnCount);
 } ExynosVideoEncBufferOps;
 
 ExynosVideoErrorType Exynos_Video_GetInstInfo(
@@ -428,4 +490,11 @@ void Exynos_Video_Unregister_Encoder(
     ExynosVideoEncOps       *pEncOps,
     ExynosVideoEncBufferOps *pInbufOps,
     ExynosVideoEncBufferOps *pOutbufOps);
+
+/* MFC throughput shared by all the decoder/encoder instances of the process */
+ExynosVideoErrorType Exynos_Video_Set_LoadBudget(
+    unsigned int nBudgetMBps);
+
+ExynosVideoErrorType Exynos_Video_Get_Load(
+    ExynosVideoLoadInfo *pLoadInfo);
 #endif /* _EXYNOS_VIDEO_API_H_ */
@@ -0,0 +1,74 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _EXYNOS_VIDEO_BUFFER_INDEX_H_
+#define _EXYNOS_VIDEO_BUFFER_INDEX_H_
+
+#include "ExynosVideoApi.h"
+
+#define VIDEO_BUFFER_INDEX_BUCKETS  64
+
+/*
+ * Slot state of one buffer array (pInbuf/pOutbuf) kept as bitmasks, so the
+ * per-frame lookups don't scan the array:
+ *   - address and fd of planes[0] hashed into buckets of slot bits
+ *   - bQueued and bSlotUsed of every slot
+ *
+ * The buffer array stays the reference. Whoever changes those fields of a
+ * slot calls Exynos_Video_Index_Sync() for it, and Exynos_Video_Index_Rebuild()
+ * after changing the whole array. With more than VIDEO_BUFFER_MAX_NUM buffers
+ * the index is disabled and the lookups return VIDEO_BUFFER_INDEX_SCAN.
+ */
+typedef struct _ExynosVideoBufferIndex {
+    int            nBuffers;
+    unsigned int   validMask;
+    unsigned int   queuedMask;
+    unsigned int   slotUsedMask;
+    void          *addrKey[VIDEO_BUFFER_MAX_NUM];
+    int            fdKey[VIDEO_BUFFER_MAX_NUM];
+    unsigned int   addrBucket[VIDEO_BUFFER_INDEX_BUCKETS];
+    unsigned int   fdBucket[VIDEO_BUFFER_INDEX_BUCKETS];
+} ExynosVideoBufferIndex;
+
+#define VIDEO_BUFFER_INDEX_SCAN     (-2)
+
+void Exynos_Video_Index_Rebuild(
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBuffer      *pBuffers,
+    int                     nBuffers);
+
+void Exynos_Video_Index_Sync(
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBuffer      *pBuffers,
+    int                     nIndex);
+
+/* First slot not queued whose planes[0].addr is pAddr (any slot if NULL), -1 if none */
+int Exynos_Video_Index_Find(
+    ExynosVideoBufferIndex *pIndex,
+    void                   *pAddr);
+
+/* First slot neither queued nor, if bCheckSlotUsed, in use as a reference, -1 if none */
+int Exynos_Video_Index_FindEmpty(
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBoolType     bCheckSlotUsed);
+
+/* Slots whose planes[0].fd is fd, one bit per slot */
+unsigned int Exynos_Video_Index_FdMask(
+    ExynosVideoBufferIndex *pIndex,
+    int                     fd);
+
+#endif /* _EXYNOS_VIDEO_BUFFER_INDEX_H_ */
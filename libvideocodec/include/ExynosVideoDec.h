@@ -18,6 +18,10 @@
 #ifndef _EXYNOS_VIDEO_DEC_H_
 #define _EXYNOS_VIDEO_DEC_H_
 
+#include <pthread.h>
+
+#include "ExynosVideoBufferIndex.h"
+
 /* Configurable */
 /* Normal Node */
 #define VIDEO_MFC_DECODER_NAME               "s5p-mfc-dec"
@@ -53,10 +57,21 @@ typedef struct _ExynosVideoDecContext {
     void                   *pInMutex;
     void                   *pOutMutex;
     ExynosVideoInstInfo     videoInstInfo;
+    ExynosVideoBufferIndex  inbufIndex;
+    ExynosVideoBufferIndex  outbufIndex;
+    int                     nSessionId;
 
     void                   *hIONHandle;
     int                     nPrivateDataShareFD;
     void                   *pPrivateDataShareAddress;
+
+    /* Start_EventLoop */
+    ExynosVideoBoolType     bEventLoop;
+    pthread_t               eventThread;
+    int                     hEventPoll;
+    int                     hEventWake;
+    ExynosVideoDecCallbacks eventCallbacks;
+    void                   *pEventUserData;
 } ExynosVideoDecContext;
 
 ExynosVideoErrorType MFC_Exynos_Video_GetInstInfo_Decoder(
@@ -18,6 +18,8 @@
 #ifndef _EXYNOS_VIDEO_ENC_H_
 #define _EXYNOS_VIDEO_ENC_H_
 
+#include "ExynosVideoBufferIndex.h"
+
 /* Configurable */
 /* Normal Node */
 #define VIDEO_ENCODER_NAME              "s5p-mfc-enc"
@@ -48,6 +50,9 @@ typedef struct _ExynosVideoEncContext {
     void                   *pInMutex;
     void                   *pOutMutex;
     ExynosVideoInstInfo     videoInstInfo;
+    ExynosVideoBufferIndex  inbufIndex;
+    ExynosVideoBufferIndex  outbufIndex;
+    int                     nSessionId;
 } ExynosVideoEncContext;
 
 ExynosVideoErrorType MFC_Exynos_Video_GetInstInfo_Encoder(
@@ -0,0 +1,65 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _EXYNOS_VIDEO_SESSION_H_
+#define _EXYNOS_VIDEO_SESSION_H_
+
+#include "ExynosVideoApi.h"
+
+#define VIDEO_SESSION_DEFAULT_FRAMERATE 30
+/* lowest share of its QoS ratio a session is cut to when over budget, in % */
+#define VIDEO_SESSION_MIN_SCALE         10
+
+/*
+ * Process-wide registry of the open MFC instances, used to share the
+ * throughput budget set with Exynos_Video_Set_LoadBudget(). It is built
+ * into libexynosv4l2: libExynosVideoApi is a static library, linked into
+ * each OMX component, and would give each of them its own registry.
+ *
+ * Every change of a session recomputes all of them: over budget, the QoS
+ * ratio of each session is scaled by budget / demand, and encoders that
+ * don't skip frames are switched to VIDEO_FRAME_SKIP_MODE_LEVEL_LIMIT.
+ * Only the controls whose value changes are written to the device.
+ */
+
+/* Returns the session id, -1 if the registry is full */
+int Exynos_Video_Session_Open(
+    int                   hDevice,
+    ExynosVideoBoolType   bIsDec,
+    ExynosVideoCodingType eCodecType);
+
+void Exynos_Video_Session_Close(int nId);
+
+/* A zero argument keeps the current value */
+void Exynos_Video_Session_Set_Format(
+    int          nId,
+    unsigned int nWidth,
+    unsigned int nHeight,
+    unsigned int nFramerate);
+
+/* Ratio asked by the client, scaled when over budget */
+ExynosVideoErrorType Exynos_Video_Session_Set_QosRatio(
+    int nId,
+    int nRatio);
+
+/* bApplied: the device has been set to eMode already, e.g. by Set_EncParam */
+ExynosVideoErrorType Exynos_Video_Session_Set_FrameSkip(
+    int                      nId,
+    ExynosVideoFrameSkipMode eMode,
+    ExynosVideoBoolType      bApplied);
+
+#endif /* _EXYNOS_VIDEO_SESSION_H_ */
@@ -0,0 +1,670 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        ExynosVideoBufferIndexTest.c
+ * @brief       Register/Enqueue/Dequeue of the decoder and the encoder on
+ *              the fake MFC, checked against the linear slot scans the
+ *              buffer index replaced
+ * @version     1.0
+ *
+ * Before every operation the slot arrays are copied and the operation is
+ * replayed on the copy with the old scans (Ref_*). Afterwards the copy
+ * and the arrays of the context have to be the same, and every lookup of
+ * the index has to return what the scan returns.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "ExynosVideoApi.h"
+#include "ExynosVideoDec.h"
+#include "ExynosVideoEnc.h"
+#include "exynos_v4l2_fake_mfc.h"
+#include "OMX_Core.h"
+
+#define TEST_WIDTH          1280
+#define TEST_HEIGHT         720
+#define TEST_STREAM_SIZE    (1024 * 1024)
+#define TEST_NUM_INBUF      8
+#define TEST_NUM_OUTBUF     12
+/* more picture buffers than slots, as gralloc hands them out with dynamic DPB */
+#define TEST_NUM_CLIENT     (TEST_NUM_OUTBUF + 6)
+#define TEST_POLL_MS        20
+
+/* addresses a few pages apart, so that they share hash buckets */
+#define TEST_ADDR(n)        ((void *)(uintptr_t)(0x40000000 + ((n) << 12)))
+#define TEST_ADDR_UNKNOWN   TEST_ADDR(4095)
+#define TEST_FD_UNKNOWN     4095
+
+static unsigned int gSeed = 1;
+static int          gFailures;
+
+#define TEST_CHECK(cond, ...)                                               \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  FAIL %s:%d: ", __func__, __LINE__);                   \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+            gFailures++;                                                    \
+        }                                                                   \
+    } while (0)
+
+static unsigned int Test_Rand(unsigned int range)
+{
+    gSeed = gSeed * 1103515245 + 12345;
+    return (gSeed >> 16) % range;
+}
+
+/* MFC_*_Find_*buf without the index */
+static int Ref_Find(ExynosVideoBuffer *pBuffers, int nBuffers, void *pAddr)
+{
+    int nIndex;
+
+    for (nIndex = 0; nIndex < nBuffers; nIndex++) {
+        if (pBuffers[nIndex].bQueued == VIDEO_FALSE) {
+            if ((pAddr == NULL) || (pBuffers[nIndex].planes[0].addr == pAddr))
+                return nIndex;
+        }
+    }
+
+    return -1;
+}
+
+/* MFC_*_FindEmpty_*buf without the index */
+static int Ref_FindEmpty(ExynosVideoBuffer *pBuffers, int nBuffers, ExynosVideoBoolType bCheckSlotUsed)
+{
+    int nIndex;
+
+    for (nIndex = 0; nIndex < nBuffers; nIndex++) {
+        if ((pBuffers[nIndex].bQueued == VIDEO_FALSE) &&
+            ((bCheckSlotUsed == VIDEO_FALSE) || (pBuffers[nIndex].bSlotUsed == VIDEO_FALSE)))
+            return nIndex;
+    }
+
+    return -1;
+}
+
+static int Ref_Register(ExynosVideoBuffer *pBuffers, int nBuffers, ExynosVideoPlane *planes, int nPlanes)
+{
+    int nIndex, plane;
+
+    for (nIndex = 0; nIndex < nBuffers; nIndex++) {
+        if (pBuffers[nIndex].bRegistered == VIDEO_FALSE) {
+            for (plane = 0; plane < nPlanes; plane++) {
+                pBuffers[nIndex].planes[plane].addr = planes[plane].addr;
+                pBuffers[nIndex].planes[plane].allocSize = planes[plane].allocSize;
+                pBuffers[nIndex].planes[plane].fd = planes[plane].fd;
+            }
+            pBuffers[nIndex].bRegistered = VIDEO_TRUE;
+            return nIndex;
+        }
+    }
+
+    return -1;
+}
+
+/* MFC_Decoder_BufferIndexFree_Outbuf with the nested fd loop */
+static void Ref_BufferIndexFree(
+    ExynosVideoBuffer      *pBuffers,
+    int                     nBuffers,
+    PrivateDataShareBuffer *pPDSB,
+    int                     index)
+{
+    int i, j;
+
+    if (pBuffers[index].nIndexUseCnt == 0)
+        pBuffers[index].bSlotUsed = VIDEO_FALSE;
+
+    for (i = 0; i < VIDEO_BUFFER_MAX_NUM; i++) {
+        if (pPDSB->dpbFD[i].fd < 0)
+            break;
+
+        for (j = 0; j < nBuffers; j++) {
+            if (pPDSB->dpbFD[i].fd != pBuffers[j].planes[0].fd)
+                continue;
+
+            if (pBuffers[j].bQueued == VIDEO_FALSE) {
+                if (pBuffers[j].nIndexUseCnt > 0)
+                    pBuffers[j].nIndexUseCnt--;
+            } else if (pBuffers[j].nIndexUseCnt > 1) {
+                pBuffers[j].nIndexUseCnt--;
+            }
+
+            if ((pBuffers[j].nIndexUseCnt == 0) && (pBuffers[j].bQueued == VIDEO_FALSE))
+                pBuffers[j].bSlotUsed = VIDEO_FALSE;
+        }
+    }
+}
+
+static void Test_CheckIndex(
+    const char             *pStep,
+    ExynosVideoBufferIndex *pIndex,
+    ExynosVideoBuffer      *pBuffers,
+    int                     nBuffers)
+{
+    unsigned int mask;
+    void *pAddr;
+    int   fd, i, j;
+
+    if (pBuffers == NULL)
+        return;
+
+    TEST_CHECK(pIndex->nBuffers == nBuffers, "%s: index of %d slots, %d buffers", pStep, pIndex->nBuffers, nBuffers);
+
+    for (i = -2; i < nBuffers; i++) {
+        pAddr = (i == -2) ? NULL : (i == -1) ? TEST_ADDR_UNKNOWN : pBuffers[i].planes[0].addr;
+        TEST_CHECK(Exynos_Video_Index_Find(pIndex, pAddr) == Ref_Find(pBuffers, nBuffers, pAddr),
+                   "%s: Find(%p) %d, scan %d", pStep, pAddr,
+                   Exynos_Video_Index_Find(pIndex, pAddr), Ref_Find(pBuffers, nBuffers, pAddr));
+
+        fd = (i < 0) ? TEST_FD_UNKNOWN : pBuffers[i].planes[0].fd;
+        mask = 0;
+        for (j = 0; j < nBuffers; j++) {
+            if (pBuffers[j].planes[0].fd == fd)
+                mask |= 1u << j;
+        }
+        TEST_CHECK(Exynos_Video_Index_FdMask(pIndex, fd) == mask,
+                   "%s: FdMask(%d) 0x%x, scan 0x%x", pStep, fd, Exynos_Video_Index_FdMask(pIndex, fd), mask);
+    }
+
+    TEST_CHECK(Exynos_Video_Index_FindEmpty(pIndex, VIDEO_FALSE) == Ref_FindEmpty(pBuffers, nBuffers, VIDEO_FALSE),
+               "%s: FindEmpty %d, scan %d", pStep,
+               Exynos_Video_Index_FindEmpty(pIndex, VIDEO_FALSE), Ref_FindEmpty(pBuffers, nBuffers, VIDEO_FALSE));
+    TEST_CHECK(Exynos_Video_Index_FindEmpty(pIndex, VIDEO_TRUE) == Ref_FindEmpty(pBuffers, nBuffers, VIDEO_TRUE),
+               "%s: FindEmpty(slot used) %d, scan %d", pStep,
+               Exynos_Video_Index_FindEmpty(pIndex, VIDEO_TRUE), Ref_FindEmpty(pBuffers, nBuffers, VIDEO_TRUE));
+}
+
+static void Test_CompareSlots(
+    const char        *pStep,
+    ExynosVideoBuffer *pExpected,
+    ExynosVideoBuffer *pBuffers,
+    int                nBuffers)
+{
+    int i;
+
+    for (i = 0; i < nBuffers; i++) {
+        TEST_CHECK((pExpected[i].bQueued == pBuffers[i].bQueued) &&
+                   (pExpected[i].bSlotUsed == pBuffers[i].bSlotUsed) &&
+                   (pExpected[i].bRegistered == pBuffers[i].bRegistered) &&
+                   (pExpected[i].nIndexUseCnt == pBuffers[i].nIndexUseCnt) &&
+                   (pExpected[i].planes[0].addr == pBuffers[i].planes[0].addr) &&
+                   (pExpected[i].planes[0].fd == pBuffers[i].planes[0].fd),
+                   "%s: slot %d queued %d/%d used %d/%d cnt %d/%d fd %d/%d", pStep, i,
+                   pBuffers[i].bQueued, pExpected[i].bQueued,
+                   pBuffers[i].bSlotUsed, pExpected[i].bSlotUsed,
+                   pBuffers[i].nIndexUseCnt, pExpected[i].nIndexUseCnt,
+                   pBuffers[i].planes[0].fd, pExpected[i].planes[0].fd);
+    }
+}
+
+static int Test_Readable(int fd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    return (poll(&pfd, 1, TEST_POLL_MS) > 0) && (pfd.revents & POLLIN);
+}
+
+/* registers one buffer more than there are slots, the last one has to fail */
+static void Test_Register(
+    const char              *pStep,
+    ExynosVideoErrorType   (*Register)(void *, ExynosVideoPlane *, int),
+    void                    *hCodec,
+    ExynosVideoBufferIndex  *pIndex,
+    ExynosVideoBuffer       *pBuffers,
+    int                      nBuffers,
+    int                      nPlanes)
+{
+    ExynosVideoBuffer    expected[VIDEO_BUFFER_MAX_NUM];
+    ExynosVideoPlane     planes[VIDEO_BUFFER_MAX_PLANES];
+    ExynosVideoErrorType ret;
+    int i, plane, nIndex;
+
+    for (i = 0; i <= nBuffers; i++) {
+        for (plane = 0; plane < nPlanes; plane++) {
+            memset(&planes[plane], 0, sizeof(planes[plane]));
+            /* every other buffer shares its page with the previous one's second plane */
+            planes[plane].addr = TEST_ADDR((i * 2) + plane);
+            planes[plane].fd = 100 + (i * VIDEO_BUFFER_MAX_PLANES) + plane;
+            planes[plane].allocSize = TEST_STREAM_SIZE;
+        }
+
+        memcpy(expected, pBuffers, sizeof(*pBuffers) * nBuffers);
+        nIndex = Ref_Register(expected, nBuffers, planes, nPlanes);
+
+        ret = Register(hCodec, planes, nPlanes);
+        TEST_CHECK(ret == ((nIndex < 0) ? VIDEO_ERROR_NOBUFFERS : VIDEO_ERROR_NONE),
+                   "%s: Register %d returned %d, expected slot %d", pStep, i, ret, nIndex);
+        Test_CompareSlots(pStep, expected, pBuffers, nBuffers);
+        Test_CheckIndex(pStep, pIndex, pBuffers, nBuffers);
+    }
+}
+
+/* Enqueue by address: the slot of that address, NOBUFFERS if it is queued or unknown */
+static void Test_Enqueue(
+    const char              *pStep,
+    ExynosVideoErrorType   (*Enqueue)(void *, void *[], unsigned long [], int, void *),
+    void                    *hCodec,
+    ExynosVideoBufferIndex  *pIndex,
+    ExynosVideoBuffer       *pBuffers,
+    int                      nBuffers,
+    void                    *pAddr[],
+    int                      nPlanes,
+    void                    *pPrivate)
+{
+    ExynosVideoBuffer    expected[VIDEO_BUFFER_MAX_NUM];
+    ExynosVideoErrorType ret;
+    unsigned long        dataSize[VIDEO_BUFFER_MAX_PLANES] = { 0, };
+    int                  nIndex;
+
+    dataSize[0] = 100;
+
+    memcpy(expected, pBuffers, sizeof(*pBuffers) * nBuffers);
+    nIndex = Ref_Find(expected, nBuffers, pAddr[0]);
+    if (nIndex >= 0)
+        expected[nIndex].bQueued = VIDEO_TRUE;
+
+    ret = Enqueue(hCodec, pAddr, dataSize, nPlanes, pPrivate);
+    TEST_CHECK(ret == ((nIndex < 0) ? VIDEO_ERROR_NOBUFFERS : VIDEO_ERROR_NONE),
+               "%s: Enqueue(%p) returned %d, expected slot %d", pStep, pAddr[0], ret, nIndex);
+    Test_CompareSlots(pStep, expected, pBuffers, nBuffers);
+    Test_CheckIndex(pStep, pIndex, pBuffers, nBuffers);
+}
+
+static void Test_Dequeue(
+    const char              *pStep,
+    ExynosVideoBuffer     *(*Dequeue)(void *),
+    void                    *hCodec,
+    ExynosVideoBufferIndex  *pIndex,
+    ExynosVideoBuffer       *pBuffers,
+    int                      nBuffers,
+    ExynosVideoBuffer      **ppBuffer)
+{
+    ExynosVideoBuffer  expected[VIDEO_BUFFER_MAX_NUM];
+    ExynosVideoBuffer *pBuffer;
+    int                nIndex;
+
+    memcpy(expected, pBuffers, sizeof(*pBuffers) * nBuffers);
+
+    pBuffer = Dequeue(hCodec);
+    if (pBuffer != NULL) {
+        nIndex = pBuffer - pBuffers;
+        TEST_CHECK((nIndex >= 0) && (nIndex < nBuffers) && (expected[nIndex].bQueued == VIDEO_TRUE),
+                   "%s: dequeued slot %d was not queued", pStep, nIndex);
+        if ((nIndex >= 0) && (nIndex < nBuffers))
+            expected[nIndex].bQueued = VIDEO_FALSE;
+    }
+
+    Test_CompareSlots(pStep, expected, pBuffers, nBuffers);
+    Test_CheckIndex(pStep, pIndex, pBuffers, nBuffers);
+
+    if (ppBuffer != NULL)
+        *ppBuffer = pBuffer;
+}
+
+static int Test_Decoder(int nSteps)
+{
+    struct exynos_v4l2_fake_mfc_config config;
+    ExynosVideoDecOps        ops;
+    ExynosVideoDecBufferOps  inOps, outOps;
+    ExynosVideoDecContext   *pCtx;
+    ExynosVideoInstInfo      instInfo;
+    ExynosVideoGeometry      geometry;
+    ExynosVideoBuffer        expected[VIDEO_BUFFER_MAX_NUM];
+    ExynosVideoBuffer        videoBuffer;
+    ExynosVideoErrorType     ret;
+    OMX_BUFFERHEADERTYPE     header;
+    void                    *hDec;
+    void                    *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    int                      pFd[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long            allocLen[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long            dataSize[VIDEO_BUFFER_MAX_PLANES];
+    int  bHeld[TEST_NUM_CLIENT];
+    int  nFrames = 0, nNoSlot = 0;
+    int  step, i, k, nIndex;
+
+    memset(&config, 0, sizeof(config));
+    config.width = TEST_WIDTH;
+    config.height = TEST_HEIGHT;
+    config.min_dpb = 4;
+    config.ref_frames = 3;
+
+    if (exynos_v4l2_fake_mfc_install(&config) != 0) {
+        printf("exynos_v4l2_fake_mfc_install failed\n");
+        return -1;
+    }
+
+    memset(&ops, 0, sizeof(ops));
+    memset(&inOps, 0, sizeof(inOps));
+    memset(&outOps, 0, sizeof(outOps));
+    ops.nSize = sizeof(ops);
+    inOps.nSize = sizeof(inOps);
+    outOps.nSize = sizeof(outOps);
+    if (Exynos_Video_Register_Decoder(&ops, &inOps, &outOps) != VIDEO_ERROR_NONE) {
+        printf("Exynos_Video_Register_Decoder failed\n");
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+
+    memset(&instInfo, 0, sizeof(instInfo));
+    instInfo.eCodecType = VIDEO_CODING_AVC;
+    instInfo.nMemoryType = V4L2_MEMORY_DMABUF;
+
+    hDec = ops.Init(&instInfo);
+    if (hDec == NULL) {
+        printf("decoder Init failed\n");
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+    pCtx = (ExynosVideoDecContext *)hDec;
+
+    inOps.Set_Shareable(hDec);
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.eCompressionFormat = VIDEO_CODING_AVC;
+    geometry.nSizeImage = TEST_STREAM_SIZE;
+    geometry.nPlaneCnt = 1;
+    inOps.Set_Geometry(hDec, &geometry);
+    inOps.Setup(hDec, TEST_NUM_INBUF);
+    Test_CheckIndex("dec in setup", &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
+    Test_Register("dec in register", inOps.Register, hDec, &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs, 1);
+    inOps.Run(hDec);
+
+    /* the header, then the capture port */
+    memset(&header, 0, sizeof(header));
+    pAddr[0] = pCtx->pInbuf[0].planes[0].addr;
+    Test_Enqueue("dec header", inOps.Enqueue, hDec, &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs, pAddr, 1, &header);
+    for (i = 0; (i < 50) && (pCtx->pInbuf[0].bQueued == VIDEO_TRUE); i++) {
+        usleep(1000);
+        Test_Dequeue("dec header", inOps.Dequeue, hDec, &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs, NULL);
+    }
+
+    outOps.Get_Geometry(hDec, &geometry);
+    geometry.nPlaneCnt = 2;
+    outOps.Set_Geometry(hDec, &geometry);
+    ops.Enable_DynamicDPB(hDec);
+    outOps.Set_Shareable(hDec);
+    if (outOps.Setup(hDec, TEST_NUM_OUTBUF) != VIDEO_ERROR_NONE) {
+        printf("decoder output Setup failed\n");
+        gFailures++;
+        goto EXIT;
+    }
+    Test_CheckIndex("dec out setup", &pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+    outOps.Run(hDec);
+
+    memset(bHeld, 0, sizeof(bHeld));
+
+    for (step = 0; step < nSteps; step++) {
+        switch (Test_Rand(5)) {
+        case 0:
+            /* a stream buffer, now and then one the decoder never saw */
+            k = Test_Rand(TEST_NUM_INBUF + 1);
+            pAddr[0] = (k < TEST_NUM_INBUF) ? pCtx->pInbuf[k].planes[0].addr : TEST_ADDR_UNKNOWN;
+            Test_Enqueue("dec in enqueue", inOps.Enqueue, hDec, &pCtx->inbufIndex,
+                         pCtx->pInbuf, pCtx->nInbufs, pAddr, 1, &header);
+            break;
+        case 1:
+            Test_Dequeue("dec in dequeue", inOps.Dequeue, hDec, &pCtx->inbufIndex,
+                         pCtx->pInbuf, pCtx->nInbufs, NULL);
+            break;
+        case 2:
+        case 3:
+            /* a picture buffer the client holds, found by address or given an empty slot */
+            k = Test_Rand(TEST_NUM_CLIENT);
+            if (bHeld[k] != 0)
+                break;
+
+            for (i = 0; i < 2; i++) {
+                pAddr[i] = TEST_ADDR(512 + (k * 2) + i);
+                pFd[i] = 1000 + (k * 2) + i;
+                allocLen[i] = TEST_WIDTH * TEST_HEIGHT;
+                dataSize[i] = 0;
+            }
+
+            memcpy(expected, pCtx->pOutbuf, sizeof(*pCtx->pOutbuf) * pCtx->nOutbufs);
+            nIndex = Ref_Find(expected, pCtx->nOutbufs, pAddr[0]);
+            if (nIndex < 0)
+                nIndex = Ref_FindEmpty(expected, pCtx->nOutbufs, VIDEO_TRUE);
+            if (nIndex >= 0) {
+                for (i = 0; i < 2; i++) {
+                    expected[nIndex].planes[i].addr = pAddr[i];
+                    expected[nIndex].planes[i].fd = pFd[i];
+                }
+                expected[nIndex].bQueued = VIDEO_TRUE;
+                expected[nIndex].bSlotUsed = VIDEO_TRUE;
+                expected[nIndex].nIndexUseCnt++;
+            } else {
+                nNoSlot++;
+            }
+
+            ret = outOps.ExtensionEnqueue(hDec, pAddr, pFd, allocLen, dataSize, 2, NULL);
+            TEST_CHECK(ret == ((nIndex < 0) ? VIDEO_ERROR_NOBUFFERS : VIDEO_ERROR_NONE),
+                       "ExtensionEnqueue(%d) returned %d, expected slot %d", k, ret, nIndex);
+            if (ret == VIDEO_ERROR_NONE)
+                bHeld[k] = 1;
+            Test_CompareSlots("dec out enqueue", expected, pCtx->pOutbuf, pCtx->nOutbufs);
+            Test_CheckIndex("dec out enqueue", &pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+            break;
+        default:
+            if (!Test_Readable(pCtx->hDec))
+                break;
+
+            memcpy(expected, pCtx->pOutbuf, sizeof(*pCtx->pOutbuf) * pCtx->nOutbufs);
+            ret = outOps.ExtensionDequeue(hDec, &videoBuffer);
+            if (ret != VIDEO_ERROR_NONE)
+                break;
+
+            /* the one slot that left the queue */
+            nIndex = -1;
+            for (i = 0; i < pCtx->nOutbufs; i++) {
+                if ((expected[i].bQueued == VIDEO_TRUE) && (pCtx->pOutbuf[i].bQueued == VIDEO_FALSE))
+                    nIndex = (nIndex == -1) ? i : -2;
+            }
+            TEST_CHECK(nIndex >= 0, "ExtensionDequeue left %d", nIndex);
+            if (nIndex < 0)
+                break;
+
+            /* PDSB is the copy taken before BufferIndexFree cleared it */
+            Ref_BufferIndexFree(expected, pCtx->nOutbufs, &videoBuffer.PDSB, nIndex);
+            expected[nIndex].bQueued = VIDEO_FALSE;
+            Test_CompareSlots("dec out dequeue", expected, pCtx->pOutbuf, pCtx->nOutbufs);
+            Test_CheckIndex("dec out dequeue", &pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+
+            k = (videoBuffer.planes[0].fd - 1000) / 2;
+            if ((k >= 0) && (k < TEST_NUM_CLIENT))
+                bHeld[k] = 0;
+            nFrames++;
+            break;
+        }
+    }
+
+    printf("  decoder: %d steps, %d pictures, %d enqueues without a free slot\n", nSteps, nFrames, nNoSlot);
+
+    inOps.Stop(hDec);
+    outOps.Stop(hDec);
+    Test_CheckIndex("dec in stop", &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
+    Test_CheckIndex("dec out stop", &pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+
+    inOps.Clear_RegisteredBuffer(hDec);
+    Test_CheckIndex("dec in clear", &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
+    Test_Register("dec in register again", inOps.Register, hDec, &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs, 1);
+
+EXIT:
+    ops.Finalize(hDec);
+    exynos_v4l2_fake_mfc_uninstall();
+
+    return 0;
+}
+
+static int Test_Encoder(int nSteps)
+{
+    struct exynos_v4l2_fake_mfc_config config;
+    ExynosVideoEncOps        ops;
+    ExynosVideoEncBufferOps  inOps, outOps;
+    ExynosVideoEncContext   *pCtx;
+    ExynosVideoInstInfo      instInfo;
+    ExynosVideoGeometry      geometry;
+    ExynosVideoBuffer       *pBuffer;
+    OMX_BUFFERHEADERTYPE     header;
+    void                    *hEnc;
+    void                    *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    int  nStreams = 0;
+    int  step, i, k;
+
+    memset(&config, 0, sizeof(config));
+    config.width = TEST_WIDTH;
+    config.height = TEST_HEIGHT;
+
+    if (exynos_v4l2_fake_mfc_install(&config) != 0) {
+        printf("exynos_v4l2_fake_mfc_install failed\n");
+        return -1;
+    }
+
+    memset(&ops, 0, sizeof(ops));
+    memset(&inOps, 0, sizeof(inOps));
+    memset(&outOps, 0, sizeof(outOps));
+    ops.nSize = sizeof(ops);
+    inOps.nSize = sizeof(inOps);
+    outOps.nSize = sizeof(outOps);
+    if (Exynos_Video_Register_Encoder(&ops, &inOps, &outOps) != VIDEO_ERROR_NONE) {
+        printf("Exynos_Video_Register_Encoder failed\n");
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+
+    memset(&instInfo, 0, sizeof(instInfo));
+    instInfo.eCodecType = VIDEO_CODING_AVC;
+    instInfo.nWidth = TEST_WIDTH;
+    instInfo.nHeight = TEST_HEIGHT;
+    instInfo.nMemoryType = V4L2_MEMORY_DMABUF;
+
+    hEnc = ops.Init(&instInfo);
+    if (hEnc == NULL) {
+        printf("encoder Init failed\n");
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+    pCtx = (ExynosVideoEncContext *)hEnc;
+
+    inOps.Set_Shareable(hEnc);
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.nFrameWidth = TEST_WIDTH;
+    geometry.nFrameHeight = TEST_HEIGHT;
+    geometry.eColorFormat = VIDEO_COLORFORMAT_NV12;
+    geometry.nPlaneCnt = 2;
+    inOps.Set_Geometry(hEnc, &geometry);
+
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.eCompressionFormat = VIDEO_CODING_AVC;
+    geometry.nSizeImage = TEST_STREAM_SIZE;
+    geometry.nPlaneCnt = 1;
+    outOps.Set_Geometry(hEnc, &geometry);
+
+    if ((inOps.Setup(hEnc, TEST_NUM_INBUF) != VIDEO_ERROR_NONE) ||
+        (outOps.Setup(hEnc, TEST_NUM_OUTBUF) != VIDEO_ERROR_NONE)) {
+        printf("encoder Setup failed\n");
+        gFailures++;
+        goto EXIT;
+    }
+    Test_CheckIndex("enc out setup", &pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+    Test_Register("enc in register", inOps.Register, hEnc, &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs, 2);
+
+    inOps.Run(hEnc);
+    outOps.Run(hEnc);
+
+    memset(&header, 0, sizeof(header));
+    for (i = 0; i < TEST_NUM_OUTBUF; i++) {
+        pAddr[0] = pCtx->pOutbuf[i].planes[0].addr;
+        Test_Enqueue("enc out enqueue", outOps.Enqueue, hEnc, &pCtx->outbufIndex,
+                     pCtx->pOutbuf, pCtx->nOutbufs, pAddr, 1, NULL);
+    }
+
+    for (step = 0; step < nSteps; step++) {
+        switch (Test_Rand(3)) {
+        case 0:
+            k = Test_Rand(TEST_NUM_INBUF + 1);
+            pAddr[0] = (k < TEST_NUM_INBUF) ? pCtx->pInbuf[k].planes[0].addr : TEST_ADDR_UNKNOWN;
+            pAddr[1] = (k < TEST_NUM_INBUF) ? pCtx->pInbuf[k].planes[1].addr : TEST_ADDR_UNKNOWN;
+            Test_Enqueue("enc in enqueue", inOps.Enqueue, hEnc, &pCtx->inbufIndex,
+                         pCtx->pInbuf, pCtx->nInbufs, pAddr, 2, &header);
+            break;
+        case 1:
+            Test_Dequeue("enc in dequeue", inOps.Dequeue, hEnc, &pCtx->inbufIndex,
+                         pCtx->pInbuf, pCtx->nInbufs, NULL);
+            break;
+        default:
+            if (!Test_Readable(pCtx->hEnc))
+                break;
+
+            Test_Dequeue("enc out dequeue", outOps.Dequeue, hEnc, &pCtx->outbufIndex,
+                         pCtx->pOutbuf, pCtx->nOutbufs, &pBuffer);
+            if (pBuffer == NULL)
+                break;
+
+            nStreams++;
+            pAddr[0] = pBuffer->planes[0].addr;
+            Test_Enqueue("enc out requeue", outOps.Enqueue, hEnc, &pCtx->outbufIndex,
+                         pCtx->pOutbuf, pCtx->nOutbufs, pAddr, 1, NULL);
+            break;
+        }
+    }
+
+    printf("  encoder: %d steps, %d streams\n", nSteps, nStreams);
+
+    inOps.Stop(hEnc);
+    outOps.Stop(hEnc);
+    Test_CheckIndex("enc in stop", &pCtx->inbufIndex, pCtx->pInbuf, pCtx->nInbufs);
+    Test_CheckIndex("enc out stop", &pCtx->outbufIndex, pCtx->pOutbuf, pCtx->nOutbufs);
+
+EXIT:
+    ops.Finalize(hEnc);
+    exynos_v4l2_fake_mfc_uninstall();
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int nSteps = 5000;
+
+    if (argc > 1)
+        nSteps = atoi(argv[1]);
+    if (argc > 2)
+        gSeed = (unsigned int)strtoul(argv[2], NULL, 0);
+
+    if (nSteps <= 0) {
+        printf("usage: %s [steps] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    printf("buffer index against the linear scans, %d steps, seed %u\n", nSteps, gSeed);
+
+    if ((Test_Decoder(nSteps) != 0) || (Test_Encoder(nSteps) != 0))
+        return 1;
+
+    printf("%s, %d failures\n", (gFailures == 0) ? "PASS" : "FAIL", gFailures);
+
+    return (gFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        ExynosVideoDynamicDpbTest.c
+ * @brief       dynamic DPB bookkeeping of the decoder on the fake MFC
+ * @version     1.0
+ *
+ * A client with more picture buffers than capture slots enqueues them
+ * with ExtensionEnqueue, holds the dequeued ones for a while and gives
+ * them back, in random order. The fake MFC keeps the last ref_frames
+ * pictures referenced, so the test knows which fds are referenced after
+ * every dequeue. Then:
+ *   - the released fds of the PDSB are the ones that left the references
+ *   - no picture is written while it is referenced
+ *   - nIndexUseCnt of every slot is queued + referenced, and bSlotUsed
+ *     is set while it is not 0
+ *   - ExtensionEnqueue fails only when every slot is queued or referenced
+ *
+ * usage: exynos_video_dynamic_dpb_test [steps]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "ExynosVideoApi.h"
+#include "ExynosVideoDec.h"
+#include "exynos_v4l2_fake_mfc.h"
+#include "OMX_Core.h"
+
+#define TEST_WIDTH          1280
+#define TEST_HEIGHT         720
+#define TEST_STREAM_SIZE    (1024 * 1024)
+#define TEST_NUM_INBUF      8
+#define TEST_NUM_OUTBUF     12
+/* more picture buffers than slots, as gralloc hands them out with dynamic DPB */
+#define TEST_NUM_CLIENT     (TEST_NUM_OUTBUF + 6)
+#define TEST_DEFAULT_STEPS  20000
+#define TEST_POLL_MS        20
+
+#define TEST_ADDR(n)        ((void *)(uintptr_t)(0x40000000 + ((n) << 12)))
+#define TEST_FD(k)          (1000 + ((k) * 2))
+
+enum {
+    CLIENT_FREE,
+    CLIENT_QUEUED,
+    CLIENT_HELD,
+};
+
+static unsigned int gSeed = 1;
+static int          gFailures;
+
+#define TEST_CHECK(cond, ...)                                               \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  FAIL %s:%d: ", __func__, __LINE__);                   \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+            gFailures++;                                                    \
+        }                                                                   \
+    } while (0)
+
+static unsigned int Test_Rand(unsigned int range)
+{
+    gSeed = gSeed * 1103515245 + 12345;
+    return (gSeed >> 16) % range;
+}
+
+static int Test_Readable(int fd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    return (poll(&pfd, 1, TEST_POLL_MS) > 0) && (pfd.revents & POLLIN);
+}
+
+static int Test_Client(int fd)
+{
+    int k = (fd - TEST_FD(0)) / 2;
+
+    if ((fd < TEST_FD(0)) || (k >= TEST_NUM_CLIENT) || (TEST_FD(k) != fd))
+        return -1;
+
+    return k;
+}
+
+/* what the fake MFC references, oldest first */
+struct Test_Refs {
+    int fd[VIDEO_BUFFER_MAX_NUM];
+    int nRefs;
+};
+
+static int Test_IsRef(struct Test_Refs *pRefs, int fd)
+{
+    int i;
+
+    for (i = 0; i < pRefs->nRefs; i++) {
+        if (pRefs->fd[i] == fd)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* every slot against the client states and the references */
+static void Test_CheckSlots(
+    const char            *pStep,
+    ExynosVideoDecContext *pCtx,
+    int                   *pState,
+    struct Test_Refs      *pRefs)
+{
+    ExynosVideoBuffer *pBuffer;
+    int nSlots[TEST_NUM_CLIENT];
+    int i, k, nExpected;
+
+    memset(nSlots, 0, sizeof(nSlots));
+
+    for (i = 0; i < pCtx->nOutbufs; i++) {
+        pBuffer = &pCtx->pOutbuf[i];
+        k = Test_Client(pBuffer->planes[0].fd);
+        if (k < 0) {
+            TEST_CHECK((pBuffer->bQueued == VIDEO_FALSE) && (pBuffer->nIndexUseCnt == 0),
+                       "%s: slot %d never given a buffer, queued %d cnt %d",
+                       pStep, i, pBuffer->bQueued, pBuffer->nIndexUseCnt);
+            continue;
+        }
+        nSlots[k]++;
+
+        nExpected = (pState[k] == CLIENT_QUEUED) + Test_IsRef(pRefs, TEST_FD(k));
+        TEST_CHECK(pBuffer->bQueued == ((pState[k] == CLIENT_QUEUED) ? VIDEO_TRUE : VIDEO_FALSE),
+                   "%s: slot %d of buffer %d queued %d, client state %d",
+                   pStep, i, k, pBuffer->bQueued, pState[k]);
+        TEST_CHECK(pBuffer->nIndexUseCnt == nExpected,
+                   "%s: slot %d of buffer %d cnt %d, expected %d",
+                   pStep, i, k, pBuffer->nIndexUseCnt, nExpected);
+        TEST_CHECK(pBuffer->bSlotUsed == ((nExpected > 0) ? VIDEO_TRUE : VIDEO_FALSE),
+                   "%s: slot %d of buffer %d used %d, cnt %d",
+                   pStep, i, k, pBuffer->bSlotUsed, nExpected);
+    }
+
+    for (k = 0; k < TEST_NUM_CLIENT; k++) {
+        TEST_CHECK(nSlots[k] <= 1, "%s: buffer %d in %d slots", pStep, k, nSlots[k]);
+        TEST_CHECK((pState[k] != CLIENT_QUEUED) || (nSlots[k] == 1),
+                   "%s: queued buffer %d in no slot", pStep, k);
+    }
+}
+
+/* a slot ExtensionEnqueue may give buffer k: its own, else one neither queued nor referenced */
+static int Test_HasSlot(ExynosVideoDecContext *pCtx, struct Test_Refs *pRefs, int k)
+{
+    ExynosVideoBuffer *pBuffer;
+    int i;
+
+    for (i = 0; i < pCtx->nOutbufs; i++) {
+        pBuffer = &pCtx->pOutbuf[i];
+        if (pBuffer->bQueued == VIDEO_TRUE)
+            continue;
+        if ((pBuffer->planes[0].fd == TEST_FD(k)) ||
+            (Test_Client(pBuffer->planes[0].fd) < 0) ||
+            !Test_IsRef(pRefs, pBuffer->planes[0].fd))
+            return 1;
+    }
+
+    return 0;
+}
+
+static void Test_Dequeue(
+    ExynosVideoDecBufferOps *pOutOps,
+    ExynosVideoDecContext   *pCtx,
+    int                     *pState,
+    struct Test_Refs        *pRefs,
+    unsigned int             nRefFrames,
+    int                     *pFrames)
+{
+    ExynosVideoBuffer    videoBuffer;
+    ExynosVideoErrorType ret;
+    int released[VIDEO_BUFFER_MAX_NUM];
+    int nReleased = 0;
+    int i, j, k;
+
+    /* wait only while the fake MFC has a stream buffer and a picture buffer it may write */
+    for (i = 0; (i < pCtx->nInbufs) && (pCtx->pInbuf[i].bQueued == VIDEO_FALSE); i++);
+    for (k = 0; k < TEST_NUM_CLIENT; k++) {
+        if ((pState[k] == CLIENT_QUEUED) && !Test_IsRef(pRefs, TEST_FD(k)))
+            break;
+    }
+    if ((i == pCtx->nInbufs) || (k == TEST_NUM_CLIENT) || !Test_Readable(pCtx->hDec))
+        return;
+
+    memset(&videoBuffer, 0, sizeof(videoBuffer));
+    ret = pOutOps->ExtensionDequeue(pCtx, &videoBuffer);
+    if (ret != VIDEO_ERROR_NONE)
+        return;
+
+    k = Test_Client(videoBuffer.planes[0].fd);
+    TEST_CHECK((k >= 0) && (pState[k] == CLIENT_QUEUED),
+               "dequeued fd %d, not a queued client buffer", videoBuffer.planes[0].fd);
+    if (k < 0)
+        return;
+    TEST_CHECK(!Test_IsRef(pRefs, TEST_FD(k)), "picture written into referenced buffer %d", k);
+
+    /* the fake MFC references the new picture and lets go of the oldest */
+    pRefs->fd[pRefs->nRefs++] = TEST_FD(k);
+    while (pRefs->nRefs > (int)nRefFrames) {
+        released[nReleased++] = pRefs->fd[0];
+        memmove(&pRefs->fd[0], &pRefs->fd[1], sizeof(pRefs->fd[0]) * (pRefs->nRefs - 1));
+        pRefs->nRefs--;
+    }
+
+    for (i = 0; (i < VIDEO_BUFFER_MAX_NUM) && (videoBuffer.PDSB.dpbFD[i].fd >= 0); i++) {
+        for (j = 0; (j < nReleased) && (released[j] != videoBuffer.PDSB.dpbFD[i].fd); j++);
+        TEST_CHECK(j < nReleased, "fd %d released, it was not dropped from the references",
+                   videoBuffer.PDSB.dpbFD[i].fd);
+    }
+    TEST_CHECK(i == nReleased, "%d fds released, %d dropped from the references", i, nReleased);
+
+    pState[k] = CLIENT_HELD;
+    (*pFrames)++;
+
+    Test_CheckSlots("dequeue", pCtx, pState, pRefs);
+}
+
+static int Test_Run(unsigned int nRefFrames, int nSteps)
+{
+    struct exynos_v4l2_fake_mfc_config config;
+    struct Test_Refs         refs;
+    ExynosVideoDecOps        ops;
+    ExynosVideoDecBufferOps  inOps, outOps;
+    ExynosVideoDecContext   *pCtx;
+    ExynosVideoInstInfo      instInfo;
+    ExynosVideoGeometry      geometry;
+    ExynosVideoErrorType     ret;
+    OMX_BUFFERHEADERTYPE     header;
+    void                    *hDec;
+    void                    *pAddr[VIDEO_BUFFER_MAX_PLANES];
+    int                      pFd[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long            allocLen[VIDEO_BUFFER_MAX_PLANES];
+    unsigned long            dataSize[VIDEO_BUFFER_MAX_PLANES];
+    ExynosVideoPlane         plane;
+    int  state[TEST_NUM_CLIENT];
+    int  nFrames = 0, nNoSlot = 0;
+    int  expectSlot;
+    int  step, i, k;
+
+    memset(&config, 0, sizeof(config));
+    config.width = TEST_WIDTH;
+    config.height = TEST_HEIGHT;
+    config.min_dpb = 4;
+    config.ref_frames = nRefFrames;
+
+    if (exynos_v4l2_fake_mfc_install(&config) != 0) {
+        printf("exynos_v4l2_fake_mfc_install failed\n");
+        return -1;
+    }
+
+    memset(&ops, 0, sizeof(ops));
+    memset(&inOps, 0, sizeof(inOps));
+    memset(&outOps, 0, sizeof(outOps));
+    ops.nSize = sizeof(ops);
+    inOps.nSize = sizeof(inOps);
+    outOps.nSize = sizeof(outOps);
+    if (Exynos_Video_Register_Decoder(&ops, &inOps, &outOps) != VIDEO_ERROR_NONE) {
+        printf("Exynos_Video_Register_Decoder failed\n");
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+
+    memset(&instInfo, 0, sizeof(instInfo));
+    instInfo.eCodecType = VIDEO_CODING_AVC;
+    instInfo.nMemoryType = V4L2_MEMORY_DMABUF;
+
+    hDec = ops.Init(&instInfo);
+    if (hDec == NULL) {
+        printf("decoder Init failed\n");
+        exynos_v4l2_fake_mfc_uninstall();
+        return -1;
+    }
+    pCtx = (ExynosVideoDecContext *)hDec;
+
+    inOps.Set_Shareable(hDec);
+    memset(&geometry, 0, sizeof(geometry));
+    geometry.eCompressionFormat = VIDEO_CODING_AVC;
+    geometry.nSizeImage = TEST_STREAM_SIZE;
+    geometry.nPlaneCnt = 1;
+    inOps.Set_Geometry(hDec, &geometry);
+    inOps.Setup(hDec, TEST_NUM_INBUF);
+    for (i = 0; i < TEST_NUM_INBUF; i++) {
+        memset(&plane, 0, sizeof(plane));
+        plane.addr = TEST_ADDR(i);
+        plane.fd = 100 + i;
+        plane.allocSize = TEST_STREAM_SIZE;
+        inOps.Register(hDec, &plane, 1);
+    }
+    inOps.Run(hDec);
+
+    /* the header, then the capture port */
+    memset(&header, 0, sizeof(header));
+    pAddr[0] = TEST_ADDR(0);
+    dataSize[0] = 100;
+    inOps.Enqueue(hDec, pAddr, dataSize, 1, &header);
+    for (i = 0; (i < 50) && (pCtx->pInbuf[0].bQueued == VIDEO_TRUE); i++) {
+        usleep(1000);
+        inOps.Dequeue(hDec);
+    }
+
+    outOps.Get_Geometry(hDec, &geometry);
+    geometry.nPlaneCnt = 2;
+    outOps.Set_Geometry(hDec, &geometry);
+    ops.Enable_DynamicDPB(hDec);
+    outOps.Set_Shareable(hDec);
+    if (outOps.Setup(hDec, TEST_NUM_OUTBUF) != VIDEO_ERROR_NONE) {
+        printf("decoder output Setup failed\n");
+        gFailures++;
+        goto EXIT;
+    }
+    outOps.Run(hDec);
+
+    memset(&refs, 0, sizeof(refs));
+    for (k = 0; k < TEST_NUM_CLIENT; k++)
+        state[k] = CLIENT_FREE;
+
+    for (step = 0; step < nSteps; step++) {
+        switch (Test_Rand(8)) {
+        case 0:
+            /* keep the stream flowing */
+            while (inOps.Dequeue(hDec) != NULL);
+            for (i = 0; i < pCtx->nInbufs; i++) {
+                if (pCtx->pInbuf[i].bQueued == VIDEO_TRUE)
+                    continue;
+                pAddr[0] = pCtx->pInbuf[i].planes[0].addr;
+                dataSize[0] = 100;
+                inOps.Enqueue(hDec, pAddr, dataSize, 1, &header);
+            }
+            break;
+        case 1:
+            /* the client is done displaying a picture */
+            k = Test_Rand(TEST_NUM_CLIENT);
+            if (state[k] == CLIENT_HELD)
+                state[k] = CLIENT_FREE;
+            break;
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+            k = Test_Rand(TEST_NUM_CLIENT);
+            if (state[k] != CLIENT_FREE)
+                break;
+
+            for (i = 0; i < 2; i++) {
+                pAddr[i] = TEST_ADDR(512 + (k * 2) + i);
+                pFd[i] = TEST_FD(k) + i;
+                allocLen[i] = TEST_WIDTH * TEST_HEIGHT;
+                dataSize[i] = 0;
+            }
+
+            expectSlot = Test_HasSlot(pCtx, &refs, k);
+            ret = outOps.ExtensionEnqueue(hDec, pAddr, pFd, allocLen, dataSize, 2, NULL);
+            TEST_CHECK(ret == (expectSlot ? VIDEO_ERROR_NONE : VIDEO_ERROR_NOBUFFERS),
+                       "ExtensionEnqueue(%d) returned %d, a slot is %s", k, ret,
+                       expectSlot ? "free" : "not free");
+            if (ret == VIDEO_ERROR_NONE)
+                state[k] = CLIENT_QUEUED;
+            else
+                nNoSlot++;
+            Test_CheckSlots("enqueue", pCtx, state, &refs);
+            break;
+        default:
+            Test_Dequeue(&outOps, pCtx, state, &refs, nRefFrames, &nFrames);
+            break;
+        }
+    }
+
+    printf("  ref_frames %u: %d steps, %d pictures, %d enqueues without a free slot\n",
+           nRefFrames, nSteps, nFrames, nNoSlot);
+    TEST_CHECK(nFrames > 0, "ref_frames %u: no picture decoded", nRefFrames);
+
+    inOps.Stop(hDec);
+    outOps.Stop(hDec);
+
+EXIT:
+    ops.Finalize(hDec);
+    exynos_v4l2_fake_mfc_uninstall();
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned int refFrames[] = { 1, 2, 4, 8 };
+    int nSteps = TEST_DEFAULT_STEPS;
+    size_t i;
+
+    if (1 < argc)
+        nSteps = atoi(argv[1]);
+    if (nSteps <= 0) {
+        printf("usage: %s [steps]\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(refFrames) / sizeof(refFrames[0]); i++) {
+        if (Test_Run(refFrames[i], nSteps) != 0)
+            return 1;
+    }
+
+    printf("%s\n", (gFailures == 0) ? "PASS" : "FAIL");
+
+    return (gFailures == 0) ? 0 : 1;
+}
@@ -33,7 +33,7 @@ ExynosVirtualDisplay::ExynosVirtualDisplay(struct exynos5_hwc_composer_device_1_
         fbTargetInfo[i].mapSize = 0;
     }
 
-    memset(mDstHandles, 0x0, MAX_BUFFER_COUNT);
+    memset(mDstHandles, 0x0, sizeof(mDstHandles));
     mPrevDisplayFrame.left = 0;
     mPrevDisplayFrame.top = 0;
     mPrevDisplayFrame.right = 0;
@@ -222,7 +222,7 @@ bool ExynosVirtualDisplay::isNewHandle(void *dstHandle)
     }
 
     if (i == MAX_BUFFER_COUNT) {
-        memset(mDstHandles, 0x0, sizeof(int) * MAX_BUFFER_COUNT);
+        memset(mDstHandles, 0x0, sizeof(mDstHandles));
         mDstHandles[0] = dstHandle;
     }
     return true;
@@ -298,7 +298,7 @@ int ExynosVirtualDisplay::set(hwc_display_contents_1_t* contents)
 
             if (isLayerResized(overlay_layer) ||
                 (!isLayerFullSize(overlay_layer) && fb_layer && (mPrevFbHandle != newFbHandle))) {
-                memset(mDstHandles, 0x0, sizeof(int) * MAX_BUFFER_COUNT);
+                memset(mDstHandles, 0x0, sizeof(mDstHandles));
             }
 
             if (isNewHandle(dstHandle)) {